@@ -1,10 +1,23 @@
-cbuffer MatrixBuffer : register(b0)
+// Slots match FRAME_CONSTANT_SLOT, OBJECT_CONSTANT_SLOT, MESH_CONSTANT_SLOT and INSTANCE_VERTEX_SLOT in CRenderQueue.hpp.
+cbuffer FrameBuffer : register(b0)
 {
-    row_major matrix worldMatrix;
     row_major matrix viewMatrix;
     row_major matrix projectionMatrix;
 }
 
+cbuffer ObjectBuffer : register(b1)
+{
+    row_major matrix worldMatrix;
+}
+
+// VertexDecode_t of the mesh being drawn, for the packed entry points.
+cbuffer MeshBuffer : register(b3)
+{
+    float4 positionScale;
+    float4 positionBias;
+    float4 texcoordScaleBias;
+}
+
 struct VertexInput
 {
     float3 position : POSITION;
@@ -12,37 +25,96 @@ struct VertexInput
     float2 texcoord : TEXCOORD;
 };
 
+// PackedVertex_t; the unorm/snorm formats arrive as floats in [0, 1] and [-1, 1].
+struct PackedVertexInput
+{
+    float4 position : POSITION;
+    float2 normal : NORMAL;
+    float2 texcoord : TEXCOORD;
+};
+
+// InstanceData_t, read from vertex buffer slot 1 once per instance.
+struct InstanceInput
+{
+    float4 world0 : INSTANCE_WORLD0;
+    float4 world1 : INSTANCE_WORLD1;
+    float4 world2 : INSTANCE_WORLD2;
+    float4 world3 : INSTANCE_WORLD3;
+    float4 data : INSTANCE_DATA;
+};
+
 struct VertexOutput
 {
     float4 position : SV_POSITION;
     float3 normal : NORMAL;
     float2 texcoord : TEXCOORD;
+    float4 tint : COLOR;
 };
 
-VertexOutput VS(VertexInput input)
+VertexOutput TransformVertex(VertexInput input, float4x4 world, float4 tint)
 {
     VertexOutput output;
-    
+
     float4 pos = float4(input.position, 1.0f);
-    pos = mul(pos, worldMatrix);
+    pos = mul(pos, world);
     pos = mul(pos, viewMatrix);
     pos = mul(pos, projectionMatrix);
-    
+
     output.position = pos;
-    
-    float3 normal = mul(float4(input.normal, 0.0f), worldMatrix).xyz;
+
+    float3 normal = mul(float4(input.normal, 0.0f), world).xyz;
     output.normal = normalize(normal);
-    
+
     output.texcoord = input.texcoord;
-    
+    output.tint = tint;
+
+    return output;
+}
+
+// Inverse of CVertexPacker::EncodeOctahedral.
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = saturate(-normal.z);
+    normal.xy += (normal.xy >= 0.0f) ? -fold : fold;
+    return normalize(normal);
+}
+
+VertexInput DecodeVertex(PackedVertexInput input)
+{
+    VertexInput output;
+    output.position = input.position.xyz * positionScale.xyz + positionBias.xyz;
+    output.normal = DecodeOctahedral(input.normal);
+    output.texcoord = input.texcoord * texcoordScaleBias.xy + texcoordScaleBias.zw;
     return output;
 }
 
+VertexOutput VS(VertexInput input)
+{
+    return TransformVertex(input, worldMatrix, float4(1.0f, 1.0f, 1.0f, 1.0f));
+}
+
+VertexOutput VSInstanced(VertexInput input, InstanceInput instance)
+{
+    float4x4 world = float4x4(instance.world0, instance.world1, instance.world2, instance.world3);
+    return TransformVertex(input, world, instance.data);
+}
+
+VertexOutput VSPacked(PackedVertexInput input)
+{
+    return VS(DecodeVertex(input));
+}
+
+VertexOutput VSPackedInstanced(PackedVertexInput input, InstanceInput instance)
+{
+    return VSInstanced(DecodeVertex(input), instance);
+}
+
 float4 PS(VertexOutput input) : SV_Target
 {
     float3 lightDir = normalize(float3(1.0f, -1.0f, 1.0f));
     float3 normal = normalize(input.normal);
     float intensity = saturate(dot(normal, -lightDir));
     
-    return float4(intensity, intensity, intensity, 1.0f);
+    return float4(intensity * input.tint.rgb, input.tint.a);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 CCamera::CCamera()
 	: m_vecPosition(0.0f, 0.0f, 0.0f)
+	, m_vecPreviousPosition(0.0f, 0.0f, 0.0f)
 	, m_vecForward(0.0f, 0.0f, 1.0f)
 	, m_vecRight(1.0f, 0.0f, 0.0f)
 	, m_vecUp(0.0f, 1.0f, 0.0f)
@@ -13,6 +14,8 @@ CCamera::CCamera()
 }
 
 void CCamera::Update(float flDeltaTime, const bool* pKeys) {
+	m_vecPreviousPosition = m_vecPosition;
+
 	float flMoveSpeed = 1.0f * flDeltaTime;
 
 	if (pKeys['W']) {
@@ -67,6 +70,7 @@ void CCamera::OnMouseMove(int iDeltaX, int iDeltaY) {
 
 void CCamera::SetPosition(const CMath::Vector3_t& vecPosition) {
 	m_vecPosition = vecPosition;
+	m_vecPreviousPosition = vecPosition;
 	UpdateViewMatrix();
 }
 
@@ -80,6 +84,12 @@ const CMath::Matrix4x4_t& CCamera::GetViewMatrix() const {
 	return m_mViewMatrix;
 }
 
+CMath::Matrix4x4_t CCamera::GetInterpolatedViewMatrix(float flAlpha) const {
+	// Orientation isn't interpolated: mouse look is applied as it arrives, not per tick.
+	CMath::Vector3_t vecPosition = m_vecPreviousPosition + (m_vecPosition - m_vecPreviousPosition) * flAlpha;
+	return CMath::Matrix4x4_t::CreateLookAt(vecPosition, vecPosition + m_vecForward, m_vecUp);
+}
+
 const CMath::Vector3_t& CCamera::GetPosition() const {
 	return m_vecPosition;
 }
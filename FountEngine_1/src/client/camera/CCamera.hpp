@@ -12,6 +12,8 @@ public:
 	void SetRotation(float flYaw, float flPitch);
 
 	const CMath::Matrix4x4_t& GetViewMatrix() const;
+	// View from between the previous and the current tick's position, flAlpha in [0, 1].
+	CMath::Matrix4x4_t GetInterpolatedViewMatrix(float flAlpha) const;
 	const CMath::Vector3_t& GetPosition() const;
 	const CMath::Vector3_t& GetForward() const;
 
@@ -19,6 +21,7 @@ private:
 	void UpdateViewMatrix();
 
 	CMath::Vector3_t m_vecPosition;
+	CMath::Vector3_t m_vecPreviousPosition;
 	CMath::Vector3_t m_vecForward;
 	CMath::Vector3_t m_vecRight;
 	CMath::Vector3_t m_vecUp;
@@ -1,159 +1,148 @@
 #include "CApplication.hpp"
 
-#include <windowsx.h>
 #include <chrono>
+#include <cmath>
 
 #include "../../system/logging/CLogSystem.hpp"
-
-static CApplication* g_pApplication = nullptr;
-
-LRESULT CALLBACK OnWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-	return g_pApplication->HandleMessage(hWnd, uMsg, wParam, lParam);
-}
+#include "../../system/profiler/CProfiler.hpp"
 
 // Class Realization
-CApplication::CApplication() : m_hInstance(nullptr), m_hWnd(nullptr), m_nWidth(0), m_nHeight(0) {
-	g_pApplication = this;
-}
+CApplication::CApplication() : m_nWidth(0), m_nHeight(0) {}
 
 CApplication::~CApplication() {
-	ReleaseCapture();
+	// The graphics context releases its buffers through the backend it owns, before the window goes away.
+	m_pGraphicsContext.reset();
+	m_pWindow.reset();
 }
 
-bool CApplication::Initialize(HINSTANCE hInstance, const std::string& strWindowTitle, int nWidth, int nHeight) {
-	m_hInstance = hInstance;
+bool CApplication::Initialize(std::unique_ptr<IWindow> pWindow, std::unique_ptr<IRenderBackend> pBackend, const std::string& strWindowTitle, int nWidth, int nHeight) {
 	m_strWindowTitle = strWindowTitle;
 	m_nWidth = nWidth;
 	m_nHeight = nHeight;
+	m_pWindow = std::move(pWindow);
 
-	WNDCLASSEX wndClass = { 0 };
-	wndClass.cbSize = sizeof(WNDCLASSEX);
-	wndClass.style = CS_HREDRAW | CS_VREDRAW;
-	wndClass.lpfnWndProc = OnWndProc;
-	wndClass.hInstance = hInstance;
-	wndClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
-	wndClass.lpszClassName = "EngineMainWindowClass";
-
-	if (!RegisterClassExA(&wndClass)) {
-		LOG_ERROR("Failed to register window class!");
-		return false;
-	}
-
-	RECT rSize = { 0, 0, m_nWidth, m_nHeight };
-	AdjustWindowRect(&rSize, WS_OVERLAPPEDWINDOW, FALSE);
-
-	m_hWnd = CreateWindowEx(
-		0,
-		wndClass.lpszClassName,
-		m_strWindowTitle.c_str(),
-		WS_OVERLAPPEDWINDOW,
-		CW_USEDEFAULT, CW_USEDEFAULT,
-		rSize.right - rSize.left,
-		rSize.bottom - rSize.top,
-		nullptr, nullptr,
-		m_hInstance, nullptr
-	);
-
-	if (!m_hWnd) {
-		LOG_ERROR("Failed to create window!");
+	if (!m_pWindow->Create(m_strWindowTitle, m_nWidth, m_nHeight)) {
+		LOG_ERROR_CH(MAINLOOP, "Failed to create window!");
 		return false;
 	}
+	m_pWindow->SetListener(this);
 
-	ShowWindow(m_hWnd, SW_SHOW);
-	UpdateWindow(m_hWnd);
-
-	SetCapture(m_hWnd);
-	
 	m_pGraphicsContext = std::make_unique<CGraphicsContext>();
-	if (!m_pGraphicsContext->Initialize(m_hWnd, m_nWidth, m_nHeight)) {
-		LOG_FATAL("Failed to initialize graphics context!");
+	if (!m_pGraphicsContext->Initialize(std::move(pBackend), m_pWindow->GetNativeHandle(), m_nWidth, m_nHeight)) {
+		LOG_FATAL_CH(MAINLOOP, "Failed to initialize graphics context!");
 		return false;
 	}
 
-	LOG_INFO("Application successfully initialized!");
+	LOG_INFO_CH(MAINLOOP, "Application successfully initialized!");
 	return true;
 }
 
-int CApplication::Run() {
-	MSG mMsg = { 0 };
-
-	using clock = std::chrono::high_resolution_clock;
+int CApplication::Run(uint64_t nMaxFrames) {
+	using clock = std::chrono::steady_clock;
 	auto aPrevTime = clock::now();
+	double flAccumulator = 0.0;
+
+	auto ToMilliseconds = [](clock::duration tDuration) {
+		return std::chrono::duration<float, std::milli>(tDuration).count();
+	};
+
+	m_FrameTimings.clear();
+	m_FrameTimings.reserve(static_cast<size_t>(nMaxFrames));
 
-	while (mMsg.message != WM_QUIT) {
-		if (PeekMessage(&mMsg, nullptr, 0, 0, PM_REMOVE)) {
-			TranslateMessage(&mMsg);
-			DispatchMessage(&mMsg);
+	PROFILE_THREAD_NAME("Main");
+
+	for (uint64_t nFrame = 0; nMaxFrames == 0 || nFrame < nMaxFrames; ++nFrame) {
+		// Handle all pending input before simulating, so it can't back up behind rendering.
+		int nExitCode = 0;
+		if (!m_pWindow->PumpEvents(nExitCode)) {
+			return nExitCode;
 		}
-		else {
-			auto aCurrentTime = clock::now();
-			float flDeltaTime = std::chrono::duration<float>(aCurrentTime - aPrevTime).count();
-			aPrevTime = aCurrentTime;
 
-			m_pGraphicsContext->UpdateCamera(flDeltaTime, m_aKeys);
+		auto aCurrentTime = clock::now();
+		flAccumulator += std::chrono::duration<double>(aCurrentTime - aPrevTime).count();
+		aPrevTime = aCurrentTime;
 
-			m_pGraphicsContext->BeginFrame();
-			m_pGraphicsContext->DrawCube();
-			m_pGraphicsContext->EndFrame();
+		int nSteps = 0;
+		while (flAccumulator >= FIXED_TIMESTEP && nSteps < MAX_STEPS_PER_FRAME) {
+			m_pGraphicsContext->FixedUpdate(static_cast<float>(FIXED_TIMESTEP), m_aKeys);
+			flAccumulator -= FIXED_TIMESTEP;
+			++nSteps;
 		}
-	}
 
-	return static_cast<int>(mMsg.wParam);
-}
+		if (flAccumulator >= FIXED_TIMESTEP) {
+			// Drop the whole steps that didn't fit and keep the partial one for interpolation.
+			const double flRemainder = std::fmod(flAccumulator, FIXED_TIMESTEP);
+			const double flDropped = flAccumulator - flRemainder;
+			LOG_DEBUG_CH(MAINLOOP, "Simulation fell behind, dropping %.0f steps (%.1f ms)", flDropped / FIXED_TIMESTEP, flDropped * 1000.0);
+			flAccumulator = flRemainder;
+		}
 
-LRESULT CApplication::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-	switch (uMsg)
-	{
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		return 0;
-
-	case WM_LBUTTONDOWN:
-		SetCapture(m_hWnd);
-		return 0;
-
-	case WM_LBUTTONUP:
-		ReleaseCapture();
-		return 0;
-
-	case WM_KILLFOCUS:
-		ReleaseCapture();
-		return 0;
-
-	case WM_KEYDOWN:
-		OnKeyDown(wParam);
-		return 0;
-
-	case WM_KEYUP:
-		OnKeyUp(wParam);
-		return 0;
-	
-	case WM_MOUSEMOVE: {
-		int x = GET_X_LPARAM(lParam);
-		int y = GET_Y_LPARAM(lParam);
-
-		static int iPrevX = x;
-		static int iPrevY = y;
-		int iDeltaX = x - iPrevX;
-		int iDeltaY = y - iPrevY;
-		iPrevX = x;
-		iPrevY = y;
-
-		if (GetCapture() == m_hWnd) {
-			m_pGraphicsContext->OnMouseMove(iDeltaX, iDeltaY);
+		auto aRenderStart = clock::now();
+		m_pGraphicsContext->BeginFrame(static_cast<float>(flAccumulator / FIXED_TIMESTEP));
+		m_pGraphicsContext->DrawCube();
+		m_pGraphicsContext->EndFrame();
+		auto aRenderEnd = clock::now();
+
+		m_FrameLimiter.WaitForNextFrame();
+		PROFILE_FRAME();
+
+		if (nMaxFrames != 0) {
+			m_FrameTimings.push_back({
+				ToMilliseconds(aRenderStart - aCurrentTime),
+				ToMilliseconds(aRenderEnd - aRenderStart),
+				ToMilliseconds(clock::now() - aCurrentTime),
+				m_pGraphicsContext->GetRenderQueue().GetFrameStats(),
+				m_pGraphicsContext->GetScene().GetUpdateStats(),
+				m_pGraphicsContext->GetCullStats(),
+				m_pGraphicsContext->GetLODStats(),
+				m_pGraphicsContext->GetClusterCullStats()
+			});
 		}
+	}
+
+	return 0;
+}
 
-		return 0;
+void CApplication::OnKeyDown(uint32_t nKey) {
+	LOG_DEBUG_CH(INPUT, "Key down 0x%02X", nKey);
+	if (nKey < 256) {
+		m_aKeys[nKey] = true;
 	}
+
+	// F8 picks the entity in the middle of the view.
+	if (nKey == KEY_F8) {
+		float flDistance = 0.0f;
+		EntityHandle_t hEntity = m_pGraphicsContext->PickEntity(1000.0f, &flDistance);
+		if (hEntity != INVALID_ENTITY) {
+			LOG_INFO_CH(MAINLOOP, "Picked entity %u at %.2f", hEntity, flDistance);
+		}
+		else {
+			LOG_INFO_CH(MAINLOOP, "Picked nothing");
+		}
 	}
 
-	return DefWindowProc(hWnd, uMsg, wParam, lParam);
+#if FOUNT_PROFILER_ENABLED
+	// F9 starts and stops a profiler capture.
+	if (nKey == KEY_F9) {
+		CProfiler& Profiler = CProfiler::GetInstance();
+		if (Profiler.IsCapturing()) {
+			Profiler.EndCapture("profile_capture.json");
+		}
+		else {
+			LOG_INFO_CH(MAINLOOP, "Profiler capture started");
+			Profiler.BeginCapture();
+		}
+	}
+#endif
 }
 
-void CApplication::OnKeyDown(WPARAM wKey) {
-	m_aKeys[wKey] = true;
+void CApplication::OnKeyUp(uint32_t nKey) {
+	LOG_DEBUG_CH(INPUT, "Key up 0x%02X", nKey);
+	if (nKey < 256) {
+		m_aKeys[nKey] = false;
+	}
 }
 
-void CApplication::OnKeyUp(WPARAM wKey) {
-	m_aKeys[wKey] = false;
-}
\ No newline at end of file
+void CApplication::OnMouseMove(int iDeltaX, int iDeltaY) {
+	m_pGraphicsContext->OnMouseMove(iDeltaX, iDeltaY);
+}
@@ -1,34 +1,64 @@
 #pragma once
-#include <Windows.h>
-
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "../../engine/graphicscontext/CGraphicsContext.hpp"
+#include "../../engine/window/IWindow.hpp"
+#include "../../render/backend/IRenderBackend.hpp"
+#include "../../system/time/CFrameLimiter.hpp"
 
-class CApplication {
+class CApplication : public IWindowListener {
 public:
+	// CPU time of one frame of Run(), in milliseconds, and what its scene update, culling and render queue did.
+	struct FrameTiming_t {
+		float flSimulateMs; // fixed steps
+		float flRenderMs; // BeginFrame to EndFrame, includes present
+		float flFrameMs; // whole frame, includes the frame limiter
+		RenderQueueStats_t QueueStats;
+		SceneUpdateStats_t SceneStats;
+		CullStats_t CullStats;
+		LODStats_t LODStats;
+		ClusterCullStats_t ClusterStats;
+	};
+
 	CApplication();
-	~CApplication();
+	~CApplication() override;
 
 	CApplication(const CApplication&) = delete;
 	CApplication& operator=(const CApplication&) = delete;
 
-	bool Initialize(HINSTANCE hInstance, const std::string& strWindowTitle, int nWidth, int nHeight);
-	int Run();
+	// A CWin32Window with CD3D11RenderBackend for the game, CHeadlessWindow with CNullRenderBackend for load tests.
+	bool Initialize(std::unique_ptr<IWindow> pWindow, std::unique_ptr<IRenderBackend> pBackend, const std::string& strWindowTitle, int nWidth, int nHeight);
+
+	// Runs until the window closes, or for nMaxFrames frames when that isn't 0.
+	// Bounded runs record the timing of every frame, see GetFrameTimings().
+	int Run(uint64_t nMaxFrames = 0);
 
-	LRESULT HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+	// 0 leaves pacing to vsync.
+	void SetFrameRateLimit(int nFramesPerSecond) { m_FrameLimiter.SetTargetFrameRate(nFramesPerSecond); }
 
-	void OnKeyDown(WPARAM wKey);
-	void OnKeyUp(WPARAM wKey);
+	const std::vector<FrameTiming_t>& GetFrameTimings() const { return m_FrameTimings; }
+	CGraphicsContext& GetGraphicsContext() { return *m_pGraphicsContext; }
+
+	void OnKeyDown(uint32_t nKey) override;
+	void OnKeyUp(uint32_t nKey) override;
+	void OnMouseMove(int iDeltaX, int iDeltaY) override;
 
 private:
-	HINSTANCE m_hInstance;
-	HWND m_hWnd;
+	static constexpr double FIXED_TIMESTEP = 1.0 / 60.0;
+	// Catch-up cap: past this many steps per frame, simulation time is dropped rather than
+	// letting each slow frame schedule even more work for the next one.
+	static constexpr int MAX_STEPS_PER_FRAME = 5;
+
 	std::string m_strWindowTitle;
 	int m_nWidth, m_nHeight;
 
 	bool m_aKeys[256] = { false };
 
+	std::unique_ptr<IWindow> m_pWindow;
 	std::unique_ptr<CGraphicsContext> m_pGraphicsContext;
-};
\ No newline at end of file
+	CFrameLimiter m_FrameLimiter;
+
+	std::vector<FrameTiming_t> m_FrameTimings;
+};
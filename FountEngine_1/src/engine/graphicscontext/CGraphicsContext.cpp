@@ -1,249 +1,321 @@
 #include "CGraphicsContext.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 #include "../../render/vertex/Vertex_t.hpp"
 #include "../../system/logging/CLogSystem.hpp"
+#include "../../system/profiler/CProfiler.hpp"
 #include "../../resources/resourcemanager/IResourceManager.hpp"
 
 CGraphicsContext::CGraphicsContext() = default;
 CGraphicsContext::~CGraphicsContext() {
-	if (m_pIndexBuffer) m_pIndexBuffer->Release();
-	if (m_pConstantBuffer) m_pConstantBuffer->Release();
-
-	if (m_pVertexBuffer) m_pVertexBuffer->Release();
-	if (m_pInputLayout) m_pInputLayout->Release();
-	if (m_pVertexShader) m_pVertexShader->Release();
-	if (m_pPixelShader) m_pPixelShader->Release();
-
-	if (m_pRenderTargetView) m_pRenderTargetView->Release();
-	if (m_pSwapChain) m_pSwapChain->Release();
-	if (m_pDeviceContext) m_pDeviceContext->Release();
-	if (m_pDevice) m_pDevice->Release();
+	// Meshes may outlive us in the resource cache; their buffers are released through the backend.
+	m_CurrentMesh = CMeshHandle();
+	IResourceManager::GetInstance().ReleaseGPUResources();
+
+	if (m_pBackend) {
+		m_RenderQueue.ReleaseBuffers(*m_pBackend);
+	}
 }
 
-bool CGraphicsContext::Initialize(HWND hWnd, int nWidth, int nHeight) {
+bool CGraphicsContext::Initialize(std::unique_ptr<IRenderBackend> pBackend, void* pNativeWindow, int nWidth, int nHeight) {
 	m_nWidth = nWidth;
 	m_nHeight = nHeight;
+	m_pBackend = std::move(pBackend);
 
-	DXGI_SWAP_CHAIN_DESC scd = { 0 };
-	scd.BufferCount = 1;
-	scd.BufferDesc.Width = nWidth;
-	scd.BufferDesc.Height = nHeight;
-	scd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	scd.BufferDesc.RefreshRate.Numerator = 60; // 60 Hz
-	scd.BufferDesc.RefreshRate.Denominator = 1;
-	scd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	scd.OutputWindow = hWnd;
-	scd.SampleDesc.Count = 1;
-	scd.Windowed = TRUE;
-	scd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
-
-	UINT uCreateDeviceFlags = 0;
-
-#ifdef _DEBUG
-	uCreateDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-	D3D_FEATURE_LEVEL fLevel;
-	HRESULT hResult = D3D11CreateDeviceAndSwapChain(
-		nullptr,
-		D3D_DRIVER_TYPE_HARDWARE,
-		nullptr,
-		uCreateDeviceFlags,
-		nullptr, 0,
-		D3D11_SDK_VERSION,
-		&scd,
-		&m_pSwapChain,
-		&m_pDevice,
-		&fLevel,
-		&m_pDeviceContext
-	);
-
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create D3D11 device and swap chain!");
+	if (!m_pBackend || !m_pBackend->Initialize(pNativeWindow, nWidth, nHeight)) {
+		LOG_ERROR_CH(RENDER, "Failed to initialize render backend!");
 		return false;
 	}
 
-	ID3D11Texture2D* pBackBuffer = nullptr;
-	hResult = m_pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&pBackBuffer));
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to get back buffer!");
-		return false;
-	}
+	BufferDesc_t ConstantBufferDesc;
+	ConstantBufferDesc.eType = BUFFER_CONSTANT;
+	ConstantBufferDesc.nSize = sizeof(CMath::Matrix4x4_t) * 2;
+	ConstantBufferDesc.bDynamic = true;
 
-	hResult = m_pDevice->CreateRenderTargetView(pBackBuffer, nullptr, &m_pRenderTargetView);
-	pBackBuffer->Release();
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create render target view!");
+	m_hFrameConstantBuffer = m_pBackend->CreateBuffer(ConstantBufferDesc);
+	if (m_hFrameConstantBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create frame constant buffer!");
 		return false;
 	}
 
-	D3D11_BUFFER_DESC dxConstantBufferDesc = {};
-	dxConstantBufferDesc.ByteWidth = sizeof(CMath::Matrix4x4_t) * 3;
-	dxConstantBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	dxConstantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	dxConstantBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-	hResult = m_pDevice->CreateBuffer(&dxConstantBufferDesc, nullptr, &m_pConstantBuffer);
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create constant buffer!");
+	ConstantBufferDesc.nSize = sizeof(CMath::Matrix4x4_t);
+	m_hObjectConstantBuffer = m_pBackend->CreateBuffer(ConstantBufferDesc);
+	if (m_hObjectConstantBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create object constant buffer!");
 		return false;
 	}
 
-	D3D11_VIEWPORT viewport = {};
-	viewport.TopLeftX = 0;
-	viewport.TopLeftY = 0;
-	viewport.Width = static_cast<float>(nWidth);
-	viewport.Height = static_cast<float>(nHeight);
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	m_pDeviceContext->RSSetViewports(1, &viewport);
-
-	if (!CompileShaders()) {
-		return false;
+	// In the order of GetPipelineDescs().
+	RenderHandle_t* apPipelines[] = { &m_hPipeline, &m_hInstancedPipeline, &m_hPackedPipeline, &m_hPackedInstancedPipeline };
+	const std::vector<PipelineDesc_t> PipelineDescs = GetPipelineDescs();
+	for (size_t i = 0; i < PipelineDescs.size(); ++i) {
+		*apPipelines[i] = m_pBackend->CreatePipeline(PipelineDescs[i]);
+		if (*apPipelines[i] == INVALID_RENDER_HANDLE) {
+			LOG_ERROR_CH(RENDER, "Failed to create shader pipeline %s (%s)!", PipelineDescs[i].strShaderPath.c_str(), PipelineDescs[i].strVertexEntry.c_str());
+			return false;
+		}
 	}
 
 	if (!CreateCubeBuffers()) {
 		return false;
 	}
 
+	m_hCubeEntity = m_Scene.CreateEntity();
+	m_Scene.SetLocalBounds(m_hCubeEntity, CMath::Vector3_t(-0.5f, -0.5f, -0.5f), CMath::Vector3_t(0.5f, 0.5f, 0.5f));
+
 	m_Camera.SetPosition(CMath::Vector3_t(0.0f, 0.0f, -3.0f));
 	this->LoadMesh("game/models/cube.obj");
 
 	return true;
 }
 
+std::vector<PipelineDesc_t> CGraphicsContext::GetPipelineDescs() {
+	std::vector<PipelineDesc_t> PipelineDescs;
+
+	PipelineDesc_t PipelineDesc;
+	PipelineDesc.strShaderPath = "game/shaders/shaders.hlsl";
+	PipelineDesc.VertexLayout = {
+		{ "POSITION", 0, VERTEX_FLOAT3, 0 },
+		{ "NORMAL", 0, VERTEX_FLOAT3, 12 },
+		{ "TEXCOORD", 0, VERTEX_FLOAT2, 24 }
+	};
+	PipelineDescs.push_back(PipelineDesc);
+
+	// Same vertices, plus InstanceData_t rows from INSTANCE_VERTEX_SLOT.
+	PipelineDesc.strVertexEntry = "VSInstanced";
+	PipelineDesc.VertexLayout.insert(PipelineDesc.VertexLayout.end(), {
+		{ "INSTANCE_WORLD", 0, VERTEX_FLOAT4, 0, INSTANCE_VERTEX_SLOT, true },
+		{ "INSTANCE_WORLD", 1, VERTEX_FLOAT4, 16, INSTANCE_VERTEX_SLOT, true },
+		{ "INSTANCE_WORLD", 2, VERTEX_FLOAT4, 32, INSTANCE_VERTEX_SLOT, true },
+		{ "INSTANCE_WORLD", 3, VERTEX_FLOAT4, 48, INSTANCE_VERTEX_SLOT, true },
+		{ "INSTANCE_DATA", 0, VERTEX_FLOAT4, 64, INSTANCE_VERTEX_SLOT, true }
+	});
+	PipelineDescs.push_back(PipelineDesc);
+
+	// PackedVertex_t, decoded with the mesh's VertexDecode_t at MESH_CONSTANT_SLOT.
+	const VertexElement_t aPackedElements[] = {
+		{ "POSITION", 0, VERTEX_UNORM16X4, 0 },
+		{ "NORMAL", 0, VERTEX_SNORM16X2, 8 },
+		{ "TEXCOORD", 0, VERTEX_UNORM16X2, 12 }
+	};
+	PipelineDesc_t PackedInstancedDesc = PipelineDesc;
+	PackedInstancedDesc.strVertexEntry = "VSPackedInstanced";
+	std::copy(std::begin(aPackedElements), std::end(aPackedElements), PackedInstancedDesc.VertexLayout.begin());
+
+	PipelineDesc.strVertexEntry = "VSPacked";
+	PipelineDesc.VertexLayout.assign(std::begin(aPackedElements), std::end(aPackedElements));
+	PipelineDescs.push_back(PipelineDesc);
+	PipelineDescs.push_back(std::move(PackedInstancedDesc));
+	return PipelineDescs;
+}
+
 void CGraphicsContext::OnMouseMove(int iDeltaX, int iDeltaY) {
 	m_Camera.OnMouseMove(-iDeltaX, iDeltaY);
 }
 
-void CGraphicsContext::UpdateCamera(float flDeltaTime, const bool* pKeys) {
-	m_Camera.Update(flDeltaTime, pKeys);
+EntityHandle_t CGraphicsContext::PickEntity(float flMaxDistance, float* pHitDistance) {
+	PROFILE_FUNCTION();
+	return m_Scene.RayCast(m_Camera.GetPosition(), m_Camera.GetForward(), flMaxDistance, pHitDistance);
 }
 
-void CGraphicsContext::BeginFrame() {
-	if (!m_pDeviceContext || !m_pRenderTargetView) {
-		return;
-	}
+void CGraphicsContext::FixedUpdate(float flTimeStep, const bool* pKeys) {
+	PROFILE_FUNCTION();
+
+	m_Camera.Update(flTimeStep, pKeys);
+
+	m_flPreviousCubeRotation = m_flCubeRotation;
+	m_flCubeRotation += CUBE_ROTATION_SPEED * flTimeStep;
+}
+
+void CGraphicsContext::BeginFrame(float flInterpolation) {
+	m_flInterpolation = flInterpolation;
 
-	m_pDeviceContext->OMSetRenderTargets(1, &m_pRenderTargetView, nullptr);
+	IResourceManager::GetInstance().ProcessPendingLoads(*m_pBackend);
 
 	const float aClearColor[4] = { 0.2f, 0.4f, 0.7f, 1.0f };
-	m_pDeviceContext->ClearRenderTargetView(m_pRenderTargetView, aClearColor);
+	m_pBackend->BeginFrame(aClearColor);
+
+	m_RenderQueue.Clear();
+	m_LODStats = LODStats_t();
+	UpdateFrameConstants();
+
+	// The grid turns with the cube, so with it in the scene every frame recomputes all of its entities.
+	float flRotationAngle = m_flPreviousCubeRotation + (m_flCubeRotation - m_flPreviousCubeRotation) * m_flInterpolation;
+	CMath::Matrix4x4_t mRotation = CMath::Matrix4x4_t::CreateRotationY(flRotationAngle);
+	m_Scene.SetLocalTransform(m_hCubeEntity, mRotation);
+	if (m_hCubeGridEntity != INVALID_ENTITY) {
+		m_Scene.SetLocalTransform(m_hCubeGridEntity, mRotation);
+	}
+	m_Scene.UpdateTransforms();
 }
 
 void CGraphicsContext::EndFrame() {
-	if (!m_pSwapChain) {
-		return;
-	}
+	m_RenderQueue.Execute(*m_pBackend, m_hObjectConstantBuffer);
 
-	m_pSwapChain->Present(1, 0);
+	PROFILE_SCOPE("Present");
+	m_pBackend->EndFrame();
 }
 
 void CGraphicsContext::DrawCube() {
-	UpdateMatrices();
+	PROFILE_FUNCTION();
+
+	m_VisibleEntities.clear();
+	m_FrustumCuller.CullAABBs(
+		CMath::ConstVector3SoA_t(m_Scene.GetWorldCentersX(), m_Scene.GetWorldCentersY(), m_Scene.GetWorldCentersZ()),
+		CMath::ConstVector3SoA_t(m_Scene.GetWorldExtentsX(), m_Scene.GetWorldExtentsY(), m_Scene.GetWorldExtentsZ()),
+		m_VisibleEntities);
+
+	DrawPacket_t Packet;
+	Packet.hPipeline = m_hPipeline;
+	Packet.hVertexBuffer = m_hVertexBuffer;
+	Packet.hIndexBuffer = m_hIndexBuffer;
+	Packet.nVertexStride = sizeof(Vertex_t);
+	Packet.eIndexFormat = INDEX_UINT32;
+	Packet.nIndexCount = m_nIndexCount;
+
+	std::span<const EntityHandle_t> Entities = m_Scene.GetEntities();
+	std::span<const CMath::Matrix4x4_t> WorldTransforms = m_Scene.GetWorldTransforms();
+	m_CubeInstances.clear();
+	for (uint32_t nIndex : m_VisibleEntities) {
+		EntityHandle_t hEntity = Entities[nIndex];
+		if (hEntity == m_hCubeEntity) {
+			const CMath::Matrix4x4_t& mWorld = WorldTransforms[nIndex];
+			Packet.nSortKey = CRenderQueue::MakeSortKey(PASS_OPAQUE, m_hPipeline, 0, m_hVertexBuffer, GetViewDepth(mWorld));
+			m_RenderQueue.Submit(Packet, mWorld);
+		}
+		else if (const uint32_t nSlot = CScene::GetHandleIndex(hEntity); nSlot < m_CubeGridIndices.size() && m_CubeGridIndices[nSlot] != INVALID_GRID_INDEX) {
+			InstanceData_t& Instance = m_CubeInstances.emplace_back();
+			Instance.mWorld = WorldTransforms[nIndex];
+			Instance.vecData = m_CubeGridTints[m_CubeGridIndices[nSlot]];
+		}
+	}
+
+	if (!m_CubeInstances.empty()) {
+		Packet.hPipeline = m_hInstancedPipeline;
+		Packet.nSortKey = CRenderQueue::MakeSortKey(PASS_OPAQUE, m_hInstancedPipeline, 0, m_hVertexBuffer, 0.0f);
+		m_RenderQueue.SubmitInstanced(Packet, m_CubeInstances);
+	}
 
-	m_pDeviceContext->VSSetShader(m_pVertexShader, nullptr, 0);
-	m_pDeviceContext->PSSetShader(m_pPixelShader, nullptr, 0);
-	m_pDeviceContext->IASetInputLayout(m_pInputLayout);
+	// Off by default: dense meshes are only affordable every frame thanks to their LODs.
+	if (m_bMeshEnabled) {
+		RenderMesh();
+	}
+}
 
-	m_pDeviceContext->VSSetConstantBuffers(0, 1, &m_pConstantBuffer);
+void CGraphicsContext::SetCubeInstanceCount(uint32_t nCount) {
+	m_Scene.DestroyEntity(m_hCubeGridEntity);
+	m_hCubeGridEntity = INVALID_ENTITY;
+	m_CubeGridIndices.clear();
+	m_CubeGridTints.clear();
+	if (nCount == 0) {
+		return;
+	}
 
-	UINT stride = sizeof(Vertex_t);
-	UINT offset = 0;
-	m_pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
-	m_pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	// A square grid on the XZ plane below the cube, tinted by position.
+	constexpr float GRID_SPACING = 1.5f;
+	const uint32_t nSide = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(nCount))));
+	const float flHalfExtent = (nSide - 1) * GRID_SPACING * 0.5f;
+
+	m_hCubeGridEntity = m_Scene.CreateEntity();
+	m_CubeGridTints.resize(nCount);
+	for (uint32_t i = 0; i < nCount; ++i) {
+		uint32_t nRow = i / nSide;
+		uint32_t nColumn = i % nSide;
+
+		EntityHandle_t hEntity = m_Scene.CreateEntity(m_hCubeGridEntity);
+		m_Scene.SetLocalTransform(hEntity, CMath::Matrix4x4_t::CreateTranslation(
+			nColumn * GRID_SPACING - flHalfExtent, -2.0f, nRow * GRID_SPACING - flHalfExtent));
+		m_Scene.SetLocalBounds(hEntity, CMath::Vector3_t(-0.5f, -0.5f, -0.5f), CMath::Vector3_t(0.5f, 0.5f, 0.5f));
+
+		const uint32_t nSlot = CScene::GetHandleIndex(hEntity);
+		if (nSlot >= m_CubeGridIndices.size()) {
+			m_CubeGridIndices.resize(nSlot + 1, INVALID_GRID_INDEX);
+		}
+		m_CubeGridIndices[nSlot] = i;
+		m_CubeGridTints[i] = CMath::Vector4_t(static_cast<float>(nColumn) / nSide, 0.5f, static_cast<float>(nRow) / nSide, 1.0f);
+	}
+}
 
-	m_pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	m_pDeviceContext->DrawIndexed(m_nIndexCount, 0, 0);
+void CGraphicsContext::DrawMeshInstanced(const CMesh& Mesh, std::span<const InstanceData_t> Instances) {
+	DrawPacket_t Packet;
+	if (!Mesh.FillDrawPacket(Packet)) {
+		return;
+	}
 
-	// RenderMesh(); WHY YOU CRUSHING MY VIDEOCARD??????
+	Packet.hPipeline = Mesh.HasPackedVertices() ? m_hPackedInstancedPipeline : m_hInstancedPipeline;
+	Packet.nSortKey = CRenderQueue::MakeSortKey(PASS_OPAQUE, Packet.hPipeline, 0, Mesh.GetVertexBuffer(), 0.0f);
+	m_RenderQueue.SubmitInstanced(Packet, Instances);
 }
 
 bool CGraphicsContext::LoadMesh(const std::string& strFilename) {
-	m_pCurrentMesh = IResourceManager::GetInstance().GetMesh(strFilename);
-	if (m_pCurrentMesh) {
-		return CreateMeshBuffers();
-	}
-	return false;
+	// Buffers are created by the resource manager at the start of the frame the load finishes in.
+	m_CurrentMesh = IResourceManager::GetInstance().GetMeshAsync(strFilename);
+	return m_CurrentMesh.IsValid();
 }
 
 bool CGraphicsContext::CreateMeshBuffers() {
-	if (m_pCurrentMesh) {
-		return m_pCurrentMesh->CreateBuffers(m_pDevice);
+	if (auto pMesh = m_CurrentMesh.Get()) {
+		return pMesh->CreateBuffers(*m_pBackend);
 	}
 	return false;
 }
 
 void CGraphicsContext::RenderMesh() {
-	if (m_pCurrentMesh) {
-		m_pCurrentMesh->Render(m_pDeviceContext);
+	auto pMesh = m_CurrentMesh.Get();
+	if (!pMesh || !pMesh->HasBuffers()) {
+		return;
 	}
-}
 
-bool CGraphicsContext::CompileShaders() {
-	ID3DBlob* pVsBlob = nullptr;
-	HRESULT hResult = D3DCompileFromFile(
-		L"game/shaders/shaders.hlsl",
-		nullptr, nullptr,
-		"VS", "vs_5_0",
-		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
-		0, &pVsBlob,
-		nullptr
-	);
-
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to compile vertex shader!");
-		return false;
+	// Sphere and LOD error scale with the largest axis of the transform.
+	const CMath::Matrix4x4_t& mWorld = m_mMeshWorld;
+	float flScale = 0.0f;
+	for (int nAxis = 0; nAxis < 3; ++nAxis) {
+		flScale = std::max(flScale, CMath::Vector3_t(mWorld.m[nAxis][0], mWorld.m[nAxis][1], mWorld.m[nAxis][2]).Length());
 	}
-
-	hResult = m_pDevice->CreateVertexShader(pVsBlob->GetBufferPointer(), pVsBlob->GetBufferSize(), nullptr, &m_pVertexShader);
-	if (FAILED(hResult)) {
-		pVsBlob->Release();
-		LOG_ERROR("Failed to create vertex shader!");
-		return false;
+	const CMath::Vector3_t& vecLocalCenter = pMesh->GetBoundingSphereCenter();
+	const CMath::Vector3_t vecCenter(
+		vecLocalCenter.x * mWorld.m[0][0] + vecLocalCenter.y * mWorld.m[1][0] + vecLocalCenter.z * mWorld.m[2][0] + mWorld.m[3][0],
+		vecLocalCenter.x * mWorld.m[0][1] + vecLocalCenter.y * mWorld.m[1][1] + vecLocalCenter.z * mWorld.m[2][1] + mWorld.m[3][1],
+		vecLocalCenter.x * mWorld.m[0][2] + vecLocalCenter.y * mWorld.m[1][2] + vecLocalCenter.z * mWorld.m[2][2] + mWorld.m[3][2]);
+	const float flRadius = pMesh->GetBoundingSphereRadius() * flScale;
+	if (!m_FrustumCuller.IsSphereVisible(vecCenter, flRadius)) {
+		return;
 	}
 
-	ID3DBlob* pPsBlob = nullptr;
-	hResult = D3DCompileFromFile(
-		L"game/shaders/shaders.hlsl",
-		nullptr, nullptr,
-		"PS", "ps_5_0",
-		D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
-		0, &pPsBlob,
-		nullptr
-	);
-
-	if (FAILED(hResult)) {
-		pVsBlob->Release();
-		LOG_ERROR("Failed to compile pixel shader!");
-		return false;
-	}
+	// Distance to the nearest point of the sphere, so no part of the mesh is closer than the LOD assumes.
+	const float flDistance = std::max((vecCenter - m_Camera.GetPosition()).Length() - flRadius, 0.0f);
+	const uint32_t nLOD = flScale > 0.0f ? pMesh->SelectLOD(flDistance / flScale, m_flLODPixelsPerUnit, MAX_LOD_PIXEL_ERROR) : 0;
 
-	hResult = m_pDevice->CreatePixelShader(pPsBlob->GetBufferPointer(), pPsBlob->GetBufferSize(), nullptr, &m_pPixelShader);
-	if (FAILED(hResult)) {
-		pVsBlob->Release();
-		pPsBlob->Release();
-		LOG_ERROR("Failed to create pixel shader!");
-		return false;
+	DrawPacket_t Packet;
+	if (!pMesh->FillDrawPacket(Packet, nLOD)) {
+		return;
 	}
 
-	D3D11_INPUT_ELEMENT_DESC layout[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12 , D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24 , D3D11_INPUT_PER_VERTEX_DATA, 0}
-	};
-	UINT nElements = ARRAYSIZE(layout);
+	++m_LODStats.nDraws;
+	m_LODStats.nFullTriangles += pMesh->GetLODs()[0].nIndexCount / 3;
 
-	hResult = m_pDevice->CreateInputLayout(layout, nElements, pVsBlob->GetBufferPointer(), pVsBlob->GetBufferSize(), &m_pInputLayout);
-	pVsBlob->Release();
-	pPsBlob->Release();
+	Packet.hPipeline = pMesh->HasPackedVertices() ? m_hPackedPipeline : m_hPipeline;
+	Packet.nSortKey = CRenderQueue::MakeSortKey(PASS_OPAQUE, Packet.hPipeline, 0, pMesh->GetVertexBuffer(), GetViewDepth(mWorld));
 
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create input layout!");
-		return false;
+	// Close enough for full detail means big on screen, so it's worth culling its clusters one by one.
+	std::span<const Meshlet_t> Meshlets = pMesh->GetMeshlets();
+	if (nLOD != 0 || Meshlets.size() < 2) {
+		m_LODStats.nTriangles += Packet.nIndexCount / 3;
+		m_RenderQueue.Submit(Packet, mWorld);
+		return;
 	}
 
-	return true;
+	m_MeshletRanges.clear();
+	m_FrustumCuller.CullMeshlets(Meshlets, mWorld, m_Camera.GetPosition(), m_MeshletRanges);
+	for (const IndexRange_t& Range : m_MeshletRanges) {
+		Packet.nStartIndex = Range.nStartIndex;
+		Packet.nIndexCount = Range.nIndexCount;
+		m_LODStats.nTriangles += Range.nIndexCount / 3;
+		m_RenderQueue.Submit(Packet, mWorld);
+	}
 }
 
 bool CGraphicsContext::CreateCubeBuffers() {
@@ -288,33 +360,25 @@ bool CGraphicsContext::CreateCubeBuffers() {
 		20, 21, 22, 20, 22, 23
 	};
 
-	D3D11_BUFFER_DESC vbd = {};
-	vbd.ByteWidth = sizeof(vertices);
-	vbd.Usage = D3D11_USAGE_DEFAULT;
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = 0;
-
-	D3D11_SUBRESOURCE_DATA dxVInitData = {};
-	dxVInitData.pSysMem = vertices;
+	BufferDesc_t VertexBufferDesc;
+	VertexBufferDesc.eType = BUFFER_VERTEX;
+	VertexBufferDesc.nSize = sizeof(vertices);
+	VertexBufferDesc.pInitialData = vertices;
 
-	HRESULT hResult = m_pDevice->CreateBuffer(&vbd, &dxVInitData, &m_pVertexBuffer);
-	if (FAILED(hResult)) {
-		MessageBox(nullptr, "Failed to create vertex buffer!", "Engine Error", MB_ICONEXCLAMATION | MB_OK);
+	m_hVertexBuffer = m_pBackend->CreateBuffer(VertexBufferDesc);
+	if (m_hVertexBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create vertex buffer!");
 		return false;
 	}
 
-	D3D11_BUFFER_DESC ibd = {};
-	ibd.ByteWidth = sizeof(indices);
-	ibd.Usage = D3D11_USAGE_DEFAULT;
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.CPUAccessFlags = 0;
+	BufferDesc_t IndexBufferDesc;
+	IndexBufferDesc.eType = BUFFER_INDEX;
+	IndexBufferDesc.nSize = sizeof(indices);
+	IndexBufferDesc.pInitialData = indices;
 
-	D3D11_SUBRESOURCE_DATA dxIInitData = {};
-	dxIInitData.pSysMem = indices;
-
-	hResult = m_pDevice->CreateBuffer(&ibd, &dxIInitData, &m_pIndexBuffer);
-	if (FAILED(hResult)) {
-		MessageBox(nullptr, "Failed to create index buffer!", "Engine Error", MB_ICONEXCLAMATION | MB_OK);
+	m_hIndexBuffer = m_pBackend->CreateBuffer(IndexBufferDesc);
+	if (m_hIndexBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create index buffer!");
 		return false;
 	}
 
@@ -323,31 +387,26 @@ bool CGraphicsContext::CreateCubeBuffers() {
 	return true;
 }
 
-void CGraphicsContext::UpdateMatrices() {
-	static float flRotationAngle = 0.0f;
-	flRotationAngle += 0.005f;
+void CGraphicsContext::UpdateFrameConstants() {
+	PROFILE_FUNCTION();
 
-	CMath::Matrix4x4_t mWorld = CMath::Matrix4x4_t::CreateRotationY(flRotationAngle);
-	CMath::Matrix4x4_t mView = m_Camera.GetViewMatrix();
+	CMath::Matrix4x4_t mView = m_Camera.GetInterpolatedViewMatrix(m_flInterpolation);
 	CMath::Matrix4x4_t mProjection = CMath::Matrix4x4_t::CreatePerspectiveFieldOfView(
-		3.14159f / 4.0f,
+		FIELD_OF_VIEW,
 		static_cast<float>(m_nWidth) / static_cast<float>(m_nHeight),
 		0.1f,
 		100.0f
 	);
 
-	D3D11_MAPPED_SUBRESOURCE dxMappedResource;
-	HRESULT hResult = m_pDeviceContext->Map(m_pConstantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &dxMappedResource);
-
-	if (FAILED(hResult) || !dxMappedResource.pData) {
-		LOG_ERROR("Failed to map constant buffer");
-		return;
-	}
+	m_FrustumCuller.SetFrustum(CMath::Frustum_t::FromViewProjection(mView * mProjection));
+	m_flLODPixelsPerUnit = static_cast<float>(m_nHeight) / (2.0f * tanf(FIELD_OF_VIEW * 0.5f));
 
-	CMath::Matrix4x4_t* pMatrices = static_cast<CMath::Matrix4x4_t*>(dxMappedResource.pData);
-	pMatrices[0] = mWorld;
-	pMatrices[1] = mView;
-	pMatrices[2] = mProjection;
+	CMath::Matrix4x4_t aMatrices[2] = { mView, mProjection };
+	m_pBackend->UpdateBuffer(m_hFrameConstantBuffer, aMatrices, sizeof(aMatrices));
+	m_pBackend->SetConstantBuffer(FRAME_CONSTANT_SLOT, m_hFrameConstantBuffer);
+}
 
-	m_pDeviceContext->Unmap(m_pConstantBuffer, 0);
-}
\ No newline at end of file
+float CGraphicsContext::GetViewDepth(const CMath::Matrix4x4_t& mWorld) const {
+	CMath::Vector3_t vecOrigin(mWorld.m[3][0], mWorld.m[3][1], mWorld.m[3][2]);
+	return (vecOrigin - m_Camera.GetPosition()).Dot(m_Camera.GetForward());
+}
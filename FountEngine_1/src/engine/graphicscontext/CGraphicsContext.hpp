@@ -1,20 +1,22 @@
 #pragma once
-#include <windows.h>
 #include <string>
 #include <memory>
-#include <d3d11.h>
-#include <dxgi.h>
-#include <d3dcompiler.h>
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "d3dcompiler.lib")
+#include <span>
+#include <vector>
 
 #include "../../client/camera/CCamera.hpp"
+#include "../../engine/scene/CScene.hpp"
+#include "../../render/backend/IRenderBackend.hpp"
+#include "../../render/culling/CFrustumCuller.hpp"
 #include "../../render/mesh/CMesh.hpp"
+#include "../../render/queue/CRenderQueue.hpp"
+#include "../../resources/resourcemanager/CMeshHandle.hpp"
 
-struct ID3D11Device;
-struct ID3D11DeviceContext;
-struct IDXGISwapChain;
-struct ID3D11RenderTargetView;
+struct LODStats_t {
+	uint64_t nDraws = 0;
+	uint64_t nTriangles = 0; // as drawn
+	uint64_t nFullTriangles = 0; // had every draw used LOD 0
+};
 
 class CGraphicsContext {
 public:
@@ -24,42 +26,97 @@ public:
 	CGraphicsContext(const CGraphicsContext&) = delete;
 	CGraphicsContext& operator=(const CGraphicsContext&) = delete;
 
-	bool Initialize(HWND hWnd, int nWidth, int nHeight);
+	// pNativeWindow is passed on to the backend.
+	bool Initialize(std::unique_ptr<IRenderBackend> pBackend, void* pNativeWindow, int nWidth, int nHeight);
+	// Every pipeline Initialize creates, for precompiling their shaders.
+	static std::vector<PipelineDesc_t> GetPipelineDescs();
 	void OnMouseMove(int iDeltaX, int iDeltaY);
-	void UpdateCamera(float flDeltaTime, const bool* pKeys);
 
-	void BeginFrame();
+	// One simulation step of flTimeStep seconds.
+	void FixedUpdate(float flTimeStep, const bool* pKeys);
+
+	// flInterpolation is how far rendering is between the last two simulation steps.
+	void BeginFrame(float flInterpolation = 1.0f);
+	// Sorts and submits the frame's render queue, then presents.
 	void EndFrame();
 
 	void DrawCube();
+	// Adds nCount cube entities on a grid that turns with the cube, drawn through one
+	// instanced draw per frame; 0 removes them.
+	void SetCubeInstanceCount(uint32_t nCount);
+
+	// One draw of Instances.size() copies of the mesh; the instance data is uploaded with the rest of the frame's.
+	void DrawMeshInstanced(const CMesh& Mesh, std::span<const InstanceData_t> Instances);
 
 	bool LoadMesh(const std::string& strFilename);
 	bool CreateMeshBuffers();
 	void RenderMesh();
+	// The loaded mesh is only drawn when enabled, at the given world transform (identity by default).
+	void SetMeshEnabled(bool bEnabled) { m_bMeshEnabled = bEnabled; }
+	void SetMeshTransform(const CMath::Matrix4x4_t& mWorld) { m_mMeshWorld = mWorld; }
+
+	// The scene entity under the center of the view, INVALID_ENTITY if the camera looks at nothing.
+	EntityHandle_t PickEntity(float flMaxDistance = 1000.0f, float* pHitDistance = nullptr);
+
+	IRenderBackend& GetBackend() { return *m_pBackend; }
+	const CRenderQueue& GetRenderQueue() const { return m_RenderQueue; }
+	CScene& GetScene() { return m_Scene; }
+	const CullStats_t& GetCullStats() const { return m_FrustumCuller.GetFrameStats(); }
+	const LODStats_t& GetLODStats() const { return m_LODStats; }
+	const ClusterCullStats_t& GetClusterCullStats() const { return m_FrustumCuller.GetClusterFrameStats(); }
 
 private:
-	bool CompileShaders();
 	bool CreateCubeBuffers();
-	void UpdateMatrices();
+	void UpdateFrameConstants();
+	float GetViewDepth(const CMath::Matrix4x4_t& mWorld) const;
 
 	int m_nWidth;
 	int m_nHeight;
 
 	CCamera m_Camera;
-	
-	ID3D11Device* m_pDevice = nullptr;
-	ID3D11DeviceContext* m_pDeviceContext = nullptr;
-	IDXGISwapChain* m_pSwapChain = nullptr;
-	ID3D11RenderTargetView* m_pRenderTargetView = nullptr;
-
-	ID3D11VertexShader* m_pVertexShader = nullptr;
-	ID3D11PixelShader* m_pPixelShader = nullptr;
-	ID3D11InputLayout* m_pInputLayout = nullptr;
-	ID3D11Buffer* m_pVertexBuffer = nullptr;
-	ID3D11Buffer* m_pConstantBuffer = nullptr;
-
-	ID3D11Buffer* m_pIndexBuffer = nullptr;
-	UINT m_nIndexCount = 0;
-
-	std::shared_ptr<CMesh> m_pCurrentMesh;
-};
\ No newline at end of file
+
+	static constexpr float CUBE_ROTATION_SPEED = 0.3f; // radians per second
+	static constexpr float FIELD_OF_VIEW = 3.14159f / 4.0f;
+	// Coarser LODs are used while their simplification error projects to at most this many pixels.
+	static constexpr float MAX_LOD_PIXEL_ERROR = 1.0f;
+
+	float m_flCubeRotation = 0.0f;
+	float m_flPreviousCubeRotation = 0.0f;
+	float m_flInterpolation = 1.0f;
+
+	std::unique_ptr<IRenderBackend> m_pBackend;
+
+	RenderHandle_t m_hPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hInstancedPipeline = INVALID_RENDER_HANDLE;
+	// For meshes with packed vertices.
+	RenderHandle_t m_hPackedPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hPackedInstancedPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hVertexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hIndexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hFrameConstantBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hObjectConstantBuffer = INVALID_RENDER_HANDLE;
+	uint32_t m_nIndexCount = 0;
+
+	CRenderQueue m_RenderQueue;
+
+	CScene m_Scene;
+	EntityHandle_t m_hCubeEntity = INVALID_ENTITY;
+	EntityHandle_t m_hCubeGridEntity = INVALID_ENTITY;
+
+	static constexpr uint32_t INVALID_GRID_INDEX = UINT32_MAX;
+	std::vector<uint32_t> m_CubeGridIndices; // by CScene::GetHandleIndex
+	std::vector<CMath::Vector4_t> m_CubeGridTints;
+	std::vector<InstanceData_t> m_CubeInstances; // the visible ones, rebuilt every frame
+
+	// Scene is culled against the frustum of the frame's camera before anything is submitted.
+	CFrustumCuller m_FrustumCuller;
+	std::vector<uint32_t> m_VisibleEntities;
+
+	CMeshHandle m_CurrentMesh;
+	bool m_bMeshEnabled = false;
+	CMath::Matrix4x4_t m_mMeshWorld;
+
+	float m_flLODPixelsPerUnit = 1.0f; // viewport height / (2 tan(fov / 2)), set with the frame constants
+	LODStats_t m_LODStats;
+	std::vector<IndexRange_t> m_MeshletRanges; // the loaded mesh's visible clusters, rebuilt every frame
+};
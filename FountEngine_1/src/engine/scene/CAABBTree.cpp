@@ -0,0 +1,394 @@
+#include "CAABBTree.hpp"
+
+#include <cfloat>
+
+#include "../../system/profiler/CProfiler.hpp"
+
+namespace {
+	float GetAxis(const CMath::Vector3_t& vec, int nAxis) {
+		return nAxis == 0 ? vec.x : (nAxis == 1 ? vec.y : vec.z);
+	}
+}
+
+int32_t CAABBTree::AllocateNode() {
+	int32_t nNode;
+	if (m_nFreeList != NULL_NODE) {
+		nNode = m_nFreeList;
+		m_nFreeList = m_Nodes[nNode].nParent;
+	}
+	else {
+		nNode = static_cast<int32_t>(m_Nodes.size());
+		m_Nodes.emplace_back();
+	}
+
+	m_Nodes[nNode] = Node_t();
+	return nNode;
+}
+
+void CAABBTree::FreeNode(int32_t nNode) {
+	m_Nodes[nNode].nParent = m_nFreeList;
+	m_Nodes[nNode].nHeight = -1;
+	m_nFreeList = nNode;
+}
+
+int32_t CAABBTree::CreateProxy(const AABB_t& Bounds, uint32_t nUserData, bool bInsert) {
+	const int32_t nProxy = AllocateNode();
+	m_Nodes[nProxy].Bounds = Fatten(Bounds);
+	m_Nodes[nProxy].nUserData = nUserData;
+	if (bInsert) {
+		InsertLeaf(nProxy);
+	}
+	++m_nProxyCount;
+	return nProxy;
+}
+
+void CAABBTree::DestroyProxy(int32_t nProxy) {
+	assert(nProxy >= 0 && nProxy < static_cast<int32_t>(m_Nodes.size()) && m_Nodes[nProxy].IsLeaf());
+	RemoveLeaf(nProxy);
+	FreeNode(nProxy);
+	--m_nProxyCount;
+}
+
+bool CAABBTree::MoveProxy(int32_t nProxy, const AABB_t& Bounds) {
+	if (m_Nodes[nProxy].Bounds.Contains(Bounds)) {
+		return false;
+	}
+
+	RemoveLeaf(nProxy);
+	m_Nodes[nProxy].Bounds = Fatten(Bounds);
+	InsertLeaf(nProxy);
+	return true;
+}
+
+void CAABBTree::Clear() {
+	m_Nodes.clear();
+	m_nRoot = NULL_NODE;
+	m_nFreeList = NULL_NODE;
+	m_nProxyCount = 0;
+}
+
+void CAABBTree::InsertLeaf(int32_t nLeaf) {
+	if (m_nRoot == NULL_NODE) {
+		m_nRoot = nLeaf;
+		m_Nodes[nLeaf].nParent = NULL_NODE;
+		return;
+	}
+
+	// Walk down to the sibling that adds the least area: pairing with a node costs its grown area,
+	// and every ancestor above it grows by the same amount.
+	const AABB_t LeafBounds = m_Nodes[nLeaf].Bounds;
+	int32_t nIndex = m_nRoot;
+	while (!m_Nodes[nIndex].IsLeaf()) {
+		const Node_t& Node = m_Nodes[nIndex];
+		const float flArea = Node.Bounds.GetArea();
+		const float flCombinedArea = AABB_t::Union(Node.Bounds, LeafBounds).GetArea();
+
+		const float flCost = 2.0f * flCombinedArea;
+		const float flInheritanceCost = 2.0f * (flCombinedArea - flArea);
+
+		auto ChildCost = [&](int32_t nChild) {
+			const Node_t& Child = m_Nodes[nChild];
+			float flChildCombined = AABB_t::Union(LeafBounds, Child.Bounds).GetArea();
+			return (Child.IsLeaf() ? flChildCombined : flChildCombined - Child.Bounds.GetArea()) + flInheritanceCost;
+		};
+
+		const float flCost1 = ChildCost(Node.nChild1);
+		const float flCost2 = ChildCost(Node.nChild2);
+		if (flCost < flCost1 && flCost < flCost2) {
+			break;
+		}
+		nIndex = flCost1 < flCost2 ? Node.nChild1 : Node.nChild2;
+	}
+
+	const int32_t nSibling = nIndex;
+	const int32_t nOldParent = m_Nodes[nSibling].nParent;
+	const int32_t nNewParent = AllocateNode();
+	m_Nodes[nNewParent].nParent = nOldParent;
+	m_Nodes[nNewParent].Bounds = AABB_t::Union(LeafBounds, m_Nodes[nSibling].Bounds);
+	m_Nodes[nNewParent].nHeight = m_Nodes[nSibling].nHeight + 1;
+	m_Nodes[nNewParent].nChild1 = nSibling;
+	m_Nodes[nNewParent].nChild2 = nLeaf;
+	m_Nodes[nSibling].nParent = nNewParent;
+	m_Nodes[nLeaf].nParent = nNewParent;
+
+	if (nOldParent == NULL_NODE) {
+		m_nRoot = nNewParent;
+	}
+	else if (m_Nodes[nOldParent].nChild1 == nSibling) {
+		m_Nodes[nOldParent].nChild1 = nNewParent;
+	}
+	else {
+		m_Nodes[nOldParent].nChild2 = nNewParent;
+	}
+
+	RefitUpwards(nNewParent);
+}
+
+void CAABBTree::RemoveLeaf(int32_t nLeaf) {
+	if (nLeaf == m_nRoot) {
+		m_nRoot = NULL_NODE;
+		return;
+	}
+
+	const int32_t nParent = m_Nodes[nLeaf].nParent;
+	const int32_t nGrandParent = m_Nodes[nParent].nParent;
+	const int32_t nSibling = m_Nodes[nParent].nChild1 == nLeaf ? m_Nodes[nParent].nChild2 : m_Nodes[nParent].nChild1;
+
+	if (nGrandParent == NULL_NODE) {
+		m_nRoot = nSibling;
+		m_Nodes[nSibling].nParent = NULL_NODE;
+		FreeNode(nParent);
+		return;
+	}
+
+	if (m_Nodes[nGrandParent].nChild1 == nParent) {
+		m_Nodes[nGrandParent].nChild1 = nSibling;
+	}
+	else {
+		m_Nodes[nGrandParent].nChild2 = nSibling;
+	}
+	m_Nodes[nSibling].nParent = nGrandParent;
+	FreeNode(nParent);
+
+	RefitUpwards(nGrandParent);
+}
+
+void CAABBTree::RefitUpwards(int32_t nNode) {
+	while (nNode != NULL_NODE) {
+		nNode = Balance(nNode);
+
+		Node_t& Node = m_Nodes[nNode];
+		Node.nHeight = 1 + std::max(m_Nodes[Node.nChild1].nHeight, m_Nodes[Node.nChild2].nHeight);
+		Node.Bounds = AABB_t::Union(m_Nodes[Node.nChild1].Bounds, m_Nodes[Node.nChild2].Bounds);
+
+		nNode = Node.nParent;
+	}
+}
+
+// Rotates the taller grandchild up when the children's heights differ by more than one.
+// Returns the node now at nA's place.
+int32_t CAABBTree::Balance(int32_t nA) {
+	Node_t& A = m_Nodes[nA];
+	if (A.IsLeaf() || A.nHeight < 2) {
+		return nA;
+	}
+
+	const int32_t nB = A.nChild1;
+	const int32_t nC = A.nChild2;
+	const int32_t nBalance = m_Nodes[nC].nHeight - m_Nodes[nB].nHeight;
+
+	auto RotateUp = [&](int32_t nUp, int32_t nStay) {
+		// nUp (a child of nA) takes nA's place; nA keeps nStay and the shorter child of nUp.
+		Node_t& Up = m_Nodes[nUp];
+		const int32_t nF = Up.nChild1;
+		const int32_t nG = Up.nChild2;
+
+		Up.nChild1 = nA;
+		Up.nParent = A.nParent;
+		A.nParent = nUp;
+
+		if (Up.nParent == NULL_NODE) {
+			m_nRoot = nUp;
+		}
+		else if (m_Nodes[Up.nParent].nChild1 == nA) {
+			m_Nodes[Up.nParent].nChild1 = nUp;
+		}
+		else {
+			m_Nodes[Up.nParent].nChild2 = nUp;
+		}
+
+		const bool bKeepF = m_Nodes[nF].nHeight > m_Nodes[nG].nHeight;
+		const int32_t nKeep = bKeepF ? nF : nG;
+		const int32_t nGive = bKeepF ? nG : nF;
+
+		Up.nChild2 = nKeep;
+		if (A.nChild1 == nUp) {
+			A.nChild1 = nGive;
+		}
+		else {
+			A.nChild2 = nGive;
+		}
+		m_Nodes[nGive].nParent = nA;
+
+		A.Bounds = AABB_t::Union(m_Nodes[nStay].Bounds, m_Nodes[nGive].Bounds);
+		Up.Bounds = AABB_t::Union(A.Bounds, m_Nodes[nKeep].Bounds);
+		A.nHeight = 1 + std::max(m_Nodes[nStay].nHeight, m_Nodes[nGive].nHeight);
+		Up.nHeight = 1 + std::max(A.nHeight, m_Nodes[nKeep].nHeight);
+		return nUp;
+	};
+
+	if (nBalance > 1) {
+		return RotateUp(nC, nB);
+	}
+	if (nBalance < -1) {
+		return RotateUp(nB, nC);
+	}
+	return nA;
+}
+
+void CAABBTree::Refit() {
+	PROFILE_FUNCTION();
+
+	if (m_nRoot == NULL_NODE) {
+		return;
+	}
+
+	// Post-order: a node is pushed again after its children, marked by a negative index.
+	std::vector<int32_t> Stack;
+	Stack.reserve(64);
+	Stack.push_back(m_nRoot);
+	while (!Stack.empty()) {
+		int32_t nEntry = Stack.back();
+		Stack.pop_back();
+
+		if (nEntry < 0) {
+			Node_t& Node = m_Nodes[~nEntry];
+			Node.Bounds = AABB_t::Union(m_Nodes[Node.nChild1].Bounds, m_Nodes[Node.nChild2].Bounds);
+			continue;
+		}
+
+		const Node_t& Node = m_Nodes[nEntry];
+		if (!Node.IsLeaf()) {
+			Stack.push_back(~nEntry);
+			Stack.push_back(Node.nChild1);
+			Stack.push_back(Node.nChild2);
+		}
+	}
+}
+
+void CAABBTree::Rebuild() {
+	PROFILE_FUNCTION();
+
+	// Leaves keep their node (so proxy ids stay valid), everything above them is built again.
+	std::vector<int32_t> Leaves;
+	Leaves.reserve(m_nProxyCount);
+	for (int32_t i = 0; i < static_cast<int32_t>(m_Nodes.size()); ++i) {
+		Node_t& Node = m_Nodes[i];
+		if (Node.nHeight < 0) {
+			continue;
+		}
+
+		if (Node.IsLeaf()) {
+			Leaves.push_back(i);
+		}
+		else {
+			FreeNode(i);
+		}
+	}
+
+	m_nRoot = Leaves.empty() ? NULL_NODE : BuildRange(Leaves, 0, Leaves.size(), 0);
+	if (m_nRoot != NULL_NODE) {
+		m_Nodes[m_nRoot].nParent = NULL_NODE;
+	}
+}
+
+int32_t CAABBTree::BuildRange(std::vector<int32_t>& Leaves, size_t nBegin, size_t nEnd, int nDepth) {
+	const size_t nCount = nEnd - nBegin;
+	if (nCount == 1) {
+		return Leaves[nBegin];
+	}
+
+	AABB_t CentroidBounds = { m_Nodes[Leaves[nBegin]].Bounds.GetCenter(), m_Nodes[Leaves[nBegin]].Bounds.GetCenter() };
+	for (size_t i = nBegin + 1; i < nEnd; ++i) {
+		CMath::Vector3_t vecCenter = m_Nodes[Leaves[i]].Bounds.GetCenter();
+		CentroidBounds = AABB_t::Union(CentroidBounds, { vecCenter, vecCenter });
+	}
+
+	// Binned SAH along the widest centroid axis: cost of a split is area * count on both sides.
+	CMath::Vector3_t vecSize = CentroidBounds.vecMax - CentroidBounds.vecMin;
+	int nAxis = vecSize.x > vecSize.y ? (vecSize.x > vecSize.z ? 0 : 2) : (vecSize.y > vecSize.z ? 1 : 2);
+	const float flAxisMin = GetAxis(CentroidBounds.vecMin, nAxis);
+	const float flAxisSize = GetAxis(vecSize, nAxis);
+
+	size_t nMid = nBegin;
+	if (flAxisSize > 0.0f && nDepth < MAX_SAH_DEPTH) {
+		const float flBinScale = SAH_BINS / flAxisSize;
+		auto GetBin = [&](int32_t nLeaf) {
+			int nBin = static_cast<int>((GetAxis(m_Nodes[nLeaf].Bounds.GetCenter(), nAxis) - flAxisMin) * flBinScale);
+			return std::min(nBin, SAH_BINS - 1);
+		};
+
+		AABB_t aBinBounds[SAH_BINS];
+		size_t aBinCounts[SAH_BINS] = {};
+		for (size_t i = nBegin; i < nEnd; ++i) {
+			const int nBin = GetBin(Leaves[i]);
+			aBinBounds[nBin] = aBinCounts[nBin]++ ? AABB_t::Union(aBinBounds[nBin], m_Nodes[Leaves[i]].Bounds) : m_Nodes[Leaves[i]].Bounds;
+		}
+
+		// Right-to-left sweep for the right side's cost, then left-to-right to pick the split.
+		float aRightCosts[SAH_BINS] = {};
+		AABB_t Accumulated;
+		size_t nAccumulated = 0;
+		for (int nBin = SAH_BINS - 1; nBin > 0; --nBin) {
+			if (aBinCounts[nBin]) {
+				Accumulated = nAccumulated ? AABB_t::Union(Accumulated, aBinBounds[nBin]) : aBinBounds[nBin];
+				nAccumulated += aBinCounts[nBin];
+			}
+			aRightCosts[nBin] = nAccumulated ? Accumulated.GetArea() * nAccumulated : 0.0f;
+		}
+
+		float flBestCost = FLT_MAX;
+		int nBestSplit = -1;
+		nAccumulated = 0;
+		for (int nBin = 0; nBin < SAH_BINS - 1; ++nBin) {
+			if (aBinCounts[nBin]) {
+				Accumulated = nAccumulated ? AABB_t::Union(Accumulated, aBinBounds[nBin]) : aBinBounds[nBin];
+				nAccumulated += aBinCounts[nBin];
+			}
+			if (nAccumulated == 0 || nAccumulated == nCount) {
+				continue;
+			}
+
+			float flCost = Accumulated.GetArea() * nAccumulated + aRightCosts[nBin + 1];
+			if (flCost < flBestCost) {
+				flBestCost = flCost;
+				nBestSplit = nBin;
+			}
+		}
+
+		if (nBestSplit >= 0) {
+			auto itMid = std::partition(Leaves.begin() + nBegin, Leaves.begin() + nEnd, [&](int32_t nLeaf) { return GetBin(nLeaf) <= nBestSplit; });
+			nMid = static_cast<size_t>(itMid - Leaves.begin());
+		}
+	}
+
+	// All centroids in one bin, or too deep already: split at the median centroid, which keeps the depth logarithmic.
+	if (nMid == nBegin || nMid == nEnd) {
+		nMid = nBegin + nCount / 2;
+		std::nth_element(Leaves.begin() + nBegin, Leaves.begin() + nMid, Leaves.begin() + nEnd, [&](int32_t a, int32_t b) {
+			return GetAxis(m_Nodes[a].Bounds.GetCenter(), nAxis) < GetAxis(m_Nodes[b].Bounds.GetCenter(), nAxis);
+		});
+	}
+
+	const int32_t nChild1 = BuildRange(Leaves, nBegin, nMid, nDepth + 1);
+	const int32_t nChild2 = BuildRange(Leaves, nMid, nEnd, nDepth + 1);
+
+	const int32_t nNode = AllocateNode();
+	Node_t& Node = m_Nodes[nNode];
+	Node.nChild1 = nChild1;
+	Node.nChild2 = nChild2;
+	Node.Bounds = AABB_t::Union(m_Nodes[nChild1].Bounds, m_Nodes[nChild2].Bounds);
+	Node.nHeight = 1 + std::max(m_Nodes[nChild1].nHeight, m_Nodes[nChild2].nHeight);
+	m_Nodes[nChild1].nParent = nNode;
+	m_Nodes[nChild2].nParent = nNode;
+	return nNode;
+}
+
+float CAABBTree::GetSAHCost() const {
+	if (m_nRoot == NULL_NODE) {
+		return 0.0f;
+	}
+
+	const float flRootArea = m_Nodes[m_nRoot].Bounds.GetArea();
+	if (flRootArea <= 0.0f) {
+		return 0.0f;
+	}
+
+	float flTotalArea = 0.0f;
+	for (const Node_t& Node : m_Nodes) {
+		if (Node.nHeight > 0) {
+			flTotalArea += Node.Bounds.GetArea();
+		}
+	}
+	return flTotalArea / flRootArea;
+}
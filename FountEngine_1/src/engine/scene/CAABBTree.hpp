@@ -0,0 +1,359 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../math/CFrustum.hpp"
+#include "../../math/CMath.hpp"
+
+struct AABB_t {
+	CMath::Vector3_t vecMin;
+	CMath::Vector3_t vecMax;
+
+	static AABB_t FromCenterExtent(const CMath::Vector3_t& vecCenter, const CMath::Vector3_t& vecExtent) {
+		return { vecCenter - vecExtent, vecCenter + vecExtent };
+	}
+
+	static AABB_t Union(const AABB_t& a, const AABB_t& b) {
+		return {
+			CMath::Vector3_t(std::min(a.vecMin.x, b.vecMin.x), std::min(a.vecMin.y, b.vecMin.y), std::min(a.vecMin.z, b.vecMin.z)),
+			CMath::Vector3_t(std::max(a.vecMax.x, b.vecMax.x), std::max(a.vecMax.y, b.vecMax.y), std::max(a.vecMax.z, b.vecMax.z))
+		};
+	}
+
+	CMath::Vector3_t GetCenter() const { return (vecMin + vecMax) * 0.5f; }
+	CMath::Vector3_t GetExtent() const { return (vecMax - vecMin) * 0.5f; }
+
+	// Half the surface area; only ever compared, so the factor doesn't matter.
+	float GetArea() const {
+		CMath::Vector3_t vecSize = vecMax - vecMin;
+		return vecSize.x * vecSize.y + vecSize.y * vecSize.z + vecSize.z * vecSize.x;
+	}
+
+	bool Contains(const AABB_t& other) const {
+		return vecMin.x <= other.vecMin.x && vecMin.y <= other.vecMin.y && vecMin.z <= other.vecMin.z &&
+			other.vecMax.x <= vecMax.x && other.vecMax.y <= vecMax.y && other.vecMax.z <= vecMax.z;
+	}
+
+	bool Overlaps(const AABB_t& other) const {
+		return vecMin.x <= other.vecMax.x && other.vecMin.x <= vecMax.x &&
+			vecMin.y <= other.vecMax.y && other.vecMin.y <= vecMax.y &&
+			vecMin.z <= other.vecMax.z && other.vecMin.z <= vecMax.z;
+	}
+
+	float GetDistanceSq(const CMath::Vector3_t& vecPoint) const {
+		float dx = std::max(std::max(vecMin.x - vecPoint.x, 0.0f), vecPoint.x - vecMax.x);
+		float dy = std::max(std::max(vecMin.y - vecPoint.y, 0.0f), vecPoint.y - vecMax.y);
+		float dz = std::max(std::max(vecMin.z - vecPoint.z, 0.0f), vecPoint.z - vecMax.z);
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	// Slab test; vecInvDirection is 1 / direction per component (infinities are fine).
+	// Returns the entry distance, or a negative value on a miss.
+	float IntersectRay(const CMath::Vector3_t& vecOrigin, const CMath::Vector3_t& vecInvDirection, float flMaxDistance) const {
+		float tx1 = (vecMin.x - vecOrigin.x) * vecInvDirection.x, tx2 = (vecMax.x - vecOrigin.x) * vecInvDirection.x;
+		float ty1 = (vecMin.y - vecOrigin.y) * vecInvDirection.y, ty2 = (vecMax.y - vecOrigin.y) * vecInvDirection.y;
+		float tz1 = (vecMin.z - vecOrigin.z) * vecInvDirection.z, tz2 = (vecMax.z - vecOrigin.z) * vecInvDirection.z;
+
+		float flNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::max(std::min(tz1, tz2), 0.0f));
+		float flFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::min(std::max(tz1, tz2), flMaxDistance));
+		return flNear <= flFar ? flNear : -1.0f;
+	}
+};
+
+// Dynamic bounding volume hierarchy over proxies (a box plus a user value). Leaves store the box grown by
+// a margin, so small movements don't touch the tree. Inserts pick the sibling that adds the least surface
+// area and rebalance on the way up. When much of the scene moves at once, set the new leaf boxes with
+// UpdateProxyBounds() and then either Refit() (same topology, O(n)) or Rebuild() (top-down binned SAH).
+// Proxy ids are node indices and stay valid across both.
+//
+// Queries take a callback; AABB, sphere and frustum ones get the proxy and return false to stop,
+// ray casts get (proxy, max distance) and return the new max distance (0 stops, the old one continues).
+// All queries return the number of nodes visited.
+class CAABBTree {
+public:
+	static constexpr int32_t NULL_NODE = -1;
+
+	explicit CAABBTree(float flMargin = 0.1f) : m_flMargin(flMargin) {}
+
+	// Without bInsert the proxy only joins the tree at the next Rebuild(), which is much cheaper
+	// than inserting many proxies one by one. Don't move or destroy it before that.
+	int32_t CreateProxy(const AABB_t& Bounds, uint32_t nUserData, bool bInsert = true);
+	void DestroyProxy(int32_t nProxy);
+	// Returns true if the proxy left its fat box and was reinserted.
+	bool MoveProxy(int32_t nProxy, const AABB_t& Bounds);
+	// Replaces the leaf's box only; the tree is stale until Refit() or Rebuild().
+	void UpdateProxyBounds(int32_t nProxy, const AABB_t& Bounds) { m_Nodes[nProxy].Bounds = Fatten(Bounds); }
+	void Clear();
+
+	void Refit();
+	void Rebuild();
+
+	uint32_t GetUserData(int32_t nProxy) const { return m_Nodes[nProxy].nUserData; }
+	const AABB_t& GetFatBounds(int32_t nProxy) const { return m_Nodes[nProxy].Bounds; }
+	size_t GetProxyCount() const { return m_nProxyCount; }
+	int32_t GetHeight() const { return m_nRoot == NULL_NODE ? 0 : m_Nodes[m_nRoot].nHeight; }
+	// Sum of internal node areas relative to the root's, lower is better.
+	float GetSAHCost() const;
+
+	template<typename Callback>
+	size_t QueryAABB(const AABB_t& Bounds, Callback&& Function) const {
+		return Traverse([&](const AABB_t& Node) { return Node.Overlaps(Bounds); }, Function);
+	}
+
+	template<typename Callback>
+	size_t QuerySphere(const CMath::Vector3_t& vecCenter, float flRadius, Callback&& Function) const {
+		const float flRadiusSq = flRadius * flRadius;
+		return Traverse([&](const AABB_t& Node) { return Node.GetDistanceSq(vecCenter) <= flRadiusSq; }, Function);
+	}
+
+	template<typename Callback>
+	size_t QueryFrustum(const CMath::Frustum_t& Frustum, Callback&& Function) const;
+
+	template<typename Callback>
+	size_t RayCast(const CMath::Vector3_t& vecOrigin, const CMath::Vector3_t& vecDirection, float flMaxDistance, Callback&& Function) const;
+
+private:
+	// Traversal stack entries kept inline; deeper trees spill to the heap.
+	static constexpr size_t INLINE_STACK_SIZE = 256;
+	static constexpr int SAH_BINS = 16;
+	// Rebuild splits at the median below this depth, so lopsided SAH splits can't make the tree
+	// (and the recursion building it) much deeper than log2 of the proxy count.
+	static constexpr int MAX_SAH_DEPTH = 48;
+
+	template<typename T>
+	class CTraversalStack {
+	public:
+		void Push(const T& Value) {
+			if (m_nSize == m_nCapacity) {
+				Grow();
+			}
+			m_pData[m_nSize++] = Value;
+		}
+		T Pop() { return m_pData[--m_nSize]; }
+		bool IsEmpty() const { return m_nSize == 0; }
+
+	private:
+		void Grow() {
+			if (m_Heap.empty()) {
+				m_Heap.assign(m_aInline, m_aInline + m_nSize);
+			}
+			m_Heap.resize(m_nCapacity * 2);
+			m_pData = m_Heap.data();
+			m_nCapacity = m_Heap.size();
+		}
+
+		T m_aInline[INLINE_STACK_SIZE];
+		std::vector<T> m_Heap;
+		T* m_pData = m_aInline;
+		size_t m_nSize = 0;
+		size_t m_nCapacity = INLINE_STACK_SIZE;
+	};
+
+	struct Node_t {
+		AABB_t Bounds;
+		int32_t nParent = NULL_NODE; // next free node while on the free list
+		int32_t nChild1 = NULL_NODE;
+		int32_t nChild2 = NULL_NODE;
+		int32_t nHeight = 0; // leaves are 0, free nodes -1
+		uint32_t nUserData = 0;
+
+		bool IsLeaf() const { return nChild1 == NULL_NODE; }
+	};
+
+	AABB_t Fatten(const AABB_t& Bounds) const {
+		CMath::Vector3_t vecMargin(m_flMargin, m_flMargin, m_flMargin);
+		return { Bounds.vecMin - vecMargin, Bounds.vecMax + vecMargin };
+	}
+
+	int32_t AllocateNode();
+	void FreeNode(int32_t nNode);
+	void InsertLeaf(int32_t nLeaf);
+	void RemoveLeaf(int32_t nLeaf);
+	int32_t Balance(int32_t nNode);
+	// Rebalances and recomputes nNode and its ancestors.
+	void RefitUpwards(int32_t nNode);
+	int32_t BuildRange(std::vector<int32_t>& Leaves, size_t nBegin, size_t nEnd, int nDepth);
+
+	template<typename Test, typename Callback>
+	size_t Traverse(Test&& NodeTest, Callback& Function) const;
+
+	template<typename Callback>
+	bool ReportSubtree(int32_t nNode, Callback& Function, size_t& nVisited) const;
+
+	std::vector<Node_t> m_Nodes;
+	int32_t m_nRoot = NULL_NODE;
+	int32_t m_nFreeList = NULL_NODE;
+	size_t m_nProxyCount = 0;
+	float m_flMargin;
+};
+
+template<typename Test, typename Callback>
+size_t CAABBTree::Traverse(Test&& NodeTest, Callback& Function) const {
+	if (m_nRoot == NULL_NODE) {
+		return 0;
+	}
+
+	CTraversalStack<int32_t> Stack;
+	Stack.Push(m_nRoot);
+
+	size_t nVisited = 0;
+	while (!Stack.IsEmpty()) {
+		const int32_t nNode = Stack.Pop();
+		const Node_t& Node = m_Nodes[nNode];
+		++nVisited;
+		if (!NodeTest(Node.Bounds)) {
+			continue;
+		}
+
+		if (Node.IsLeaf()) {
+			if (!Function(nNode)) {
+				break;
+			}
+		}
+		else {
+			Stack.Push(Node.nChild1);
+			Stack.Push(Node.nChild2);
+		}
+	}
+	return nVisited;
+}
+
+template<typename Callback>
+bool CAABBTree::ReportSubtree(int32_t nNode, Callback& Function, size_t& nVisited) const {
+	CTraversalStack<int32_t> Stack;
+	Stack.Push(nNode);
+
+	while (!Stack.IsEmpty()) {
+		const int32_t nCurrent = Stack.Pop();
+		const Node_t& Node = m_Nodes[nCurrent];
+		++nVisited;
+		if (Node.IsLeaf()) {
+			if (!Function(nCurrent)) {
+				return false;
+			}
+		}
+		else {
+			Stack.Push(Node.nChild1);
+			Stack.Push(Node.nChild2);
+		}
+	}
+	return true;
+}
+
+template<typename Callback>
+size_t CAABBTree::QueryFrustum(const CMath::Frustum_t& Frustum, Callback&& Function) const {
+	if (m_nRoot == NULL_NODE) {
+		return 0;
+	}
+
+	// Each stack entry carries the planes its box still straddles; a node inside all of
+	// them reports its whole subtree without further tests.
+	struct Entry_t {
+		int32_t nNode;
+		uint32_t nPlaneMask;
+	};
+	constexpr uint32_t ALL_PLANES = (1u << CMath::Frustum_t::PLANE_COUNT) - 1;
+
+	CTraversalStack<Entry_t> Stack;
+	Stack.Push({ m_nRoot, ALL_PLANES });
+
+	size_t nVisited = 0;
+	while (!Stack.IsEmpty()) {
+		const Entry_t Entry = Stack.Pop();
+		const Node_t& Node = m_Nodes[Entry.nNode];
+
+		const CMath::Vector3_t vecCenter = Node.Bounds.GetCenter();
+		const CMath::Vector3_t vecExtent = Node.Bounds.GetExtent();
+		uint32_t nPlaneMask = Entry.nPlaneMask;
+		bool bOutside = false;
+		for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT && !bOutside; ++p) {
+			if (!(nPlaneMask & (1u << p))) {
+				continue;
+			}
+
+			const CMath::Plane_t& Plane = Frustum.Planes[p];
+			float flDistance = Plane.GetDistance(vecCenter);
+			float flRadius = fabsf(Plane.vecNormal.x) * vecExtent.x + fabsf(Plane.vecNormal.y) * vecExtent.y + fabsf(Plane.vecNormal.z) * vecExtent.z;
+			if (flDistance < -flRadius) {
+				bOutside = true;
+			}
+			else if (flDistance >= flRadius) {
+				nPlaneMask &= ~(1u << p);
+			}
+		}
+
+		if (bOutside) {
+			++nVisited;
+			continue;
+		}
+
+		if (nPlaneMask == 0) {
+			if (!ReportSubtree(Entry.nNode, Function, nVisited)) {
+				break;
+			}
+			continue;
+		}
+
+		++nVisited;
+		if (Node.IsLeaf()) {
+			if (!Function(Entry.nNode)) {
+				break;
+			}
+		}
+		else {
+			Stack.Push({ Node.nChild1, nPlaneMask });
+			Stack.Push({ Node.nChild2, nPlaneMask });
+		}
+	}
+	return nVisited;
+}
+
+template<typename Callback>
+size_t CAABBTree::RayCast(const CMath::Vector3_t& vecOrigin, const CMath::Vector3_t& vecDirection, float flMaxDistance, Callback&& Function) const {
+	if (m_nRoot == NULL_NODE) {
+		return 0;
+	}
+
+	const CMath::Vector3_t vecInvDirection(1.0f / vecDirection.x, 1.0f / vecDirection.y, 1.0f / vecDirection.z);
+
+	CTraversalStack<int32_t> Stack;
+	Stack.Push(m_nRoot);
+
+	size_t nVisited = 0;
+	while (!Stack.IsEmpty()) {
+		const int32_t nNode = Stack.Pop();
+		const Node_t& Node = m_Nodes[nNode];
+		++nVisited;
+		if (Node.Bounds.IntersectRay(vecOrigin, vecInvDirection, flMaxDistance) < 0.0f) {
+			continue;
+		}
+
+		if (Node.IsLeaf()) {
+			flMaxDistance = Function(nNode, flMaxDistance);
+			if (flMaxDistance <= 0.0f) {
+				break;
+			}
+			continue;
+		}
+
+		// Nearer child on top, so a hit there can clip the ray before the other one is opened.
+		float flDistance1 = m_Nodes[Node.nChild1].Bounds.IntersectRay(vecOrigin, vecInvDirection, flMaxDistance);
+		float flDistance2 = m_Nodes[Node.nChild2].Bounds.IntersectRay(vecOrigin, vecInvDirection, flMaxDistance);
+		int32_t nNear = Node.nChild1, nFar = Node.nChild2;
+		if (flDistance2 >= 0.0f && (flDistance1 < 0.0f || flDistance2 < flDistance1)) {
+			std::swap(nNear, nFar);
+			std::swap(flDistance1, flDistance2);
+		}
+
+		if (flDistance2 >= 0.0f) {
+			Stack.Push(nFar);
+		}
+		if (flDistance1 >= 0.0f) {
+			Stack.Push(nNear);
+		}
+	}
+	return nVisited;
+}
@@ -0,0 +1,529 @@
+#include "CScene.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "../../math/CMathBatch.hpp"
+#include "../../system/jobs/CJobSystem.hpp"
+#include "../../system/profiler/CProfiler.hpp"
+
+namespace {
+	constexpr uint32_t UNKNOWN_DEPTH = UINT32_MAX;
+
+	// Array = Array[Order[0]], Array[Order[1]], ...
+	template<typename T>
+	void Permute(std::vector<T>& Array, const std::vector<uint32_t>& Order) {
+		std::vector<T> Sorted;
+		Sorted.reserve(Array.size());
+		for (uint32_t nOld : Order) {
+			Sorted.push_back(std::move(Array[nOld]));
+		}
+		Array.swap(Sorted);
+	}
+
+	// Keeps the elements with a non-zero Keep entry, in order.
+	template<typename T>
+	void Compact(std::vector<T>& Array, const std::vector<uint8_t>& Keep) {
+		size_t nOut = 0;
+		for (size_t i = 0; i < Array.size(); ++i) {
+			if (Keep[i]) {
+				if (nOut != i) {
+					Array[nOut] = std::move(Array[i]);
+				}
+				++nOut;
+			}
+		}
+		Array.resize(nOut);
+	}
+}
+
+EntityHandle_t CScene::CreateEntity(EntityHandle_t hParent) {
+	uint32_t nSlot;
+	if (!m_FreeSlots.empty()) {
+		nSlot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else {
+		// The last slot would make INVALID_ENTITY a handle.
+		assert(m_Slots.size() < HANDLE_INDEX_MASK);
+		nSlot = static_cast<uint32_t>(m_Slots.size());
+		m_Slots.push_back(INVALID_INDEX);
+		m_Generations.push_back(0);
+	}
+	const EntityHandle_t hEntity = (m_Generations[nSlot] << HANDLE_INDEX_BITS) | nSlot;
+
+	const size_t nIndex = ResizeArrays(m_Entities.size() + 1) - 1;
+	m_Parents[nIndex] = IsValid(hParent) ? GetDenseIndex(hParent) : INVALID_INDEX;
+	m_Slots[nSlot] = static_cast<uint32_t>(nIndex);
+	m_Entities[nIndex] = hEntity;
+	m_Dirty[nIndex] = 1;
+
+	// Appending breaks the grouping by depth.
+	m_bNeedsSort = true;
+	return hEntity;
+}
+
+void CScene::DestroyEntity(EntityHandle_t hEntity) {
+	if (!IsValid(hEntity)) {
+		return;
+	}
+
+	// Sorted, a subtree is its root plus whatever after it has a removed parent.
+	if (m_bNeedsSort) {
+		SortHierarchy();
+	}
+
+	const size_t nCount = m_Entities.size();
+	std::vector<uint8_t> Keep(nCount, 1);
+	Keep[GetDenseIndex(hEntity)] = 0;
+	for (size_t i = GetDenseIndex(hEntity) + 1; i < nCount; ++i) {
+		if (m_Parents[i] != INVALID_INDEX && !Keep[m_Parents[i]]) {
+			Keep[i] = 0;
+		}
+	}
+
+	std::vector<uint32_t> OldToNew(nCount, INVALID_INDEX);
+	uint32_t nNew = 0;
+	for (size_t i = 0; i < nCount; ++i) {
+		if (Keep[i]) {
+			OldToNew[i] = nNew++;
+		}
+		else {
+			const uint32_t nSlot = GetHandleIndex(m_Entities[i]);
+			m_Slots[nSlot] = INVALID_INDEX;
+			m_Generations[nSlot] = (m_Generations[nSlot] + 1) & HANDLE_GENERATION_MASK;
+			m_FreeSlots.push_back(nSlot);
+			if (m_Proxies[i] != CAABBTree::NULL_NODE) {
+				m_SpatialTree.DestroyProxy(m_Proxies[i]);
+			}
+		}
+	}
+
+	Compact(m_Entities, Keep);
+	Compact(m_Parents, Keep);
+	Compact(m_Dirty, Keep);
+	Compact(m_LocalTransforms, Keep);
+	Compact(m_WorldTransforms, Keep);
+	Compact(m_LocalCenters, Keep);
+	Compact(m_LocalExtents, Keep);
+	Compact(m_WorldCenterX, Keep);
+	Compact(m_WorldCenterY, Keep);
+	Compact(m_WorldCenterZ, Keep);
+	Compact(m_WorldExtentX, Keep);
+	Compact(m_WorldExtentY, Keep);
+	Compact(m_WorldExtentZ, Keep);
+	Compact(m_Meshes, Keep);
+	Compact(m_PendingBounds, Keep);
+	Compact(m_Proxies, Keep);
+	Compact(m_SpatialDirty, Keep);
+
+	for (size_t i = 0; i < m_Entities.size(); ++i) {
+		m_Slots[GetHandleIndex(m_Entities[i])] = static_cast<uint32_t>(i);
+		if (m_Parents[i] != INVALID_INDEX) {
+			m_Parents[i] = OldToNew[m_Parents[i]];
+		}
+	}
+
+	// Order is still valid, the level offsets are not.
+	m_bNeedsSort = true;
+}
+
+bool CScene::SetParent(EntityHandle_t hEntity, EntityHandle_t hParent) {
+	if (!IsValid(hEntity)) {
+		return false;
+	}
+
+	const uint32_t nIndex = GetDenseIndex(hEntity);
+	uint32_t nParent = INVALID_INDEX;
+	if (IsValid(hParent)) {
+		nParent = GetDenseIndex(hParent);
+		for (uint32_t nAncestor = nParent; nAncestor != INVALID_INDEX; nAncestor = m_Parents[nAncestor]) {
+			if (nAncestor == nIndex) {
+				return false;
+			}
+		}
+	}
+
+	m_Parents[nIndex] = nParent;
+	m_Dirty[nIndex] = 1;
+	m_bNeedsSort = true;
+	return true;
+}
+
+EntityHandle_t CScene::GetParent(EntityHandle_t hEntity) const {
+	const uint32_t nParent = m_Parents[GetDenseIndex(hEntity)];
+	return nParent != INVALID_INDEX ? m_Entities[nParent] : INVALID_ENTITY;
+}
+
+void CScene::SetLocalTransform(EntityHandle_t hEntity, const CMath::Matrix4x4_t& mLocal) {
+	const uint32_t nIndex = GetDenseIndex(hEntity);
+	m_LocalTransforms[nIndex] = mLocal;
+	m_Dirty[nIndex] = 1;
+}
+
+void CScene::SetMesh(EntityHandle_t hEntity, CMeshHandle Mesh) {
+	const uint32_t nIndex = GetDenseIndex(hEntity);
+	if (auto pMesh = Mesh.Get()) {
+		SetLocalBounds(hEntity, pMesh->GetBoundsMin(), pMesh->GetBoundsMax());
+		m_PendingBounds[nIndex] = 0;
+	}
+	else {
+		m_PendingBounds[nIndex] = Mesh.IsValid() && !Mesh.IsFailed();
+		m_bBoundsPending |= m_PendingBounds[nIndex] != 0;
+	}
+	m_Meshes[nIndex] = std::move(Mesh);
+}
+
+void CScene::SetLocalBounds(EntityHandle_t hEntity, const CMath::Vector3_t& vecMin, const CMath::Vector3_t& vecMax) {
+	const uint32_t nIndex = GetDenseIndex(hEntity);
+	m_LocalCenters[nIndex] = (vecMin + vecMax) * 0.5f;
+	m_LocalExtents[nIndex] = (vecMax - vecMin) * 0.5f;
+	m_Dirty[nIndex] = 1;
+}
+
+void CScene::UpdateTransforms() {
+	PROFILE_FUNCTION();
+
+	auto tStart = std::chrono::steady_clock::now();
+
+	m_Stats = SceneUpdateStats_t();
+	m_Stats.bSorted = m_bNeedsSort;
+	if (m_bNeedsSort) {
+		SortHierarchy();
+	}
+	if (m_bBoundsPending) {
+		UpdatePendingBounds();
+	}
+
+	// A level only reads the level above it, so each one can be split freely.
+	std::atomic<uint64_t> nUpdated = 0;
+	for (size_t nLevel = 0; nLevel + 1 < m_LevelOffsets.size(); ++nLevel) {
+		const size_t nBegin = m_LevelOffsets[nLevel];
+		const size_t nEnd = m_LevelOffsets[nLevel + 1];
+		CJobSystem::GetInstance().ParallelFor(nBegin, nEnd, UPDATE_GRAIN_SIZE, [this, &nUpdated](size_t nChunkBegin, size_t nChunkEnd) {
+			UpdateRange(nChunkBegin, nChunkEnd);
+			size_t nChunkUpdated = 0;
+			for (size_t i = nChunkBegin; i < nChunkEnd; ++i) {
+				nChunkUpdated += m_Dirty[i];
+			}
+			nUpdated.fetch_add(nChunkUpdated, std::memory_order_relaxed);
+		});
+	}
+
+	if (!m_Dirty.empty()) {
+		memset(m_Dirty.data(), 0, m_Dirty.size());
+	}
+
+	m_Stats.nEntities = m_Entities.size();
+	m_Stats.nUpdated = nUpdated.load(std::memory_order_relaxed);
+	m_bSpatialTreeStale |= m_Stats.nUpdated > 0;
+	m_Stats.nLevels = static_cast<uint32_t>(m_LevelOffsets.empty() ? 0 : m_LevelOffsets.size() - 1);
+	m_Stats.flUpdateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+void CScene::UpdatePendingBounds() {
+	m_bBoundsPending = false;
+	for (size_t i = 0; i < m_PendingBounds.size(); ++i) {
+		if (!m_PendingBounds[i]) {
+			continue;
+		}
+
+		const CMeshHandle& Mesh = m_Meshes[i];
+		if (Mesh.IsReady()) {
+			if (auto pMesh = Mesh.Get()) {
+				m_LocalCenters[i] = (pMesh->GetBoundsMin() + pMesh->GetBoundsMax()) * 0.5f;
+				m_LocalExtents[i] = (pMesh->GetBoundsMax() - pMesh->GetBoundsMin()) * 0.5f;
+				m_Dirty[i] = 1;
+			}
+			m_PendingBounds[i] = 0;
+		}
+		else if (Mesh.IsFailed()) {
+			m_PendingBounds[i] = 0;
+		}
+		else {
+			m_bBoundsPending = true;
+		}
+	}
+}
+
+void CScene::UpdateRange(size_t nBegin, size_t nEnd) {
+	size_t i = nBegin;
+	while (i < nEnd) {
+		const uint32_t nParent = m_Parents[i];
+
+		// Every child of a moved parent moves with it. Siblings are created, and so sorted, next to each
+		// other, so the whole run is one batch multiply by the parent's world matrix.
+		if (nParent != INVALID_INDEX && m_Dirty[nParent]) {
+			size_t nRunEnd = i + 1;
+			while (nRunEnd < nEnd && m_Parents[nRunEnd] == nParent) {
+				++nRunEnd;
+			}
+
+			const size_t nRunSize = nRunEnd - i;
+			memset(&m_Dirty[i], 1, nRunSize);
+			CMath::MultiplyMany(std::span(m_LocalTransforms).subspan(i, nRunSize), m_WorldTransforms[nParent],
+				std::span(m_WorldTransforms).subspan(i, nRunSize));
+			for (; i < nRunEnd; ++i) {
+				UpdateWorldBounds(i);
+			}
+			continue;
+		}
+
+		if (m_Dirty[i]) {
+			if (nParent == INVALID_INDEX) {
+				m_WorldTransforms[i] = m_LocalTransforms[i];
+			}
+			else {
+				m_WorldTransforms[i] = m_LocalTransforms[i] * m_WorldTransforms[nParent];
+			}
+			UpdateWorldBounds(i);
+		}
+		++i;
+	}
+}
+
+void CScene::UpdateWorldBounds(size_t nIndex) {
+	// The box around the transformed box: the center moves as a point, each
+	// world axis gets the local extents weighted by the absolute rotation/scale.
+	const CMath::Matrix4x4_t& mWorld = m_WorldTransforms[nIndex];
+	const CMath::Vector3_t& vecCenter = m_LocalCenters[nIndex];
+	const CMath::Vector3_t& vecExtent = m_LocalExtents[nIndex];
+	m_WorldCenterX[nIndex] = vecCenter.x * mWorld.m[0][0] + vecCenter.y * mWorld.m[1][0] + vecCenter.z * mWorld.m[2][0] + mWorld.m[3][0];
+	m_WorldCenterY[nIndex] = vecCenter.x * mWorld.m[0][1] + vecCenter.y * mWorld.m[1][1] + vecCenter.z * mWorld.m[2][1] + mWorld.m[3][1];
+	m_WorldCenterZ[nIndex] = vecCenter.x * mWorld.m[0][2] + vecCenter.y * mWorld.m[1][2] + vecCenter.z * mWorld.m[2][2] + mWorld.m[3][2];
+	m_WorldExtentX[nIndex] = vecExtent.x * fabsf(mWorld.m[0][0]) + vecExtent.y * fabsf(mWorld.m[1][0]) + vecExtent.z * fabsf(mWorld.m[2][0]);
+	m_WorldExtentY[nIndex] = vecExtent.x * fabsf(mWorld.m[0][1]) + vecExtent.y * fabsf(mWorld.m[1][1]) + vecExtent.z * fabsf(mWorld.m[2][1]);
+	m_WorldExtentZ[nIndex] = vecExtent.x * fabsf(mWorld.m[0][2]) + vecExtent.y * fabsf(mWorld.m[1][2]) + vecExtent.z * fabsf(mWorld.m[2][2]);
+	m_SpatialDirty[nIndex] = 1;
+}
+
+void CScene::SortHierarchy() {
+	PROFILE_FUNCTION();
+
+	const size_t nCount = m_Entities.size();
+
+	// Depth of every entity; walks up to the first ancestor with a known depth.
+	std::vector<uint32_t> Depths(nCount, UNKNOWN_DEPTH);
+	std::vector<uint32_t> Chain;
+	uint32_t nMaxDepth = 0;
+	for (size_t i = 0; i < nCount; ++i) {
+		uint32_t nIndex = static_cast<uint32_t>(i);
+		while (nIndex != INVALID_INDEX && Depths[nIndex] == UNKNOWN_DEPTH) {
+			Chain.push_back(nIndex);
+			nIndex = m_Parents[nIndex];
+		}
+
+		uint32_t nDepth = nIndex == INVALID_INDEX ? 0 : Depths[nIndex] + 1;
+		while (!Chain.empty()) {
+			Depths[Chain.back()] = nDepth++;
+			Chain.pop_back();
+		}
+		nMaxDepth = std::max(nMaxDepth, Depths[i]);
+	}
+
+	// Counting sort by depth; stable, so siblings keep their relative order.
+	m_LevelOffsets.assign(nCount > 0 ? nMaxDepth + 2 : 1, 0);
+	for (uint32_t nDepth : Depths) {
+		++m_LevelOffsets[nDepth + 1];
+	}
+	for (size_t nLevel = 1; nLevel < m_LevelOffsets.size(); ++nLevel) {
+		m_LevelOffsets[nLevel] += m_LevelOffsets[nLevel - 1];
+	}
+
+	std::vector<uint32_t> Order(nCount);
+	std::vector<uint32_t> OldToNew(nCount);
+	std::vector<size_t> Cursor(m_LevelOffsets.begin(), m_LevelOffsets.end() - 1);
+	for (size_t i = 0; i < nCount; ++i) {
+		const size_t nNew = Cursor[Depths[i]]++;
+		Order[nNew] = static_cast<uint32_t>(i);
+		OldToNew[i] = static_cast<uint32_t>(nNew);
+	}
+
+	Permute(m_Entities, Order);
+	Permute(m_Parents, Order);
+	Permute(m_Dirty, Order);
+	Permute(m_LocalTransforms, Order);
+	Permute(m_WorldTransforms, Order);
+	Permute(m_LocalCenters, Order);
+	Permute(m_LocalExtents, Order);
+	Permute(m_WorldCenterX, Order);
+	Permute(m_WorldCenterY, Order);
+	Permute(m_WorldCenterZ, Order);
+	Permute(m_WorldExtentX, Order);
+	Permute(m_WorldExtentY, Order);
+	Permute(m_WorldExtentZ, Order);
+	Permute(m_Meshes, Order);
+	Permute(m_PendingBounds, Order);
+	Permute(m_Proxies, Order);
+	Permute(m_SpatialDirty, Order);
+
+	for (size_t i = 0; i < nCount; ++i) {
+		m_Slots[GetHandleIndex(m_Entities[i])] = static_cast<uint32_t>(i);
+		if (m_Parents[i] != INVALID_INDEX) {
+			m_Parents[i] = OldToNew[m_Parents[i]];
+		}
+	}
+
+	m_bNeedsSort = false;
+}
+
+size_t CScene::ResizeArrays(size_t nCount) {
+	m_Entities.resize(nCount, INVALID_ENTITY);
+	m_Parents.resize(nCount, INVALID_INDEX);
+	m_Dirty.resize(nCount, 0);
+	m_LocalTransforms.resize(nCount);
+	m_WorldTransforms.resize(nCount);
+	m_LocalCenters.resize(nCount);
+	m_LocalExtents.resize(nCount);
+	m_WorldCenterX.resize(nCount, 0.0f);
+	m_WorldCenterY.resize(nCount, 0.0f);
+	m_WorldCenterZ.resize(nCount, 0.0f);
+	m_WorldExtentX.resize(nCount, 0.0f);
+	m_WorldExtentY.resize(nCount, 0.0f);
+	m_WorldExtentZ.resize(nCount, 0.0f);
+	m_Meshes.resize(nCount);
+	m_PendingBounds.resize(nCount, 0);
+	m_Proxies.resize(nCount, CAABBTree::NULL_NODE);
+	m_SpatialDirty.resize(nCount, 0);
+	return nCount;
+}
+
+AABB_t CScene::GetWorldBounds(size_t nIndex) const {
+	return AABB_t::FromCenterExtent(
+		CMath::Vector3_t(m_WorldCenterX[nIndex], m_WorldCenterY[nIndex], m_WorldCenterZ[nIndex]),
+		CMath::Vector3_t(m_WorldExtentX[nIndex], m_WorldExtentY[nIndex], m_WorldExtentZ[nIndex]));
+}
+
+void CScene::SyncSpatialTree() {
+	if (!m_bSpatialTreeStale) {
+		return;
+	}
+	m_bSpatialTreeStale = false;
+
+	std::vector<uint32_t> Moved;
+	for (size_t i = 0; i < m_SpatialDirty.size(); ++i) {
+		if (m_SpatialDirty[i]) {
+			Moved.push_back(static_cast<uint32_t>(i));
+		}
+	}
+	if (Moved.empty()) {
+		return;
+	}
+
+	PROFILE_FUNCTION();
+	auto tStart = std::chrono::steady_clock::now();
+
+	m_SpatialStats = SpatialSyncStats_t();
+	m_SpatialStats.nMoved = Moved.size();
+
+	if (Moved.size() * INCREMENTAL_SYNC_DIVISOR <= m_Entities.size()) {
+		m_SpatialStats.eMode = SpatialSyncStats_t::SYNC_INCREMENTAL;
+		for (uint32_t nIndex : Moved) {
+			if (m_Proxies[nIndex] == CAABBTree::NULL_NODE) {
+				m_Proxies[nIndex] = m_SpatialTree.CreateProxy(GetWorldBounds(nIndex), m_Entities[nIndex]);
+				++m_SpatialStats.nReinserted;
+			}
+			else if (m_SpatialTree.MoveProxy(m_Proxies[nIndex], GetWorldBounds(nIndex))) {
+				++m_SpatialStats.nReinserted;
+			}
+		}
+	}
+	else {
+		bool bAdded = false;
+		for (uint32_t nIndex : Moved) {
+			if (m_Proxies[nIndex] == CAABBTree::NULL_NODE) {
+				m_Proxies[nIndex] = m_SpatialTree.CreateProxy(GetWorldBounds(nIndex), m_Entities[nIndex], false);
+				bAdded = true;
+			}
+			else {
+				m_SpatialTree.UpdateProxyBounds(m_Proxies[nIndex], GetWorldBounds(nIndex));
+			}
+		}
+
+		bool bRebuild = bAdded;
+		if (!bRebuild) {
+			m_SpatialTree.Refit();
+			bRebuild = m_SpatialTree.GetSAHCost() > m_flRebuildSAHCost * MAX_REFIT_SAH_GROWTH;
+		}
+
+		m_SpatialStats.eMode = bRebuild ? SpatialSyncStats_t::SYNC_REBUILD : SpatialSyncStats_t::SYNC_REFIT;
+		if (bRebuild) {
+			m_SpatialTree.Rebuild();
+			m_flRebuildSAHCost = m_SpatialTree.GetSAHCost();
+		}
+	}
+
+	memset(m_SpatialDirty.data(), 0, m_SpatialDirty.size());
+	m_SpatialStats.flSyncMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+EntityHandle_t CScene::RayCast(const CMath::Vector3_t& vecOrigin, const CMath::Vector3_t& vecDirection, float flMaxDistance, float* pHitDistance) {
+	SyncSpatialTree();
+
+	const CMath::Vector3_t vecInvDirection(1.0f / vecDirection.x, 1.0f / vecDirection.y, 1.0f / vecDirection.z);
+	EntityHandle_t hHit = INVALID_ENTITY;
+	float flHitDistance = flMaxDistance;
+
+	// Leaves hold fat boxes, so each candidate is tested again against its exact one.
+	m_SpatialTree.RayCast(vecOrigin, vecDirection, flMaxDistance, [&](int32_t nProxy, float flMax) {
+		const EntityHandle_t hEntity = m_SpatialTree.GetUserData(nProxy);
+		const float flDistance = GetWorldBounds(GetDenseIndex(hEntity)).IntersectRay(vecOrigin, vecInvDirection, flMax);
+		if (flDistance < 0.0f) {
+			return flMax;
+		}
+
+		hHit = hEntity;
+		flHitDistance = flDistance;
+		// A hit at the origin can't be beaten.
+		return flDistance > 0.0f ? flDistance : 0.0f;
+	});
+
+	if (pHitDistance && hHit != INVALID_ENTITY) {
+		*pHitDistance = flHitDistance;
+	}
+	return hHit;
+}
+
+void CScene::QueryAABB(const AABB_t& Bounds, std::vector<EntityHandle_t>& Results) {
+	SyncSpatialTree();
+
+	m_SpatialTree.QueryAABB(Bounds, [&](int32_t nProxy) {
+		const EntityHandle_t hEntity = m_SpatialTree.GetUserData(nProxy);
+		if (GetWorldBounds(GetDenseIndex(hEntity)).Overlaps(Bounds)) {
+			Results.push_back(hEntity);
+		}
+		return true;
+	});
+}
+
+void CScene::QuerySphere(const CMath::Vector3_t& vecCenter, float flRadius, std::vector<EntityHandle_t>& Results) {
+	SyncSpatialTree();
+
+	const float flRadiusSq = flRadius * flRadius;
+	m_SpatialTree.QuerySphere(vecCenter, flRadius, [&](int32_t nProxy) {
+		const EntityHandle_t hEntity = m_SpatialTree.GetUserData(nProxy);
+		if (GetWorldBounds(GetDenseIndex(hEntity)).GetDistanceSq(vecCenter) <= flRadiusSq) {
+			Results.push_back(hEntity);
+		}
+		return true;
+	});
+}
+
+void CScene::QueryFrustum(const CMath::Frustum_t& Frustum, std::vector<EntityHandle_t>& Results) {
+	SyncSpatialTree();
+
+	m_SpatialTree.QueryFrustum(Frustum, [&](int32_t nProxy) {
+		const EntityHandle_t hEntity = m_SpatialTree.GetUserData(nProxy);
+		const size_t nIndex = GetDenseIndex(hEntity);
+		if (Frustum.IntersectsAABB(
+			CMath::Vector3_t(m_WorldCenterX[nIndex], m_WorldCenterY[nIndex], m_WorldCenterZ[nIndex]),
+			CMath::Vector3_t(m_WorldExtentX[nIndex], m_WorldExtentY[nIndex], m_WorldExtentZ[nIndex]))) {
+			Results.push_back(hEntity);
+		}
+		return true;
+	});
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../../math/CFrustum.hpp"
+#include "../../math/CMath.hpp"
+#include "../../resources/resourcemanager/CMeshHandle.hpp"
+#include "CAABBTree.hpp"
+
+// Stable entity id; its dense index changes whenever the scene re-sorts. The low bits pick a slot, the
+// high bits count how often that slot has been reused, so a handle kept past DestroyEntity stops being
+// valid instead of referring to whichever entity gets the slot next.
+using EntityHandle_t = uint32_t;
+constexpr EntityHandle_t INVALID_ENTITY = UINT32_MAX;
+
+struct SceneUpdateStats_t {
+	uint64_t nEntities = 0;
+	uint64_t nUpdated = 0; // world transforms recomputed
+	uint32_t nLevels = 0; // hierarchy depth
+	bool bSorted = false; // the hierarchy was re-sorted this update
+	double flUpdateMs = 0.0;
+};
+
+struct SpatialSyncStats_t {
+	enum EMode {
+		SYNC_NONE,
+		SYNC_INCREMENTAL, // few moved: reinserted the ones that left their fat boxes
+		SYNC_REFIT, // many moved: new leaf boxes, same topology
+		SYNC_REBUILD // the refit tree got too much worse, or many entities were added
+	};
+
+	EMode eMode = SYNC_NONE;
+	uint64_t nMoved = 0;
+	uint64_t nReinserted = 0;
+	double flSyncMs = 0.0;
+};
+
+// Entities as parallel (SoA) arrays, sorted by hierarchy depth so that every parent comes before its
+// children. UpdateTransforms() is then one pass over the arrays, level by level, each level split
+// across the job system; only entities whose local transform changed, or whose parent's did, are recomputed.
+class CScene {
+public:
+	EntityHandle_t CreateEntity(EntityHandle_t hParent = INVALID_ENTITY);
+	// Also destroys the children. Costs a pass over all entities, so tear down whole subtrees at once.
+	void DestroyEntity(EntityHandle_t hEntity);
+	bool IsValid(EntityHandle_t hEntity) const {
+		const uint32_t nSlot = GetHandleIndex(hEntity);
+		return nSlot < m_Slots.size() && m_Slots[nSlot] != INVALID_INDEX && m_Generations[nSlot] == hEntity >> HANDLE_INDEX_BITS;
+	}
+	// The handle's slot: small and dense, unlike the handle itself, for tables kept next to the scene.
+	static uint32_t GetHandleIndex(EntityHandle_t hEntity) { return hEntity & HANDLE_INDEX_MASK; }
+
+	// Fails if hParent is hEntity or one of its children.
+	bool SetParent(EntityHandle_t hEntity, EntityHandle_t hParent);
+	EntityHandle_t GetParent(EntityHandle_t hEntity) const;
+
+	void SetLocalTransform(EntityHandle_t hEntity, const CMath::Matrix4x4_t& mLocal);
+	const CMath::Matrix4x4_t& GetLocalTransform(EntityHandle_t hEntity) const { return m_LocalTransforms[GetDenseIndex(hEntity)]; }
+	// As of the last UpdateTransforms().
+	const CMath::Matrix4x4_t& GetWorldTransform(EntityHandle_t hEntity) const { return m_WorldTransforms[GetDenseIndex(hEntity)]; }
+
+	// Object space bounds; takes the mesh's, right away if it has been loaded already, otherwise in the
+	// first UpdateTransforms() after it has.
+	void SetMesh(EntityHandle_t hEntity, CMeshHandle Mesh);
+	void SetLocalBounds(EntityHandle_t hEntity, const CMath::Vector3_t& vecMin, const CMath::Vector3_t& vecMax);
+
+	// Re-sorts the hierarchy if it changed, then brings the world transforms and bounds up to date.
+	void UpdateTransforms();
+
+	// Spatial queries against the world AABBs, through a BVH over them. The BVH catches up with moved
+	// entities on the first query after UpdateTransforms(), so a scene nobody queries doesn't pay for it.
+	// Returns the closest entity whose box the ray enters within flMaxDistance, INVALID_ENTITY if none.
+	EntityHandle_t RayCast(const CMath::Vector3_t& vecOrigin, const CMath::Vector3_t& vecDirection, float flMaxDistance, float* pHitDistance = nullptr);
+	void QueryAABB(const AABB_t& Bounds, std::vector<EntityHandle_t>& Results);
+	void QuerySphere(const CMath::Vector3_t& vecCenter, float flRadius, std::vector<EntityHandle_t>& Results);
+	void QueryFrustum(const CMath::Frustum_t& Frustum, std::vector<EntityHandle_t>& Results);
+
+	const CAABBTree& GetSpatialTree() { SyncSpatialTree(); return m_SpatialTree; }
+	const SpatialSyncStats_t& GetSpatialSyncStats() const { return m_SpatialStats; }
+
+	size_t GetEntityCount() const { return m_Entities.size(); }
+	const SceneUpdateStats_t& GetUpdateStats() const { return m_Stats; }
+
+	// Dense arrays for systems that walk the whole scene, valid until the next create, destroy or reparent.
+	std::span<const EntityHandle_t> GetEntities() const { return m_Entities; }
+	std::span<const CMath::Matrix4x4_t> GetWorldTransforms() const { return m_WorldTransforms; }
+	std::span<const CMeshHandle> GetMeshes() const { return m_Meshes; }
+	// World space AABBs as center and half extent, one array per component.
+	std::span<const float> GetWorldCentersX() const { return m_WorldCenterX; }
+	std::span<const float> GetWorldCentersY() const { return m_WorldCenterY; }
+	std::span<const float> GetWorldCentersZ() const { return m_WorldCenterZ; }
+	std::span<const float> GetWorldExtentsX() const { return m_WorldExtentX; }
+	std::span<const float> GetWorldExtentsY() const { return m_WorldExtentY; }
+	std::span<const float> GetWorldExtentsZ() const { return m_WorldExtentZ; }
+
+private:
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+	// 16M slots, and a slot's handles repeat after 256 reuses.
+	static constexpr uint32_t HANDLE_INDEX_BITS = 24;
+	static constexpr uint32_t HANDLE_INDEX_MASK = (1u << HANDLE_INDEX_BITS) - 1;
+	static constexpr uint32_t HANDLE_GENERATION_MASK = UINT32_MAX >> HANDLE_INDEX_BITS;
+	// Entities per job; a world transform and its bounds are a few dozen instructions.
+	static constexpr size_t UPDATE_GRAIN_SIZE = 2048;
+	// Above this share of moved entities, the BVH is refit rather than updated one by one.
+	static constexpr size_t INCREMENTAL_SYNC_DIVISOR = 8;
+	// Rebuild once refitting made the tree this much more expensive than after its last rebuild.
+	static constexpr float MAX_REFIT_SAH_GROWTH = 1.5f;
+
+	uint32_t GetDenseIndex(EntityHandle_t hEntity) const { return m_Slots[GetHandleIndex(hEntity)]; }
+	void SortHierarchy();
+	// Takes the bounds of meshes that finished loading since SetMesh.
+	void UpdatePendingBounds();
+	void UpdateRange(size_t nBegin, size_t nEnd);
+	// World AABB and spatial dirty flag from the entity's world matrix.
+	void UpdateWorldBounds(size_t nIndex);
+	size_t ResizeArrays(size_t nCount);
+	void SyncSpatialTree();
+	AABB_t GetWorldBounds(size_t nIndex) const;
+
+	// Slot -> dense index, INVALID_INDEX for free slots, and the generation its current handle carries.
+	std::vector<uint32_t> m_Slots;
+	std::vector<uint32_t> m_Generations;
+	std::vector<uint32_t> m_FreeSlots;
+
+	// Dense, sorted by depth once UpdateTransforms() ran.
+	std::vector<EntityHandle_t> m_Entities;
+	std::vector<uint32_t> m_Parents; // dense index, INVALID_INDEX for roots
+	std::vector<uint8_t> m_Dirty;
+	std::vector<CMath::Matrix4x4_t> m_LocalTransforms;
+	std::vector<CMath::Matrix4x4_t> m_WorldTransforms;
+	std::vector<CMath::Vector3_t> m_LocalCenters;
+	std::vector<CMath::Vector3_t> m_LocalExtents;
+	std::vector<float> m_WorldCenterX, m_WorldCenterY, m_WorldCenterZ;
+	std::vector<float> m_WorldExtentX, m_WorldExtentY, m_WorldExtentZ;
+	std::vector<CMeshHandle> m_Meshes;
+	std::vector<uint8_t> m_PendingBounds; // the mesh's bounds aren't known yet
+	std::vector<int32_t> m_Proxies; // CAABBTree::NULL_NODE until the first sync
+	std::vector<uint8_t> m_SpatialDirty; // world bounds changed since the last sync
+
+	// Dense index where each depth starts, plus one past the end.
+	std::vector<size_t> m_LevelOffsets;
+	bool m_bNeedsSort = false;
+	bool m_bBoundsPending = false; // some m_PendingBounds flag may be set
+
+	SceneUpdateStats_t m_Stats;
+
+	CAABBTree m_SpatialTree;
+	bool m_bSpatialTreeStale = false; // some m_SpatialDirty flag is set
+	float m_flRebuildSAHCost = 0.0f;
+	SpatialSyncStats_t m_SpatialStats;
+};
@@ -0,0 +1,8 @@
+#include "CHeadlessWindow.hpp"
+
+#include "../../system/logging/CLogSystem.hpp"
+
+bool CHeadlessWindow::Create(const std::string& /*strTitle*/, int nWidth, int nHeight) {
+	LOG_INFO_CH(MAINLOOP, "Running headless (%dx%d)", nWidth, nHeight);
+	return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "IWindow.hpp"
+
+// Window without a surface, for running the engine headless together with CNullRenderBackend.
+class CHeadlessWindow : public IWindow {
+public:
+	bool Create(const std::string& strTitle, int nWidth, int nHeight) override;
+	bool PumpEvents(int& /*nExitCode*/) override { return true; }
+	void* GetNativeHandle() const override { return nullptr; }
+};
@@ -0,0 +1,130 @@
+#include "CWin32Window.hpp"
+
+#include <windowsx.h>
+
+#include "../../system/logging/CLogSystem.hpp"
+
+static CWin32Window* g_pWindow = nullptr;
+
+LRESULT CALLBACK OnWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+	return g_pWindow->HandleMessage(hWnd, uMsg, wParam, lParam);
+}
+
+CWin32Window::CWin32Window(HINSTANCE hInstance) : m_hInstance(hInstance) {
+	g_pWindow = this;
+}
+
+CWin32Window::~CWin32Window() {
+	ReleaseCapture();
+	if (m_hWnd) {
+		DestroyWindow(m_hWnd);
+	}
+}
+
+bool CWin32Window::Create(const std::string& strTitle, int nWidth, int nHeight) {
+	WNDCLASSEX wndClass = { 0 };
+	wndClass.cbSize = sizeof(WNDCLASSEX);
+	wndClass.style = CS_HREDRAW | CS_VREDRAW;
+	wndClass.lpfnWndProc = OnWndProc;
+	wndClass.hInstance = m_hInstance;
+	wndClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
+	wndClass.lpszClassName = "EngineMainWindowClass";
+
+	if (!RegisterClassExA(&wndClass)) {
+		LOG_ERROR_CH(MAINLOOP, "Failed to register window class!");
+		return false;
+	}
+
+	RECT rSize = { 0, 0, nWidth, nHeight };
+	AdjustWindowRect(&rSize, WS_OVERLAPPEDWINDOW, FALSE);
+
+	m_hWnd = CreateWindowEx(
+		0,
+		wndClass.lpszClassName,
+		strTitle.c_str(),
+		WS_OVERLAPPEDWINDOW,
+		CW_USEDEFAULT, CW_USEDEFAULT,
+		rSize.right - rSize.left,
+		rSize.bottom - rSize.top,
+		nullptr, nullptr,
+		m_hInstance, nullptr
+	);
+
+	if (!m_hWnd) {
+		LOG_ERROR_CH(MAINLOOP, "Failed to create window!");
+		return false;
+	}
+
+	ShowWindow(m_hWnd, SW_SHOW);
+	UpdateWindow(m_hWnd);
+
+	SetCapture(m_hWnd);
+	return true;
+}
+
+bool CWin32Window::PumpEvents(int& nExitCode) {
+	MSG mMsg = { 0 };
+	while (PeekMessage(&mMsg, nullptr, 0, 0, PM_REMOVE)) {
+		if (mMsg.message == WM_QUIT) {
+			nExitCode = static_cast<int>(mMsg.wParam);
+			return false;
+		}
+		TranslateMessage(&mMsg);
+		DispatchMessage(&mMsg);
+	}
+	return true;
+}
+
+LRESULT CWin32Window::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+	switch (uMsg)
+	{
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		m_hWnd = nullptr;
+		return 0;
+
+	case WM_LBUTTONDOWN:
+		SetCapture(m_hWnd);
+		return 0;
+
+	case WM_LBUTTONUP:
+		ReleaseCapture();
+		return 0;
+
+	case WM_KILLFOCUS:
+		ReleaseCapture();
+		return 0;
+
+	case WM_KEYDOWN:
+		if (m_pListener) {
+			m_pListener->OnKeyDown(static_cast<uint32_t>(wParam));
+		}
+		return 0;
+
+	case WM_KEYUP:
+		if (m_pListener) {
+			m_pListener->OnKeyUp(static_cast<uint32_t>(wParam));
+		}
+		return 0;
+
+	case WM_MOUSEMOVE: {
+		int x = GET_X_LPARAM(lParam);
+		int y = GET_Y_LPARAM(lParam);
+
+		static int iPrevX = x;
+		static int iPrevY = y;
+		int iDeltaX = x - iPrevX;
+		int iDeltaY = y - iPrevY;
+		iPrevX = x;
+		iPrevY = y;
+
+		if (GetCapture() == m_hWnd && m_pListener) {
+			m_pListener->OnMouseMove(iDeltaX, iDeltaY);
+		}
+
+		return 0;
+	}
+	}
+
+	return DefWindowProc(hWnd, uMsg, wParam, lParam);
+}
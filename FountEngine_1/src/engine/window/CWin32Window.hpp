@@ -0,0 +1,23 @@
+#pragma once
+#include <Windows.h>
+
+#include "IWindow.hpp"
+
+class CWin32Window : public IWindow {
+public:
+	explicit CWin32Window(HINSTANCE hInstance);
+	~CWin32Window() override;
+
+	CWin32Window(const CWin32Window&) = delete;
+	CWin32Window& operator=(const CWin32Window&) = delete;
+
+	bool Create(const std::string& strTitle, int nWidth, int nHeight) override;
+	bool PumpEvents(int& nExitCode) override;
+	void* GetNativeHandle() const override { return m_hWnd; }
+
+	LRESULT HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+private:
+	HINSTANCE m_hInstance;
+	HWND m_hWnd = nullptr;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Key codes are Win32 virtual-key codes on every platform; letters and digits are their ASCII values.
+constexpr uint32_t KEY_CONTROL = 0x11;
+constexpr uint32_t KEY_SPACE = 0x20;
+constexpr uint32_t KEY_F8 = 0x77;
+constexpr uint32_t KEY_F9 = 0x78;
+
+// Receives the input of a window, on the thread that calls IWindow::PumpEvents().
+class IWindowListener {
+public:
+	virtual ~IWindowListener() = default;
+
+	virtual void OnKeyDown(uint32_t nKey) = 0;
+	virtual void OnKeyUp(uint32_t nKey) = 0;
+	virtual void OnMouseMove(int iDeltaX, int iDeltaY) = 0;
+};
+
+// The platform window the engine renders into. CWin32Window is a real one,
+// CHeadlessWindow has no surface and never produces input.
+class IWindow {
+public:
+	virtual ~IWindow() = default;
+
+	virtual bool Create(const std::string& strTitle, int nWidth, int nHeight) = 0;
+
+	// Dispatches pending events to the listener. Returns false once the window was closed,
+	// nExitCode is then what the application should return.
+	virtual bool PumpEvents(int& nExitCode) = 0;
+
+	// What IRenderBackend::Initialize() takes: HWND for Win32, nullptr when headless.
+	virtual void* GetNativeHandle() const = 0;
+
+	void SetListener(IWindowListener* pListener) { m_pListener = pListener; }
+
+protected:
+	IWindowListener* m_pListener = nullptr;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <cmath>
+
+#include "CMath.hpp"
+
+namespace CMath {
+	// Points with GetDistance() >= 0 are on the inner side.
+	struct Plane_t {
+		Vector3_t vecNormal;
+		float flDistance = 0.0f;
+
+		float GetDistance(const Vector3_t& vecPoint) const {
+			return vecNormal.Dot(vecPoint) + flDistance;
+		}
+	};
+
+	struct Frustum_t {
+		enum EPlane {
+			PLANE_LEFT,
+			PLANE_RIGHT,
+			PLANE_BOTTOM,
+			PLANE_TOP,
+			PLANE_NEAR,
+			PLANE_FAR,
+			PLANE_COUNT
+		};
+
+		Plane_t Planes[PLANE_COUNT];
+
+		// Planes of view * projection in world space, normals pointing inwards. With row vectors
+		// clip = p * M, so column j of M gives clip component j; the D3D clip volume is
+		// -w <= x, y <= w and 0 <= z <= w.
+		static Frustum_t FromViewProjection(const Matrix4x4_t& mViewProjection) {
+			const auto& m = mViewProjection.m;
+			auto Column = [&](int j, float aOut[4]) {
+				aOut[0] = m[0][j]; aOut[1] = m[1][j]; aOut[2] = m[2][j]; aOut[3] = m[3][j];
+			};
+
+			float c0[4], c1[4], c2[4], c3[4];
+			Column(0, c0);
+			Column(1, c1);
+			Column(2, c2);
+			Column(3, c3);
+
+			Frustum_t Frustum;
+			auto SetPlane = [&](EPlane ePlane, float a, float b, float c, float d) {
+				float flLength = sqrtf(a * a + b * b + c * c);
+				float flScale = flLength > 0.0f ? 1.0f / flLength : 0.0f;
+				Frustum.Planes[ePlane].vecNormal = Vector3_t(a * flScale, b * flScale, c * flScale);
+				Frustum.Planes[ePlane].flDistance = d * flScale;
+			};
+
+			SetPlane(PLANE_LEFT, c3[0] + c0[0], c3[1] + c0[1], c3[2] + c0[2], c3[3] + c0[3]);
+			SetPlane(PLANE_RIGHT, c3[0] - c0[0], c3[1] - c0[1], c3[2] - c0[2], c3[3] - c0[3]);
+			SetPlane(PLANE_BOTTOM, c3[0] + c1[0], c3[1] + c1[1], c3[2] + c1[2], c3[3] + c1[3]);
+			SetPlane(PLANE_TOP, c3[0] - c1[0], c3[1] - c1[1], c3[2] - c1[2], c3[3] - c1[3]);
+			SetPlane(PLANE_NEAR, c2[0], c2[1], c2[2], c2[3]);
+			SetPlane(PLANE_FAR, c3[0] - c2[0], c3[1] - c2[1], c3[2] - c2[2], c3[3] - c2[3]);
+			return Frustum;
+		}
+
+		// Conservative: boxes and spheres that straddle two planes outside a corner still pass.
+		bool IntersectsSphere(const Vector3_t& vecCenter, float flRadius) const {
+			for (const Plane_t& Plane : Planes) {
+				if (Plane.GetDistance(vecCenter) < -flRadius) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool IntersectsAABB(const Vector3_t& vecCenter, const Vector3_t& vecExtent) const {
+			for (const Plane_t& Plane : Planes) {
+				float flRadius = fabsf(Plane.vecNormal.x) * vecExtent.x + fabsf(Plane.vecNormal.y) * vecExtent.y + fabsf(Plane.vecNormal.z) * vecExtent.z;
+				if (Plane.GetDistance(vecCenter) < -flRadius) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+}
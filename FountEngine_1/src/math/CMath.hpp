@@ -1,7 +1,12 @@
 #pragma once
 #include <cmath>
+#include <cstring>
 
+#include "CMathSIMD.hpp"
+
+#ifndef M_PI
 #define M_PI 3.1415926535f
+#endif
 
 namespace CMath {
 	struct Vector2_t {
@@ -48,39 +53,98 @@ namespace CMath {
 		}
 
 		float Dot(const Vector3_t& other) const {
+#if CMATH_SIMD_SSE
+			return _mm_cvtss_f32(SIMD::Dot3(SIMD::LoadVector3(&x), SIMD::LoadVector3(&other.x)));
+#else
 			return x * other.x + y * other.y + z * other.z;
+#endif
 		}
 
 		Vector3_t Cross(const Vector3_t& other) const {
+#if CMATH_SIMD_SSE
+			Vector3_t vecResult;
+			SIMD::StoreVector3(&vecResult.x, SIMD::Cross3(SIMD::LoadVector3(&x), SIMD::LoadVector3(&other.x)));
+			return vecResult;
+#else
 			return Vector3_t(
 				y * other.z - z * other.y,
 				z * other.x - x * other.z,
 				x * other.y - y * other.x
 			);
+#endif
 		}
 
 		float Length() const {
-			return sqrtf(x * x + y * y + z * z);
+			return sqrtf(Dot(*this));
 		}
 
 		Vector3_t Normalize() const {
+#if CMATH_SIMD_SSE
+			__m128 v = SIMD::LoadVector3(&x);
+			__m128 flLength = _mm_sqrt_ps(SIMD::Dot3(v, v));
+			if (_mm_cvtss_f32(flLength) > 0) {
+				Vector3_t vecResult;
+				SIMD::StoreVector3(&vecResult.x, _mm_div_ps(v, flLength));
+				return vecResult;
+			}
+			return *this;
+#else
 			float flLength = Length();
 			if (flLength > 0) {
 				return *this / flLength;
 			}
 			return *this;
+#endif
 		}
 	};
 
-	struct Vector4_t {
+	struct alignas(16) Vector4_t {
 		float x, y, z, w;
 
 		Vector4_t() : x(0), y(0), z(0), w(0) {}
 		Vector4_t(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
 		Vector4_t(const Vector3_t& vector3, float w) : x(vector3.x), y(vector3.y), z(vector3.z), w(w) {}
+
+		Vector4_t operator+(const Vector4_t& other) const {
+#if CMATH_SIMD_SSE
+			Vector4_t vecResult;
+			_mm_store_ps(&vecResult.x, _mm_add_ps(_mm_load_ps(&x), _mm_load_ps(&other.x)));
+			return vecResult;
+#else
+			return Vector4_t(x + other.x, y + other.y, z + other.z, w + other.w);
+#endif
+		}
+
+		Vector4_t operator-(const Vector4_t& other) const {
+#if CMATH_SIMD_SSE
+			Vector4_t vecResult;
+			_mm_store_ps(&vecResult.x, _mm_sub_ps(_mm_load_ps(&x), _mm_load_ps(&other.x)));
+			return vecResult;
+#else
+			return Vector4_t(x - other.x, y - other.y, z - other.z, w - other.w);
+#endif
+		}
+
+		Vector4_t operator*(float flScalar) const {
+#if CMATH_SIMD_SSE
+			Vector4_t vecResult;
+			_mm_store_ps(&vecResult.x, _mm_mul_ps(_mm_load_ps(&x), _mm_set1_ps(flScalar)));
+			return vecResult;
+#else
+			return Vector4_t(x * flScalar, y * flScalar, z * flScalar, w * flScalar);
+#endif
+		}
+
+		float Dot(const Vector4_t& other) const {
+#if CMATH_SIMD_SSE
+			return _mm_cvtss_f32(SIMD::Dot4(_mm_load_ps(&x), _mm_load_ps(&other.x)));
+#else
+			return x * other.x + y * other.y + z * other.z + w * other.w;
+#endif
+		}
 	};
 
-	struct Matrix4x4_t {
+	struct alignas(16) Matrix4x4_t {
 		float m[4][4];
 
 		Matrix4x4_t() {
@@ -156,6 +220,28 @@ namespace CMath {
 		}
 
 		static Matrix4x4_t CreateLookAt(const Vector3_t& vecEye, const Vector3_t& vecTarget, const Vector3_t& vecUp) {
+#if CMATH_SIMD_SSE
+			__m128 vEye = SIMD::LoadVector3(&vecEye.x);
+			__m128 vUp = SIMD::LoadVector3(&vecUp.x);
+			__m128 vZ = NormalizeOrKeep(_mm_sub_ps(SIMD::LoadVector3(&vecTarget.x), vEye));
+			__m128 vX = NormalizeOrKeep(SIMD::Cross3(vUp, vZ));
+			__m128 vY = SIMD::Cross3(vZ, vX);
+
+			// Axes go into the columns; the w lane of each axis is zero, which gives the 0 column.
+			__m128 vTranslation = _mm_xor_ps(_mm_set1_ps(-0.0f), _mm_movelh_ps(
+				_mm_unpacklo_ps(SIMD::Dot3(vX, vEye), SIMD::Dot3(vY, vEye)),
+				_mm_unpacklo_ps(SIMD::Dot3(vZ, vEye), _mm_setzero_ps())));
+
+			__m128 vRow0 = vX, vRow1 = vY, vRow2 = vZ, vRow3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(vRow0, vRow1, vRow2, vRow3);
+
+			Matrix4x4_t mResult;
+			_mm_store_ps(mResult.m[0], vRow0);
+			_mm_store_ps(mResult.m[1], vRow1);
+			_mm_store_ps(mResult.m[2], vRow2);
+			_mm_store_ps(mResult.m[3], _mm_add_ps(vTranslation, _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f)));
+			return mResult;
+#else
 			Vector3_t zAxis = (vecTarget - vecEye).Normalize();
 			Vector3_t xAxis = vecUp.Cross(zAxis).Normalize();
 			Vector3_t yAxis = zAxis.Cross(xAxis);
@@ -182,10 +268,34 @@ namespace CMath {
 			mResult.m[3][3] = 1.0f;
 
 			return mResult;
+#endif
 		}
 
-		Matrix4x4_t operator*(const Matrix4x4_t& mOther) {
+		Matrix4x4_t operator*(const Matrix4x4_t& mOther) const {
 			Matrix4x4_t mResult;
+#if CMATH_SIMD_AVX
+			// Two result rows per iteration: each 128-bit lane holds one row of this matrix.
+			__m256 vOther0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mOther.m[0]));
+			__m256 vOther1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mOther.m[1]));
+			__m256 vOther2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mOther.m[2]));
+			__m256 vOther3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mOther.m[3]));
+			for (int i = 0; i < 4; i += 2) {
+				__m256 vRows = _mm256_loadu_ps(m[i]);
+				__m256 vResult = _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(0, 0, 0, 0)), vOther0);
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(1, 1, 1, 1)), vOther1));
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(2, 2, 2, 2)), vOther2));
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(3, 3, 3, 3)), vOther3));
+				_mm256_storeu_ps(mResult.m[i], vResult);
+			}
+#elif CMATH_SIMD_SSE
+			__m128 vOther0 = _mm_load_ps(mOther.m[0]);
+			__m128 vOther1 = _mm_load_ps(mOther.m[1]);
+			__m128 vOther2 = _mm_load_ps(mOther.m[2]);
+			__m128 vOther3 = _mm_load_ps(mOther.m[3]);
+			for (int i = 0; i < 4; ++i) {
+				_mm_store_ps(mResult.m[i], SIMD::TransformRow(_mm_load_ps(m[i]), vOther0, vOther1, vOther2, vOther3));
+			}
+#else
 			for (int i = 0; i < 4; ++i) {
 				for (int j = 0; j < 4; ++j) {
 					mResult.m[i][j] = 0;
@@ -194,8 +304,37 @@ namespace CMath {
 					}
 				}
 			}
+#endif
 
 			return mResult;
 		}
+
+		// Row vector times matrix, same convention as mul(v, M) in the shaders.
+		Vector4_t Transform(const Vector4_t& vec) const {
+#if CMATH_SIMD_SSE
+			Vector4_t vecResult;
+			_mm_store_ps(&vecResult.x, SIMD::TransformRow(_mm_load_ps(&vec.x),
+				_mm_load_ps(m[0]), _mm_load_ps(m[1]), _mm_load_ps(m[2]), _mm_load_ps(m[3])));
+			return vecResult;
+#else
+			return Vector4_t(
+				vec.x * m[0][0] + vec.y * m[1][0] + vec.z * m[2][0] + vec.w * m[3][0],
+				vec.x * m[0][1] + vec.y * m[1][1] + vec.z * m[2][1] + vec.w * m[3][1],
+				vec.x * m[0][2] + vec.y * m[1][2] + vec.z * m[2][2] + vec.w * m[3][2],
+				vec.x * m[0][3] + vec.y * m[1][3] + vec.z * m[2][3] + vec.w * m[3][3]
+			);
+#endif
+		}
+
+#if CMATH_SIMD_SSE
+	private:
+		static __m128 NormalizeOrKeep(__m128 v) {
+			__m128 flLength = _mm_sqrt_ps(SIMD::Dot3(v, v));
+			if (_mm_cvtss_f32(flLength) > 0) {
+				return _mm_div_ps(v, flLength);
+			}
+			return v;
+		}
+#endif
 	};
 }
\ No newline at end of file
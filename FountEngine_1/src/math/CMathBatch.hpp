@@ -0,0 +1,209 @@
+#pragma once
+#include <span>
+#include <cassert>
+#include <cstddef>
+
+#include "CMath.hpp"
+
+// Batch kernels: push whole arrays through one matrix instead of calling Transform per element.
+// Row-vector convention everywhere (p' = p * M), inputs and outputs may alias.
+namespace CMath {
+	struct Vector3SoA_t {
+		std::span<float> x, y, z;
+
+		size_t Size() const { return x.size(); }
+	};
+
+	struct ConstVector3SoA_t {
+		std::span<const float> x, y, z;
+
+		ConstVector3SoA_t() = default;
+		ConstVector3SoA_t(std::span<const float> x, std::span<const float> y, std::span<const float> z) : x(x), y(y), z(z) {}
+		ConstVector3SoA_t(const Vector3SoA_t& other) : x(other.x), y(other.y), z(other.z) {}
+
+		size_t Size() const { return x.size(); }
+	};
+
+	namespace Batch {
+		// flW is 1 for points and 0 for directions; the translation row is only added for points.
+		inline void TransformScalar(const Matrix4x4_t& m, float x, float y, float z, float flW, float& outX, float& outY, float& outZ) {
+			outX = x * m.m[0][0] + y * m.m[1][0] + z * m.m[2][0] + flW * m.m[3][0];
+			outY = x * m.m[0][1] + y * m.m[1][1] + z * m.m[2][1] + flW * m.m[3][1];
+			outZ = x * m.m[0][2] + y * m.m[1][2] + z * m.m[2][2] + flW * m.m[3][2];
+		}
+
+		inline void TransformSoA(const Matrix4x4_t& m, ConstVector3SoA_t In, Vector3SoA_t Out, float flW) {
+			const size_t nCount = In.Size();
+			assert(In.y.size() >= nCount && In.z.size() >= nCount);
+			assert(Out.x.size() >= nCount && Out.y.size() >= nCount && Out.z.size() >= nCount);
+
+			size_t i = 0;
+#if CMATH_SIMD_AVX
+			{
+				const __m256 m00 = _mm256_set1_ps(m.m[0][0]), m01 = _mm256_set1_ps(m.m[0][1]), m02 = _mm256_set1_ps(m.m[0][2]);
+				const __m256 m10 = _mm256_set1_ps(m.m[1][0]), m11 = _mm256_set1_ps(m.m[1][1]), m12 = _mm256_set1_ps(m.m[1][2]);
+				const __m256 m20 = _mm256_set1_ps(m.m[2][0]), m21 = _mm256_set1_ps(m.m[2][1]), m22 = _mm256_set1_ps(m.m[2][2]);
+				const __m256 m30 = _mm256_set1_ps(m.m[3][0] * flW), m31 = _mm256_set1_ps(m.m[3][1] * flW), m32 = _mm256_set1_ps(m.m[3][2] * flW);
+
+				for (; i + 8 <= nCount; i += 8) {
+					__m256 x = _mm256_loadu_ps(&In.x[i]);
+					__m256 y = _mm256_loadu_ps(&In.y[i]);
+					__m256 z = _mm256_loadu_ps(&In.z[i]);
+
+					__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m00), _mm256_mul_ps(y, m10)), _mm256_mul_ps(z, m20)), m30);
+					__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m01), _mm256_mul_ps(y, m11)), _mm256_mul_ps(z, m21)), m31);
+					__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m02), _mm256_mul_ps(y, m12)), _mm256_mul_ps(z, m22)), m32);
+
+					_mm256_storeu_ps(&Out.x[i], rx);
+					_mm256_storeu_ps(&Out.y[i], ry);
+					_mm256_storeu_ps(&Out.z[i], rz);
+				}
+			}
+#endif
+#if CMATH_SIMD_SSE
+			{
+				const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]), m02 = _mm_set1_ps(m.m[0][2]);
+				const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]), m12 = _mm_set1_ps(m.m[1][2]);
+				const __m128 m20 = _mm_set1_ps(m.m[2][0]), m21 = _mm_set1_ps(m.m[2][1]), m22 = _mm_set1_ps(m.m[2][2]);
+				const __m128 m30 = _mm_set1_ps(m.m[3][0] * flW), m31 = _mm_set1_ps(m.m[3][1] * flW), m32 = _mm_set1_ps(m.m[3][2] * flW);
+
+				for (; i + 4 <= nCount; i += 4) {
+					__m128 x = _mm_loadu_ps(&In.x[i]);
+					__m128 y = _mm_loadu_ps(&In.y[i]);
+					__m128 z = _mm_loadu_ps(&In.z[i]);
+
+					_mm_storeu_ps(&Out.x[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)), m30));
+					_mm_storeu_ps(&Out.y[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)), m31));
+					_mm_storeu_ps(&Out.z[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)), m32));
+				}
+			}
+#endif
+			for (; i < nCount; ++i) {
+				TransformScalar(m, In.x[i], In.y[i], In.z[i], flW, Out.x[i], Out.y[i], Out.z[i]);
+			}
+		}
+
+		inline void TransformAoS(const Matrix4x4_t& m, std::span<const Vector3_t> In, std::span<Vector3_t> Out, float flW) {
+			const size_t nCount = In.size();
+			assert(Out.size() >= nCount);
+
+			size_t i = 0;
+#if CMATH_SIMD_SSE
+			const __m128 m00 = _mm_set1_ps(m.m[0][0]), m01 = _mm_set1_ps(m.m[0][1]), m02 = _mm_set1_ps(m.m[0][2]);
+			const __m128 m10 = _mm_set1_ps(m.m[1][0]), m11 = _mm_set1_ps(m.m[1][1]), m12 = _mm_set1_ps(m.m[1][2]);
+			const __m128 m20 = _mm_set1_ps(m.m[2][0]), m21 = _mm_set1_ps(m.m[2][1]), m22 = _mm_set1_ps(m.m[2][2]);
+			const __m128 m30 = _mm_set1_ps(m.m[3][0] * flW), m31 = _mm_set1_ps(m.m[3][1] * flW), m32 = _mm_set1_ps(m.m[3][2] * flW);
+
+			// Four Vector3_t are exactly three registers: transpose to SoA, transform, transpose back.
+			for (; i + 4 <= nCount; i += 4) {
+				const float* pIn = &In[i].x;
+				__m128 a = _mm_loadu_ps(pIn);     // x0 y0 z0 x1
+				__m128 b = _mm_loadu_ps(pIn + 4); // y1 z1 x2 y2
+				__m128 c = _mm_loadu_ps(pIn + 8); // z2 x3 y3 z3
+
+				__m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+				__m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+				__m128 x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+				__m128 y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+				__m128 z = _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+
+				__m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)), m30);
+				__m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)), m31);
+				__m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)), m32);
+
+				__m128 x0y0x1y1 = _mm_unpacklo_ps(rx, ry);
+				a = _mm_shuffle_ps(x0y0x1y1, _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+				b = _mm_shuffle_ps(_mm_shuffle_ps(ry, rz, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(rx, ry, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+				c = _mm_shuffle_ps(_mm_shuffle_ps(rz, rx, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+				float* pOut = &Out[i].x;
+				_mm_storeu_ps(pOut, a);
+				_mm_storeu_ps(pOut + 4, b);
+				_mm_storeu_ps(pOut + 8, c);
+			}
+#endif
+			for (; i < nCount; ++i) {
+				const Vector3_t vecIn = In[i];
+				TransformScalar(m, vecIn.x, vecIn.y, vecIn.z, flW, Out[i].x, Out[i].y, Out[i].z);
+			}
+		}
+	}
+
+	inline void TransformPoints(const Matrix4x4_t& m, std::span<const Vector3_t> In, std::span<Vector3_t> Out) {
+		Batch::TransformAoS(m, In, Out, 1.0f);
+	}
+
+	inline void TransformDirections(const Matrix4x4_t& m, std::span<const Vector3_t> In, std::span<Vector3_t> Out) {
+		Batch::TransformAoS(m, In, Out, 0.0f);
+	}
+
+	inline void TransformPoints(const Matrix4x4_t& m, ConstVector3SoA_t In, Vector3SoA_t Out) {
+		Batch::TransformSoA(m, In, Out, 1.0f);
+	}
+
+	inline void TransformDirections(const Matrix4x4_t& m, ConstVector3SoA_t In, Vector3SoA_t Out) {
+		Batch::TransformSoA(m, In, Out, 0.0f);
+	}
+
+	// Full homogeneous transform, e.g. straight to clip space.
+	inline void TransformVectors(const Matrix4x4_t& m, std::span<const Vector4_t> In, std::span<Vector4_t> Out) {
+		const size_t nCount = In.size();
+		assert(Out.size() >= nCount);
+
+#if CMATH_SIMD_SSE
+		const __m128 vRow0 = _mm_load_ps(m.m[0]);
+		const __m128 vRow1 = _mm_load_ps(m.m[1]);
+		const __m128 vRow2 = _mm_load_ps(m.m[2]);
+		const __m128 vRow3 = _mm_load_ps(m.m[3]);
+		for (size_t i = 0; i < nCount; ++i) {
+			_mm_store_ps(&Out[i].x, SIMD::TransformRow(_mm_load_ps(&In[i].x), vRow0, vRow1, vRow2, vRow3));
+		}
+#else
+		for (size_t i = 0; i < nCount; ++i) {
+			Out[i] = m.Transform(In[i]);
+		}
+#endif
+	}
+
+	// Out[i] = Left[i] * mRight, e.g. world matrices by one view-projection.
+	inline void MultiplyMany(std::span<const Matrix4x4_t> Left, const Matrix4x4_t& mRight, std::span<Matrix4x4_t> Out) {
+		const size_t nCount = Left.size();
+		assert(Out.size() >= nCount);
+
+#if CMATH_SIMD_AVX
+		const __m256 vRight0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mRight.m[0]));
+		const __m256 vRight1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mRight.m[1]));
+		const __m256 vRight2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mRight.m[2]));
+		const __m256 vRight3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(mRight.m[3]));
+		for (size_t i = 0; i < nCount; ++i) {
+			for (int j = 0; j < 4; j += 2) {
+				__m256 vRows = _mm256_loadu_ps(Left[i].m[j]);
+				__m256 vResult = _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(0, 0, 0, 0)), vRight0);
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(1, 1, 1, 1)), vRight1));
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(2, 2, 2, 2)), vRight2));
+				vResult = _mm256_add_ps(vResult, _mm256_mul_ps(_mm256_shuffle_ps(vRows, vRows, _MM_SHUFFLE(3, 3, 3, 3)), vRight3));
+				_mm256_storeu_ps(Out[i].m[j], vResult);
+			}
+		}
+#elif CMATH_SIMD_SSE
+		const __m128 vRight0 = _mm_load_ps(mRight.m[0]);
+		const __m128 vRight1 = _mm_load_ps(mRight.m[1]);
+		const __m128 vRight2 = _mm_load_ps(mRight.m[2]);
+		const __m128 vRight3 = _mm_load_ps(mRight.m[3]);
+		for (size_t i = 0; i < nCount; ++i) {
+			__m128 vRow0 = _mm_load_ps(Left[i].m[0]);
+			__m128 vRow1 = _mm_load_ps(Left[i].m[1]);
+			__m128 vRow2 = _mm_load_ps(Left[i].m[2]);
+			__m128 vRow3 = _mm_load_ps(Left[i].m[3]);
+			_mm_store_ps(Out[i].m[0], SIMD::TransformRow(vRow0, vRight0, vRight1, vRight2, vRight3));
+			_mm_store_ps(Out[i].m[1], SIMD::TransformRow(vRow1, vRight0, vRight1, vRight2, vRight3));
+			_mm_store_ps(Out[i].m[2], SIMD::TransformRow(vRow2, vRight0, vRight1, vRight2, vRight3));
+			_mm_store_ps(Out[i].m[3], SIMD::TransformRow(vRow3, vRight0, vRight1, vRight2, vRight3));
+		}
+#else
+		for (size_t i = 0; i < nCount; ++i) {
+			Out[i] = Left[i] * mRight;
+		}
+#endif
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Backend selection for CMath. SSE is picked up automatically on x64 (and on x86 with /arch:SSE2),
+// AVX when the compiler is allowed to emit it (/arch:AVX, -mavx). Define CMATH_FORCE_SCALAR to
+// build the plain C++ path everywhere.
+#if !defined(CMATH_FORCE_SCALAR) && (defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#	define CMATH_SIMD_SSE 1
+#	include <xmmintrin.h>
+#	include <emmintrin.h>
+#	if defined(__AVX__)
+#		define CMATH_SIMD_AVX 1
+#		include <immintrin.h>
+#	else
+#		define CMATH_SIMD_AVX 0
+#	endif
+#else
+#	define CMATH_SIMD_SSE 0
+#	define CMATH_SIMD_AVX 0
+#endif
+
+#if CMATH_SIMD_SSE
+namespace CMath {
+	namespace SIMD {
+		// Vector3_t is 12 bytes (it's part of the Vertex_t layout), so it's loaded as x, y, z, 0.
+		// x and y go through __m128i, which GCC and Clang let alias floats; a double* load may be reordered
+		// around plain float stores to the same vector under strict aliasing.
+		inline __m128 LoadVector3(const float* pData) {
+			__m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pData)));
+			__m128 z = _mm_load_ss(pData + 2);
+			return _mm_movelh_ps(xy, z);
+		}
+
+		inline void StoreVector3(float* pData, __m128 v) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pData), _mm_castps_si128(v));
+			_mm_store_ss(pData + 2, _mm_movehl_ps(v, v));
+		}
+
+		// Summed in the same order as the scalar code: (x + y) + z.
+		inline __m128 Dot3(__m128 a, __m128 b) {
+			__m128 m = _mm_mul_ps(a, b);
+			__m128 s = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+			return _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 0, 0, 0));
+		}
+
+		inline __m128 Dot4(__m128 a, __m128 b) {
+			__m128 m = _mm_mul_ps(a, b);
+			__m128 s = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+			return _mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 0, 0, 0));
+		}
+
+		inline __m128 Cross3(__m128 a, __m128 b) {
+			__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+			__m128 bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+			return _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+		}
+
+		// Row vector times matrix (the convention used by the shaders): r = v.x * m0 + v.y * m1 + v.z * m2 + v.w * m3.
+		inline __m128 TransformRow(__m128 v, __m128 m0, __m128 m1, __m128 m2, __m128 m3) {
+			__m128 r = _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)), m0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), m1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), m2));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), m3));
+			return r;
+		}
+	}
+}
+#endif
\ No newline at end of file
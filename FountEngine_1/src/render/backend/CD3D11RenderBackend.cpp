@@ -0,0 +1,342 @@
+#include "CD3D11RenderBackend.hpp"
+
+#include <chrono>
+#include <cstring>
+
+#include "../../system/logging/CLogSystem.hpp"
+#include "../../system/profiler/CProfiler.hpp"
+
+namespace {
+	// Optimized in every configuration; debug builds add debug info for graphics debuggers. Part of the cache key.
+#ifdef _DEBUG
+	constexpr UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_DEBUG;
+#else
+	constexpr UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+	DXGI_FORMAT ToDXGIFormat(EVertexFormat eFormat) {
+		switch (eFormat) {
+		case VERTEX_FLOAT2: return DXGI_FORMAT_R32G32_FLOAT;
+		case VERTEX_FLOAT3: return DXGI_FORMAT_R32G32B32_FLOAT;
+		case VERTEX_FLOAT4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		case VERTEX_UNORM16X2: return DXGI_FORMAT_R16G16_UNORM;
+		case VERTEX_UNORM16X4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case VERTEX_SNORM16X2: return DXGI_FORMAT_R16G16_SNORM;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	UINT ToBindFlags(EBufferType eType) {
+		switch (eType) {
+		case BUFFER_INDEX: return D3D11_BIND_INDEX_BUFFER;
+		case BUFFER_CONSTANT: return D3D11_BIND_CONSTANT_BUFFER;
+		default: return D3D11_BIND_VERTEX_BUFFER;
+		}
+	}
+}
+
+CD3D11RenderBackend::CD3D11RenderBackend() = default;
+CD3D11RenderBackend::~CD3D11RenderBackend() {
+	for (auto& [hBuffer, pBuffer] : m_Buffers) {
+		pBuffer->Release();
+	}
+	for (auto& [hPipeline, Pipeline] : m_Pipelines) {
+		ReleasePipeline(Pipeline);
+	}
+
+	if (m_pRenderTargetView) m_pRenderTargetView->Release();
+	if (m_pSwapChain) m_pSwapChain->Release();
+	if (m_pDeviceContext) m_pDeviceContext->Release();
+	if (m_pDevice) m_pDevice->Release();
+}
+
+bool CD3D11RenderBackend::Initialize(void* pNativeWindow, int nWidth, int nHeight) {
+	DXGI_SWAP_CHAIN_DESC scd = { 0 };
+	scd.BufferCount = 1;
+	scd.BufferDesc.Width = nWidth;
+	scd.BufferDesc.Height = nHeight;
+	scd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	scd.BufferDesc.RefreshRate.Numerator = 60; // 60 Hz
+	scd.BufferDesc.RefreshRate.Denominator = 1;
+	scd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	scd.OutputWindow = static_cast<HWND>(pNativeWindow);
+	scd.SampleDesc.Count = 1;
+	scd.Windowed = TRUE;
+	scd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+
+	UINT uCreateDeviceFlags = 0;
+
+#ifdef _DEBUG
+	uCreateDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	D3D_FEATURE_LEVEL fLevel;
+	HRESULT hResult = D3D11CreateDeviceAndSwapChain(
+		nullptr,
+		D3D_DRIVER_TYPE_HARDWARE,
+		nullptr,
+		uCreateDeviceFlags,
+		nullptr, 0,
+		D3D11_SDK_VERSION,
+		&scd,
+		&m_pSwapChain,
+		&m_pDevice,
+		&fLevel,
+		&m_pDeviceContext
+	);
+
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to create D3D11 device and swap chain!");
+		return false;
+	}
+
+	ID3D11Texture2D* pBackBuffer = nullptr;
+	hResult = m_pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&pBackBuffer));
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to get back buffer!");
+		return false;
+	}
+
+	hResult = m_pDevice->CreateRenderTargetView(pBackBuffer, nullptr, &m_pRenderTargetView);
+	pBackBuffer->Release();
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to create render target view!");
+		return false;
+	}
+
+	D3D11_VIEWPORT viewport = {};
+	viewport.TopLeftX = 0;
+	viewport.TopLeftY = 0;
+	viewport.Width = static_cast<float>(nWidth);
+	viewport.Height = static_cast<float>(nHeight);
+	viewport.MinDepth = 0.0f;
+	viewport.MaxDepth = 1.0f;
+	m_pDeviceContext->RSSetViewports(1, &viewport);
+
+	m_pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	return true;
+}
+
+RenderHandle_t CD3D11RenderBackend::CreateBuffer(const BufferDesc_t& Desc) {
+	D3D11_BUFFER_DESC dxBufferDesc = {};
+	dxBufferDesc.ByteWidth = static_cast<UINT>(Desc.nSize);
+	dxBufferDesc.Usage = Desc.bDynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+	dxBufferDesc.BindFlags = ToBindFlags(Desc.eType);
+	dxBufferDesc.CPUAccessFlags = Desc.bDynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+
+	D3D11_SUBRESOURCE_DATA dxInitData = {};
+	dxInitData.pSysMem = Desc.pInitialData;
+
+	ID3D11Buffer* pBuffer = nullptr;
+	HRESULT hResult = m_pDevice->CreateBuffer(&dxBufferDesc, Desc.pInitialData ? &dxInitData : nullptr, &pBuffer);
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to create buffer (%zu bytes)", Desc.nSize);
+		return INVALID_RENDER_HANDLE;
+	}
+
+	const RenderHandle_t hBuffer = m_hNextHandle++;
+	m_Buffers.emplace(hBuffer, pBuffer);
+	++m_FrameStats.nBufferCreations;
+	return hBuffer;
+}
+
+void CD3D11RenderBackend::DestroyBuffer(RenderHandle_t hBuffer) {
+	auto it = m_Buffers.find(hBuffer);
+	if (it != m_Buffers.end()) {
+		it->second->Release();
+		m_Buffers.erase(it);
+	}
+}
+
+bool CD3D11RenderBackend::UpdateBuffer(RenderHandle_t hBuffer, const void* pData, size_t nSize) {
+	ID3D11Buffer* pBuffer = GetBuffer(hBuffer);
+	if (!pBuffer) {
+		return false;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE dxMappedResource;
+	HRESULT hResult = m_pDeviceContext->Map(pBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &dxMappedResource);
+	if (FAILED(hResult) || !dxMappedResource.pData) {
+		LOG_ERROR_CH(RENDER, "Failed to map buffer");
+		return false;
+	}
+
+	memcpy(dxMappedResource.pData, pData, nSize);
+	m_pDeviceContext->Unmap(pBuffer, 0);
+
+	++m_FrameStats.nBufferUpdates;
+	m_FrameStats.nBytesUpdated += nSize;
+	return true;
+}
+
+bool CD3D11RenderBackend::CompileShader(const PipelineDesc_t& Desc, const std::string& strEntry, const char* szTarget, std::vector<char>& Bytecode) {
+	PROFILE_FUNCTION();
+
+	ShaderCacheKey_t Key;
+	Key.strSourcePath = Desc.strShaderPath;
+	Key.strEntry = strEntry;
+	Key.strProfile = szTarget;
+	Key.Defines = Desc.Defines;
+	Key.nFlags = SHADER_COMPILE_FLAGS;
+	Key.nCompilerVersion = D3D_COMPILER_VERSION;
+	if (m_ShaderCache.Load(Key, Bytecode)) {
+		LOG_DEBUG_CH(RENDER, "Loaded %s %s from the shader cache", Desc.strShaderPath.c_str(), strEntry.c_str());
+		return true;
+	}
+
+	std::vector<D3D_SHADER_MACRO> Macros;
+	for (const auto& [strName, strValue] : Desc.Defines) {
+		Macros.push_back({ strName.c_str(), strValue.c_str() });
+	}
+	Macros.push_back({ nullptr, nullptr });
+
+	auto tStart = std::chrono::steady_clock::now();
+	ID3DBlob* pBlob = nullptr;
+	ID3DBlob* pErrors = nullptr;
+	HRESULT hResult = D3DCompileFromFile(
+		std::wstring(Desc.strShaderPath.begin(), Desc.strShaderPath.end()).c_str(),
+		Macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		strEntry.c_str(), szTarget,
+		SHADER_COMPILE_FLAGS,
+		0, &pBlob,
+		&pErrors
+	);
+
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to compile %s %s: %s", Desc.strShaderPath.c_str(), strEntry.c_str(),
+			pErrors ? static_cast<const char*>(pErrors->GetBufferPointer()) : "file not found");
+		if (pErrors) pErrors->Release();
+		return false;
+	}
+
+	if (pErrors) pErrors->Release();
+	const char* pData = static_cast<const char*>(pBlob->GetBufferPointer());
+	Bytecode.assign(pData, pData + pBlob->GetBufferSize());
+	pBlob->Release();
+
+	double flMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	LOG_INFO_CH(RENDER, "Compiled %s %s in %.1f ms", Desc.strShaderPath.c_str(), strEntry.c_str(), flMilliseconds);
+	m_ShaderCache.Store(Key, Bytecode);
+	return true;
+}
+
+bool CD3D11RenderBackend::PrecompilePipeline(const PipelineDesc_t& Desc) {
+	std::vector<char> Bytecode;
+	return CompileShader(Desc, Desc.strVertexEntry, "vs_5_0", Bytecode) && CompileShader(Desc, Desc.strPixelEntry, "ps_5_0", Bytecode);
+}
+
+RenderHandle_t CD3D11RenderBackend::CreatePipeline(const PipelineDesc_t& Desc) {
+	std::vector<char> VertexShader, PixelShader;
+	if (!CompileShader(Desc, Desc.strVertexEntry, "vs_5_0", VertexShader) || !CompileShader(Desc, Desc.strPixelEntry, "ps_5_0", PixelShader)) {
+		return INVALID_RENDER_HANDLE;
+	}
+
+	Pipeline_t Pipeline;
+	HRESULT hResult = m_pDevice->CreateVertexShader(VertexShader.data(), VertexShader.size(), nullptr, &Pipeline.pVertexShader);
+	if (SUCCEEDED(hResult)) {
+		hResult = m_pDevice->CreatePixelShader(PixelShader.data(), PixelShader.size(), nullptr, &Pipeline.pPixelShader);
+	}
+
+	if (SUCCEEDED(hResult)) {
+		std::vector<D3D11_INPUT_ELEMENT_DESC> Layout;
+		for (const VertexElement_t& Element : Desc.VertexLayout) {
+			Layout.push_back({
+				Element.szSemantic, Element.nSemanticIndex, ToDXGIFormat(Element.eFormat), Element.nSlot, Element.nOffset,
+				Element.bPerInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA,
+				Element.bPerInstance ? 1u : 0u
+			});
+		}
+
+		hResult = m_pDevice->CreateInputLayout(Layout.data(), static_cast<UINT>(Layout.size()), VertexShader.data(), VertexShader.size(), &Pipeline.pInputLayout);
+	}
+
+	if (FAILED(hResult)) {
+		LOG_ERROR_CH(RENDER, "Failed to create pipeline for %s", Desc.strShaderPath.c_str());
+		ReleasePipeline(Pipeline);
+		return INVALID_RENDER_HANDLE;
+	}
+
+	const RenderHandle_t hPipeline = m_hNextHandle++;
+	m_Pipelines.emplace(hPipeline, Pipeline);
+	return hPipeline;
+}
+
+void CD3D11RenderBackend::DestroyPipeline(RenderHandle_t hPipeline) {
+	auto it = m_Pipelines.find(hPipeline);
+	if (it != m_Pipelines.end()) {
+		ReleasePipeline(it->second);
+		m_Pipelines.erase(it);
+	}
+}
+
+void CD3D11RenderBackend::ReleasePipeline(Pipeline_t& Pipeline) {
+	if (Pipeline.pInputLayout) Pipeline.pInputLayout->Release();
+	if (Pipeline.pVertexShader) Pipeline.pVertexShader->Release();
+	if (Pipeline.pPixelShader) Pipeline.pPixelShader->Release();
+	Pipeline = Pipeline_t();
+}
+
+void CD3D11RenderBackend::BeginFrame(const float* pClearColor) {
+	if (!m_pDeviceContext || !m_pRenderTargetView) {
+		return;
+	}
+
+	m_pDeviceContext->OMSetRenderTargets(1, &m_pRenderTargetView, nullptr);
+	m_pDeviceContext->ClearRenderTargetView(m_pRenderTargetView, pClearColor);
+}
+
+void CD3D11RenderBackend::EndFrame() {
+	if (m_pSwapChain) {
+		m_pSwapChain->Present(1, 0);
+	}
+	FinishFrameStats();
+}
+
+ID3D11Buffer* CD3D11RenderBackend::GetBuffer(RenderHandle_t hBuffer) const {
+	auto it = m_Buffers.find(hBuffer);
+	return it != m_Buffers.end() ? it->second : nullptr;
+}
+
+void CD3D11RenderBackend::SetPipeline(RenderHandle_t hPipeline) {
+	auto it = m_Pipelines.find(hPipeline);
+	if (it == m_Pipelines.end()) {
+		return;
+	}
+
+	m_pDeviceContext->VSSetShader(it->second.pVertexShader, nullptr, 0);
+	m_pDeviceContext->PSSetShader(it->second.pPixelShader, nullptr, 0);
+	m_pDeviceContext->IASetInputLayout(it->second.pInputLayout);
+	++m_FrameStats.nPipelineBinds;
+}
+
+void CD3D11RenderBackend::SetVertexBuffer(uint32_t nSlot, RenderHandle_t hBuffer, uint32_t nStride) {
+	ID3D11Buffer* pBuffer = GetBuffer(hBuffer);
+	UINT nOffset = 0;
+	m_pDeviceContext->IASetVertexBuffers(nSlot, 1, &pBuffer, &nStride, &nOffset);
+	++m_FrameStats.nBufferBinds;
+}
+
+void CD3D11RenderBackend::SetIndexBuffer(RenderHandle_t hBuffer, EIndexFormat eFormat) {
+	m_pDeviceContext->IASetIndexBuffer(GetBuffer(hBuffer), eFormat == INDEX_UINT16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+	++m_FrameStats.nBufferBinds;
+}
+
+void CD3D11RenderBackend::SetConstantBuffer(uint32_t nSlot, RenderHandle_t hBuffer) {
+	ID3D11Buffer* pBuffer = GetBuffer(hBuffer);
+	m_pDeviceContext->VSSetConstantBuffers(nSlot, 1, &pBuffer);
+	++m_FrameStats.nBufferBinds;
+}
+
+void CD3D11RenderBackend::DrawIndexed(uint32_t nIndexCount, uint32_t nStartIndex, int32_t nBaseVertex) {
+	m_pDeviceContext->DrawIndexed(nIndexCount, nStartIndex, nBaseVertex);
+	++m_FrameStats.nDrawCalls;
+	++m_FrameStats.nInstances;
+	m_FrameStats.nIndices += nIndexCount;
+}
+
+void CD3D11RenderBackend::DrawIndexedInstanced(uint32_t nIndexCount, uint32_t nInstanceCount, uint32_t nStartIndex, int32_t nBaseVertex, uint32_t nStartInstance) {
+	m_pDeviceContext->DrawIndexedInstanced(nIndexCount, nInstanceCount, nStartIndex, nBaseVertex, nStartInstance);
+	++m_FrameStats.nDrawCalls;
+	m_FrameStats.nInstances += nInstanceCount;
+	m_FrameStats.nIndices += static_cast<uint64_t>(nIndexCount) * nInstanceCount;
+}
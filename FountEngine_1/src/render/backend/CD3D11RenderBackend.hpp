@@ -0,0 +1,66 @@
+#pragma once
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#include <d3dcompiler.h>
+#include <unordered_map>
+#include <vector>
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+#include "IRenderBackend.hpp"
+#include "../shader/CShaderCache.hpp"
+
+class CD3D11RenderBackend : public IRenderBackend {
+public:
+	CD3D11RenderBackend();
+	~CD3D11RenderBackend() override;
+
+	CD3D11RenderBackend(const CD3D11RenderBackend&) = delete;
+	CD3D11RenderBackend& operator=(const CD3D11RenderBackend&) = delete;
+
+	bool Initialize(void* pNativeWindow, int nWidth, int nHeight) override;
+	const char* GetName() const override { return "d3d11"; }
+
+	RenderHandle_t CreateBuffer(const BufferDesc_t& Desc) override;
+	void DestroyBuffer(RenderHandle_t hBuffer) override;
+	bool UpdateBuffer(RenderHandle_t hBuffer, const void* pData, size_t nSize) override;
+
+	RenderHandle_t CreatePipeline(const PipelineDesc_t& Desc) override;
+	void DestroyPipeline(RenderHandle_t hPipeline) override;
+	bool PrecompilePipeline(const PipelineDesc_t& Desc) override;
+
+	void BeginFrame(const float* pClearColor) override;
+	void EndFrame() override;
+
+	void SetPipeline(RenderHandle_t hPipeline) override;
+	void SetVertexBuffer(uint32_t nSlot, RenderHandle_t hBuffer, uint32_t nStride) override;
+	void SetIndexBuffer(RenderHandle_t hBuffer, EIndexFormat eFormat) override;
+	void SetConstantBuffer(uint32_t nSlot, RenderHandle_t hBuffer) override;
+	void DrawIndexed(uint32_t nIndexCount, uint32_t nStartIndex, int32_t nBaseVertex) override;
+	void DrawIndexedInstanced(uint32_t nIndexCount, uint32_t nInstanceCount, uint32_t nStartIndex, int32_t nBaseVertex, uint32_t nStartInstance) override;
+
+private:
+	struct Pipeline_t {
+		ID3D11VertexShader* pVertexShader = nullptr;
+		ID3D11PixelShader* pPixelShader = nullptr;
+		ID3D11InputLayout* pInputLayout = nullptr;
+	};
+
+	ID3D11Buffer* GetBuffer(RenderHandle_t hBuffer) const;
+	// From the shader cache if it has an up to date entry, compiled and stored in it otherwise.
+	bool CompileShader(const PipelineDesc_t& Desc, const std::string& strEntry, const char* szTarget, std::vector<char>& Bytecode);
+	void ReleasePipeline(Pipeline_t& Pipeline);
+
+	ID3D11Device* m_pDevice = nullptr;
+	ID3D11DeviceContext* m_pDeviceContext = nullptr;
+	IDXGISwapChain* m_pSwapChain = nullptr;
+	ID3D11RenderTargetView* m_pRenderTargetView = nullptr;
+
+	std::unordered_map<RenderHandle_t, ID3D11Buffer*> m_Buffers;
+	std::unordered_map<RenderHandle_t, Pipeline_t> m_Pipelines;
+	RenderHandle_t m_hNextHandle = 1;
+
+	static constexpr const char* SHADER_CACHE_DIRECTORY = "game/shaders/cache";
+	CShaderCache m_ShaderCache{ SHADER_CACHE_DIRECTORY };
+};
@@ -0,0 +1,121 @@
+#include "CNullRenderBackend.hpp"
+
+#include <cstring>
+
+#include "../../system/logging/CLogSystem.hpp"
+
+bool CNullRenderBackend::Initialize(void* /*pNativeWindow*/, int nWidth, int nHeight) {
+	LOG_INFO_CH(RENDER, "Null render backend initialized (%dx%d)", nWidth, nHeight);
+	return true;
+}
+
+RenderHandle_t CNullRenderBackend::CreateBuffer(const BufferDesc_t& Desc) {
+	if (Desc.nSize == 0) {
+		LOG_ERROR_CH(RENDER, "Failed to create buffer: size is 0");
+		return INVALID_RENDER_HANDLE;
+	}
+
+	Buffer_t Buffer = { Desc.eType, Desc.nSize, {} };
+	if (Desc.bDynamic) {
+		Buffer.Data.resize(Desc.nSize);
+		if (Desc.pInitialData) {
+			memcpy(Buffer.Data.data(), Desc.pInitialData, Desc.nSize);
+		}
+	}
+
+	const RenderHandle_t hBuffer = m_hNextHandle++;
+	m_Buffers.emplace(hBuffer, std::move(Buffer));
+	m_nBufferMemory += Desc.nSize;
+	++m_FrameStats.nBufferCreations;
+	return hBuffer;
+}
+
+void CNullRenderBackend::DestroyBuffer(RenderHandle_t hBuffer) {
+	auto it = m_Buffers.find(hBuffer);
+	if (it == m_Buffers.end()) {
+		return;
+	}
+
+	m_nBufferMemory -= it->second.nSize;
+	m_Buffers.erase(it);
+}
+
+bool CNullRenderBackend::UpdateBuffer(RenderHandle_t hBuffer, const void* pData, size_t nSize) {
+	auto it = m_Buffers.find(hBuffer);
+	if (it == m_Buffers.end() || it->second.Data.size() < nSize) {
+		LOG_ERROR_CH(RENDER, "Failed to update buffer %u", hBuffer);
+		return false;
+	}
+
+	memcpy(it->second.Data.data(), pData, nSize);
+	++m_FrameStats.nBufferUpdates;
+	m_FrameStats.nBytesUpdated += nSize;
+	return true;
+}
+
+RenderHandle_t CNullRenderBackend::CreatePipeline(const PipelineDesc_t& Desc) {
+	const RenderHandle_t hPipeline = m_hNextHandle++;
+	m_Pipelines.emplace(hPipeline, Desc);
+	return hPipeline;
+}
+
+void CNullRenderBackend::DestroyPipeline(RenderHandle_t hPipeline) {
+	m_Pipelines.erase(hPipeline);
+}
+
+void CNullRenderBackend::BeginFrame(const float* /*pClearColor*/) {
+	m_Draws.clear();
+}
+
+void CNullRenderBackend::EndFrame() {
+	FinishFrameStats();
+}
+
+void CNullRenderBackend::SetPipeline(RenderHandle_t hPipeline) {
+	m_hPipeline = m_Pipelines.count(hPipeline) ? hPipeline : INVALID_RENDER_HANDLE;
+	++m_FrameStats.nPipelineBinds;
+}
+
+void CNullRenderBackend::SetVertexBuffer(uint32_t nSlot, RenderHandle_t hBuffer, uint32_t /*nStride*/) {
+	const RenderHandle_t hValidBuffer = m_Buffers.count(hBuffer) ? hBuffer : INVALID_RENDER_HANDLE;
+	if (nSlot == 0) {
+		m_hVertexBuffer = hValidBuffer;
+	}
+	else if (nSlot == 1) {
+		m_hInstanceBuffer = hValidBuffer;
+	}
+	++m_FrameStats.nBufferBinds;
+}
+
+void CNullRenderBackend::SetIndexBuffer(RenderHandle_t hBuffer, EIndexFormat /*eFormat*/) {
+	m_hIndexBuffer = m_Buffers.count(hBuffer) ? hBuffer : INVALID_RENDER_HANDLE;
+	++m_FrameStats.nBufferBinds;
+}
+
+void CNullRenderBackend::SetConstantBuffer(uint32_t /*nSlot*/, RenderHandle_t /*hBuffer*/) {
+	++m_FrameStats.nBufferBinds;
+}
+
+void CNullRenderBackend::DrawIndexed(uint32_t nIndexCount, uint32_t nStartIndex, int32_t nBaseVertex) {
+	if (m_hPipeline == INVALID_RENDER_HANDLE || m_hVertexBuffer == INVALID_RENDER_HANDLE || m_hIndexBuffer == INVALID_RENDER_HANDLE) {
+		LOG_WARNING_CH(RENDER, "Draw without a valid pipeline, vertex or index buffer");
+		return;
+	}
+
+	m_Draws.push_back({ m_hPipeline, m_hVertexBuffer, m_hIndexBuffer, INVALID_RENDER_HANDLE, nIndexCount, nStartIndex, nBaseVertex, 1, 0 });
+	++m_FrameStats.nDrawCalls;
+	++m_FrameStats.nInstances;
+	m_FrameStats.nIndices += nIndexCount;
+}
+
+void CNullRenderBackend::DrawIndexedInstanced(uint32_t nIndexCount, uint32_t nInstanceCount, uint32_t nStartIndex, int32_t nBaseVertex, uint32_t nStartInstance) {
+	if (m_hPipeline == INVALID_RENDER_HANDLE || m_hVertexBuffer == INVALID_RENDER_HANDLE || m_hIndexBuffer == INVALID_RENDER_HANDLE || m_hInstanceBuffer == INVALID_RENDER_HANDLE) {
+		LOG_WARNING_CH(RENDER, "Instanced draw without a valid pipeline, vertex, instance or index buffer");
+		return;
+	}
+
+	m_Draws.push_back({ m_hPipeline, m_hVertexBuffer, m_hIndexBuffer, m_hInstanceBuffer, nIndexCount, nStartIndex, nBaseVertex, nInstanceCount, nStartInstance });
+	++m_FrameStats.nDrawCalls;
+	m_FrameStats.nInstances += nInstanceCount;
+	m_FrameStats.nIndices += static_cast<uint64_t>(nIndexCount) * nInstanceCount;
+}
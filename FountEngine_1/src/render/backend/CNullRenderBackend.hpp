@@ -0,0 +1,67 @@
+#pragma once
+#include <unordered_map>
+
+#include "IRenderBackend.hpp"
+
+// Backend without a GPU: validates handles, keeps the contents of dynamic buffers in system memory
+// and records the draws of the current frame, so headless runs exercise the same engine code paths as real ones.
+class CNullRenderBackend : public IRenderBackend {
+public:
+	struct DrawRecord_t {
+		RenderHandle_t hPipeline;
+		RenderHandle_t hVertexBuffer;
+		RenderHandle_t hIndexBuffer;
+		RenderHandle_t hInstanceBuffer;
+		uint32_t nIndexCount;
+		uint32_t nStartIndex;
+		int32_t nBaseVertex;
+		uint32_t nInstanceCount; // 1 for DrawIndexed
+		uint32_t nStartInstance;
+	};
+
+	bool Initialize(void* pNativeWindow, int nWidth, int nHeight) override;
+	const char* GetName() const override { return "null"; }
+
+	RenderHandle_t CreateBuffer(const BufferDesc_t& Desc) override;
+	void DestroyBuffer(RenderHandle_t hBuffer) override;
+	bool UpdateBuffer(RenderHandle_t hBuffer, const void* pData, size_t nSize) override;
+
+	RenderHandle_t CreatePipeline(const PipelineDesc_t& Desc) override;
+	void DestroyPipeline(RenderHandle_t hPipeline) override;
+	// Nothing to compile.
+	bool PrecompilePipeline(const PipelineDesc_t& /*Desc*/) override { return true; }
+
+	void BeginFrame(const float* pClearColor) override;
+	void EndFrame() override;
+
+	void SetPipeline(RenderHandle_t hPipeline) override;
+	void SetVertexBuffer(uint32_t nSlot, RenderHandle_t hBuffer, uint32_t nStride) override;
+	void SetIndexBuffer(RenderHandle_t hBuffer, EIndexFormat eFormat) override;
+	void SetConstantBuffer(uint32_t nSlot, RenderHandle_t hBuffer) override;
+	void DrawIndexed(uint32_t nIndexCount, uint32_t nStartIndex, int32_t nBaseVertex) override;
+	void DrawIndexedInstanced(uint32_t nIndexCount, uint32_t nInstanceCount, uint32_t nStartIndex, int32_t nBaseVertex, uint32_t nStartInstance) override;
+
+	// Draws of the frame in progress, or of the last one after EndFrame().
+	const std::vector<DrawRecord_t>& GetRecordedDraws() const { return m_Draws; }
+	size_t GetBufferCount() const { return m_Buffers.size(); }
+	size_t GetBufferMemory() const { return m_nBufferMemory; }
+
+private:
+	struct Buffer_t {
+		EBufferType eType;
+		size_t nSize;
+		std::vector<uint8_t> Data; // dynamic buffers only
+	};
+
+	std::unordered_map<RenderHandle_t, Buffer_t> m_Buffers;
+	std::unordered_map<RenderHandle_t, PipelineDesc_t> m_Pipelines;
+	RenderHandle_t m_hNextHandle = 1;
+	size_t m_nBufferMemory = 0;
+
+	RenderHandle_t m_hPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hVertexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hInstanceBuffer = INVALID_RENDER_HANDLE; // slot 1
+	RenderHandle_t m_hIndexBuffer = INVALID_RENDER_HANDLE;
+
+	std::vector<DrawRecord_t> m_Draws;
+};
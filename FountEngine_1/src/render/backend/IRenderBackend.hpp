@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Handles to backend objects. 0 is never a valid handle.
+using RenderHandle_t = uint32_t;
+constexpr RenderHandle_t INVALID_RENDER_HANDLE = 0;
+
+enum EBufferType {
+	BUFFER_VERTEX,
+	BUFFER_INDEX,
+	BUFFER_CONSTANT
+};
+
+enum EIndexFormat {
+	INDEX_UINT16,
+	INDEX_UINT32
+};
+
+enum EVertexFormat {
+	VERTEX_FLOAT2,
+	VERTEX_FLOAT3,
+	VERTEX_FLOAT4,
+	// 16-bit integers the shader reads as [0, 1] (unorm) or [-1, 1] (snorm) floats.
+	VERTEX_UNORM16X2,
+	VERTEX_UNORM16X4,
+	VERTEX_SNORM16X2
+};
+
+struct BufferDesc_t {
+	EBufferType eType = BUFFER_VERTEX;
+	size_t nSize = 0;
+	const void* pInitialData = nullptr;
+	bool bDynamic = false; // rewritten from the CPU with UpdateBuffer()
+};
+
+struct VertexElement_t {
+	const char* szSemantic;
+	uint32_t nSemanticIndex;
+	EVertexFormat eFormat;
+	uint32_t nOffset;
+	uint32_t nSlot = 0;
+	bool bPerInstance = false;
+};
+
+struct PipelineDesc_t {
+	std::string strShaderPath;
+	std::string strVertexEntry = "VS";
+	std::string strPixelEntry = "PS";
+	std::vector<std::pair<std::string, std::string>> Defines; // preprocessor macros (name, value) for both stages
+	std::vector<VertexElement_t> VertexLayout;
+};
+
+struct RenderStats_t {
+	uint64_t nDrawCalls = 0;
+	uint64_t nInstances = 0;
+	uint64_t nIndices = 0; // summed over instances
+	uint64_t nBufferCreations = 0;
+	uint64_t nBufferUpdates = 0;
+	uint64_t nBytesUpdated = 0;
+	uint64_t nPipelineBinds = 0;
+	uint64_t nBufferBinds = 0;
+
+	RenderStats_t& operator+=(const RenderStats_t& Other) {
+		nDrawCalls += Other.nDrawCalls;
+		nInstances += Other.nInstances;
+		nIndices += Other.nIndices;
+		nBufferCreations += Other.nBufferCreations;
+		nBufferUpdates += Other.nBufferUpdates;
+		nBytesUpdated += Other.nBytesUpdated;
+		nPipelineBinds += Other.nPipelineBinds;
+		nBufferBinds += Other.nBufferBinds;
+		return *this;
+	}
+};
+
+// Everything the engine needs from a graphics API. CD3D11RenderBackend draws through D3D11,
+// CNullRenderBackend only records and counts, so the engine can run headless.
+class IRenderBackend {
+public:
+	virtual ~IRenderBackend() = default;
+
+	// pNativeWindow is the platform window (HWND for D3D11), nullptr when headless.
+	virtual bool Initialize(void* pNativeWindow, int nWidth, int nHeight) = 0;
+	virtual const char* GetName() const = 0;
+
+	virtual RenderHandle_t CreateBuffer(const BufferDesc_t& Desc) = 0;
+	virtual void DestroyBuffer(RenderHandle_t hBuffer) = 0;
+	// Replaces the contents of a dynamic buffer.
+	virtual bool UpdateBuffer(RenderHandle_t hBuffer, const void* pData, size_t nSize) = 0;
+
+	virtual RenderHandle_t CreatePipeline(const PipelineDesc_t& Desc) = 0;
+	virtual void DestroyPipeline(RenderHandle_t hPipeline) = 0;
+	// Compiles the pipeline's shaders into the backend's shader cache and creates nothing, so it works without
+	// Initialize(). Offline precompilation for shipping builds.
+	virtual bool PrecompilePipeline(const PipelineDesc_t& Desc) = 0;
+
+	virtual void BeginFrame(const float* pClearColor) = 0;
+	// Presents the frame.
+	virtual void EndFrame() = 0;
+
+	virtual void SetPipeline(RenderHandle_t hPipeline) = 0;
+	virtual void SetVertexBuffer(uint32_t nSlot, RenderHandle_t hBuffer, uint32_t nStride) = 0;
+	virtual void SetIndexBuffer(RenderHandle_t hBuffer, EIndexFormat eFormat) = 0;
+	virtual void SetConstantBuffer(uint32_t nSlot, RenderHandle_t hBuffer) = 0;
+	virtual void DrawIndexed(uint32_t nIndexCount, uint32_t nStartIndex = 0, int32_t nBaseVertex = 0) = 0;
+	// Per-instance vertex elements start at nStartInstance of the buffers bound for them.
+	virtual void DrawIndexedInstanced(uint32_t nIndexCount, uint32_t nInstanceCount, uint32_t nStartIndex = 0, int32_t nBaseVertex = 0, uint32_t nStartInstance = 0) = 0;
+
+	// Counters of the last finished frame, and since Initialize().
+	const RenderStats_t& GetFrameStats() const { return m_LastFrameStats; }
+	const RenderStats_t& GetTotalStats() const { return m_TotalStats; }
+
+protected:
+	// Backends count into m_FrameStats and call this at the end of EndFrame().
+	void FinishFrameStats() {
+		m_TotalStats += m_FrameStats;
+		m_LastFrameStats = m_FrameStats;
+		m_FrameStats = RenderStats_t();
+	}
+
+	RenderStats_t m_FrameStats;
+	RenderStats_t m_LastFrameStats;
+	RenderStats_t m_TotalStats;
+};
@@ -0,0 +1,180 @@
+#include "CFrustumCuller.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#include "../../system/profiler/CProfiler.hpp"
+
+void CFrustumCuller::SetFrustum(const CMath::Frustum_t& Frustum) {
+	m_Frustum = Frustum;
+	m_Stats = CullStats_t();
+	m_ClusterStats = ClusterCullStats_t();
+}
+
+void CFrustumCuller::CullAABBs(CMath::ConstVector3SoA_t Centers, CMath::ConstVector3SoA_t Extents, std::vector<uint32_t>& Visible) {
+	PROFILE_FUNCTION();
+
+	auto tStart = std::chrono::steady_clock::now();
+
+	const size_t nCount = Centers.Size();
+	assert(Centers.y.size() >= nCount && Centers.z.size() >= nCount);
+	assert(Extents.x.size() >= nCount && Extents.y.size() >= nCount && Extents.z.size() >= nCount);
+
+	// Room for everything visible; each index is written unconditionally and the cursor
+	// only moves past it when the box passed, so there is no branch per box.
+	const size_t nFirst = Visible.size();
+	Visible.resize(nFirst + nCount);
+	uint32_t* pOut = Visible.data() + nFirst;
+
+	const CMath::Plane_t* pPlanes = m_Frustum.Planes;
+	size_t i = 0;
+#if CMATH_SIMD_AVX
+	{
+		__m256 vNormalX[CMath::Frustum_t::PLANE_COUNT], vNormalY[CMath::Frustum_t::PLANE_COUNT], vNormalZ[CMath::Frustum_t::PLANE_COUNT];
+		__m256 vAbsX[CMath::Frustum_t::PLANE_COUNT], vAbsY[CMath::Frustum_t::PLANE_COUNT], vAbsZ[CMath::Frustum_t::PLANE_COUNT];
+		__m256 vDistance[CMath::Frustum_t::PLANE_COUNT];
+		for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT; ++p) {
+			vNormalX[p] = _mm256_set1_ps(pPlanes[p].vecNormal.x);
+			vNormalY[p] = _mm256_set1_ps(pPlanes[p].vecNormal.y);
+			vNormalZ[p] = _mm256_set1_ps(pPlanes[p].vecNormal.z);
+			vAbsX[p] = _mm256_set1_ps(fabsf(pPlanes[p].vecNormal.x));
+			vAbsY[p] = _mm256_set1_ps(fabsf(pPlanes[p].vecNormal.y));
+			vAbsZ[p] = _mm256_set1_ps(fabsf(pPlanes[p].vecNormal.z));
+			vDistance[p] = _mm256_set1_ps(pPlanes[p].flDistance);
+		}
+
+		for (; i + 8 <= nCount; i += 8) {
+			__m256 cx = _mm256_loadu_ps(&Centers.x[i]), cy = _mm256_loadu_ps(&Centers.y[i]), cz = _mm256_loadu_ps(&Centers.z[i]);
+			__m256 ex = _mm256_loadu_ps(&Extents.x[i]), ey = _mm256_loadu_ps(&Extents.y[i]), ez = _mm256_loadu_ps(&Extents.z[i]);
+
+			// Outside a plane when distance + projected extent < 0; accumulate the sign bits.
+			__m256 vOutside = _mm256_setzero_ps();
+			for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT; ++p) {
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, vNormalX[p]), _mm256_mul_ps(cy, vNormalY[p])), _mm256_add_ps(_mm256_mul_ps(cz, vNormalZ[p]), vDistance[p]));
+				__m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, vAbsX[p]), _mm256_mul_ps(ey, vAbsY[p])), _mm256_mul_ps(ez, vAbsZ[p]));
+				vOutside = _mm256_or_ps(vOutside, _mm256_add_ps(d, r));
+			}
+
+			int nOutsideMask = _mm256_movemask_ps(vOutside);
+			for (int nLane = 0; nLane < 8; ++nLane) {
+				*pOut = static_cast<uint32_t>(i + nLane);
+				pOut += ((nOutsideMask >> nLane) & 1) ^ 1;
+			}
+		}
+	}
+#endif
+#if CMATH_SIMD_SSE
+	{
+		__m128 vNormalX[CMath::Frustum_t::PLANE_COUNT], vNormalY[CMath::Frustum_t::PLANE_COUNT], vNormalZ[CMath::Frustum_t::PLANE_COUNT];
+		__m128 vAbsX[CMath::Frustum_t::PLANE_COUNT], vAbsY[CMath::Frustum_t::PLANE_COUNT], vAbsZ[CMath::Frustum_t::PLANE_COUNT];
+		__m128 vDistance[CMath::Frustum_t::PLANE_COUNT];
+		for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT; ++p) {
+			vNormalX[p] = _mm_set1_ps(pPlanes[p].vecNormal.x);
+			vNormalY[p] = _mm_set1_ps(pPlanes[p].vecNormal.y);
+			vNormalZ[p] = _mm_set1_ps(pPlanes[p].vecNormal.z);
+			vAbsX[p] = _mm_set1_ps(fabsf(pPlanes[p].vecNormal.x));
+			vAbsY[p] = _mm_set1_ps(fabsf(pPlanes[p].vecNormal.y));
+			vAbsZ[p] = _mm_set1_ps(fabsf(pPlanes[p].vecNormal.z));
+			vDistance[p] = _mm_set1_ps(pPlanes[p].flDistance);
+		}
+
+		for (; i + 4 <= nCount; i += 4) {
+			__m128 cx = _mm_loadu_ps(&Centers.x[i]), cy = _mm_loadu_ps(&Centers.y[i]), cz = _mm_loadu_ps(&Centers.z[i]);
+			__m128 ex = _mm_loadu_ps(&Extents.x[i]), ey = _mm_loadu_ps(&Extents.y[i]), ez = _mm_loadu_ps(&Extents.z[i]);
+
+			__m128 vOutside = _mm_setzero_ps();
+			for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT; ++p) {
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, vNormalX[p]), _mm_mul_ps(cy, vNormalY[p])), _mm_add_ps(_mm_mul_ps(cz, vNormalZ[p]), vDistance[p]));
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, vAbsX[p]), _mm_mul_ps(ey, vAbsY[p])), _mm_mul_ps(ez, vAbsZ[p]));
+				vOutside = _mm_or_ps(vOutside, _mm_add_ps(d, r));
+			}
+
+			int nOutsideMask = _mm_movemask_ps(vOutside);
+			for (int nLane = 0; nLane < 4; ++nLane) {
+				*pOut = static_cast<uint32_t>(i + nLane);
+				pOut += ((nOutsideMask >> nLane) & 1) ^ 1;
+			}
+		}
+	}
+#endif
+	for (; i < nCount; ++i) {
+		*pOut = static_cast<uint32_t>(i);
+		pOut += m_Frustum.IntersectsAABB(CMath::Vector3_t(Centers.x[i], Centers.y[i], Centers.z[i]), CMath::Vector3_t(Extents.x[i], Extents.y[i], Extents.z[i])) ? 1 : 0;
+	}
+
+	const size_t nVisible = static_cast<size_t>(pOut - (Visible.data() + nFirst));
+	Visible.resize(nFirst + nVisible);
+
+	m_Stats.nTested += nCount;
+	m_Stats.nVisible += nVisible;
+	m_Stats.nCulled += nCount - nVisible;
+	m_Stats.flCullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+bool CFrustumCuller::IsSphereVisible(const CMath::Vector3_t& vecCenter, float flRadius) {
+	const bool bVisible = m_Frustum.IntersectsSphere(vecCenter, flRadius);
+	++m_Stats.nTested;
+	++(bVisible ? m_Stats.nVisible : m_Stats.nCulled);
+	return bVisible;
+}
+
+void CFrustumCuller::CullMeshlets(std::span<const Meshlet_t> Meshlets, const CMath::Matrix4x4_t& mWorld, const CMath::Vector3_t& vecCameraPosition,
+	std::vector<IndexRange_t>& Ranges) {
+	PROFILE_FUNCTION();
+
+	auto tStart = std::chrono::steady_clock::now();
+
+	float flScale = 0.0f;
+	for (int nAxis = 0; nAxis < 3; ++nAxis) {
+		flScale = std::max(flScale, CMath::Vector3_t(mWorld.m[nAxis][0], mWorld.m[nAxis][1], mWorld.m[nAxis][2]).Length());
+	}
+	const float flInverseScale = flScale > 0.0f ? 1.0f / flScale : 0.0f;
+
+	// Bounds to world space in two batches, the tests below only read the results.
+	const size_t nCount = Meshlets.size();
+	m_WorldCenters.resize(nCount);
+	m_WorldConeAxes.resize(nCount);
+	for (size_t i = 0; i < nCount; ++i) {
+		m_WorldCenters[i] = Meshlets[i].vecCenter;
+		m_WorldConeAxes[i] = Meshlets[i].vecConeAxis;
+	}
+	CMath::TransformPoints(mWorld, m_WorldCenters, m_WorldCenters);
+	CMath::TransformDirections(mWorld, m_WorldConeAxes, m_WorldConeAxes);
+
+	const size_t nFirstRange = Ranges.size();
+	for (size_t i = 0; i < nCount; ++i) {
+		const Meshlet_t& Meshlet = Meshlets[i];
+		const CMath::Vector3_t& vecCenter = m_WorldCenters[i];
+		const float flRadius = Meshlet.flRadius * flScale;
+		m_ClusterStats.nTrianglesTested += Meshlet.nTriangleCount;
+
+		if (!m_Frustum.IntersectsSphere(vecCenter, flRadius)) {
+			++m_ClusterStats.nFrustumCulled;
+			continue;
+		}
+
+		// Back facing if the camera sees every normal of the cone from behind, from anywhere in the sphere.
+		if (Meshlet.flConeCutoff < 1.0f) {
+			const CMath::Vector3_t vecAxis = m_WorldConeAxes[i] * flInverseScale;
+			const CMath::Vector3_t vecView = vecCenter - vecCameraPosition;
+			if (vecView.Dot(vecAxis) >= Meshlet.flConeCutoff * vecView.Length() + flRadius) {
+				++m_ClusterStats.nBackfaceCulled;
+				continue;
+			}
+		}
+
+		const uint32_t nIndexCount = Meshlet.nTriangleCount * 3;
+		m_ClusterStats.nTrianglesVisible += Meshlet.nTriangleCount;
+		if (Ranges.size() > nFirstRange && Ranges.back().nStartIndex + Ranges.back().nIndexCount == Meshlet.nStartIndex) {
+			Ranges.back().nIndexCount += nIndexCount;
+		}
+		else {
+			Ranges.push_back({ Meshlet.nStartIndex, nIndexCount });
+		}
+	}
+
+	m_ClusterStats.nTested += nCount;
+	m_ClusterStats.nRanges += Ranges.size() - nFirstRange;
+	m_ClusterStats.flCullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+}
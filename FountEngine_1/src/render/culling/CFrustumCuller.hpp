@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../../math/CFrustum.hpp"
+#include "../../math/CMathBatch.hpp"
+#include "../mesh/CMeshletBuilder.hpp"
+
+struct CullStats_t {
+	uint64_t nTested = 0;
+	uint64_t nVisible = 0;
+	uint64_t nCulled = 0;
+	double flCullMs = 0.0;
+};
+
+struct ClusterCullStats_t {
+	uint64_t nTested = 0;
+	uint64_t nFrustumCulled = 0;
+	uint64_t nBackfaceCulled = 0;
+	uint64_t nTrianglesTested = 0;
+	uint64_t nTrianglesVisible = 0;
+	uint64_t nRanges = 0; // draws left after merging neighbouring visible clusters
+	double flCullMs = 0.0;
+};
+
+struct IndexRange_t {
+	uint32_t nStartIndex;
+	uint32_t nIndexCount;
+};
+
+// Tests bounds against the frame's frustum. The batch path takes AABBs as SoA centers and half extents
+// (the layout CScene keeps them in) and tests 8 (AVX) or 4 (SSE) boxes against each plane at once.
+class CFrustumCuller {
+public:
+	// Also starts a new frame of stats.
+	void SetFrustum(const CMath::Frustum_t& Frustum);
+	const CMath::Frustum_t& GetFrustum() const { return m_Frustum; }
+
+	// Appends the indices of the boxes that touch the frustum to Visible.
+	void CullAABBs(CMath::ConstVector3SoA_t Centers, CMath::ConstVector3SoA_t Extents, std::vector<uint32_t>& Visible);
+
+	bool IsSphereVisible(const CMath::Vector3_t& vecCenter, float flRadius);
+
+	// Appends the index ranges of the meshlets that touch the frustum and don't face away from vecCameraPosition,
+	// merging ranges that follow each other. mWorld may rotate, translate and scale uniformly.
+	void CullMeshlets(std::span<const Meshlet_t> Meshlets, const CMath::Matrix4x4_t& mWorld, const CMath::Vector3_t& vecCameraPosition,
+		std::vector<IndexRange_t>& Ranges);
+
+	const CullStats_t& GetFrameStats() const { return m_Stats; }
+	const ClusterCullStats_t& GetClusterFrameStats() const { return m_ClusterStats; }
+
+private:
+	CMath::Frustum_t m_Frustum;
+	CullStats_t m_Stats;
+	ClusterCullStats_t m_ClusterStats;
+
+	// CullMeshlets scratch: meshlet bounds in world space.
+	std::vector<CMath::Vector3_t> m_WorldCenters;
+	std::vector<CMath::Vector3_t> m_WorldConeAxes;
+};
@@ -1,125 +1,455 @@
 #include "CMesh.hpp"
 
-#include <fstream>
-#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
 
+#include "COBJParser.hpp"
+#include "CMeshOptimizer.hpp"
+#include "CMeshSimplifier.hpp"
+#include "CMeshFile.hpp"
+#include "../vertex/CVertexPacker.hpp"
 #include "../../system/logging/CLogSystem.hpp"
+#include "../../system/filesystem/CMappedFile.hpp"
+#include "../../system/profiler/CProfiler.hpp"
 #include "../../math/CMath.hpp"
 
 CMesh::CMesh() = default;
 CMesh::~CMesh() {
-	if (m_pVertexBuffer) m_pVertexBuffer->Release();
-	if (m_pIndexBuffer) m_pIndexBuffer->Release();
+	ReleaseBuffers();
 }
 
 bool CMesh::LoadFromOBJ(const std::string& strFilePath) {
-	std::ifstream sFile(strFilePath);
-	if (!sFile.is_open()) {
-		LOG_ERROR("Failed to open file: %s", strFilePath.c_str());
+	PROFILE_FUNCTION();
+	auto tStart = std::chrono::steady_clock::now();
+
+	CMappedFile File;
+	if (!File.Open(strFilePath)) {
+		LOG_ERROR_CH(RENDER, "Failed to open file: %s", strFilePath.c_str());
+		return false;
+	}
+
+	COBJParser Parser;
+	if (!Parser.Parse(File.GetData(), File.GetSize(), strFilePath)) {
+		return false;
+	}
+
+	m_pMappedFile.reset();
+	BuildIndexedVertices(Parser);
+	UseOwnedData();
+	m_LODs.assign(1, { 0, static_cast<uint32_t>(m_Indices.size()), 0.0f });
+	m_Meshlets.clear();
+	ComputeBounds();
+	m_strSourcePath = strFilePath;
+
+	double flSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+	double flMegabytes = static_cast<double>(File.GetSize()) / (1024.0 * 1024.0);
+	LOG_INFO_CH(RENDER, "Successfully loaded mesh from %s (%.2f MB in %.1f ms, %.1f MB/s, %zu unique vertices for %zu corners)", strFilePath.c_str(),
+		flMegabytes, flSeconds * 1000.0, flSeconds > 0.0 ? flMegabytes / flSeconds : 0.0, m_Vertices.size(), m_Indices.size());
+	return true;
+}
+
+void CMesh::CopyCPUData(const CMesh& Source) {
+	m_Vertices.assign(Source.m_VertexData.begin(), Source.m_VertexData.end());
+	m_Indices.assign(Source.m_IndexData.begin(), Source.m_IndexData.end());
+	m_pMappedFile.reset();
+	UseOwnedData();
+
+	m_LODs = Source.m_LODs;
+	m_Meshlets = Source.m_Meshlets;
+	m_vecBoundsMin = Source.m_vecBoundsMin;
+	m_vecBoundsMax = Source.m_vecBoundsMax;
+	m_vecSphereCenter = Source.m_vecSphereCenter;
+	m_flSphereRadius = Source.m_flSphereRadius;
+	m_strSourcePath = Source.m_strSourcePath;
+	m_bPackVertices = Source.m_bPackVertices;
+}
+
+bool CMesh::LoadFromCooked(const std::string& strFilePath) {
+	auto pMappedFile = std::make_unique<CMappedFile>();
+	if (!pMappedFile->Open(strFilePath)) {
+		LOG_ERROR_CH(RENDER, "Failed to open file: %s", strFilePath.c_str());
 		return false;
 	}
 
-	std::vector<CMath::Vector3_t> Positions;
-	std::vector<CMath::Vector3_t> Normals;
-	std::vector<CMath::Vector2_t> Texcoords;
+	const MeshFileHeader_t* pHeader = CMeshFile::Validate(pMappedFile->GetData(), pMappedFile->GetSize());
+	if (!pHeader) {
+		LOG_ERROR_CH(RENDER, "Invalid or outdated cooked mesh: %s", strFilePath.c_str());
+		return false;
+	}
+
+	m_Vertices.clear();
+	m_Indices.clear();
+
+	const char* pData = pMappedFile->GetData();
+	m_VertexData = std::span<const Vertex_t>(reinterpret_cast<const Vertex_t*>(pData + pHeader->nVertexOffset), static_cast<size_t>(pHeader->nVertexCount));
+	m_IndexData = std::span<const unsigned int>(reinterpret_cast<const unsigned int*>(pData + pHeader->nIndexOffset), static_cast<size_t>(pHeader->nIndexCount));
+	m_vecBoundsMin = CMath::Vector3_t(pHeader->aBoundsMin[0], pHeader->aBoundsMin[1], pHeader->aBoundsMin[2]);
+	m_vecBoundsMax = CMath::Vector3_t(pHeader->aBoundsMax[0], pHeader->aBoundsMax[1], pHeader->aBoundsMax[2]);
+	ComputeBoundingSphere();
+	m_LODs.assign(pHeader->aLODs, pHeader->aLODs + pHeader->nLODCount);
+	const Meshlet_t* pMeshlets = reinterpret_cast<const Meshlet_t*>(pData + pHeader->nMeshletOffset);
+	m_Meshlets.assign(pMeshlets, pMeshlets + pHeader->nMeshletCount);
+	m_pMappedFile = std::move(pMappedFile);
+	m_strSourcePath = strFilePath;
+
+	LOG_INFO_CH(RENDER, "Successfully mapped cooked mesh %s (%zu vertices, %zu indices, %zu LODs, %zu meshlets)", strFilePath.c_str(),
+		m_VertexData.size(), m_IndexData.size(), m_LODs.size(), m_Meshlets.size());
+	return true;
+}
+
+bool CMesh::SaveCooked(const std::string& strFilePath) const {
+	return CMeshFile::Write(strFilePath, m_strSourcePath, m_VertexData, m_IndexData, m_LODs, m_Meshlets, m_vecBoundsMin, m_vecBoundsMax);
+}
+
+void CMesh::BuildIndexedVertices(const COBJParser& Parser) {
+	const auto& Positions = Parser.GetPositions();
+	const auto& Normals = Parser.GetNormals();
+	const auto& Texcoords = Parser.GetTexcoords();
+	const auto& Corners = Parser.GetCorners();
+
+	m_Vertices.clear();
+	m_Indices.clear();
+	m_Indices.reserve(Corners.size());
+
+	// Open-addressing table of vertex indices; the key of a slot is the corner that created the vertex.
+	// There can never be more unique vertices than corners, so sizing it for all corners means no rehashing.
+	size_t nCapacity = 16;
+	int nCapacityBits = 4;
+	while (nCapacity < Corners.size() + Corners.size() / 2) {
+		nCapacity <<= 1;
+		++nCapacityBits;
+	}
+	const size_t nMask = nCapacity - 1;
+	constexpr unsigned int EMPTY_SLOT = ~0u;
 
-	std::string strLine;
-	while (std::getline(sFile, strLine)) {
-		std::istringstream iss(strLine);
-		std::string strType;
-		iss >> strType;
+	std::vector<unsigned int> Slots(nCapacity, EMPTY_SLOT);
+	std::vector<COBJParser::Corner_t> UniqueCorners;
+	UniqueCorners.reserve(Positions.size());
+	m_Vertices.reserve(Positions.size());
 
-		if (strType == "v") { // Vertex Position
-			float x, y, z;
-			iss >> x >> y >> z;
-			Positions.emplace_back(x, y, z);
+	for (const auto& Corner : Corners) {
+		// Fibonacci hashing: the top bits of the product are the well-mixed ones.
+		uint64_t nHash = static_cast<uint32_t>(Corner.nPosition);
+		nHash = (nHash * 0x9E3779B97F4A7C15ull) ^ static_cast<uint32_t>(Corner.nTexcoord);
+		nHash = (nHash * 0x9E3779B97F4A7C15ull) ^ static_cast<uint32_t>(Corner.nNormal);
+		nHash *= 0x9E3779B97F4A7C15ull;
+
+		size_t nSlot = static_cast<size_t>(nHash >> (64 - nCapacityBits));
+		while (true) {
+			unsigned int nVertex = Slots[nSlot];
+			if (nVertex == EMPTY_SLOT) {
+				nVertex = static_cast<unsigned int>(m_Vertices.size());
+				Slots[nSlot] = nVertex;
+				UniqueCorners.push_back(Corner);
+
+				Vertex_t Vertex;
+				Vertex.vec3Position = Positions[Corner.nPosition];
+				if (Corner.nTexcoord >= 0) {
+					Vertex.vec2Texcoord = Texcoords[Corner.nTexcoord];
+				}
+				if (Corner.nNormal >= 0) {
+					Vertex.vec3Normal = Normals[Corner.nNormal];
+				}
+				m_Vertices.push_back(Vertex);
+
+				m_Indices.push_back(nVertex);
+				break;
+			}
+
+			const auto& Existing = UniqueCorners[nVertex];
+			if (Existing.nPosition == Corner.nPosition && Existing.nTexcoord == Corner.nTexcoord && Existing.nNormal == Corner.nNormal) {
+				m_Indices.push_back(nVertex);
+				break;
+			}
+
+			nSlot = (nSlot + 1) & nMask;
 		}
-		else if (strType == "vn") { // Vertex Normal Position
-			float x, y, z;
-			iss >> x >> y >> z;
-			Normals.emplace_back(x, y, z);
+	}
+
+	m_Vertices.shrink_to_fit();
+}
+
+void CMesh::GenerateLODs(uint32_t nLODCount, float flReduction) {
+	PROFILE_FUNCTION();
+	auto tStart = std::chrono::steady_clock::now();
+	MakeDataOwned();
+
+	// Every level is simplified from the full mesh, so its error is against the original surface.
+	const size_t nFullIndexCount = m_LODs.empty() ? m_Indices.size() : m_LODs[0].nIndexCount;
+	m_Indices.resize(nFullIndexCount);
+	m_LODs.assign(1, { 0, static_cast<uint32_t>(nFullIndexCount), 0.0f });
+
+	nLODCount = std::min(nLODCount, MAX_MESH_LODS);
+	std::vector<unsigned int> LODIndices;
+	float flTargetRatio = 1.0f;
+	for (uint32_t nLOD = 1; nLOD < nLODCount; ++nLOD) {
+		flTargetRatio *= flReduction;
+		LODIndices.assign(m_Indices.begin(), m_Indices.begin() + nFullIndexCount);
+		float flError = CMeshSimplifier::Simplify(m_Vertices, LODIndices, static_cast<size_t>(nFullIndexCount * flTargetRatio));
+
+		// Not worth a level if it barely got smaller than the previous one.
+		if (LODIndices.empty() || LODIndices.size() > m_LODs.back().nIndexCount * 0.9f) {
+			break;
 		}
-		else if (strType == "vt") {
-			float u, v;
-			iss >> u >> v;
-			Texcoords.emplace_back(u, v);
+
+		m_LODs.push_back({ static_cast<uint32_t>(m_Indices.size()), static_cast<uint32_t>(LODIndices.size()), std::max(flError, m_LODs.back().flError) });
+		m_Indices.insert(m_Indices.end(), LODIndices.begin(), LODIndices.end());
+	}
+	UseOwnedData();
+
+	double flMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	std::string strLevels;
+	for (const MeshLOD_t& LOD : m_LODs) {
+		char szLevel[64];
+		snprintf(szLevel, sizeof(szLevel), "%s%u (%.4f)", strLevels.empty() ? "" : ", ", LOD.nIndexCount / 3, LOD.flError);
+		strLevels += szLevel;
+	}
+	LOG_INFO_CH(RENDER, "Generated %zu LODs for %s in %.1f ms, triangles (error): %s", m_LODs.size(), m_strSourcePath.c_str(), flMilliseconds, strLevels.c_str());
+}
+
+uint32_t CMesh::SelectLOD(float flDistance, float flPixelsPerUnit, float flMaxPixelError) const {
+	// error * flPixelsPerUnit / flDistance <= flMaxPixelError, without dividing by a distance that may be 0.
+	const float flMaxError = flMaxPixelError * flDistance / flPixelsPerUnit;
+	for (uint32_t nLOD = static_cast<uint32_t>(m_LODs.size()); nLOD > 1; --nLOD) {
+		if (m_LODs[nLOD - 1].flError <= flMaxError) {
+			return nLOD - 1;
 		}
-		else if (strType == "f") {
-			std::string strVertex;
-			while (iss >> strVertex) {
-				std::istringstream viss(strVertex);
-				std::string strIndices;
+	}
+	return 0;
+}
 
-				Vertex_t Vertex;
-				std::getline(viss, strIndices, '/');
-				if (!strIndices.empty()) {
-					int nPositionIndex = std::stoi(strIndices) - 1;
-					Vertex.vec3Position = Positions[nPositionIndex];
-				}
+void CMesh::Optimize() {
+	PROFILE_FUNCTION();
+	auto tStart = std::chrono::steady_clock::now();
+	MakeDataOwned();
+	if (m_LODs.empty()) {
+		m_LODs.assign(1, { 0, static_cast<uint32_t>(m_Indices.size()), 0.0f });
+	}
+	const size_t nFullIndexCount = m_LODs[0].nIndexCount;
+	auto Before = CMeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int>(m_Indices).first(nFullIndexCount), m_Vertices.size());
 
-				std::getline(viss, strIndices, '/');
-				if (!strIndices.empty()) {
-					int nTexIndex = std::stoi(strIndices) - 1;
-					Vertex.vec2Texcoord = Texcoords[nTexIndex];
-				}
+	// Each LOD is drawn on its own, so each gets its own cache and overdraw order.
+	std::vector<unsigned int> LODIndices;
+	std::vector<unsigned int> ClusterStarts;
+	for (const MeshLOD_t& LOD : m_LODs) {
+		LODIndices.assign(m_Indices.begin() + LOD.nStartIndex, m_Indices.begin() + LOD.nStartIndex + LOD.nIndexCount);
+		ClusterStarts.clear();
+		CMeshOptimizer::OptimizeVertexCache(LODIndices, m_Vertices.size(), &ClusterStarts);
+		CMeshOptimizer::OptimizeOverdraw(LODIndices, m_Vertices, ClusterStarts);
+		std::copy(LODIndices.begin(), LODIndices.end(), m_Indices.begin() + LOD.nStartIndex);
+	}
+	// Fetch order follows LOD 0, the coarser levels use a subset of its vertices.
+	CMeshOptimizer::OptimizeVertexFetch(m_Vertices, m_Indices);
+	UseOwnedData();
+	m_Meshlets.clear();
 
-				std::getline(viss, strIndices, '/');
-				if (!strIndices.empty()) {
-					int nNormIndex = std::stoi(strIndices) - 1;
-					Vertex.vec3Normal = Normals[nNormIndex];
-				}
+	auto After = CMeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int>(m_Indices).first(nFullIndexCount), m_Vertices.size());
+	double flMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
 
-				m_Vertices.push_back(Vertex);
-				m_Indices.push_back(static_cast<unsigned int>(m_Indices.size()));
+	LOG_INFO_CH(RENDER, "Optimized mesh %s in %.1f ms: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", m_strSourcePath.c_str(), flMilliseconds,
+		Before.flACMR, After.flACMR, Before.flATVR, After.flATVR);
+}
+
+void CMesh::BuildMeshlets(size_t nMaxVertices, size_t nMaxTriangles) {
+	PROFILE_FUNCTION();
+	auto tStart = std::chrono::steady_clock::now();
+	MakeDataOwned();
+	if (m_LODs.empty()) {
+		m_LODs.assign(1, { 0, static_cast<uint32_t>(m_Indices.size()), 0.0f });
+	}
+
+	const MeshLOD_t& FullLOD = m_LODs[0];
+	m_Meshlets = CMeshletBuilder::Build(m_Vertices, std::span<unsigned int>(m_Indices).subspan(FullLOD.nStartIndex, FullLOD.nIndexCount),
+		FullLOD.nStartIndex, nMaxVertices, nMaxTriangles);
+
+	// The builder leaves each meshlet's triangles in the order it grew them, which undoes Optimize's cache order.
+	// Redo it per meshlet, on indices local to the meshlet so each pass only sizes for its few vertices.
+	std::vector<unsigned int> MeshletIndices, LocalToMesh;
+	std::unordered_map<unsigned int, unsigned int> MeshToLocal;
+	for (const Meshlet_t& Meshlet : m_Meshlets) {
+		auto itBegin = m_Indices.begin() + Meshlet.nStartIndex;
+		auto itEnd = itBegin + Meshlet.nTriangleCount * 3;
+
+		MeshletIndices.clear();
+		LocalToMesh.clear();
+		MeshToLocal.clear();
+		for (auto it = itBegin; it != itEnd; ++it) {
+			auto [itLocal, bInserted] = MeshToLocal.try_emplace(*it, static_cast<unsigned int>(LocalToMesh.size()));
+			if (bInserted) {
+				LocalToMesh.push_back(*it);
 			}
+			MeshletIndices.push_back(itLocal->second);
 		}
+
+		CMeshOptimizer::OptimizeVertexCache(MeshletIndices, LocalToMesh.size());
+		std::transform(MeshletIndices.begin(), MeshletIndices.end(), itBegin, [&](unsigned int nLocal) { return LocalToMesh[nLocal]; });
 	}
+	UseOwnedData();
 
-	LOG_INFO("Successfully loaded mesh from %s", strFilePath.c_str());
-	return true;
+	auto Stats = CMeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int>(m_Indices).subspan(FullLOD.nStartIndex, FullLOD.nIndexCount), m_Vertices.size());
+	double flMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	LOG_INFO_CH(RENDER, "Built %zu meshlets for %s in %.1f ms (%.1f triangles each on average), ACMR %.3f, ATVR %.3f", m_Meshlets.size(),
+		m_strSourcePath.c_str(), flMilliseconds, m_Meshlets.empty() ? 0.0 : FullLOD.nIndexCount / 3.0 / m_Meshlets.size(), Stats.flACMR, Stats.flATVR);
+}
+
+void CMesh::ComputeBounds() {
+	if (m_VertexData.empty()) {
+		m_vecBoundsMin = m_vecBoundsMax = CMath::Vector3_t();
+		return;
+	}
+
+	m_vecBoundsMin = m_vecBoundsMax = m_VertexData[0].vec3Position;
+	for (const Vertex_t& Vertex : m_VertexData) {
+		const CMath::Vector3_t& p = Vertex.vec3Position;
+		m_vecBoundsMin = CMath::Vector3_t(std::min(m_vecBoundsMin.x, p.x), std::min(m_vecBoundsMin.y, p.y), std::min(m_vecBoundsMin.z, p.z));
+		m_vecBoundsMax = CMath::Vector3_t(std::max(m_vecBoundsMax.x, p.x), std::max(m_vecBoundsMax.y, p.y), std::max(m_vecBoundsMax.z, p.z));
+	}
+
+	ComputeBoundingSphere();
+}
+
+void CMesh::ComputeBoundingSphere() {
+	// Not the minimal sphere, but never bigger than the AABB's and one pass over the vertices.
+	m_vecSphereCenter = (m_vecBoundsMin + m_vecBoundsMax) * 0.5f;
+
+	float flRadiusSq = 0.0f;
+	for (const Vertex_t& Vertex : m_VertexData) {
+		CMath::Vector3_t vecOffset = Vertex.vec3Position - m_vecSphereCenter;
+		flRadiusSq = std::max(flRadiusSq, vecOffset.Dot(vecOffset));
+	}
+	m_flSphereRadius = sqrtf(flRadiusSq);
+}
+
+void CMesh::MakeDataOwned() {
+	if (!m_pMappedFile) {
+		return;
+	}
+
+	m_Vertices.assign(m_VertexData.begin(), m_VertexData.end());
+	m_Indices.assign(m_IndexData.begin(), m_IndexData.end());
+	m_pMappedFile.reset();
+	UseOwnedData();
 }
 
-bool CMesh::CreateBuffers(ID3D11Device* pDevice) {
-	D3D11_BUFFER_DESC vbd = {};
-	vbd.ByteWidth = static_cast<UINT>(sizeof(Vertex_t) * m_Vertices.size());
-	vbd.Usage = D3D11_USAGE_DEFAULT;
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = 0;
+void CMesh::UseOwnedData() {
+	m_VertexData = m_Vertices;
+	m_IndexData = m_Indices;
+}
 
-	D3D11_SUBRESOURCE_DATA vInitData = { };
-	vInitData.pSysMem = m_Vertices.data();
+bool CMesh::CreateBuffers(IRenderBackend& Backend) {
+	PROFILE_FUNCTION();
+	if (HasBuffers()) {
+		return true;
+	}
+	ReleaseBuffers();
+	m_pBackend = &Backend;
+
+	BufferDesc_t VertexBufferDesc;
+	VertexBufferDesc.eType = BUFFER_VERTEX;
+	VertexBufferDesc.nSize = m_VertexData.size_bytes();
+	VertexBufferDesc.pInitialData = m_VertexData.data();
 
-	HRESULT hResult = pDevice->CreateBuffer(&vbd, &vInitData, &m_pVertexBuffer);
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create vertex buffer.");
+	// The CPU side keeps full precision for culling, picking and re-cooking; only the GPU copy is packed.
+	std::vector<PackedVertex_t> PackedVertices;
+	VertexDecode_t VertexDecode;
+	if (m_bPackVertices) {
+		VertexDecode = CVertexPacker::Pack(m_VertexData, PackedVertices);
+		VertexBufferDesc.nSize = PackedVertices.size() * sizeof(PackedVertex_t);
+		VertexBufferDesc.pInitialData = PackedVertices.data();
+	}
+
+	m_hVertexBuffer = Backend.CreateBuffer(VertexBufferDesc);
+	if (m_hVertexBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create vertex buffer.");
 		return false;
 	}
 
-	D3D11_BUFFER_DESC ibd = { };
-	ibd.ByteWidth = static_cast<UINT>(sizeof(unsigned int) * m_Indices.size());
-	ibd.Usage = D3D11_USAGE_DEFAULT;
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.CPUAccessFlags = 0;
+	if (m_bPackVertices) {
+		BufferDesc_t ConstantBufferDesc;
+		ConstantBufferDesc.eType = BUFFER_CONSTANT;
+		ConstantBufferDesc.nSize = sizeof(VertexDecode_t);
+		ConstantBufferDesc.pInitialData = &VertexDecode;
+
+		m_hMeshConstantBuffer = Backend.CreateBuffer(ConstantBufferDesc);
+		if (m_hMeshConstantBuffer == INVALID_RENDER_HANDLE) {
+			LOG_ERROR_CH(RENDER, "Failed to create mesh constant buffer.");
+			return false;
+		}
+	}
+
+	BufferDesc_t IndexBufferDesc;
+	IndexBufferDesc.eType = BUFFER_INDEX;
+	IndexBufferDesc.nSize = m_IndexData.size_bytes();
+	IndexBufferDesc.pInitialData = m_IndexData.data();
 
-	D3D11_SUBRESOURCE_DATA iInitData = { };
-	iInitData.pSysMem = m_Indices.data();
+	// Every index fits in 16 bits below 65536 vertices.
+	std::vector<uint16_t> ShortIndices;
+	m_eIndexFormat = INDEX_UINT32;
+	if (m_VertexData.size() <= UINT16_MAX + 1) {
+		ShortIndices.assign(m_IndexData.begin(), m_IndexData.end());
+		IndexBufferDesc.nSize = ShortIndices.size() * sizeof(uint16_t);
+		IndexBufferDesc.pInitialData = ShortIndices.data();
+		m_eIndexFormat = INDEX_UINT16;
+	}
 
-	hResult = pDevice->CreateBuffer(&ibd, &iInitData, &m_pIndexBuffer);
-	if (FAILED(hResult)) {
-		LOG_ERROR("Failed to create index buffer.");
+	m_hIndexBuffer = Backend.CreateBuffer(IndexBufferDesc);
+	if (m_hIndexBuffer == INVALID_RENDER_HANDLE) {
+		LOG_ERROR_CH(RENDER, "Failed to create index buffer.");
 		return false;
 	}
 
+	m_nGPUMemoryUsage = VertexBufferDesc.nSize + IndexBufferDesc.nSize + (m_bPackVertices ? sizeof(VertexDecode_t) : 0);
+	LOG_INFO_CH(RENDER, "Created buffers for %s: %zu bytes of %s vertices, %zu bytes of %d-bit indices (%.1f%% of unpacked)", m_strSourcePath.c_str(),
+		VertexBufferDesc.nSize, m_bPackVertices ? "packed" : "float", IndexBufferDesc.nSize, m_eIndexFormat == INDEX_UINT16 ? 16 : 32,
+		100.0 * m_nGPUMemoryUsage / std::max<size_t>(m_VertexData.size_bytes() + m_IndexData.size_bytes(), 1));
 	return true;
 }
 
-void CMesh::Render(ID3D11DeviceContext* pDeviceContext) {
-	UINT stride = sizeof(Vertex_t);
-	UINT offset = 0;
+void CMesh::ReleaseBuffers() {
+	if (m_pBackend) {
+		m_pBackend->DestroyBuffer(m_hVertexBuffer);
+		m_pBackend->DestroyBuffer(m_hIndexBuffer);
+		m_pBackend->DestroyBuffer(m_hMeshConstantBuffer);
+		m_pBackend = nullptr;
+	}
+
+	m_hVertexBuffer = INVALID_RENDER_HANDLE;
+	m_hIndexBuffer = INVALID_RENDER_HANDLE;
+	m_hMeshConstantBuffer = INVALID_RENDER_HANDLE;
+	m_nGPUMemoryUsage = 0;
+}
 
-	pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
-	pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+void CMesh::ReleaseCPUData() {
+	std::vector<Vertex_t>().swap(m_Vertices);
+	std::vector<unsigned int>().swap(m_Indices);
+	m_pMappedFile.reset();
 
-	pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	pDeviceContext->DrawIndexed(static_cast<UINT>(m_Indices.size()), 0, 0);
-}
\ No newline at end of file
+	m_VertexData = {};
+	m_IndexData = {};
+}
+
+size_t CMesh::GetCPUMemoryUsage() const {
+	if (m_pMappedFile) {
+		return m_pMappedFile->GetSize();
+	}
+	return m_Vertices.capacity() * sizeof(Vertex_t) + m_Indices.capacity() * sizeof(unsigned int);
+}
+
+bool CMesh::FillDrawPacket(DrawPacket_t& Packet, uint32_t nLOD) const {
+	if (!HasBuffers() || nLOD >= m_LODs.size()) {
+		return false;
+	}
+
+	Packet.hVertexBuffer = m_hVertexBuffer;
+	Packet.hIndexBuffer = m_hIndexBuffer;
+	Packet.hMeshConstants = m_hMeshConstantBuffer;
+	Packet.nVertexStride = HasPackedVertices() ? sizeof(PackedVertex_t) : sizeof(Vertex_t);
+	Packet.eIndexFormat = m_eIndexFormat;
+	Packet.nIndexCount = m_LODs[nLOD].nIndexCount;
+	Packet.nStartIndex = m_LODs[nLOD].nStartIndex;
+	Packet.nBaseVertex = 0;
+	return true;
+}
@@ -1,9 +1,18 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <d3d11.h>
-
+#include <span>
+#include <memory>
+#include <atomic>
+#include <cstdint>
 #include "../vertex/Vertex_t.hpp"
+#include "../backend/IRenderBackend.hpp"
+#include "CMeshFile.hpp"
+#include "CMeshletBuilder.hpp"
+#include "../queue/CRenderQueue.hpp"
+
+class COBJParser;
+class CMappedFile;
 
 class CMesh {
 public:
@@ -11,16 +20,110 @@ public:
 	~CMesh();
 
 	bool LoadFromOBJ(const std::string& szFilename);
-	bool CreateBuffers(ID3D11Device* pDevice);
-	void Render(ID3D11DeviceContext* pDeviceContext);
+	// Copies the CPU side of another mesh (vertices, indices, LODs, meshlets, bounds) into owned storage.
+	// No GPU buffers; Source has to have its CPU data.
+	void CopyCPUData(const CMesh& Source);
+
+	// Maps a cooked .fmesh file, vertex and index data are used straight from the mapping.
+	bool LoadFromCooked(const std::string& strFilePath);
+	bool SaveCooked(const std::string& strFilePath) const;
+
+	// Appends up to nLODCount - 1 simplified copies of the full index set, each with flReduction times the
+	// triangles of the previous one, to the index buffer. Stops early once simplification stalls (seams, borders).
+	// Has to run before Optimize and CreateBuffers.
+	void GenerateLODs(uint32_t nLODCount = 4, float flReduction = 0.5f);
+
+	// Reorders indices and vertices for the post-transform cache, overdraw and vertex fetch, every LOD on its own.
+	// Has to run before CreateBuffers. Drops the meshlets, build them afterwards.
+	void Optimize();
+
+	// Splits LOD 0 into meshlets for per-cluster culling, reordering its triangles so each is an index range
+	// in vertex cache order of its own.
+	// Has to run before CreateBuffers.
+	void BuildMeshlets(size_t nMaxVertices = CMeshletBuilder::DEFAULT_MAX_VERTICES, size_t nMaxTriangles = CMeshletBuilder::DEFAULT_MAX_TRIANGLES);
+	// Ranges in the index buffer, like the LODs they survive ReleaseCPUData.
+	std::span<const Meshlet_t> GetMeshlets() const { return m_Meshlets; }
+
+	// Does nothing if the buffers already exist. The backend has to outlive them.
+	// Meshes below 65536 vertices get 16-bit indices.
+	bool CreateBuffers(IRenderBackend& Backend);
+	void ReleaseBuffers();
+	bool HasBuffers() const { return m_hVertexBuffer != INVALID_RENDER_HANDLE && m_hIndexBuffer != INVALID_RENDER_HANDLE; }
+	// Fills in the buffers and the index range of the LOD; pipeline, material and sort key are up to the caller.
+	// Packed vertices need a pipeline that decodes them (VSPacked).
+	bool FillDrawPacket(DrawPacket_t& Packet, uint32_t nLOD = 0) const;
+	RenderHandle_t GetVertexBuffer() const { return m_hVertexBuffer; }
+
+	// Upload PackedVertex_t instead of Vertex_t; takes effect with the next CreateBuffers.
+	void SetVertexPacking(bool bEnabled) { m_bPackVertices = bEnabled; }
+	bool HasPackedVertices() const { return m_hMeshConstantBuffer != INVALID_RENDER_HANDLE; }
+
+	// Drops the system memory copy of the vertex/index data (GPU buffers and bounds stay).
+	// Pinned meshes, e.g. ones needed for collision, keep it.
+	void ReleaseCPUData();
+	bool HasCPUData() const { return !m_IndexData.empty(); }
+	void SetCPUDataPinned(bool bPinned) { m_bCPUDataPinned = bPinned; }
+	bool IsCPUDataPinned() const { return m_bCPUDataPinned; }
+
+	size_t GetCPUMemoryUsage() const;
+	size_t GetGPUMemoryUsage() const { return m_nGPUMemoryUsage; }
 
-	const std::vector<Vertex_t>& GetVertices() const { return m_Vertices; }
-	const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+	void Touch(uint64_t nFrame) { m_nLastUsedFrame.store(nFrame, std::memory_order_relaxed); }
+	uint64_t GetLastUsedFrame() const { return m_nLastUsedFrame.load(std::memory_order_relaxed); }
+
+	// LOD 0 is the full mesh; the rest are ever coarser, with growing error.
+	std::span<const MeshLOD_t> GetLODs() const { return m_LODs; }
+	uint32_t GetLODCount() const { return static_cast<uint32_t>(m_LODs.size()); }
+	// The coarsest LOD whose error, projected from flDistance, stays within flMaxPixelError pixels.
+	// flPixelsPerUnit is the size in pixels of one unit at distance 1: viewport height / (2 tan(fov / 2)).
+	uint32_t SelectLOD(float flDistance, float flPixelsPerUnit, float flMaxPixelError) const;
+
+	std::span<const Vertex_t> GetVertices() const { return m_VertexData; }
+	std::span<const unsigned int> GetIndices() const { return m_IndexData; }
+	const std::string& GetSourcePath() const { return m_strSourcePath; }
+
+	const CMath::Vector3_t& GetBoundsMin() const { return m_vecBoundsMin; }
+	const CMath::Vector3_t& GetBoundsMax() const { return m_vecBoundsMax; }
+	// Centered on the AABB, radius to the farthest vertex.
+	const CMath::Vector3_t& GetBoundingSphereCenter() const { return m_vecSphereCenter; }
+	float GetBoundingSphereRadius() const { return m_flSphereRadius; }
 
 private:
+	// Deduplicates face corners by their (position, texcoord, normal) indices.
+	void BuildIndexedVertices(const COBJParser& Parser);
+	void ComputeBounds();
+	void ComputeBoundingSphere();
+
+	// Mapped (cooked) data is read-only; copy it into the vectors before modifying it.
+	void MakeDataOwned();
+	void UseOwnedData();
+
+	std::string m_strSourcePath;
+
 	std::vector<Vertex_t> m_Vertices;
 	std::vector<unsigned int> m_Indices;
+	std::unique_ptr<CMappedFile> m_pMappedFile;
+
+	// Whatever currently holds the data: the vectors above or the mapped file.
+	std::span<const Vertex_t> m_VertexData;
+	std::span<const unsigned int> m_IndexData;
+	// Survives ReleaseCPUData, drawing needs it.
+	std::vector<MeshLOD_t> m_LODs;
+	std::vector<Meshlet_t> m_Meshlets;
+
+	CMath::Vector3_t m_vecBoundsMin;
+	CMath::Vector3_t m_vecBoundsMax;
+	CMath::Vector3_t m_vecSphereCenter;
+	float m_flSphereRadius = 0.0f;
+
+	IRenderBackend* m_pBackend = nullptr;
+	RenderHandle_t m_hVertexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hIndexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t m_hMeshConstantBuffer = INVALID_RENDER_HANDLE; // VertexDecode_t, with packed vertices
+	EIndexFormat m_eIndexFormat = INDEX_UINT32;
+	size_t m_nGPUMemoryUsage = 0;
+	bool m_bPackVertices = false;
 
-	ID3D11Buffer* m_pVertexBuffer = nullptr;
-	ID3D11Buffer* m_pIndexBuffer = nullptr;
+	bool m_bCPUDataPinned = false;
+	std::atomic<uint64_t> m_nLastUsedFrame = 0;
 };
\ No newline at end of file
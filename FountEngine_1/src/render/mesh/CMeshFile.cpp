@@ -0,0 +1,183 @@
+#include "CMeshFile.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "../../system/logging/CLogSystem.hpp"
+
+namespace {
+	constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+	uint64_t AlignUp(uint64_t nValue) {
+		return (nValue + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+	}
+
+	bool GetSourceState(const std::string& strSourcePath, uint64_t& nSize, int64_t& nWriteTime) {
+		std::error_code ErrorCode;
+		nSize = std::filesystem::file_size(strSourcePath, ErrorCode);
+		if (ErrorCode) {
+			return false;
+		}
+
+		auto WriteTime = std::filesystem::last_write_time(strSourcePath, ErrorCode);
+		if (ErrorCode) {
+			return false;
+		}
+
+		nWriteTime = static_cast<int64_t>(WriteTime.time_since_epoch().count());
+		return true;
+	}
+}
+
+std::string CMeshFile::GetCookedPath(const std::string& strSourcePath) {
+	return std::filesystem::path(strSourcePath).replace_extension(EXTENSION).string();
+}
+
+bool CMeshFile::IsUpToDate(const std::string& strCookedPath, const std::string& strSourcePath) {
+	std::ifstream sFile(strCookedPath, std::ios::binary);
+	if (!sFile.is_open()) {
+		return false;
+	}
+
+	MeshFileHeader_t Header;
+	if (!sFile.read(reinterpret_cast<char*>(&Header), sizeof(Header))) {
+		return false;
+	}
+
+	if (Header.nMagic != MAGIC || Header.nVersion != VERSION || Header.nVertexStride != sizeof(Vertex_t)) {
+		return false;
+	}
+
+	uint64_t nSourceSize;
+	int64_t nSourceWriteTime;
+	if (!GetSourceState(strSourcePath, nSourceSize, nSourceWriteTime)) {
+		return true;
+	}
+
+	return Header.nSourceSize == nSourceSize && Header.nSourceWriteTime == nSourceWriteTime;
+}
+
+const MeshFileHeader_t* CMeshFile::Validate(const char* pData, size_t nSize) {
+	if (!pData || nSize < sizeof(MeshFileHeader_t)) {
+		return nullptr;
+	}
+
+	const MeshFileHeader_t* pHeader = reinterpret_cast<const MeshFileHeader_t*>(pData);
+	if (pHeader->nMagic != MAGIC || pHeader->nVersion != VERSION ||
+		pHeader->nVertexStride != sizeof(Vertex_t) || pHeader->nIndexSize != sizeof(unsigned int)) {
+		return nullptr;
+	}
+
+	if (pHeader->nVertexOffset % BLOB_ALIGNMENT != 0 || pHeader->nIndexOffset % BLOB_ALIGNMENT != 0) {
+		return nullptr;
+	}
+
+	// Counts are bounded first so the size products below can't overflow.
+	if (pHeader->nVertexCount > nSize || pHeader->nIndexCount > nSize ||
+		pHeader->nVertexOffset > nSize || pHeader->nIndexOffset > nSize) {
+		return nullptr;
+	}
+
+	if (pHeader->nVertexOffset + pHeader->nVertexCount * sizeof(Vertex_t) > nSize ||
+		pHeader->nIndexOffset + pHeader->nIndexCount * sizeof(unsigned int) > nSize) {
+		return nullptr;
+	}
+
+	if (pHeader->nMeshletOffset % BLOB_ALIGNMENT != 0 || pHeader->nMeshletCount > nSize || pHeader->nMeshletOffset > nSize ||
+		pHeader->nMeshletOffset + pHeader->nMeshletCount * sizeof(Meshlet_t) > nSize) {
+		return nullptr;
+	}
+
+	const Meshlet_t* pMeshlets = reinterpret_cast<const Meshlet_t*>(pData + pHeader->nMeshletOffset);
+	for (uint64_t i = 0; i < pHeader->nMeshletCount; ++i) {
+		if (static_cast<uint64_t>(pMeshlets[i].nStartIndex) + pMeshlets[i].nTriangleCount * 3ull > pHeader->nIndexCount) {
+			return nullptr;
+		}
+	}
+
+	if (pHeader->nLODCount == 0 || pHeader->nLODCount > MAX_MESH_LODS) {
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < pHeader->nLODCount; ++i) {
+		const MeshLOD_t& LOD = pHeader->aLODs[i];
+		if (static_cast<uint64_t>(LOD.nStartIndex) + LOD.nIndexCount > pHeader->nIndexCount) {
+			return nullptr;
+		}
+	}
+
+	return pHeader;
+}
+
+bool CMeshFile::Write(const std::string& strCookedPath, const std::string& strSourcePath,
+	std::span<const Vertex_t> Vertices, std::span<const unsigned int> Indices, std::span<const MeshLOD_t> LODs,
+	std::span<const Meshlet_t> Meshlets, const CMath::Vector3_t& vecBoundsMin, const CMath::Vector3_t& vecBoundsMax) {
+	MeshFileHeader_t Header = {};
+	Header.nMagic = MAGIC;
+	Header.nVersion = VERSION;
+	Header.nVertexStride = sizeof(Vertex_t);
+	Header.nIndexSize = sizeof(unsigned int);
+	Header.nVertexCount = Vertices.size();
+	Header.nIndexCount = Indices.size();
+	Header.nVertexOffset = AlignUp(sizeof(MeshFileHeader_t));
+	Header.nIndexOffset = AlignUp(Header.nVertexOffset + Vertices.size_bytes());
+	Header.nMeshletCount = Meshlets.size();
+	Header.nMeshletOffset = AlignUp(Header.nIndexOffset + Indices.size_bytes());
+
+	Header.aBoundsMin[0] = vecBoundsMin.x;
+	Header.aBoundsMin[1] = vecBoundsMin.y;
+	Header.aBoundsMin[2] = vecBoundsMin.z;
+	Header.aBoundsMax[0] = vecBoundsMax.x;
+	Header.aBoundsMax[1] = vecBoundsMax.y;
+	Header.aBoundsMax[2] = vecBoundsMax.z;
+
+	// A mesh without LODs is its own only level.
+	if (LODs.empty()) {
+		Header.nLODCount = 1;
+		Header.aLODs[0] = { 0, static_cast<uint32_t>(Indices.size()), 0.0f };
+	}
+	else {
+		Header.nLODCount = static_cast<uint32_t>(std::min<size_t>(LODs.size(), MAX_MESH_LODS));
+		std::copy_n(LODs.begin(), Header.nLODCount, Header.aLODs);
+	}
+
+	if (!GetSourceState(strSourcePath, Header.nSourceSize, Header.nSourceWriteTime)) {
+		Header.nSourceSize = 0;
+		Header.nSourceWriteTime = 0;
+	}
+
+	// Written under a temporary name so a crashed cook never leaves a truncated file that looks valid.
+	std::string strTempPath = strCookedPath + ".tmp";
+	{
+		std::ofstream sFile(strTempPath, std::ios::binary | std::ios::trunc);
+		if (!sFile.is_open()) {
+			LOG_ERROR_CH(RENDER, "Failed to create cooked mesh file: %s", strTempPath.c_str());
+			return false;
+		}
+
+		static const char aPadding[BLOB_ALIGNMENT] = {};
+		sFile.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		sFile.write(aPadding, Header.nVertexOffset - sizeof(Header));
+		sFile.write(reinterpret_cast<const char*>(Vertices.data()), Vertices.size_bytes());
+		sFile.write(aPadding, Header.nIndexOffset - (Header.nVertexOffset + Vertices.size_bytes()));
+		sFile.write(reinterpret_cast<const char*>(Indices.data()), Indices.size_bytes());
+		sFile.write(aPadding, Header.nMeshletOffset - (Header.nIndexOffset + Indices.size_bytes()));
+		sFile.write(reinterpret_cast<const char*>(Meshlets.data()), Meshlets.size_bytes());
+
+		if (!sFile.good()) {
+			LOG_ERROR_CH(RENDER, "Failed to write cooked mesh file: %s", strTempPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code ErrorCode;
+	std::filesystem::rename(strTempPath, strCookedPath, ErrorCode);
+	if (ErrorCode) {
+		LOG_ERROR_CH(RENDER, "Failed to replace cooked mesh file %s: %s", strCookedPath.c_str(), ErrorCode.message().c_str());
+		std::filesystem::remove(strTempPath, ErrorCode);
+		return false;
+	}
+
+	return true;
+}
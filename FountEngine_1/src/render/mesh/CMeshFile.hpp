@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <span>
+#include <cstdint>
+
+#include "../vertex/Vertex_t.hpp"
+#include "CMeshletBuilder.hpp"
+
+// One level of detail: a range of the mesh's index buffer, all levels index the same vertices.
+// flError is how far the simplified surface may be from the full one, in mesh units.
+struct MeshLOD_t {
+	uint32_t nStartIndex;
+	uint32_t nIndexCount;
+	float flError;
+};
+
+constexpr uint32_t MAX_MESH_LODS = 8;
+
+// Cooked mesh format (.fmesh): header, vertex blob, index blob, meshlet blob. All blobs start on a 16 byte boundary;
+// vertices and indices are stored exactly as the GPU buffers expect them, so a mapped file can be handed to CreateBuffers as is.
+struct MeshFileHeader_t {
+	uint32_t nMagic;
+	uint32_t nVersion;
+	uint32_t nVertexStride;
+	uint32_t nIndexSize;
+
+	uint64_t nVertexCount;
+	uint64_t nIndexCount;
+	uint64_t nVertexOffset;
+	uint64_t nIndexOffset;
+
+	float aBoundsMin[3];
+	float aBoundsMax[3];
+
+	uint32_t nLODCount;
+	MeshLOD_t aLODs[MAX_MESH_LODS];
+
+	// Meshlets of LOD 0, none if they weren't built.
+	uint64_t nMeshletCount;
+	uint64_t nMeshletOffset;
+
+	// Source file state at cook time, used to detect stale cooked files.
+	uint64_t nSourceSize;
+	int64_t nSourceWriteTime;
+};
+
+class CMeshFile {
+public:
+	static constexpr uint32_t MAGIC = 0x48534D46; // "FMSH"
+	static constexpr uint32_t VERSION = 3;
+	static constexpr const char* EXTENSION = ".fmesh";
+
+	static std::string GetCookedPath(const std::string& strSourcePath);
+
+	// True if the cooked file exists, has the current version/layout and was cooked from the current source.
+	// A missing source counts as up to date, shipping builds only carry cooked files.
+	static bool IsUpToDate(const std::string& strCookedPath, const std::string& strSourcePath);
+
+	// Checks magic, version, layout and that all blobs and index ranges lie inside the file.
+	static const MeshFileHeader_t* Validate(const char* pData, size_t nSize);
+
+	static bool Write(const std::string& strCookedPath, const std::string& strSourcePath,
+		std::span<const Vertex_t> Vertices, std::span<const unsigned int> Indices, std::span<const MeshLOD_t> LODs,
+		std::span<const Meshlet_t> Meshlets, const CMath::Vector3_t& vecBoundsMin, const CMath::Vector3_t& vecBoundsMax);
+};
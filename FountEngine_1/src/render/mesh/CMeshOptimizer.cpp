@@ -0,0 +1,299 @@
+#include "CMeshOptimizer.hpp"
+
+#include <algorithm>
+
+namespace {
+	// Timestamp-based FIFO: a vertex is still cached if fewer than nCacheSize misses happened since it was loaded.
+	class CCacheSimulator {
+	public:
+		CCacheSimulator(size_t nVertexCount, unsigned int nCacheSize)
+			: m_CacheTime(nVertexCount, 0), m_nCacheSize(nCacheSize), m_nTimestamp(nCacheSize + 1) {}
+
+		unsigned int Access(unsigned int nVertex) {
+			if (m_nTimestamp - m_CacheTime[nVertex] > m_nCacheSize) {
+				m_CacheTime[nVertex] = m_nTimestamp++;
+				return 1;
+			}
+			return 0;
+		}
+
+		unsigned int AccessTriangle(const unsigned int* pTriangle) {
+			return Access(pTriangle[0]) + Access(pTriangle[1]) + Access(pTriangle[2]);
+		}
+
+		unsigned int GetAge(unsigned int nVertex) const {
+			return m_nTimestamp - m_CacheTime[nVertex];
+		}
+
+		void Flush() {
+			m_nTimestamp += m_nCacheSize + 1;
+		}
+
+	private:
+		std::vector<unsigned int> m_CacheTime;
+		unsigned int m_nCacheSize;
+		unsigned int m_nTimestamp;
+	};
+}
+
+CMeshOptimizer::VertexCacheStats_t CMeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int> Indices, size_t nVertexCount, unsigned int nCacheSize) {
+	VertexCacheStats_t Stats;
+	if (Indices.size() < 3 || nVertexCount == 0) {
+		return Stats;
+	}
+
+	CCacheSimulator Cache(nVertexCount, nCacheSize);
+	std::vector<bool> Referenced(nVertexCount, false);
+	size_t nMisses = 0;
+	size_t nReferenced = 0;
+
+	for (unsigned int nIndex : Indices) {
+		nMisses += Cache.Access(nIndex);
+		if (!Referenced[nIndex]) {
+			Referenced[nIndex] = true;
+			++nReferenced;
+		}
+	}
+
+	Stats.flACMR = static_cast<float>(nMisses) / static_cast<float>(Indices.size() / 3);
+	Stats.flATVR = static_cast<float>(nMisses) / static_cast<float>(nReferenced);
+	return Stats;
+}
+
+void CMeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& Indices, size_t nVertexCount,
+	std::vector<unsigned int>* pClusterStarts, unsigned int nCacheSize) {
+	const size_t nTriangleCount = Indices.size() / 3;
+	if (pClusterStarts) {
+		pClusterStarts->clear();
+	}
+	if (nTriangleCount == 0 || nVertexCount == 0) {
+		return;
+	}
+
+	// Vertex -> triangle adjacency in compressed rows.
+	std::vector<unsigned int> LiveTriangles(nVertexCount, 0);
+	for (unsigned int nIndex : Indices) {
+		++LiveTriangles[nIndex];
+	}
+
+	std::vector<unsigned int> AdjacencyOffsets(nVertexCount + 1, 0);
+	for (size_t i = 0; i < nVertexCount; ++i) {
+		AdjacencyOffsets[i + 1] = AdjacencyOffsets[i] + LiveTriangles[i];
+	}
+
+	std::vector<unsigned int> AdjacentTriangles(Indices.size());
+	{
+		std::vector<unsigned int> FillCursor(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < Indices.size(); ++i) {
+			AdjacentTriangles[FillCursor[Indices[i]]++] = static_cast<unsigned int>(i / 3);
+		}
+	}
+
+	CCacheSimulator Cache(nVertexCount, nCacheSize);
+	std::vector<bool> Emitted(nTriangleCount, false);
+	std::vector<unsigned int> DeadEnds;
+	std::vector<unsigned int> Candidates;
+	std::vector<unsigned int> Output;
+	DeadEnds.reserve(Indices.size());
+	Output.reserve(Indices.size());
+
+	size_t nCursor = 0;
+	auto NextFromCursor = [&]() -> long long {
+		while (nCursor < nVertexCount && LiveTriangles[nCursor] == 0) {
+			++nCursor;
+		}
+		return nCursor < nVertexCount ? static_cast<long long>(nCursor) : -1;
+	};
+
+	long long nFanning = NextFromCursor();
+	if (pClusterStarts && nFanning >= 0) {
+		pClusterStarts->push_back(0);
+	}
+
+	while (nFanning >= 0) {
+		Candidates.clear();
+
+		for (unsigned int a = AdjacencyOffsets[nFanning]; a < AdjacencyOffsets[nFanning + 1]; ++a) {
+			unsigned int nTriangle = AdjacentTriangles[a];
+			if (Emitted[nTriangle]) {
+				continue;
+			}
+
+			for (int k = 0; k < 3; ++k) {
+				unsigned int nVertex = Indices[nTriangle * 3 + k];
+				Output.push_back(nVertex);
+				DeadEnds.push_back(nVertex);
+				Candidates.push_back(nVertex);
+				--LiveTriangles[nVertex];
+				Cache.Access(nVertex);
+			}
+
+			Emitted[nTriangle] = true;
+		}
+
+		// Prefer the oldest candidate that will still be in the cache after its remaining triangles are emitted.
+		long long nNext = -1;
+		long long nBestPriority = -1;
+		for (unsigned int nVertex : Candidates) {
+			if (LiveTriangles[nVertex] == 0) {
+				continue;
+			}
+
+			long long nPriority = 0;
+			if (Cache.GetAge(nVertex) + 2 * LiveTriangles[nVertex] <= nCacheSize) {
+				nPriority = Cache.GetAge(nVertex);
+			}
+
+			if (nPriority > nBestPriority) {
+				nBestPriority = nPriority;
+				nNext = nVertex;
+			}
+		}
+
+		if (nNext < 0) {
+			while (!DeadEnds.empty()) {
+				unsigned int nVertex = DeadEnds.back();
+				DeadEnds.pop_back();
+				if (LiveTriangles[nVertex] > 0) {
+					nNext = nVertex;
+					break;
+				}
+			}
+
+			if (nNext < 0) {
+				nNext = NextFromCursor();
+			}
+
+			if (pClusterStarts && nNext >= 0) {
+				pClusterStarts->push_back(static_cast<unsigned int>(Output.size() / 3));
+			}
+		}
+
+		nFanning = nNext;
+	}
+
+	Indices.swap(Output);
+}
+
+void CMeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& Indices, std::span<const Vertex_t> Vertices,
+	const std::vector<unsigned int>& ClusterStarts, float flThreshold, unsigned int nCacheSize) {
+	const size_t nTriangleCount = Indices.size() / 3;
+	if (nTriangleCount == 0 || ClusterStarts.empty()) {
+		return;
+	}
+
+	// Split the hard clusters wherever the running ACMR already reaches the cluster's (scaled) ACMR,
+	// so reordering the pieces costs little cache efficiency.
+	CCacheSimulator Cache(Vertices.size(), nCacheSize);
+	std::vector<unsigned int> SoftStarts;
+
+	for (size_t c = 0; c < ClusterStarts.size(); ++c) {
+		const size_t nStart = ClusterStarts[c];
+		const size_t nEnd = c + 1 < ClusterStarts.size() ? ClusterStarts[c + 1] : nTriangleCount;
+
+		Cache.Flush();
+		unsigned int nClusterMisses = 0;
+		for (size_t t = nStart; t < nEnd; ++t) {
+			nClusterMisses += Cache.AccessTriangle(&Indices[t * 3]);
+		}
+		const float flClusterThreshold = flThreshold * static_cast<float>(nClusterMisses) / static_cast<float>(nEnd - nStart);
+
+		Cache.Flush();
+		SoftStarts.push_back(static_cast<unsigned int>(nStart));
+
+		unsigned int nRunningMisses = 0;
+		unsigned int nRunningTriangles = 0;
+		for (size_t t = nStart; t < nEnd; ++t) {
+			nRunningMisses += Cache.AccessTriangle(&Indices[t * 3]);
+			++nRunningTriangles;
+
+			if (t + 1 < nEnd && static_cast<float>(nRunningMisses) / static_cast<float>(nRunningTriangles) <= flClusterThreshold) {
+				SoftStarts.push_back(static_cast<unsigned int>(t + 1));
+				Cache.Flush();
+				nRunningMisses = 0;
+				nRunningTriangles = 0;
+			}
+		}
+	}
+
+	struct Cluster_t {
+		unsigned int nStart;
+		unsigned int nEnd;
+		float flSortKey;
+	};
+
+	std::vector<Cluster_t> Clusters(SoftStarts.size());
+	std::vector<CMath::Vector3_t> Centroids(SoftStarts.size());
+	std::vector<CMath::Vector3_t> ClusterNormals(SoftStarts.size());
+
+	CMath::Vector3_t vecMeshCentroid;
+	float flMeshArea = 0.0f;
+
+	for (size_t c = 0; c < SoftStarts.size(); ++c) {
+		Cluster_t& Cluster = Clusters[c];
+		Cluster.nStart = SoftStarts[c];
+		Cluster.nEnd = c + 1 < SoftStarts.size() ? SoftStarts[c + 1] : static_cast<unsigned int>(nTriangleCount);
+
+		CMath::Vector3_t vecCentroid;
+		CMath::Vector3_t vecNormal;
+		float flArea = 0.0f;
+
+		for (unsigned int t = Cluster.nStart; t < Cluster.nEnd; ++t) {
+			const CMath::Vector3_t& p0 = Vertices[Indices[t * 3 + 0]].vec3Position;
+			const CMath::Vector3_t& p1 = Vertices[Indices[t * 3 + 1]].vec3Position;
+			const CMath::Vector3_t& p2 = Vertices[Indices[t * 3 + 2]].vec3Position;
+
+			CMath::Vector3_t vecAreaNormal = (p1 - p0).Cross(p2 - p0);
+			float flTriangleArea = vecAreaNormal.Length();
+
+			vecCentroid += (p0 + p1 + p2) * (flTriangleArea / 3.0f);
+			vecNormal += vecAreaNormal;
+			flArea += flTriangleArea;
+		}
+
+		vecMeshCentroid += vecCentroid;
+		flMeshArea += flArea;
+
+		Centroids[c] = flArea > 0.0f ? vecCentroid / flArea : vecCentroid;
+		ClusterNormals[c] = vecNormal.Normalize();
+	}
+
+	if (flMeshArea > 0.0f) {
+		vecMeshCentroid = vecMeshCentroid / flMeshArea;
+	}
+
+	// Clusters facing away from the mesh center are the likely occluders, draw them first.
+	for (size_t c = 0; c < Clusters.size(); ++c) {
+		Clusters[c].flSortKey = (Centroids[c] - vecMeshCentroid).Dot(ClusterNormals[c]);
+	}
+
+	std::stable_sort(Clusters.begin(), Clusters.end(), [](const Cluster_t& a, const Cluster_t& b) {
+		return a.flSortKey > b.flSortKey;
+	});
+
+	std::vector<unsigned int> Output;
+	Output.reserve(Indices.size());
+	for (const Cluster_t& Cluster : Clusters) {
+		Output.insert(Output.end(), Indices.begin() + Cluster.nStart * 3, Indices.begin() + Cluster.nEnd * 3);
+	}
+
+	Indices.swap(Output);
+}
+
+void CMeshOptimizer::OptimizeVertexFetch(std::vector<Vertex_t>& Vertices, std::vector<unsigned int>& Indices) {
+	constexpr unsigned int UNUSED_VERTEX = ~0u;
+
+	std::vector<unsigned int> Remap(Vertices.size(), UNUSED_VERTEX);
+	std::vector<Vertex_t> Output;
+	Output.reserve(Vertices.size());
+
+	for (unsigned int& nIndex : Indices) {
+		if (Remap[nIndex] == UNUSED_VERTEX) {
+			Remap[nIndex] = static_cast<unsigned int>(Output.size());
+			Output.push_back(Vertices[nIndex]);
+		}
+		nIndex = Remap[nIndex];
+	}
+
+	Vertices.swap(Output);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cstddef>
+
+#include "../vertex/Vertex_t.hpp"
+
+// Index/vertex reordering passes for indexed triangle lists:
+// Tipsify for post-transform cache locality, cluster sorting for overdraw and first-use order for vertex fetch.
+class CMeshOptimizer {
+public:
+	struct VertexCacheStats_t {
+		float flACMR = 0.0f; // Transformed vertices per triangle
+		float flATVR = 0.0f; // Transformed vertices per referenced vertex (1.0 is ideal)
+	};
+
+	static constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+
+	// FIFO cache simulation.
+	static VertexCacheStats_t AnalyzeVertexCache(std::span<const unsigned int> Indices, size_t nVertexCount, unsigned int nCacheSize = DEFAULT_CACHE_SIZE);
+
+	// Reorders triangles for vertex reuse. ClusterStarts (optional) receives the first triangle of every
+	// cluster the pass had to restart from a dead end; OptimizeOverdraw works on those clusters.
+	static void OptimizeVertexCache(std::vector<unsigned int>& Indices, size_t nVertexCount,
+		std::vector<unsigned int>* pClusterStarts = nullptr, unsigned int nCacheSize = DEFAULT_CACHE_SIZE);
+
+	// Splits the clusters further while ACMR stays within flThreshold of the cluster's, then sorts them
+	// so outward-facing clusters come first. Expects the output of OptimizeVertexCache.
+	static void OptimizeOverdraw(std::vector<unsigned int>& Indices, std::span<const Vertex_t> Vertices,
+		const std::vector<unsigned int>& ClusterStarts, float flThreshold = 1.05f, unsigned int nCacheSize = DEFAULT_CACHE_SIZE);
+
+	// Renumbers vertices in order of first use and drops unreferenced ones.
+	static void OptimizeVertexFetch(std::vector<Vertex_t>& Vertices, std::vector<unsigned int>& Indices);
+};
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "CMeshSimplifier.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+	// Sum of squared distances to a set of planes, as the upper triangle of a symmetric 4x4 matrix. Planes
+	// are weighted by their triangle's area; divided by the total weight, Evaluate() is the mean squared distance.
+	struct Quadric_t {
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+		double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+		double a22 = 0.0, a23 = 0.0;
+		double a33 = 0.0;
+		double flWeight = 0.0;
+
+		void AddPlane(const CMath::Vector3_t& vecNormal, float flDistance, float flArea) {
+			const double a = vecNormal.x, b = vecNormal.y, c = vecNormal.z, d = flDistance, w = flArea;
+			a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+			a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+			a22 += w * c * c; a23 += w * c * d;
+			a33 += w * d * d;
+			flWeight += w;
+		}
+
+		void Add(const Quadric_t& other) {
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+			a11 += other.a11; a12 += other.a12; a13 += other.a13;
+			a22 += other.a22; a23 += other.a23;
+			a33 += other.a33;
+			flWeight += other.flWeight;
+		}
+
+		double Evaluate(const CMath::Vector3_t& vecPoint) const {
+			const double x = vecPoint.x, y = vecPoint.y, z = vecPoint.z;
+			return a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2.0 * (a03 * x + a13 * y + a23 * z) + a33;
+		}
+	};
+
+	struct Collapse_t {
+		unsigned int nFrom;
+		unsigned int nTo;
+		float flErrorSq;
+	};
+
+	uint64_t MakeEdgeKey(unsigned int a, unsigned int b) {
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+}
+
+float CMeshSimplifier::Simplify(std::span<const Vertex_t> Vertices, std::vector<unsigned int>& Indices,
+	size_t nTargetIndexCount, float flMaxError) {
+	const size_t nVertexCount = Vertices.size();
+	nTargetIndexCount -= nTargetIndexCount % 3;
+	if (Indices.size() <= nTargetIndexCount || nVertexCount == 0) {
+		return 0.0f;
+	}
+
+	// Vertices that share a position are one vertex as far as the topology goes, represented by the first of
+	// them. Anything with more than one (a seam) is locked, as are the ends of edges without exactly two triangles.
+	std::vector<unsigned int> Position(nVertexCount);
+	std::vector<uint8_t> Locked(nVertexCount, 0);
+	{
+		std::vector<unsigned int> Sorted(nVertexCount);
+		std::iota(Sorted.begin(), Sorted.end(), 0u);
+		std::sort(Sorted.begin(), Sorted.end(), [&](unsigned int a, unsigned int b) {
+			const CMath::Vector3_t& pa = Vertices[a].vec3Position;
+			const CMath::Vector3_t& pb = Vertices[b].vec3Position;
+			return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+		});
+
+		for (size_t i = 0; i < nVertexCount;) {
+			const CMath::Vector3_t& p = Vertices[Sorted[i]].vec3Position;
+			size_t j = i + 1;
+			while (j < nVertexCount && Vertices[Sorted[j]].vec3Position.x == p.x &&
+				Vertices[Sorted[j]].vec3Position.y == p.y && Vertices[Sorted[j]].vec3Position.z == p.z) {
+				++j;
+			}
+			for (size_t k = i; k < j; ++k) {
+				Position[Sorted[k]] = Sorted[i];
+			}
+			Locked[Sorted[i]] = j - i > 1;
+			i = j;
+		}
+	}
+
+	{
+		std::vector<uint64_t> Edges;
+		Edges.reserve(Indices.size());
+		for (size_t i = 0; i < Indices.size(); i += 3) {
+			const unsigned int a = Position[Indices[i]], b = Position[Indices[i + 1]], c = Position[Indices[i + 2]];
+			if (a != b && b != c && c != a) {
+				Edges.push_back(MakeEdgeKey(a, b));
+				Edges.push_back(MakeEdgeKey(b, c));
+				Edges.push_back(MakeEdgeKey(c, a));
+			}
+		}
+		std::sort(Edges.begin(), Edges.end());
+
+		for (size_t i = 0; i < Edges.size();) {
+			size_t j = i + 1;
+			while (j < Edges.size() && Edges[j] == Edges[i]) {
+				++j;
+			}
+			if (j - i != 2) {
+				Locked[static_cast<unsigned int>(Edges[i] >> 32)] = 1;
+				Locked[static_cast<unsigned int>(Edges[i])] = 1;
+			}
+			i = j;
+		}
+	}
+
+	std::vector<Quadric_t> Quadrics(nVertexCount);
+	for (size_t i = 0; i < Indices.size(); i += 3) {
+		const unsigned int a = Position[Indices[i]], b = Position[Indices[i + 1]], c = Position[Indices[i + 2]];
+		const CMath::Vector3_t& p0 = Vertices[a].vec3Position;
+		CMath::Vector3_t vecNormal = (Vertices[b].vec3Position - p0).Cross(Vertices[c].vec3Position - p0);
+		const float flLength = vecNormal.Length();
+		if (flLength == 0.0f) {
+			continue;
+		}
+
+		vecNormal = vecNormal / flLength;
+		const float flDistance = -vecNormal.Dot(p0);
+		Quadrics[a].AddPlane(vecNormal, flDistance, flLength * 0.5f);
+		Quadrics[b].AddPlane(vecNormal, flDistance, flLength * 0.5f);
+		Quadrics[c].AddPlane(vecNormal, flDistance, flLength * 0.5f);
+	}
+
+	auto GetCollapseError = [&](unsigned int nFrom, unsigned int nTo) {
+		const double flWeight = Quadrics[nFrom].flWeight + Quadrics[nTo].flWeight;
+		if (flWeight <= 0.0) {
+			return 0.0f;
+		}
+		const CMath::Vector3_t& vecTarget = Vertices[nTo].vec3Position;
+		const double flError = (Quadrics[nFrom].Evaluate(vecTarget) + Quadrics[nTo].Evaluate(vecTarget)) / flWeight;
+		return static_cast<float>(std::max(flError, 0.0));
+	};
+
+	const size_t nTargetTriangles = nTargetIndexCount / 3;
+	const float flMaxErrorSq = flMaxError * flMaxError;
+	float flResultErrorSq = 0.0f;
+
+	std::vector<unsigned int> TriangleOffsets(nVertexCount + 1);
+	std::vector<unsigned int> VertexTriangles;
+	std::vector<Collapse_t> Collapses;
+	std::vector<unsigned int> Remap(nVertexCount);
+	std::vector<uint8_t> Touched(nVertexCount);
+
+	// Each pass collapses the cheapest edges whose neighbourhoods don't overlap, then rewrites the triangles.
+	while (Indices.size() > nTargetIndexCount) {
+		const size_t nTriangles = Indices.size() / 3;
+
+		std::fill(TriangleOffsets.begin(), TriangleOffsets.end(), 0u);
+		for (unsigned int nIndex : Indices) {
+			++TriangleOffsets[Position[nIndex] + 1];
+		}
+		for (size_t i = 0; i < nVertexCount; ++i) {
+			TriangleOffsets[i + 1] += TriangleOffsets[i];
+		}
+		VertexTriangles.resize(Indices.size());
+		{
+			std::vector<unsigned int> Cursor(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+			for (size_t i = 0; i < Indices.size(); ++i) {
+				VertexTriangles[Cursor[Position[Indices[i]]]++] = static_cast<unsigned int>(i / 3);
+			}
+		}
+
+		// Every inner edge shows up once with a < b; the other triangle winds it the other way.
+		Collapses.clear();
+		for (size_t i = 0; i < Indices.size(); i += 3) {
+			for (int e = 0; e < 3; ++e) {
+				const unsigned int a = Position[Indices[i + e]], b = Position[Indices[i + (e + 1) % 3]];
+				if (a >= b) {
+					continue;
+				}
+				if (!Locked[a]) {
+					Collapses.push_back({ a, b, GetCollapseError(a, b) });
+				}
+				if (!Locked[b]) {
+					Collapses.push_back({ b, a, GetCollapseError(b, a) });
+				}
+			}
+		}
+		std::sort(Collapses.begin(), Collapses.end(), [](const Collapse_t& a, const Collapse_t& b) { return a.flErrorSq < b.flErrorSq; });
+
+		std::iota(Remap.begin(), Remap.end(), 0u);
+		std::fill(Touched.begin(), Touched.end(), 0);
+		const size_t nGoal = nTriangles - nTargetTriangles;
+		size_t nRemoved = 0;
+		bool bCollapsed = false;
+
+		for (const Collapse_t& Collapse : Collapses) {
+			if (Collapse.flErrorSq > flMaxErrorSq || nRemoved >= nGoal) {
+				break;
+			}
+			if (Touched[Collapse.nFrom] || Touched[Collapse.nTo]) {
+				continue;
+			}
+
+			// The triangles on the edge disappear, the others around nFrom must not turn over. The vertex
+			// nFrom's corners become is the one the edge's triangles use at nTo, so they keep nTo's attributes there.
+			const CMath::Vector3_t& vecTarget = Vertices[Collapse.nTo].vec3Position;
+			unsigned int nToVertex = UINT_MAX;
+			size_t nShared = 0;
+			bool bFlips = false;
+			for (unsigned int k = TriangleOffsets[Collapse.nFrom]; k < TriangleOffsets[Collapse.nFrom + 1] && !bFlips; ++k) {
+				const unsigned int* pTriangle = &Indices[VertexTriangles[k] * 3];
+				int nCorner = 0;
+				bool bOnEdge = false;
+				for (int c = 0; c < 3; ++c) {
+					if (Position[pTriangle[c]] == Collapse.nFrom) {
+						nCorner = c;
+					}
+					else if (Position[pTriangle[c]] == Collapse.nTo) {
+						nToVertex = pTriangle[c];
+						bOnEdge = true;
+					}
+				}
+				if (bOnEdge) {
+					++nShared;
+					continue;
+				}
+
+				CMath::Vector3_t p[3] = { Vertices[pTriangle[0]].vec3Position, Vertices[pTriangle[1]].vec3Position, Vertices[pTriangle[2]].vec3Position };
+				const CMath::Vector3_t vecBefore = (p[1] - p[0]).Cross(p[2] - p[0]);
+				p[nCorner] = vecTarget;
+				const CMath::Vector3_t vecAfter = (p[1] - p[0]).Cross(p[2] - p[0]);
+				// More than ~75 degrees of rotation counts as turning over.
+				bFlips = vecBefore.Dot(vecAfter) < 0.25f * vecBefore.Length() * vecAfter.Length();
+			}
+			if (bFlips || nToVertex == UINT_MAX) {
+				continue;
+			}
+
+			Remap[Collapse.nFrom] = nToVertex;
+			Quadrics[Collapse.nTo].Add(Quadrics[Collapse.nFrom]);
+			for (unsigned int k = TriangleOffsets[Collapse.nFrom]; k < TriangleOffsets[Collapse.nFrom + 1]; ++k) {
+				const unsigned int* pTriangle = &Indices[VertexTriangles[k] * 3];
+				Touched[Position[pTriangle[0]]] = Touched[Position[pTriangle[1]]] = Touched[Position[pTriangle[2]]] = 1;
+			}
+
+			nRemoved += nShared;
+			flResultErrorSq = std::max(flResultErrorSq, Collapse.flErrorSq);
+			bCollapsed = true;
+		}
+
+		if (!bCollapsed) {
+			break;
+		}
+
+		size_t nWrite = 0;
+		for (size_t i = 0; i < Indices.size(); i += 3) {
+			const unsigned int a = Remap[Indices[i]], b = Remap[Indices[i + 1]], c = Remap[Indices[i + 2]];
+			if (Position[a] != Position[b] && Position[b] != Position[c] && Position[c] != Position[a]) {
+				Indices[nWrite++] = a;
+				Indices[nWrite++] = b;
+				Indices[nWrite++] = c;
+			}
+		}
+		Indices.resize(nWrite);
+	}
+
+	return sqrtf(flResultErrorSq);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "../vertex/Vertex_t.hpp"
+
+// Quadric error metric (Garland-Heckbert) edge collapse for indexed triangle lists. Collapses always move
+// a vertex onto an existing neighbour, so the result indexes the input vertex buffer and every LOD of a
+// mesh can share it. Vertices on open borders and on attribute seams (same position, different normal
+// or texcoord) are never moved, which keeps silhouettes of open meshes and UV islands intact.
+class CMeshSimplifier {
+public:
+	// Collapses edges, cheapest first, until Indices has at most nTargetIndexCount indices or the next collapse
+	// would move the surface by more than flMaxError. Returns the error of the result as a distance in mesh units.
+	static float Simplify(std::span<const Vertex_t> Vertices, std::vector<unsigned int>& Indices,
+		size_t nTargetIndexCount, float flMaxError = FLT_MAX);
+};
@@ -0,0 +1,178 @@
+#include "CMeshletBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	void ComputeMeshletBounds(std::span<const Vertex_t> Vertices, const unsigned int* pIndices, Meshlet_t& Meshlet) {
+		const size_t nIndexCount = static_cast<size_t>(Meshlet.nTriangleCount) * 3;
+
+		// Same sphere as CMesh's: centered on the AABB, out to the farthest vertex.
+		CMath::Vector3_t vecMin = Vertices[pIndices[0]].vec3Position, vecMax = vecMin;
+		for (size_t i = 1; i < nIndexCount; ++i) {
+			const CMath::Vector3_t& p = Vertices[pIndices[i]].vec3Position;
+			vecMin = CMath::Vector3_t(std::min(vecMin.x, p.x), std::min(vecMin.y, p.y), std::min(vecMin.z, p.z));
+			vecMax = CMath::Vector3_t(std::max(vecMax.x, p.x), std::max(vecMax.y, p.y), std::max(vecMax.z, p.z));
+		}
+		Meshlet.vecCenter = (vecMin + vecMax) * 0.5f;
+
+		float flRadiusSq = 0.0f;
+		for (size_t i = 0; i < nIndexCount; ++i) {
+			CMath::Vector3_t vecOffset = Vertices[pIndices[i]].vec3Position - Meshlet.vecCenter;
+			flRadiusSq = std::max(flRadiusSq, vecOffset.Dot(vecOffset));
+		}
+		Meshlet.flRadius = sqrtf(flRadiusSq);
+
+		// Front faces wind so that (b - a) x (c - a) points out of the surface.
+		auto GetFaceNormal = [&](size_t i, CMath::Vector3_t& vecNormal) {
+			const CMath::Vector3_t& a = Vertices[pIndices[i]].vec3Position;
+			vecNormal = (Vertices[pIndices[i + 1]].vec3Position - a).Cross(Vertices[pIndices[i + 2]].vec3Position - a);
+			const float flLength = vecNormal.Length();
+			if (flLength == 0.0f) {
+				return false;
+			}
+			vecNormal = vecNormal / flLength;
+			return true;
+		};
+
+		CMath::Vector3_t vecAxis;
+		CMath::Vector3_t vecNormal;
+		for (size_t i = 0; i < nIndexCount; i += 3) {
+			if (GetFaceNormal(i, vecNormal)) {
+				vecAxis = vecAxis + vecNormal;
+			}
+		}
+
+		Meshlet.vecConeAxis = CMath::Vector3_t();
+		Meshlet.flConeCutoff = 1.0f;
+		const float flAxisLength = vecAxis.Length();
+		if (flAxisLength == 0.0f) {
+			return;
+		}
+		vecAxis = vecAxis / flAxisLength;
+
+		float flMinDot = 1.0f;
+		for (size_t i = 0; i < nIndexCount; i += 3) {
+			if (GetFaceNormal(i, vecNormal)) {
+				flMinDot = std::min(flMinDot, vecNormal.Dot(vecAxis));
+			}
+		}
+
+		// A cone wider than a hemisphere always has some triangle facing the camera; close to it, the test
+		// would practically never pass, so don't bother.
+		Meshlet.vecConeAxis = vecAxis;
+		if (flMinDot > 0.1f) {
+			Meshlet.flConeCutoff = sqrtf(1.0f - flMinDot * flMinDot);
+		}
+	}
+}
+
+std::vector<Meshlet_t> CMeshletBuilder::Build(std::span<const Vertex_t> Vertices, std::span<unsigned int> Indices, uint32_t nIndexOffset,
+	size_t nMaxVertices, size_t nMaxTriangles) {
+	std::vector<Meshlet_t> Meshlets;
+	const size_t nTriangleCount = Indices.size() / 3;
+	const size_t nVertexCount = Vertices.size();
+	if (nTriangleCount == 0 || nMaxVertices < 3 || nMaxTriangles == 0) {
+		return Meshlets;
+	}
+
+	// Triangles around each vertex.
+	std::vector<uint32_t> TriangleOffsets(nVertexCount + 1, 0);
+	for (size_t i = 0; i < nTriangleCount * 3; ++i) {
+		++TriangleOffsets[Indices[i] + 1];
+	}
+	for (size_t i = 0; i < nVertexCount; ++i) {
+		TriangleOffsets[i + 1] += TriangleOffsets[i];
+	}
+	std::vector<uint32_t> VertexTriangles(nTriangleCount * 3);
+	{
+		std::vector<uint32_t> Cursor(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+		for (size_t i = 0; i < nTriangleCount * 3; ++i) {
+			VertexTriangles[Cursor[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	// Stamps hold the meshlet that last took the vertex, or last listed the triangle as a candidate.
+	constexpr uint32_t NO_MESHLET = UINT32_MAX;
+	std::vector<uint32_t> VertexStamps(nVertexCount, NO_MESHLET);
+	std::vector<uint32_t> CandidateStamps(nTriangleCount, NO_MESHLET);
+	std::vector<uint8_t> Emitted(nTriangleCount, 0);
+	std::vector<uint32_t> Candidates;
+	std::vector<unsigned int> Output;
+	Output.reserve(nTriangleCount * 3);
+
+	size_t nSeed = 0;
+	while (Output.size() < nTriangleCount * 3) {
+		const uint32_t nMeshlet = static_cast<uint32_t>(Meshlets.size());
+		Meshlet_t Meshlet = {};
+		Meshlet.nStartIndex = nIndexOffset + static_cast<uint32_t>(Output.size());
+		Candidates.clear();
+
+		// New meshlets start from the first unused triangle, which keeps the input's order roughly intact.
+		while (Emitted[nSeed]) {
+			++nSeed;
+		}
+
+		size_t nNext = nSeed;
+		while (true) {
+			Emitted[nNext] = 1;
+			++Meshlet.nTriangleCount;
+			for (int c = 0; c < 3; ++c) {
+				const unsigned int nVertex = Indices[nNext * 3 + c];
+				Output.push_back(nVertex);
+				if (VertexStamps[nVertex] != nMeshlet) {
+					VertexStamps[nVertex] = nMeshlet;
+					++Meshlet.nVertexCount;
+				}
+
+				for (uint32_t k = TriangleOffsets[nVertex]; k < TriangleOffsets[nVertex + 1]; ++k) {
+					const uint32_t nTriangle = VertexTriangles[k];
+					if (!Emitted[nTriangle] && CandidateStamps[nTriangle] != nMeshlet) {
+						CandidateStamps[nTriangle] = nMeshlet;
+						Candidates.push_back(nTriangle);
+					}
+				}
+			}
+
+			if (Meshlet.nTriangleCount == nMaxTriangles) {
+				break;
+			}
+
+			// The neighbour that brings the fewest new vertices and still fits.
+			size_t nBest = nTriangleCount;
+			uint32_t nBestNewVertices = 4;
+			for (size_t k = 0; k < Candidates.size();) {
+				const uint32_t nTriangle = Candidates[k];
+				if (Emitted[nTriangle]) {
+					Candidates[k] = Candidates.back();
+					Candidates.pop_back();
+					continue;
+				}
+
+				uint32_t nNewVertices = 0;
+				for (int c = 0; c < 3; ++c) {
+					nNewVertices += VertexStamps[Indices[nTriangle * 3 + c]] != nMeshlet ? 1 : 0;
+				}
+				if (Meshlet.nVertexCount + nNewVertices <= nMaxVertices && nNewVertices < nBestNewVertices) {
+					nBest = nTriangle;
+					nBestNewVertices = nNewVertices;
+					if (nNewVertices == 0) {
+						break;
+					}
+				}
+				++k;
+			}
+
+			if (nBest == nTriangleCount) {
+				break;
+			}
+			nNext = nBest;
+		}
+
+		ComputeMeshletBounds(Vertices, &Output[Meshlet.nStartIndex - nIndexOffset], Meshlet);
+		Meshlets.push_back(Meshlet);
+	}
+
+	std::copy(Output.begin(), Output.end(), Indices.begin());
+	return Meshlets;
+}
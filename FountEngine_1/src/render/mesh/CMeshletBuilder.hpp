@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../vertex/Vertex_t.hpp"
+
+// A small cluster of neighbouring triangles, stored as a contiguous range of the mesh's index buffer.
+// Bounds are in object space; stored as is in cooked meshes.
+struct Meshlet_t {
+	uint32_t nStartIndex;
+	uint32_t nTriangleCount;
+	uint32_t nVertexCount; // unique vertices its triangles reference
+
+	CMath::Vector3_t vecCenter;
+	float flRadius;
+	// Every triangle's normal is within the cone around vecConeAxis. flConeCutoff is the sine of its half
+	// angle, 1 if the triangles face too many ways for the cluster to ever be back facing as a whole.
+	CMath::Vector3_t vecConeAxis;
+	float flConeCutoff;
+};
+
+class CMeshletBuilder {
+public:
+	static constexpr size_t DEFAULT_MAX_VERTICES = 64;
+	static constexpr size_t DEFAULT_MAX_TRIANGLES = 124;
+
+	// Regroups the triangles of Indices into meshlets of at most nMaxVertices unique vertices and nMaxTriangles
+	// triangles and reorders them so each meshlet is contiguous. Meshlets grow from a seed triangle through
+	// shared vertices, preferring triangles that add the fewest new ones, which keeps them compact and flat.
+	// nIndexOffset is added to every nStartIndex, for index ranges inside a bigger buffer.
+	static std::vector<Meshlet_t> Build(std::span<const Vertex_t> Vertices, std::span<unsigned int> Indices, uint32_t nIndexOffset = 0,
+		size_t nMaxVertices = DEFAULT_MAX_VERTICES, size_t nMaxTriangles = DEFAULT_MAX_TRIANGLES);
+};
@@ -0,0 +1,190 @@
+#include "COBJParser.hpp"
+
+#include <charconv>
+#include <cstring>
+
+#include "../../system/logging/CLogSystem.hpp"
+
+namespace {
+	inline bool IsBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* SkipBlanks(const char* pCursor, const char* pEnd) {
+		while (pCursor < pEnd && IsBlank(*pCursor)) {
+			++pCursor;
+		}
+		return pCursor;
+	}
+
+	inline bool ParseFloat(const char*& pCursor, const char* pEnd, float& flValue) {
+		pCursor = SkipBlanks(pCursor, pEnd);
+		if (pCursor < pEnd && *pCursor == '+') {
+			++pCursor;
+		}
+
+		auto Result = std::from_chars(pCursor, pEnd, flValue);
+		if (Result.ec != std::errc()) {
+			return false;
+		}
+
+		pCursor = Result.ptr;
+		return true;
+	}
+
+	inline bool ParseInt(const char*& pCursor, const char* pEnd, int& nValue) {
+		if (pCursor < pEnd && *pCursor == '+') {
+			++pCursor;
+		}
+
+		auto Result = std::from_chars(pCursor, pEnd, nValue);
+		if (Result.ec != std::errc()) {
+			return false;
+		}
+
+		pCursor = Result.ptr;
+		return true;
+	}
+
+	// OBJ indices are 1-based, negative ones are relative to the end of the list read so far.
+	inline bool ResolveIndex(int nRawIndex, size_t nCount, int& nIndex) {
+		if (nRawIndex > 0) {
+			nIndex = nRawIndex - 1;
+		}
+		else if (nRawIndex < 0) {
+			nIndex = static_cast<int>(nCount) + nRawIndex;
+		}
+		else {
+			return false;
+		}
+
+		return nIndex >= 0 && static_cast<size_t>(nIndex) < nCount;
+	}
+}
+
+void COBJParser::Clear() {
+	m_Positions.clear();
+	m_Normals.clear();
+	m_Texcoords.clear();
+	m_Corners.clear();
+}
+
+bool COBJParser::Parse(const char* pData, size_t nSize, const std::string& strSourceName) {
+	Clear();
+
+	const char* pCursor = pData;
+	const char* pEnd = pData + nSize;
+	size_t nLine = 0;
+
+	while (pCursor < pEnd) {
+		++nLine;
+
+		const char* pLineEnd = static_cast<const char*>(memchr(pCursor, '\n', pEnd - pCursor));
+		const char* pNext = pLineEnd ? pLineEnd + 1 : pEnd;
+		if (!pLineEnd) {
+			pLineEnd = pEnd;
+		}
+
+		// A comment runs to the end of the line, also after data.
+		if (const char* pComment = static_cast<const char*>(memchr(pCursor, '#', pLineEnd - pCursor))) {
+			pLineEnd = pComment;
+		}
+
+		pCursor = SkipBlanks(pCursor, pLineEnd);
+		const size_t nRemaining = pLineEnd - pCursor;
+
+		bool bSuccess = true;
+		if (nRemaining >= 2 && pCursor[0] == 'v' && IsBlank(pCursor[1])) { // Vertex Position
+			float x, y, z;
+			pCursor += 2;
+			bSuccess = ParseFloat(pCursor, pLineEnd, x) && ParseFloat(pCursor, pLineEnd, y) && ParseFloat(pCursor, pLineEnd, z);
+			if (bSuccess) {
+				m_Positions.emplace_back(x, y, z);
+			}
+		}
+		else if (nRemaining >= 3 && pCursor[0] == 'v' && pCursor[1] == 'n' && IsBlank(pCursor[2])) { // Vertex Normal
+			float x, y, z;
+			pCursor += 3;
+			bSuccess = ParseFloat(pCursor, pLineEnd, x) && ParseFloat(pCursor, pLineEnd, y) && ParseFloat(pCursor, pLineEnd, z);
+			if (bSuccess) {
+				m_Normals.emplace_back(x, y, z);
+			}
+		}
+		else if (nRemaining >= 3 && pCursor[0] == 'v' && pCursor[1] == 't' && IsBlank(pCursor[2])) { // Texture Coordinate
+			float u, v = 0.0f;
+			pCursor += 3;
+			bSuccess = ParseFloat(pCursor, pLineEnd, u);
+			if (bSuccess) {
+				ParseFloat(pCursor, pLineEnd, v); // 1D texture coordinates are allowed
+				m_Texcoords.emplace_back(u, v);
+			}
+		}
+		else if (nRemaining >= 2 && pCursor[0] == 'f' && IsBlank(pCursor[1])) {
+			bSuccess = ParseFace(pCursor + 2, pLineEnd);
+		}
+		// Groups, materials and smoothing groups are ignored.
+
+		if (!bSuccess) {
+			LOG_ERROR_CH(RENDER, "Malformed OBJ data in %s at line %zu", strSourceName.c_str(), nLine);
+			return false;
+		}
+
+		pCursor = pNext;
+	}
+
+	return true;
+}
+
+bool COBJParser::ParseFace(const char* pCursor, const char* pLineEnd) {
+	Corner_t First, Previous, Current;
+	int nCorners = 0;
+
+	pCursor = SkipBlanks(pCursor, pLineEnd);
+	while (pCursor < pLineEnd) {
+		if (!ParseCorner(pCursor, pLineEnd, Current)) {
+			return false;
+		}
+
+		if (nCorners == 0) {
+			First = Current;
+		}
+		else if (nCorners >= 2) {
+			m_Corners.push_back(First);
+			m_Corners.push_back(Previous);
+			m_Corners.push_back(Current);
+		}
+
+		Previous = Current;
+		++nCorners;
+		pCursor = SkipBlanks(pCursor, pLineEnd);
+	}
+
+	return nCorners >= 3;
+}
+
+bool COBJParser::ParseCorner(const char*& pCursor, const char* pLineEnd, Corner_t& Corner) const {
+	Corner.nPosition = Corner.nTexcoord = Corner.nNormal = -1;
+
+	int nRawIndex;
+	if (!ParseInt(pCursor, pLineEnd, nRawIndex) || !ResolveIndex(nRawIndex, m_Positions.size(), Corner.nPosition)) {
+		return false;
+	}
+
+	if (pCursor < pLineEnd && *pCursor == '/') {
+		++pCursor;
+		if (pCursor < pLineEnd && *pCursor != '/' && !IsBlank(*pCursor)) { // v/vt or v/vt/vn
+			if (!ParseInt(pCursor, pLineEnd, nRawIndex) || !ResolveIndex(nRawIndex, m_Texcoords.size(), Corner.nTexcoord)) {
+				return false;
+			}
+		}
+
+		if (pCursor < pLineEnd && *pCursor == '/') { // v//vn or v/vt/vn
+			++pCursor;
+			if (!ParseInt(pCursor, pLineEnd, nRawIndex) || !ResolveIndex(nRawIndex, m_Normals.size(), Corner.nNormal)) {
+				return false;
+			}
+		}
+	}
+
+	return pCursor == pLineEnd || IsBlank(*pCursor);
+}
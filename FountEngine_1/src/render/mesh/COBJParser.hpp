@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "../../math/CMath.hpp"
+
+// In-place Wavefront OBJ parser. Works directly on a memory-mapped (or otherwise bulk-read) buffer,
+// the only allocations are the growing attribute arrays.
+class COBJParser {
+public:
+	// Zero-based attribute indices of a face corner, -1 when the corner doesn't reference the attribute.
+	struct Corner_t {
+		int nPosition;
+		int nTexcoord;
+		int nNormal;
+	};
+
+	bool Parse(const char* pData, size_t nSize, const std::string& strSourceName);
+	void Clear();
+
+	const std::vector<CMath::Vector3_t>& GetPositions() const { return m_Positions; }
+	const std::vector<CMath::Vector3_t>& GetNormals() const { return m_Normals; }
+	const std::vector<CMath::Vector2_t>& GetTexcoords() const { return m_Texcoords; }
+
+	// Three corners per triangle, quads and n-gons are fan-triangulated.
+	const std::vector<Corner_t>& GetCorners() const { return m_Corners; }
+
+private:
+	bool ParseFace(const char* pCursor, const char* pLineEnd);
+	bool ParseCorner(const char*& pCursor, const char* pLineEnd, Corner_t& Corner) const;
+
+	std::vector<CMath::Vector3_t> m_Positions;
+	std::vector<CMath::Vector3_t> m_Normals;
+	std::vector<CMath::Vector2_t> m_Texcoords;
+	std::vector<Corner_t> m_Corners;
+};
@@ -0,0 +1,254 @@
+#include "CRenderQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "../../system/logging/CLogSystem.hpp"
+#include "../../system/profiler/CProfiler.hpp"
+
+namespace {
+	constexpr int PASS_BITS = 4;
+	constexpr int SHADER_BITS = 10;
+	constexpr int MATERIAL_BITS = 12;
+	constexpr int MESH_BITS = 18;
+	constexpr int DEPTH_BITS = 20;
+
+	constexpr size_t MIN_INSTANCE_CAPACITY = 1024;
+	static_assert(PASS_BITS + SHADER_BITS + MATERIAL_BITS + MESH_BITS + DEPTH_BITS == 64);
+
+	constexpr uint64_t Mask(int nBits) {
+		return (uint64_t(1) << nBits) - 1;
+	}
+
+	// The bit pattern of a non-negative float grows with its value, so its top bits are a
+	// logarithmically spaced depth bucket: fine close to the camera, coarse far away.
+	uint64_t QuantizeDepth(float flDepth) {
+		if (!(flDepth > 0.0f)) {
+			return 0;
+		}
+
+		uint32_t nBits;
+		memcpy(&nBits, &flDepth, sizeof(nBits));
+		return nBits >> (31 - DEPTH_BITS);
+	}
+
+	double ElapsedMs(std::chrono::steady_clock::time_point tStart) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	}
+}
+
+uint64_t CRenderQueue::MakeSortKey(ERenderPass ePass, uint32_t nShader, uint32_t nMaterial, uint32_t nMesh, float flViewDepth) {
+	uint64_t nDepth = QuantizeDepth(flViewDepth);
+	if (ePass == PASS_TRANSPARENT) {
+		nDepth = Mask(DEPTH_BITS) - nDepth;
+	}
+
+	uint64_t nKey = static_cast<uint64_t>(ePass) & Mask(PASS_BITS);
+	nKey = (nKey << SHADER_BITS) | (nShader & Mask(SHADER_BITS));
+	nKey = (nKey << MATERIAL_BITS) | (nMaterial & Mask(MATERIAL_BITS));
+	nKey = (nKey << MESH_BITS) | (nMesh & Mask(MESH_BITS));
+	nKey = (nKey << DEPTH_BITS) | nDepth;
+	return nKey;
+}
+
+void CRenderQueue::Clear() {
+	m_Packets.clear();
+	m_Transforms.clear();
+	m_Instances.clear();
+}
+
+void CRenderQueue::Submit(DrawPacket_t Packet, const CMath::Matrix4x4_t& mWorld) {
+	Packet.nTransform = static_cast<uint32_t>(m_Transforms.size());
+	m_Transforms.push_back(mWorld);
+	m_Packets.push_back(Packet);
+}
+
+void CRenderQueue::SubmitInstanced(DrawPacket_t Packet, std::span<const InstanceData_t> Instances) {
+	if (Instances.empty()) {
+		return;
+	}
+
+	Packet.nFirstInstance = static_cast<uint32_t>(m_Instances.size());
+	Packet.nInstanceCount = static_cast<uint32_t>(Instances.size());
+	m_Instances.insert(m_Instances.end(), Instances.begin(), Instances.end());
+	m_Packets.push_back(Packet);
+}
+
+void CRenderQueue::ReleaseBuffers(IRenderBackend& Backend) {
+	Backend.DestroyBuffer(m_hInstanceBuffer);
+	m_hInstanceBuffer = INVALID_RENDER_HANDLE;
+	m_nInstanceCapacity = 0;
+}
+
+bool CRenderQueue::UploadInstances(IRenderBackend& Backend) {
+	PROFILE_FUNCTION();
+
+	if (m_Instances.size() > m_nInstanceCapacity) {
+		Backend.DestroyBuffer(m_hInstanceBuffer);
+
+		m_nInstanceCapacity = std::max(MIN_INSTANCE_CAPACITY, m_nInstanceCapacity * 2);
+		while (m_nInstanceCapacity < m_Instances.size()) {
+			m_nInstanceCapacity *= 2;
+		}
+
+		BufferDesc_t InstanceBufferDesc;
+		InstanceBufferDesc.eType = BUFFER_VERTEX;
+		InstanceBufferDesc.nSize = m_nInstanceCapacity * sizeof(InstanceData_t);
+		InstanceBufferDesc.bDynamic = true;
+
+		m_hInstanceBuffer = Backend.CreateBuffer(InstanceBufferDesc);
+		if (m_hInstanceBuffer == INVALID_RENDER_HANDLE) {
+			LOG_ERROR_CH(RENDER, "Failed to create instance buffer (%zu instances)", m_nInstanceCapacity);
+			m_nInstanceCapacity = 0;
+			return false;
+		}
+	}
+
+	const size_t nBytes = m_Instances.size() * sizeof(InstanceData_t);
+	if (!Backend.UpdateBuffer(m_hInstanceBuffer, m_Instances.data(), nBytes)) {
+		return false;
+	}
+
+	Backend.SetVertexBuffer(INSTANCE_VERTEX_SLOT, m_hInstanceBuffer, sizeof(InstanceData_t));
+	++m_Stats.nBindsIssued;
+	m_Stats.nInstanceBytes = nBytes;
+	return true;
+}
+
+void CRenderQueue::Sort() {
+	PROFILE_FUNCTION();
+
+	const size_t nCount = m_Packets.size();
+	m_SortEntries.resize(nCount);
+	m_SortScratch.resize(nCount);
+	for (size_t i = 0; i < nCount; ++i) {
+		m_SortEntries[i] = { m_Packets[i].nSortKey, static_cast<uint32_t>(i) };
+	}
+
+	// LSD radix sort, one byte per pass. All eight histograms come from a single read of the keys,
+	// and a pass is skipped when every key has the same byte there (common for the pass and shader bits).
+	uint32_t nHistograms[8][256] = {};
+	for (const SortEntry_t& Entry : m_SortEntries) {
+		for (int nByte = 0; nByte < 8; ++nByte) {
+			++nHistograms[nByte][(Entry.nKey >> (nByte * 8)) & 0xFF];
+		}
+	}
+
+	for (int nByte = 0; nByte < 8; ++nByte) {
+		uint32_t* pHistogram = nHistograms[nByte];
+		if (pHistogram[(m_SortEntries[0].nKey >> (nByte * 8)) & 0xFF] == nCount) {
+			continue;
+		}
+
+		uint32_t nOffset = 0;
+		for (int nBucket = 0; nBucket < 256; ++nBucket) {
+			uint32_t nBucketCount = pHistogram[nBucket];
+			pHistogram[nBucket] = nOffset;
+			nOffset += nBucketCount;
+		}
+
+		for (const SortEntry_t& Entry : m_SortEntries) {
+			m_SortScratch[pHistogram[(Entry.nKey >> (nByte * 8)) & 0xFF]++] = Entry;
+		}
+		m_SortEntries.swap(m_SortScratch);
+	}
+}
+
+void CRenderQueue::Execute(IRenderBackend& Backend, RenderHandle_t hObjectBuffer) {
+	PROFILE_FUNCTION();
+
+	m_Stats = RenderQueueStats_t();
+	if (m_Packets.empty()) {
+		return;
+	}
+
+	auto tStart = std::chrono::steady_clock::now();
+	Sort();
+	m_Stats.flSortMs = ElapsedMs(tStart);
+
+	tStart = std::chrono::steady_clock::now();
+
+	RenderHandle_t hPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t hMaterial = INVALID_RENDER_HANDLE;
+	// The first draw binds its material even when it has none, so last frame's doesn't stay bound.
+	bool bMaterialBound = false;
+	RenderHandle_t hMeshConstants = INVALID_RENDER_HANDLE;
+	RenderHandle_t hVertexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t hIndexBuffer = INVALID_RENDER_HANDLE;
+	uint32_t nVertexStride = 0;
+	EIndexFormat eIndexFormat = INDEX_UINT32;
+
+	Backend.SetConstantBuffer(OBJECT_CONSTANT_SLOT, hObjectBuffer);
+	++m_Stats.nBindsIssued;
+
+	const bool bHasInstances = !m_Instances.empty() && UploadInstances(Backend);
+
+	for (const SortEntry_t& Entry : m_SortEntries) {
+		const DrawPacket_t& Packet = m_Packets[Entry.nPacket];
+
+		if (Packet.hPipeline != hPipeline) {
+			hPipeline = Packet.hPipeline;
+			Backend.SetPipeline(hPipeline);
+			++m_Stats.nBindsIssued;
+		}
+		else {
+			++m_Stats.nBindsSkipped;
+		}
+
+		if (!bMaterialBound || Packet.hMaterial != hMaterial) {
+			hMaterial = Packet.hMaterial;
+			bMaterialBound = true;
+			Backend.SetConstantBuffer(MATERIAL_CONSTANT_SLOT, hMaterial);
+			++m_Stats.nBindsIssued;
+		}
+		else {
+			++m_Stats.nBindsSkipped;
+		}
+
+		// Draws that don't read it leave the previous mesh's bound, and don't count as a skipped bind either.
+		if (Packet.hMeshConstants != INVALID_RENDER_HANDLE) {
+			if (Packet.hMeshConstants != hMeshConstants) {
+				hMeshConstants = Packet.hMeshConstants;
+				Backend.SetConstantBuffer(MESH_CONSTANT_SLOT, hMeshConstants);
+				++m_Stats.nBindsIssued;
+			}
+			else {
+				++m_Stats.nBindsSkipped;
+			}
+		}
+
+		if (Packet.hVertexBuffer != hVertexBuffer || Packet.nVertexStride != nVertexStride) {
+			hVertexBuffer = Packet.hVertexBuffer;
+			nVertexStride = Packet.nVertexStride;
+			Backend.SetVertexBuffer(0, hVertexBuffer, nVertexStride);
+			++m_Stats.nBindsIssued;
+		}
+		else {
+			++m_Stats.nBindsSkipped;
+		}
+
+		if (Packet.hIndexBuffer != hIndexBuffer || Packet.eIndexFormat != eIndexFormat) {
+			hIndexBuffer = Packet.hIndexBuffer;
+			eIndexFormat = Packet.eIndexFormat;
+			Backend.SetIndexBuffer(hIndexBuffer, eIndexFormat);
+			++m_Stats.nBindsIssued;
+		}
+		else {
+			++m_Stats.nBindsSkipped;
+		}
+
+		if (Packet.nInstanceCount == 0) {
+			Backend.UpdateBuffer(hObjectBuffer, &m_Transforms[Packet.nTransform], sizeof(CMath::Matrix4x4_t));
+			Backend.DrawIndexed(Packet.nIndexCount, Packet.nStartIndex, Packet.nBaseVertex);
+			++m_Stats.nInstances;
+		}
+		else if (bHasInstances) {
+			Backend.DrawIndexedInstanced(Packet.nIndexCount, Packet.nInstanceCount, Packet.nStartIndex, Packet.nBaseVertex, Packet.nFirstInstance);
+			m_Stats.nInstances += Packet.nInstanceCount;
+		}
+		++m_Stats.nDraws;
+	}
+
+	m_Stats.flSubmitMs = ElapsedMs(tStart);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../../math/CMath.hpp"
+#include "../backend/IRenderBackend.hpp"
+
+// Constant buffer slots shared with shaders.hlsl.
+constexpr uint32_t FRAME_CONSTANT_SLOT = 0; // view, projection
+constexpr uint32_t OBJECT_CONSTANT_SLOT = 1; // world
+constexpr uint32_t MATERIAL_CONSTANT_SLOT = 2;
+constexpr uint32_t MESH_CONSTANT_SLOT = 3; // VertexDecode_t of packed vertices
+// Vertex buffer slot of the per-instance data.
+constexpr uint32_t INSTANCE_VERTEX_SLOT = 1;
+
+enum ERenderPass {
+	PASS_OPAQUE,
+	PASS_TRANSPARENT,
+	PASS_COUNT
+};
+
+// Per-instance vertex data of instanced draws (INSTANCE_WORLD0-3, INSTANCE_DATA in shaders.hlsl).
+struct InstanceData_t {
+	CMath::Matrix4x4_t mWorld;
+	CMath::Vector4_t vecData; // free for the shader, VSInstanced uses it as a color tint
+};
+
+// Everything one draw needs, so the queue can sort draws without touching the objects that made them.
+struct DrawPacket_t {
+	uint64_t nSortKey = 0;
+	RenderHandle_t hPipeline = INVALID_RENDER_HANDLE;
+	RenderHandle_t hMaterial = INVALID_RENDER_HANDLE; // constant buffer, optional
+	RenderHandle_t hMeshConstants = INVALID_RENDER_HANDLE; // constant buffer, only for packed vertices
+	RenderHandle_t hVertexBuffer = INVALID_RENDER_HANDLE;
+	RenderHandle_t hIndexBuffer = INVALID_RENDER_HANDLE;
+	uint32_t nVertexStride = 0;
+	EIndexFormat eIndexFormat = INDEX_UINT32;
+	uint32_t nIndexCount = 0;
+	uint32_t nStartIndex = 0;
+	int32_t nBaseVertex = 0;
+	uint32_t nTransform = 0; // index into the queue's world matrices
+	uint32_t nInstanceCount = 0; // 0 for a regular draw
+	uint32_t nFirstInstance = 0; // into the queue's instance data
+};
+
+struct RenderQueueStats_t {
+	uint64_t nDraws = 0;
+	uint64_t nInstances = 0;
+	uint64_t nInstanceBytes = 0; // uploaded in one update
+	uint64_t nBindsIssued = 0;
+	uint64_t nBindsSkipped = 0;
+	double flSortMs = 0.0;
+	double flSubmitMs = 0.0;
+};
+
+// Collects the draws of a frame, radix-sorts them by their 64-bit key and submits them,
+// binding only the state that differs from the previous draw. The instance data of all
+// instanced draws goes to the GPU in a single update per frame.
+class CRenderQueue {
+public:
+	// Key layout from the most significant bit: pass (4), shader (10), material (12), mesh (18), depth (20).
+	// Opaque passes draw front to back, transparent ones back to front.
+	static uint64_t MakeSortKey(ERenderPass ePass, uint32_t nShader, uint32_t nMaterial, uint32_t nMesh, float flViewDepth);
+
+	void Clear();
+
+	// Stores mWorld for the draw; Packet.nTransform is filled in.
+	void Submit(DrawPacket_t Packet, const CMath::Matrix4x4_t& mWorld);
+
+	// One draw of Instances.size() copies. Packet.hPipeline has to read the per-instance
+	// elements from INSTANCE_VERTEX_SLOT; Packet.nInstanceCount and nFirstInstance are filled in.
+	void SubmitInstanced(DrawPacket_t Packet, std::span<const InstanceData_t> Instances);
+
+	// hObjectBuffer receives each regular draw's world matrix at OBJECT_CONSTANT_SLOT.
+	void Execute(IRenderBackend& Backend, RenderHandle_t hObjectBuffer);
+
+	// Call before the backend goes away.
+	void ReleaseBuffers(IRenderBackend& Backend);
+
+	size_t GetDrawCount() const { return m_Packets.size(); }
+	const RenderQueueStats_t& GetFrameStats() const { return m_Stats; }
+
+private:
+	void Sort();
+	bool UploadInstances(IRenderBackend& Backend);
+
+	std::vector<DrawPacket_t> m_Packets;
+	std::vector<CMath::Matrix4x4_t> m_Transforms;
+	std::vector<InstanceData_t> m_Instances;
+
+	// Dynamic vertex buffer that grows to the largest frame's instance data.
+	RenderHandle_t m_hInstanceBuffer = INVALID_RENDER_HANDLE;
+	size_t m_nInstanceCapacity = 0;
+
+	// Radix sort works on (key, packet index) pairs, the packets themselves stay where they are.
+	struct SortEntry_t {
+		uint64_t nKey;
+		uint32_t nPacket;
+	};
+	std::vector<SortEntry_t> m_SortEntries;
+	std::vector<SortEntry_t> m_SortScratch;
+
+	RenderQueueStats_t m_Stats;
+};
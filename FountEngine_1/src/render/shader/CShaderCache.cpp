@@ -0,0 +1,197 @@
+#include "CShaderCache.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <unordered_set>
+
+#include "../../system/logging/CLogSystem.hpp"
+
+namespace {
+	// FNV-1a
+	constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ull;
+
+	uint64_t HashBytes(uint64_t nHash, const void* pData, size_t nSize) {
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		for (size_t i = 0; i < nSize; ++i) {
+			nHash ^= pBytes[i];
+			nHash *= 0x100000001B3ull;
+		}
+		return nHash;
+	}
+
+	uint64_t HashValue(uint64_t nHash, uint64_t nValue) {
+		return HashBytes(nHash, &nValue, sizeof(nValue));
+	}
+
+	// Length first, so neighbouring strings can't trade characters and hash the same.
+	uint64_t HashString(uint64_t nHash, const std::string& str) {
+		return HashBytes(HashValue(nHash, str.size()), str.data(), str.size());
+	}
+
+	bool ReadFile(const std::filesystem::path& Path, std::string& strContents) {
+		std::ifstream sFile(Path, std::ios::binary);
+		if (!sFile.is_open()) {
+			return false;
+		}
+		strContents.assign(std::istreambuf_iterator<char>(sFile), std::istreambuf_iterator<char>());
+		return !sFile.bad();
+	}
+
+	// Files named by #include "x" or <x>, looked up next to the including file like the compiler's standard
+	// include handler does. Includes that can't be read only contribute their name; the compile will fail on them anyway.
+	void HashIncludes(uint64_t& nHash, const std::filesystem::path& Path, const std::string& strContents,
+		std::unordered_set<std::string>& Visited) {
+		std::istringstream sLines(strContents);
+		std::string strLine;
+		while (std::getline(sLines, strLine)) {
+			size_t nPos = strLine.find_first_not_of(" \t");
+			if (nPos == std::string::npos || strLine.compare(nPos, 1, "#") != 0) {
+				continue;
+			}
+			nPos = strLine.find_first_not_of(" \t", nPos + 1);
+			if (nPos == std::string::npos || strLine.compare(nPos, 7, "include") != 0) {
+				continue;
+			}
+
+			const size_t nOpen = strLine.find_first_of("\"<", nPos + 7);
+			if (nOpen == std::string::npos) {
+				continue;
+			}
+			const size_t nClose = strLine.find(strLine[nOpen] == '"' ? '"' : '>', nOpen + 1);
+			if (nClose == std::string::npos) {
+				continue;
+			}
+
+			const std::string strName = strLine.substr(nOpen + 1, nClose - nOpen - 1);
+			nHash = HashString(nHash, strName);
+
+			const std::filesystem::path IncludePath = (Path.parent_path() / strName).lexically_normal();
+			if (!Visited.insert(IncludePath.string()).second) {
+				continue;
+			}
+
+			std::string strInclude;
+			if (ReadFile(IncludePath, strInclude)) {
+				nHash = HashString(nHash, strInclude);
+				HashIncludes(nHash, IncludePath, strInclude, Visited);
+			}
+		}
+	}
+}
+
+CShaderCache::CShaderCache(std::string strDirectory) : m_strDirectory(std::move(strDirectory)) {}
+
+uint64_t CShaderCache::HashKey(const ShaderCacheKey_t& Key) {
+	uint64_t nHash = HASH_SEED;
+	nHash = HashString(nHash, Key.strSourcePath);
+	nHash = HashString(nHash, Key.strEntry);
+	nHash = HashString(nHash, Key.strProfile);
+	nHash = HashValue(nHash, Key.Defines.size());
+	for (const auto& [strName, strValue] : Key.Defines) {
+		nHash = HashString(nHash, strName);
+		nHash = HashString(nHash, strValue);
+	}
+	nHash = HashValue(nHash, Key.nFlags);
+	nHash = HashValue(nHash, Key.nCompilerVersion);
+	return nHash;
+}
+
+uint64_t CShaderCache::HashSources(const std::string& strSourcePath) {
+	const std::filesystem::path Path = std::filesystem::path(strSourcePath).lexically_normal();
+	std::string strContents;
+	if (!ReadFile(Path, strContents)) {
+		return 0;
+	}
+
+	uint64_t nHash = HashString(HASH_SEED, strContents);
+	std::unordered_set<std::string> Visited = { Path.string() };
+	HashIncludes(nHash, Path, strContents, Visited);
+	return nHash != 0 ? nHash : 1;
+}
+
+std::string CShaderCache::GetEntryPath(const ShaderCacheKey_t& Key) const {
+	char szName[32];
+	snprintf(szName, sizeof(szName), "%016" PRIx64, HashKey(Key));
+	return (std::filesystem::path(m_strDirectory) / (std::string(szName) + EXTENSION)).string();
+}
+
+bool CShaderCache::Load(const ShaderCacheKey_t& Key, std::vector<char>& Bytecode) {
+	const std::string strEntryPath = GetEntryPath(Key);
+	std::ifstream sFile(strEntryPath, std::ios::binary);
+	ShaderCacheEntryHeader_t Header;
+	if (!sFile.is_open() || !sFile.read(reinterpret_cast<char*>(&Header), sizeof(Header)) ||
+		Header.nMagic != MAGIC || Header.nVersion != VERSION || Header.nKeyHash != HashKey(Key)) {
+		++m_Stats.nMisses;
+		return false;
+	}
+
+	const uint64_t nSourceHash = HashSources(Key.strSourcePath);
+	if (nSourceHash != 0 && nSourceHash != Header.nSourceHash) {
+		++m_Stats.nMisses;
+		return false;
+	}
+
+	// Bounded before allocating, a damaged size mustn't turn into a huge allocation.
+	std::error_code ErrorCode;
+	const uint64_t nFileSize = std::filesystem::file_size(strEntryPath, ErrorCode);
+	if (ErrorCode || Header.nSize == 0 || Header.nSize != nFileSize - sizeof(Header)) {
+		++m_Stats.nMisses;
+		return false;
+	}
+
+	Bytecode.resize(Header.nSize);
+	if (!sFile.read(Bytecode.data(), static_cast<std::streamsize>(Bytecode.size())) ||
+		HashBytes(HASH_SEED, Bytecode.data(), Bytecode.size()) != Header.nChecksum) {
+		LOG_WARNING_CH(RENDER, "Damaged shader cache entry for %s %s", Key.strSourcePath.c_str(), Key.strEntry.c_str());
+		Bytecode.clear();
+		++m_Stats.nMisses;
+		return false;
+	}
+
+	++m_Stats.nHits;
+	return true;
+}
+
+bool CShaderCache::Store(const ShaderCacheKey_t& Key, std::span<const char> Bytecode) {
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(m_strDirectory, ErrorCode);
+	if (ErrorCode) {
+		LOG_ERROR_CH(RENDER, "Failed to create shader cache directory %s: %s", m_strDirectory.c_str(), ErrorCode.message().c_str());
+		return false;
+	}
+
+	ShaderCacheEntryHeader_t Header = {};
+	Header.nMagic = MAGIC;
+	Header.nVersion = VERSION;
+	Header.nKeyHash = HashKey(Key);
+	Header.nSourceHash = HashSources(Key.strSourcePath);
+	Header.nSize = Bytecode.size();
+	Header.nChecksum = HashBytes(HASH_SEED, Bytecode.data(), Bytecode.size());
+
+	const std::string strEntryPath = GetEntryPath(Key);
+	const std::string strTempPath = strEntryPath + ".tmp";
+	{
+		std::ofstream sFile(strTempPath, std::ios::binary | std::ios::trunc);
+		if (!sFile.is_open() ||
+			!sFile.write(reinterpret_cast<const char*>(&Header), sizeof(Header)) ||
+			!sFile.write(Bytecode.data(), static_cast<std::streamsize>(Bytecode.size()))) {
+			LOG_ERROR_CH(RENDER, "Failed to write shader cache entry %s", strTempPath.c_str());
+			return false;
+		}
+	}
+
+	std::filesystem::rename(strTempPath, strEntryPath, ErrorCode);
+	if (ErrorCode) {
+		LOG_ERROR_CH(RENDER, "Failed to write shader cache entry %s: %s", strEntryPath.c_str(), ErrorCode.message().c_str());
+		std::filesystem::remove(strTempPath, ErrorCode);
+		return false;
+	}
+
+	++m_Stats.nStores;
+	return true;
+}
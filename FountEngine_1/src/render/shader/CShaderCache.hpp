@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Everything besides the source text that decides what a shader compiles to.
+struct ShaderCacheKey_t {
+	std::string strSourcePath;
+	std::string strEntry;
+	std::string strProfile; // e.g. "vs_5_0"
+	std::vector<std::pair<std::string, std::string>> Defines;
+	uint64_t nFlags = 0;
+	uint32_t nCompilerVersion = 0;
+};
+
+// Header of a cache entry, followed by nSize bytes of bytecode.
+struct ShaderCacheEntryHeader_t {
+	uint32_t nMagic;
+	uint32_t nVersion;
+	uint64_t nKeyHash;
+	uint64_t nSourceHash;
+	uint64_t nSize;
+	uint64_t nChecksum; // of the bytecode, catches truncated or damaged entries
+};
+
+// Compiled shader bytecode on disk, independent of the graphics API: one file per key, named after its hash.
+// Entries also store the hash of the source and every file it #includes; editing any of them makes the
+// entry stale. Like cooked meshes, a missing source counts as up to date: shipping builds only carry the cache.
+class CShaderCache {
+public:
+	static constexpr uint32_t MAGIC = 0x43485346; // "FSHC"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr const char* EXTENSION = ".fsc";
+
+	explicit CShaderCache(std::string strDirectory);
+
+	// False on a miss: no entry, or a stale or damaged one.
+	bool Load(const ShaderCacheKey_t& Key, std::vector<char>& Bytecode);
+	// Writes to a temporary file first, so readers never see half an entry.
+	bool Store(const ShaderCacheKey_t& Key, std::span<const char> Bytecode);
+
+	static uint64_t HashKey(const ShaderCacheKey_t& Key);
+	// Hash of the file and, recursively, the files its #include lines name. 0 if it can't be read.
+	static uint64_t HashSources(const std::string& strSourcePath);
+
+	std::string GetEntryPath(const ShaderCacheKey_t& Key) const;
+	const std::string& GetDirectory() const { return m_strDirectory; }
+
+	struct Stats_t {
+		uint64_t nHits = 0;
+		uint64_t nMisses = 0;
+		uint64_t nStores = 0;
+	};
+	const Stats_t& GetStats() const { return m_Stats; }
+
+private:
+	std::string m_strDirectory;
+	Stats_t m_Stats;
+};
@@ -0,0 +1,77 @@
+#include "CVertexPacker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	uint16_t QuantizeUnorm16(float flValue) {
+		return static_cast<uint16_t>(std::clamp(flValue, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	int16_t QuantizeSnorm16(float flValue) {
+		return static_cast<int16_t>(std::lround(std::clamp(flValue, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	// 1 / extent, or 0 for a flat axis, where every value quantizes to 0 and decodes to the bias.
+	float GetInverseExtent(float flMin, float flMax) {
+		return flMax > flMin ? 1.0f / (flMax - flMin) : 0.0f;
+	}
+}
+
+VertexDecode_t CVertexPacker::Pack(std::span<const Vertex_t> Vertices, std::vector<PackedVertex_t>& Packed) {
+	Packed.resize(Vertices.size());
+	VertexDecode_t Decode;
+	if (Vertices.empty()) {
+		return Decode;
+	}
+
+	CMath::Vector3_t vecMin = Vertices[0].vec3Position, vecMax = vecMin;
+	CMath::Vector2_t vecTexcoordMin = Vertices[0].vec2Texcoord, vecTexcoordMax = vecTexcoordMin;
+	for (const Vertex_t& Vertex : Vertices) {
+		const CMath::Vector3_t& p = Vertex.vec3Position;
+		vecMin = CMath::Vector3_t(std::min(vecMin.x, p.x), std::min(vecMin.y, p.y), std::min(vecMin.z, p.z));
+		vecMax = CMath::Vector3_t(std::max(vecMax.x, p.x), std::max(vecMax.y, p.y), std::max(vecMax.z, p.z));
+		const CMath::Vector2_t& uv = Vertex.vec2Texcoord;
+		vecTexcoordMin = CMath::Vector2_t(std::min(vecTexcoordMin.x, uv.x), std::min(vecTexcoordMin.y, uv.y));
+		vecTexcoordMax = CMath::Vector2_t(std::max(vecTexcoordMax.x, uv.x), std::max(vecTexcoordMax.y, uv.y));
+	}
+
+	const CMath::Vector3_t vecScale(GetInverseExtent(vecMin.x, vecMax.x), GetInverseExtent(vecMin.y, vecMax.y), GetInverseExtent(vecMin.z, vecMax.z));
+	const CMath::Vector2_t vecTexcoordScale(GetInverseExtent(vecTexcoordMin.x, vecTexcoordMax.x), GetInverseExtent(vecTexcoordMin.y, vecTexcoordMax.y));
+
+	for (size_t i = 0; i < Vertices.size(); ++i) {
+		const Vertex_t& Vertex = Vertices[i];
+		PackedVertex_t& Out = Packed[i];
+
+		const CMath::Vector3_t& p = Vertex.vec3Position;
+		Out.aPosition[0] = QuantizeUnorm16((p.x - vecMin.x) * vecScale.x);
+		Out.aPosition[1] = QuantizeUnorm16((p.y - vecMin.y) * vecScale.y);
+		Out.aPosition[2] = QuantizeUnorm16((p.z - vecMin.z) * vecScale.z);
+		Out.aPosition[3] = 0;
+
+		const CMath::Vector2_t vecNormal = EncodeOctahedral(Vertex.vec3Normal);
+		Out.aNormal[0] = QuantizeSnorm16(vecNormal.x);
+		Out.aNormal[1] = QuantizeSnorm16(vecNormal.y);
+
+		Out.aTexcoord[0] = QuantizeUnorm16((Vertex.vec2Texcoord.x - vecTexcoordMin.x) * vecTexcoordScale.x);
+		Out.aTexcoord[1] = QuantizeUnorm16((Vertex.vec2Texcoord.y - vecTexcoordMin.y) * vecTexcoordScale.y);
+	}
+
+	Decode.vecPositionScale = CMath::Vector4_t(vecMax.x - vecMin.x, vecMax.y - vecMin.y, vecMax.z - vecMin.z, 0.0f);
+	Decode.vecPositionBias = CMath::Vector4_t(vecMin.x, vecMin.y, vecMin.z, 1.0f);
+	Decode.vecTexcoordScaleBias = CMath::Vector4_t(vecTexcoordMax.x - vecTexcoordMin.x, vecTexcoordMax.y - vecTexcoordMin.y, vecTexcoordMin.x, vecTexcoordMin.y);
+	return Decode;
+}
+
+CMath::Vector2_t CVertexPacker::EncodeOctahedral(const CMath::Vector3_t& vecNormal) {
+	const float flLength = fabsf(vecNormal.x) + fabsf(vecNormal.y) + fabsf(vecNormal.z);
+	if (flLength == 0.0f) {
+		return CMath::Vector2_t(0.0f, 0.0f);
+	}
+
+	const float x = vecNormal.x / flLength, y = vecNormal.y / flLength;
+	if (vecNormal.z >= 0.0f) {
+		return CMath::Vector2_t(x, y);
+	}
+	return CMath::Vector2_t((1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f), (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f));
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Vertex_t.hpp"
+
+// Half of a Vertex_t: position quantized to 16 bits per axis over the mesh bounds (w is padding),
+// octahedral normal in two snorm16s and texcoord quantized over the mesh's texcoord range.
+// VSPacked in shaders.hlsl decodes it.
+struct PackedVertex_t {
+	uint16_t aPosition[4];
+	int16_t aNormal[2];
+	uint16_t aTexcoord[2];
+};
+static_assert(sizeof(PackedVertex_t) == 16);
+
+// Turns the [0, 1] the shader reads back into mesh units: value * scale + bias.
+// MeshBuffer at MESH_CONSTANT_SLOT in shaders.hlsl.
+struct VertexDecode_t {
+	CMath::Vector4_t vecPositionScale;
+	CMath::Vector4_t vecPositionBias;
+	CMath::Vector4_t vecTexcoordScaleBias; // scale in xy, bias in zw
+};
+
+class CVertexPacker {
+public:
+	// Packs Vertices against the bounds of their positions and texcoords, returns the constants to decode them.
+	static VertexDecode_t Pack(std::span<const Vertex_t> Vertices, std::vector<PackedVertex_t>& Packed);
+
+	// Maps a unit vector onto the [-1, 1] square: the upper half of the octahedron directly, the lower folded over the diagonals.
+	// DecodeOctahedral() in shaders.hlsl is the inverse.
+	static CMath::Vector2_t EncodeOctahedral(const CMath::Vector3_t& vecNormal);
+};
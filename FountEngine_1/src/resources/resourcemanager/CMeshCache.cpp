@@ -0,0 +1,105 @@
+#include "CMeshCache.hpp"
+
+#include <mutex>
+
+uint64_t CMeshCache::Hash(std::string_view strPath) {
+	// FNV-1a
+	uint64_t nHash = 0xCBF29CE484222325ull;
+	for (char c : strPath) {
+		nHash ^= static_cast<unsigned char>(c);
+		nHash *= 0x100000001B3ull;
+	}
+	return nHash;
+}
+
+std::shared_ptr<CMesh> CMeshCache::Find(const Key_t& Key) {
+	Shard_t& Shard = GetShard(Key.nHash);
+
+	std::shared_ptr<CMesh> pMesh;
+	{
+		std::shared_lock<std::shared_mutex> lock(Shard.Mutex);
+		auto it = Shard.Entries.find(Key);
+		if (it != Shard.Entries.end()) {
+			pMesh = it->second.lock();
+		}
+	}
+
+	(pMesh ? Shard.nHits : Shard.nMisses).fetch_add(1, std::memory_order_relaxed);
+	return pMesh;
+}
+
+void CMeshCache::Insert(const Key_t& Key, const std::shared_ptr<CMesh>& pMesh) {
+	Shard_t& Shard = GetShard(Key.nHash);
+
+	std::unique_lock<std::shared_mutex> lock(Shard.Mutex);
+	auto it = Shard.Entries.find(Key);
+	if (it != Shard.Entries.end()) {
+		it->second = pMesh;
+	}
+	else {
+		Shard.Entries.emplace(std::string(Key.strPath), pMesh);
+	}
+}
+
+void CMeshCache::Erase(const Key_t& Key) {
+	Shard_t& Shard = GetShard(Key.nHash);
+
+	std::unique_lock<std::shared_mutex> lock(Shard.Mutex);
+	auto it = Shard.Entries.find(Key);
+	if (it != Shard.Entries.end()) {
+		Shard.Entries.erase(it);
+	}
+}
+
+size_t CMeshCache::PruneNextShard() {
+	size_t nShard = m_nNextPruneShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+	return PruneShard(m_Shards[nShard]);
+}
+
+size_t CMeshCache::PruneAll() {
+	size_t nPruned = 0;
+	for (Shard_t& Shard : m_Shards) {
+		nPruned += PruneShard(Shard);
+	}
+	return nPruned;
+}
+
+size_t CMeshCache::PruneShard(Shard_t& Shard) {
+	std::unique_lock<std::shared_mutex> lock(Shard.Mutex);
+
+	size_t nPruned = std::erase_if(Shard.Entries, [](const auto& Entry) {
+		return Entry.second.expired();
+	});
+
+	Shard.nPruned.fetch_add(nPruned, std::memory_order_relaxed);
+	return nPruned;
+}
+
+void CMeshCache::RecordLoad(uint64_t nMicroseconds) {
+	m_nLoads.fetch_add(1, std::memory_order_relaxed);
+	m_nLoadTimeMicroseconds.fetch_add(nMicroseconds, std::memory_order_relaxed);
+}
+
+void CMeshCache::RecordEviction(uint64_t nBytes) {
+	m_nEvictions.fetch_add(1, std::memory_order_relaxed);
+	m_nEvictedBytes.fetch_add(nBytes, std::memory_order_relaxed);
+}
+
+CMeshCache::Stats_t CMeshCache::GetStats() const {
+	Stats_t Stats;
+	Stats.nLoads = m_nLoads.load(std::memory_order_relaxed);
+	Stats.nLoadTimeMicroseconds = m_nLoadTimeMicroseconds.load(std::memory_order_relaxed);
+	Stats.nEvictions = m_nEvictions.load(std::memory_order_relaxed);
+	Stats.nEvictedBytes = m_nEvictedBytes.load(std::memory_order_relaxed);
+
+	for (const Shard_t& Shard : m_Shards) {
+		Stats.nHits += Shard.nHits.load(std::memory_order_relaxed);
+		Stats.nMisses += Shard.nMisses.load(std::memory_order_relaxed);
+		Stats.nPruned += Shard.nPruned.load(std::memory_order_relaxed);
+
+		std::shared_lock<std::shared_mutex> lock(Shard.Mutex);
+		Stats.nEntries += Shard.Entries.size();
+	}
+
+	return Stats;
+}
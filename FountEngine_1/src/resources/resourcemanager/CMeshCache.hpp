@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "../../render/mesh/CMesh.hpp"
+
+// Path -> mesh cache, split into independently locked shards by key hash. Lookups only take a shared lock.
+// Entries are weak: the cache never keeps a mesh alive, dead entries are pruned incrementally.
+class CMeshCache {
+public:
+	static constexpr size_t SHARD_COUNT = 16;
+
+	struct Stats_t {
+		uint64_t nHits = 0;
+		uint64_t nMisses = 0;
+		uint64_t nLoads = 0;
+		uint64_t nLoadTimeMicroseconds = 0;
+		uint64_t nPruned = 0;
+		uint64_t nEntries = 0;
+		// Meshes the resource manager dropped from residency, and the bytes that freed.
+		uint64_t nEvictions = 0;
+		uint64_t nEvictedBytes = 0;
+	};
+
+	// The path is hashed once per request; the hash picks the shard and is reused as the map hash.
+	struct Key_t {
+		uint64_t nHash;
+		std::string_view strPath;
+
+		explicit Key_t(std::string_view strPath) : nHash(Hash(strPath)), strPath(strPath) {}
+	};
+
+	static uint64_t Hash(std::string_view strPath);
+
+	std::shared_ptr<CMesh> Find(const Key_t& Key);
+	void Insert(const Key_t& Key, const std::shared_ptr<CMesh>& pMesh);
+	void Erase(const Key_t& Key);
+
+	// Drops expired entries from one shard (round robin) or from all of them.
+	size_t PruneNextShard();
+	size_t PruneAll();
+
+	void RecordLoad(uint64_t nMicroseconds);
+	void RecordEviction(uint64_t nBytes);
+	Stats_t GetStats() const;
+
+private:
+	struct KeyHasher_t {
+		using is_transparent = void;
+		size_t operator()(const Key_t& Key) const { return static_cast<size_t>(Key.nHash); }
+		size_t operator()(const std::string& strPath) const { return static_cast<size_t>(Hash(strPath)); }
+	};
+
+	struct KeyEqual_t {
+		using is_transparent = void;
+		bool operator()(const std::string& a, const std::string& b) const { return a == b; }
+		bool operator()(const Key_t& a, const std::string& b) const { return a.strPath == b; }
+		bool operator()(const std::string& a, const Key_t& b) const { return a == b.strPath; }
+	};
+
+	struct alignas(64) Shard_t {
+		mutable std::shared_mutex Mutex;
+		std::unordered_map<std::string, std::weak_ptr<CMesh>, KeyHasher_t, KeyEqual_t> Entries;
+
+		std::atomic<uint64_t> nHits = 0;
+		std::atomic<uint64_t> nMisses = 0;
+		std::atomic<uint64_t> nPruned = 0;
+	};
+
+	Shard_t& GetShard(uint64_t nHash) { return m_Shards[(nHash >> 32) % SHARD_COUNT]; }
+	size_t PruneShard(Shard_t& Shard);
+
+	Shard_t m_Shards[SHARD_COUNT];
+	std::atomic<size_t> m_nNextPruneShard = 0;
+	std::atomic<uint64_t> m_nLoads = 0;
+	std::atomic<uint64_t> m_nLoadTimeMicroseconds = 0;
+	std::atomic<uint64_t> m_nEvictions = 0;
+	std::atomic<uint64_t> m_nEvictedBytes = 0;
+};
@@ -0,0 +1,22 @@
+#include "CMeshHandle.hpp"
+
+#include "IResourceManager.hpp"
+
+std::shared_ptr<CMesh> CMeshHandle::Get() const {
+	if (!m_pRequest) {
+		return nullptr;
+	}
+
+	switch (m_pRequest->eState.load(std::memory_order_acquire)) {
+	case MESH_LOAD_READY:
+		m_pRequest->pMesh->Touch(IResourceManager::GetInstance().GetFrameIndex());
+		return m_pRequest->pMesh;
+
+	case MESH_LOAD_EVICTED:
+		IResourceManager::GetInstance().RequestReload(m_pRequest);
+		return nullptr;
+
+	default:
+		return nullptr;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "../../render/mesh/CMesh.hpp"
+
+enum EMeshLoadState {
+	MESH_LOAD_PENDING,
+	MESH_LOAD_READY,
+	MESH_LOAD_FAILED,
+	MESH_LOAD_EVICTED // Dropped to stay within the memory budget, reloads on the next Get()
+};
+
+// One asynchronous mesh load and the residency of its result, shared by every handle that asked for the same path.
+struct MeshRequest_t {
+	std::string strFilePath;
+	std::shared_ptr<CMesh> pMesh;
+	std::atomic<bool> bPinCPUData = false;
+
+	// What the render thread sees; only changes at IResourceManager::ProcessPendingLoads.
+	std::atomic<EMeshLoadState> eState = MESH_LOAD_PENDING;
+
+	// Taken by whoever runs the queued load: the job, or a GetMesh that got there before a worker did.
+	std::atomic<bool> bLoadClaimed = false;
+
+	// Worker side: set once the CPU data is loaded (or failed to load).
+	std::mutex Mutex;
+	std::condition_variable Loaded;
+	bool bLoaded = false;
+	bool bLoadSucceeded = false;
+};
+
+class CMeshHandle {
+public:
+	CMeshHandle() = default;
+	explicit CMeshHandle(std::shared_ptr<MeshRequest_t> pRequest) : m_pRequest(std::move(pRequest)) {}
+
+	bool IsValid() const { return m_pRequest != nullptr; }
+	EMeshLoadState GetState() const { return m_pRequest ? m_pRequest->eState.load(std::memory_order_acquire) : MESH_LOAD_FAILED; }
+	bool IsReady() const { return GetState() == MESH_LOAD_READY; }
+	bool IsFailed() const { return GetState() == MESH_LOAD_FAILED; }
+
+	// Null until the mesh became ready at a sync point; its GPU buffers exist by then.
+	// Marks the mesh as used this frame, and requests a reload if it has been evicted.
+	std::shared_ptr<CMesh> Get() const;
+	const std::string& GetFilePath() const { static const std::string strEmpty; return m_pRequest ? m_pRequest->strFilePath : strEmpty; }
+
+private:
+	std::shared_ptr<MeshRequest_t> m_pRequest;
+};
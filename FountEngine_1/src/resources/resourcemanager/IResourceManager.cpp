@@ -1,26 +1,324 @@
 #include "IResourceManager.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 #include "../../system/logging/CLogSystem.hpp"
+#include "../../render/mesh/CMeshFile.hpp"
+#include "../../system/profiler/CProfiler.hpp"
 
 IResourceManager& IResourceManager::GetInstance() {
     static IResourceManager nInstance;
     return nInstance;
 }
 
+// The job system has to outlive the loads it runs, so make sure it is constructed (and destroyed) around us.
+IResourceManager::IResourceManager() {
+    CJobSystem::GetInstance();
+}
+
+IResourceManager::~IResourceManager() {
+    m_bShuttingDown = true;
+    CJobSystem::GetInstance().Wait(m_LoadCounter);
+}
+
 std::shared_ptr<CMesh> IResourceManager::GetMesh(const std::string& strFilePath) {
-    auto it = m_MeshCache.find(strFilePath);
-    if (it != m_MeshCache.end()) {
-        if (auto mesh = it->second.lock()) {
-            return mesh;
+    // The cache only holds meshes earlier GetMesh calls loaded. Meshes of async requests are released
+    // and evicted at the sync point, which mustn't happen to one the caller owns.
+    CMeshCache::Key_t Key(strFilePath);
+    if (auto cachedMesh = m_MeshCache.Find(Key)) {
+        return cachedMesh;
+    }
+
+    std::shared_ptr<MeshRequest_t> pRequest;
+    {
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        auto it = m_Requests.find(strFilePath);
+        if (it != m_Requests.end()) {
+            pRequest = it->second.lock();
         }
     }
 
+    // Don't parse the file a second time if a worker is already on it: wait for its CPU data and copy it.
+    // MakeResident releases the data under the same lock. A load still in the job queue is run here
+    // instead, since on a worker thread the one that would pick it up may be this one.
     auto newMesh = std::make_shared<CMesh>();
-    if (newMesh->LoadFromOBJ(strFilePath)) {
-        m_MeshCache[strFilePath] = newMesh;
-        return newMesh;
+    bool bCopied = false;
+    if (pRequest) {
+        std::unique_lock<std::mutex> lock(pRequest->Mutex);
+        while (!pRequest->bLoaded) {
+            if (!pRequest->bLoadClaimed.load(std::memory_order_acquire)) {
+                lock.unlock();
+                LoadJob(pRequest);
+                lock.lock();
+                continue;
+            }
+            pRequest->Loaded.wait(lock);
+        }
+        if (pRequest->bLoadSucceeded && pRequest->pMesh && pRequest->pMesh->HasCPUData()) {
+            newMesh->CopyCPUData(*pRequest->pMesh);
+            bCopied = true;
+        }
+    }
+
+    if (!bCopied && !LoadMeshData(*newMesh, strFilePath)) {
+        LOG_WARNING_CH(RESOURCES, "Failed to get mesh from %s", strFilePath.c_str());
+        return nullptr;
+    }
+
+    m_MeshCache.Insert(Key, newMesh);
+    return newMesh;
+}
+
+CMeshHandle IResourceManager::GetMeshAsync(const std::string& strFilePath, bool bPinCPUData) {
+    std::lock_guard<std::mutex> lock(m_LoadMutex);
+
+    auto it = m_Requests.find(strFilePath);
+    if (it != m_Requests.end()) {
+        if (auto pRequest = it->second.lock()) {
+            // Pinning only affects uploads from now on; data released earlier comes back with the next reload.
+            if (bPinCPUData) {
+                pRequest->bPinCPUData = true;
+            }
+            if (pRequest->eState.load(std::memory_order_acquire) == MESH_LOAD_EVICTED) {
+                QueueLoad(pRequest);
+            }
+            return CMeshHandle(pRequest);
+        }
+    }
+
+    auto pRequest = std::make_shared<MeshRequest_t>();
+    pRequest->strFilePath = strFilePath;
+    pRequest->bPinCPUData = bPinCPUData;
+    m_Requests[strFilePath] = pRequest;
+
+    // Meshes already loaded through GetMesh skip the load job and go straight to the sync point with a
+    // copy of their CPU data. The GetMesh owners keep theirs, untouched by residency.
+    if (auto cachedMesh = m_MeshCache.Find(CMeshCache::Key_t(strFilePath)); cachedMesh && cachedMesh->HasCPUData()) {
+        pRequest->pMesh = std::make_shared<CMesh>();
+        pRequest->pMesh->CopyCPUData(*cachedMesh);
+        pRequest->bLoaded = pRequest->bLoadSucceeded = true;
+        pRequest->bLoadClaimed = true;
+        m_Completed.push_back(pRequest);
+        return CMeshHandle(pRequest);
+    }
+
+    QueueLoad(pRequest);
+    return CMeshHandle(pRequest);
+}
+
+void IResourceManager::RequestReload(const std::shared_ptr<MeshRequest_t>& pRequest) {
+    std::lock_guard<std::mutex> lock(m_LoadMutex);
+    if (pRequest->eState.load(std::memory_order_acquire) == MESH_LOAD_EVICTED) {
+        QueueLoad(pRequest);
+    }
+}
+
+void IResourceManager::QueueLoad(const std::shared_ptr<MeshRequest_t>& pRequest) {
+    // Pinned meshes keep their CPU data through eviction; only their buffers have to be created again.
+    bool bHasCPUData;
+    {
+        std::lock_guard<std::mutex> lock(pRequest->Mutex);
+        bHasCPUData = pRequest->pMesh && pRequest->pMesh->HasCPUData();
+        pRequest->bLoaded = bHasCPUData;
+        pRequest->bLoadSucceeded = bHasCPUData;
+        pRequest->bLoadClaimed.store(bHasCPUData, std::memory_order_release);
+    }
+    pRequest->eState.store(MESH_LOAD_PENDING, std::memory_order_release);
+
+    if (bHasCPUData) {
+        m_Completed.push_back(pRequest);
+        return;
+    }
+
+    CJobSystem::GetInstance().Run([this, pRequest] { LoadJob(pRequest); }, &m_LoadCounter);
+}
+
+void IResourceManager::ProcessPendingLoads(IRenderBackend& Backend) {
+    PROFILE_FUNCTION();
+
+    uint64_t nFrame = m_nFrameIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // Amortized cleanup: one cache shard per frame, dead request entries every few seconds.
+    m_MeshCache.PruneNextShard();
+
+    std::vector<std::shared_ptr<MeshRequest_t>> Completed;
+    {
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        Completed.swap(m_Completed);
+
+        if (nFrame % 256 == 0) {
+            std::erase_if(m_Requests, [](const auto& Entry) { return Entry.second.expired(); });
+        }
+    }
+
+    for (const auto& pRequest : Completed) {
+        bool bSuccess = pRequest->bLoadSucceeded && pRequest->pMesh->CreateBuffers(Backend);
+        if (bSuccess) {
+            MakeResident(pRequest);
+        }
+        else {
+            LOG_WARNING_CH(RESOURCES, "Failed to get mesh from %s", pRequest->strFilePath.c_str());
+        }
+
+        pRequest->eState.store(bSuccess ? MESH_LOAD_READY : MESH_LOAD_FAILED, std::memory_order_release);
+    }
+
+    EnforceMemoryBudget();
+}
+
+void IResourceManager::MakeResident(const std::shared_ptr<MeshRequest_t>& pRequest) {
+    CMesh& Mesh = *pRequest->pMesh;
+    {
+        std::lock_guard<std::mutex> lock(pRequest->Mutex);
+        if (pRequest->bPinCPUData) {
+            Mesh.SetCPUDataPinned(true);
+        }
+        if (!Mesh.IsCPUDataPinned()) {
+            Mesh.ReleaseCPUData();
+        }
     }
 
-    LOG_WARNING("Failed to get mesh from %s", strFilePath.c_str());
-    return nullptr;
-}
\ No newline at end of file
+    Mesh.Touch(GetFrameIndex());
+
+    auto it = std::find_if(m_ResidentMeshes.begin(), m_ResidentMeshes.end(), [&](const ResidentMesh_t& Resident) {
+        return Resident.pRequest == pRequest;
+    });
+    if (it != m_ResidentMeshes.end()) {
+        m_nResidentMeshMemory -= it->nBytes;
+        m_ResidentMeshes.erase(it);
+    }
+
+    size_t nBytes = Mesh.GetGPUMemoryUsage() + Mesh.GetCPUMemoryUsage();
+    m_ResidentMeshes.push_back({ pRequest, nBytes });
+    m_nResidentMeshMemory += nBytes;
+}
+
+void IResourceManager::EnforceMemoryBudget() {
+    if (m_nResidentMeshMemory <= m_nMeshMemoryBudget) {
+        m_bWorkingSetOverBudget = false;
+        return;
+    }
+
+    std::sort(m_ResidentMeshes.begin(), m_ResidentMeshes.end(), [](const ResidentMesh_t& a, const ResidentMesh_t& b) {
+        return a.pRequest->pMesh->GetLastUsedFrame() < b.pRequest->pMesh->GetLastUsedFrame();
+    });
+
+    // Anything drawn last frame is the working set; evicting it would just reload it next frame.
+    const uint64_t nFrame = GetFrameIndex();
+    size_t nEvicted = 0;
+
+    for (ResidentMesh_t& Resident : m_ResidentMeshes) {
+        if (m_nResidentMeshMemory <= m_nMeshMemoryBudget) {
+            break;
+        }
+
+        if (Resident.pRequest->pMesh->GetLastUsedFrame() + 1 >= nFrame) {
+            continue;
+        }
+
+        LOG_DEBUG_CH(RESOURCES, "Evicting mesh %s (%zu bytes)", Resident.pRequest->strFilePath.c_str(), Resident.nBytes);
+        Evict(Resident);
+        ++nEvicted;
+    }
+
+    if (nEvicted > 0) {
+        std::erase_if(m_ResidentMeshes, [](const ResidentMesh_t& Resident) { return !Resident.pRequest; });
+    }
+
+    // Warn once per overrun rather than every frame.
+    if (m_nResidentMeshMemory > m_nMeshMemoryBudget && !m_bWorkingSetOverBudget) {
+        m_bWorkingSetOverBudget = true;
+        LOG_WARNING_CH(RESOURCES, "Mesh working set (%zu bytes) exceeds the memory budget (%zu bytes)", m_nResidentMeshMemory, m_nMeshMemoryBudget);
+    }
+}
+
+void IResourceManager::Evict(ResidentMesh_t& Resident) {
+    MeshRequest_t& Request = *Resident.pRequest;
+
+    // Done with the mesh before EVICTED is published. Once it is, GetMeshAsync or RequestReload may queue
+    // a new load on another thread, whose pMesh mustn't be touched here. A pinned mesh stays with the
+    // request, CPU data and all, for that reload to upload again.
+    std::shared_ptr<CMesh> pMesh;
+    bool bPinned;
+    {
+        std::lock_guard<std::mutex> lock(Request.Mutex);
+        pMesh = Request.pMesh;
+        pMesh->ReleaseBuffers();
+        bPinned = Request.bPinCPUData;
+        if (!bPinned) {
+            Request.pMesh.reset();
+        }
+        Request.eState.store(MESH_LOAD_EVICTED, std::memory_order_release);
+    }
+
+    if (!bPinned) {
+        pMesh->ReleaseCPUData();
+    }
+
+    m_nResidentMeshMemory -= Resident.nBytes;
+    m_MeshCache.RecordEviction(Resident.nBytes);
+    Resident.pRequest.reset();
+}
+
+void IResourceManager::ReleaseGPUResources() {
+    for (ResidentMesh_t& Resident : m_ResidentMeshes) {
+        Evict(Resident);
+    }
+    m_ResidentMeshes.clear();
+}
+
+bool IResourceManager::LoadMeshData(CMesh& Mesh, const std::string& strFilePath) {
+    auto tStart = std::chrono::steady_clock::now();
+    auto RecordLoad = [&] {
+        m_MeshCache.RecordLoad(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count()));
+    };
+    Mesh.SetVertexPacking(m_bPackVerticesOnLoad);
+
+    // Cooked meshes are already optimized, have their LODs and meshlets and map straight into memory.
+    std::string strCookedPath = CMeshFile::GetCookedPath(strFilePath);
+    if (CMeshFile::IsUpToDate(strCookedPath, strFilePath) && Mesh.LoadFromCooked(strCookedPath)) {
+        RecordLoad();
+        return true;
+    }
+
+    if (!Mesh.LoadFromOBJ(strFilePath)) {
+        return false;
+    }
+
+    if (m_bGenerateLODsOnLoad) {
+        Mesh.GenerateLODs();
+    }
+    if (m_bOptimizeMeshesOnLoad) {
+        Mesh.Optimize();
+    }
+
+    if (m_bBuildMeshletsOnLoad) {
+        Mesh.BuildMeshlets();
+    }
+
+    RecordLoad();
+    return true;
+}
+
+void IResourceManager::LoadJob(const std::shared_ptr<MeshRequest_t>& pRequest) {
+    // Already run by GetMesh.
+    if (pRequest->bLoadClaimed.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    auto pMesh = std::make_shared<CMesh>();
+    bool bSuccess = !m_bShuttingDown && LoadMeshData(*pMesh, pRequest->strFilePath);
+
+    {
+        std::lock_guard<std::mutex> lock(pRequest->Mutex);
+        pRequest->pMesh = std::move(pMesh);
+        pRequest->bLoadSucceeded = bSuccess;
+        pRequest->bLoaded = true;
+    }
+    pRequest->Loaded.notify_all();
+
+    std::lock_guard<std::mutex> lock(m_LoadMutex);
+    m_Completed.push_back(pRequest);
+}
@@ -2,17 +2,94 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
 
+#include "CMeshHandle.hpp"
+#include "CMeshCache.hpp"
 #include "../../render/mesh/CMesh.hpp"
+#include "../../system/jobs/CJobSystem.hpp"
 
 class IResourceManager {
 public:
+	static constexpr size_t DEFAULT_MESH_MEMORY_BUDGET = 512ull * 1024 * 1024;
+
 	static IResourceManager& GetInstance();
+
+	// Synchronous load for tools and one-off use. The caller owns the result: it keeps its CPU data
+	// and doesn't count against the residency budget. It is never the mesh of an async request,
+	// at most a copy of one's CPU data. Fine to call from a job: joining an async load that hasn't
+	// started yet runs it on the calling thread.
 	std::shared_ptr<CMesh> GetMesh(const std::string& strFilePath);
 
+	// Loads as a job on the job system. Requests for a path that is already loading join that load.
+	// CPU data is released once the GPU buffers exist, unless bPinCPUData is set (e.g. for collision).
+	// Pinning keeps only the CPU copy: the GPU buffers are evicted like any others and recreated from it.
+	CMeshHandle GetMeshAsync(const std::string& strFilePath, bool bPinCPUData = false);
+
+	// Sync point for asynchronous loads, call once per frame on the thread that owns the device:
+	// creates GPU buffers for finished loads and only then makes the meshes visible through their handles,
+	// then evicts least recently used meshes while over the memory budget.
+	void ProcessPendingLoads(IRenderBackend& Backend);
+
+	// Evicts every resident mesh. Call before destroying the backend their buffers were created with.
+	void ReleaseGPUResources();
+
+	// Called by CMeshHandle::Get() for evicted meshes.
+	void RequestReload(const std::shared_ptr<MeshRequest_t>& pRequest);
+
+	void SetOptimizeMeshesOnLoad(bool bEnabled) { m_bOptimizeMeshesOnLoad = bEnabled; }
+	// Uncooked meshes only; cooked ones carry the LODs they were cooked with.
+	void SetGenerateLODsOnLoad(bool bEnabled) { m_bGenerateLODsOnLoad = bEnabled; }
+	void SetBuildMeshletsOnLoad(bool bEnabled) { m_bBuildMeshletsOnLoad = bEnabled; }
+	// GPU buffers of meshes loaded from now on hold PackedVertex_t; see CMesh::SetVertexPacking.
+	void SetPackVerticesOnLoad(bool bEnabled) { m_bPackVerticesOnLoad = bEnabled; }
+	void SetMeshMemoryBudget(size_t nBytes) { m_nMeshMemoryBudget = nBytes; }
+	size_t GetMeshMemoryBudget() const { return m_nMeshMemoryBudget; }
+	size_t GetResidentMeshMemory() const { return m_nResidentMeshMemory; }
+
+	uint64_t GetFrameIndex() const { return m_nFrameIndex.load(std::memory_order_relaxed); }
+	CMeshCache::Stats_t GetMeshCacheStats() const { return m_MeshCache.GetStats(); }
+
 private:
-	IResourceManager() = default;
-	~IResourceManager() = default;
+	IResourceManager();
+	~IResourceManager();
+
+	bool LoadMeshData(CMesh& Mesh, const std::string& strFilePath);
+
+	// m_LoadMutex must be held.
+	void QueueLoad(const std::shared_ptr<MeshRequest_t>& pRequest);
+
+	void MakeResident(const std::shared_ptr<MeshRequest_t>& pRequest);
+	void EnforceMemoryBudget();
+
+	void LoadJob(const std::shared_ptr<MeshRequest_t>& pRequest);
+
+	std::atomic<bool> m_bOptimizeMeshesOnLoad = true;
+	std::atomic<bool> m_bGenerateLODsOnLoad = true;
+	std::atomic<bool> m_bBuildMeshletsOnLoad = true;
+	std::atomic<bool> m_bPackVerticesOnLoad = true;
+	CMeshCache m_MeshCache;
+
+	// Async loading. m_Requests maps every path with live handles to its shared request.
+	std::mutex m_LoadMutex;
+	std::unordered_map<std::string, std::weak_ptr<MeshRequest_t>> m_Requests;
+	std::vector<std::shared_ptr<MeshRequest_t>> m_Completed;
+	CJobCounter m_LoadCounter;
+	std::atomic<bool> m_bShuttingDown = false;
+
+	// Residency, only touched at the sync point.
+	struct ResidentMesh_t {
+		std::shared_ptr<MeshRequest_t> pRequest;
+		size_t nBytes;
+	};
+
+	void Evict(ResidentMesh_t& Resident);
 
-	std::unordered_map<std::string, std::weak_ptr<CMesh>> m_MeshCache;
-};
\ No newline at end of file
+	std::vector<ResidentMesh_t> m_ResidentMeshes;
+	size_t m_nResidentMeshMemory = 0;
+	size_t m_nMeshMemoryBudget = DEFAULT_MESH_MEMORY_BUDGET;
+	bool m_bWorkingSetOverBudget = false;
+	std::atomic<uint64_t> m_nFrameIndex = 0;
+};
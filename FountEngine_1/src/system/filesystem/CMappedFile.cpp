@@ -0,0 +1,111 @@
+#include "CMappedFile.hpp"
+
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+CMappedFile::CMappedFile() = default;
+CMappedFile::~CMappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+bool CMappedFile::Open(const std::string& strFilePath) {
+	Close();
+
+	HANDLE hFile = CreateFileA(strFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER liSize;
+	if (!GetFileSizeEx(hFile, &liSize)) {
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_hFile = hFile;
+	m_nSize = static_cast<size_t>(liSize.QuadPart);
+	m_bOpen = true;
+
+	// Zero-length files can't be mapped, but they are still valid (empty) files.
+	if (m_nSize == 0) {
+		return true;
+	}
+
+	m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_hMapping) {
+		Close();
+		return false;
+	}
+
+	m_pData = MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_pData) {
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void CMappedFile::Close() {
+	if (m_pData) UnmapViewOfFile(m_pData);
+	if (m_hMapping) CloseHandle(m_hMapping);
+	if (m_hFile) CloseHandle(m_hFile);
+
+	m_pData = nullptr;
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+	m_nSize = 0;
+	m_bOpen = false;
+}
+#else
+bool CMappedFile::Open(const std::string& strFilePath) {
+	Close();
+
+	int nFileDescriptor = open(strFilePath.c_str(), O_RDONLY);
+	if (nFileDescriptor < 0) {
+		return false;
+	}
+
+	struct stat FileStat;
+	if (fstat(nFileDescriptor, &FileStat) != 0) {
+		close(nFileDescriptor);
+		return false;
+	}
+
+	m_nFileDescriptor = nFileDescriptor;
+	m_nSize = static_cast<size_t>(FileStat.st_size);
+	m_bOpen = true;
+
+	if (m_nSize == 0) {
+		return true;
+	}
+
+	void* pData = mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, nFileDescriptor, 0);
+	if (pData == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	madvise(pData, m_nSize, MADV_SEQUENTIAL);
+	m_pData = pData;
+	return true;
+}
+
+void CMappedFile::Close() {
+	if (m_pData) munmap(m_pData, m_nSize);
+	if (m_nFileDescriptor >= 0) close(m_nFileDescriptor);
+
+	m_pData = nullptr;
+	m_nFileDescriptor = -1;
+	m_nSize = 0;
+	m_bOpen = false;
+}
+#endif
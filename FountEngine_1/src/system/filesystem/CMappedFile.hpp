@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Read-only view of a whole file. The data stays valid until Close() or destruction.
+class CMappedFile {
+public:
+	CMappedFile();
+	~CMappedFile();
+
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+
+	bool Open(const std::string& strFilePath);
+	void Close();
+
+	bool IsOpen() const { return m_bOpen; }
+	const char* GetData() const { return static_cast<const char*>(m_pData); }
+	size_t GetSize() const { return m_nSize; }
+
+private:
+	bool m_bOpen = false;
+	void* m_pData = nullptr;
+	size_t m_nSize = 0;
+
+#ifdef _WIN32
+	void* m_hFile = nullptr;
+	void* m_hMapping = nullptr;
+#else
+	int m_nFileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,238 @@
+#include "CJobSystem.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "../profiler/CProfiler.hpp"
+
+namespace {
+	thread_local const CJobSystem* t_pJobSystem = nullptr;
+	thread_local int t_nQueueIndex = -1;
+}
+
+CJobSystem& CJobSystem::GetInstance() {
+	static CJobSystem Instance;
+	return Instance;
+}
+
+CJobSystem::CJobSystem(unsigned int nThreads) {
+	if (nThreads == 0) {
+		// At least one worker, so jobs make progress while the main thread blocks outside of Wait().
+		nThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	}
+
+	for (unsigned int i = 0; i < nThreads; ++i) {
+		m_Queues.push_back(std::make_unique<CWorkStealingDeque<Job_t, QUEUE_CAPACITY>>());
+	}
+
+	m_pPreviousSystem = t_pJobSystem;
+	m_nPreviousQueue = t_nQueueIndex;
+	t_pJobSystem = this;
+	t_nQueueIndex = 0;
+
+	for (unsigned int i = 1; i < nThreads; ++i) {
+		m_Workers.emplace_back(&CJobSystem::WorkerMain, this, i);
+	}
+}
+
+CJobSystem::~CJobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_bStop = true;
+	}
+	m_SleepCondition.notify_all();
+
+	// Workers only exit once nothing is queued. What is left was queued after the last one exited, or
+	// there were no workers; running it still releases its counter and continuations.
+	for (auto& Worker : m_Workers) {
+		Worker.join();
+	}
+
+	while (Job_t* pJob = FindJob()) {
+		Execute(pJob);
+	}
+
+	if (t_pJobSystem == this) {
+		t_pJobSystem = m_pPreviousSystem;
+		t_nQueueIndex = m_nPreviousQueue;
+	}
+}
+
+void CJobSystem::Run(std::function<void()> Function, CJobCounter* pCounter) {
+	if (pCounter) {
+		pCounter->m_nPending.fetch_add(1, std::memory_order_relaxed);
+	}
+	Submit(new Job_t{ std::move(Function), pCounter });
+}
+
+void CJobSystem::RunAfter(CJobCounter& Dependency, std::function<void()> Function, CJobCounter* pCounter) {
+	if (pCounter) {
+		pCounter->m_nPending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job_t* pJob = new Job_t{ std::move(Function), pCounter };
+	{
+		// Execute() takes the same lock before releasing the continuations, so the job can't be missed.
+		std::lock_guard<std::mutex> lock(Dependency.m_Mutex);
+		if (!Dependency.IsDone()) {
+			Dependency.m_Continuations.push_back(pJob);
+			return;
+		}
+	}
+	Submit(pJob);
+}
+
+void CJobSystem::ParallelFor(size_t nBegin, size_t nEnd, size_t nGrainSize, const std::function<void(size_t, size_t)>& Function) {
+	if (nBegin >= nEnd) {
+		return;
+	}
+
+	const size_t nCount = nEnd - nBegin;
+	if (nGrainSize == 0) {
+		// A few chunks per thread so stealing can even out uneven chunks.
+		nGrainSize = std::max<size_t>(1, nCount / (GetThreadCount() * 4));
+	}
+
+	if (nCount <= nGrainSize) {
+		Function(nBegin, nEnd);
+		return;
+	}
+
+	CJobCounter Counter;
+	size_t nChunkBegin = nBegin;
+	for (; nChunkBegin + nGrainSize < nEnd; nChunkBegin += nGrainSize) {
+		const size_t nChunkEnd = nChunkBegin + nGrainSize;
+		Run([&Function, nChunkBegin, nChunkEnd] { Function(nChunkBegin, nChunkEnd); }, &Counter);
+	}
+
+	// The caller takes the last chunk itself, then helps with the rest.
+	Function(nChunkBegin, nEnd);
+	Wait(Counter);
+}
+
+void CJobSystem::Wait(CJobCounter& Counter) {
+	while (!Counter.IsDone()) {
+		if (Job_t* pJob = FindJob()) {
+			Execute(pJob);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(Counter.m_Mutex);
+}
+
+int CJobSystem::GetCurrentQueue() const {
+	return t_pJobSystem == this ? t_nQueueIndex : -1;
+}
+
+void CJobSystem::Submit(Job_t* pJob) {
+	// seq_cst pairs with the m_nSleeping increment in WorkerMain(), so either the worker sees the job or we see the sleeper.
+	m_nQueuedJobs.fetch_add(1);
+
+	// Foreign threads and full deques go through the shared queue. Running the job inline instead
+	// could deadlock a caller that submits while holding a lock the job needs.
+	const int nQueue = GetCurrentQueue();
+	if (nQueue < 0 || !m_Queues[nQueue]->Push(pJob)) {
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		m_SharedQueue.push_back(pJob);
+		m_nSharedJobs.fetch_add(1, std::memory_order_release);
+	}
+
+	if (m_nSleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_SleepCondition.notify_one();
+	}
+}
+
+Job_t* CJobSystem::FindJob() {
+	const int nQueue = GetCurrentQueue();
+	Job_t* pJob = nullptr;
+
+	if (nQueue >= 0) {
+		pJob = m_Queues[nQueue]->Pop();
+	}
+
+	if (!pJob && m_nSharedJobs.load(std::memory_order_acquire) > 0) {
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		if (!m_SharedQueue.empty()) {
+			pJob = m_SharedQueue.front();
+			m_SharedQueue.pop_front();
+			m_nSharedJobs.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (!pJob) {
+		// Start at a different victim per thread so thieves don't all hit the same deque.
+		const size_t nQueueCount = m_Queues.size();
+		const size_t nStart = nQueue >= 0 ? static_cast<size_t>(nQueue) + 1 : 0;
+		for (size_t i = 0; i < nQueueCount && !pJob; ++i) {
+			const size_t nVictim = (nStart + i) % nQueueCount;
+			if (static_cast<int>(nVictim) != nQueue) {
+				pJob = m_Queues[nVictim]->Steal();
+			}
+		}
+	}
+
+	if (pJob) {
+		m_nQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return pJob;
+}
+
+void CJobSystem::Execute(Job_t* pJob) {
+	pJob->Function();
+
+	CJobCounter* pCounter = pJob->pCounter;
+	delete pJob;
+
+	if (pCounter) {
+		// Decrement under the lock: Wait() takes it once more before returning, so the counter
+		// can't be destroyed while we still touch it.
+		std::vector<Job_t*> Continuations;
+		{
+			std::lock_guard<std::mutex> lock(pCounter->m_Mutex);
+			if (pCounter->m_nPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				Continuations.swap(pCounter->m_Continuations);
+			}
+		}
+
+		for (Job_t* pContinuation : Continuations) {
+			Submit(pContinuation);
+		}
+	}
+}
+
+void CJobSystem::WorkerMain(unsigned int nIndex) {
+	t_pJobSystem = this;
+	t_nQueueIndex = static_cast<int>(nIndex);
+	PROFILE_THREAD_NAME("Job Worker " + std::to_string(nIndex));
+
+	while (true) {
+		if (Job_t* pJob = FindJob()) {
+			Execute(pJob);
+			continue;
+		}
+
+		// Nothing to run. Spin briefly since more work usually follows within microseconds, then sleep.
+		bool bFound = false;
+		for (int i = 0; i < 64 && !bFound; ++i) {
+			std::this_thread::yield();
+			bFound = m_nQueuedJobs.load(std::memory_order_acquire) > 0;
+		}
+		if (bFound) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_nSleeping.fetch_add(1);
+		m_SleepCondition.wait(lock, [this] { return m_bStop || m_nQueuedJobs.load() > 0; });
+		m_nSleeping.fetch_sub(1, std::memory_order_acq_rel);
+
+		// Stopping drains the queues first; a job that queues more runs on a thread that is still awake.
+		if (m_bStop && m_nQueuedJobs.load() == 0) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CWorkStealingDeque.hpp"
+
+struct Job_t;
+
+// Counts unfinished jobs. Pass it to Run() for every job of a batch, then Wait() on it,
+// or make further jobs depend on it with RunAfter(). Only destroy it after Wait() returned.
+class CJobCounter {
+public:
+	CJobCounter() = default;
+	CJobCounter(const CJobCounter&) = delete;
+	CJobCounter& operator=(const CJobCounter&) = delete;
+
+	bool IsDone() const { return m_nPending.load(std::memory_order_acquire) == 0; }
+	int GetPending() const { return m_nPending.load(std::memory_order_acquire); }
+
+private:
+	friend class CJobSystem;
+
+	std::atomic<int> m_nPending = 0;
+	std::mutex m_Mutex;
+	std::vector<Job_t*> m_Continuations;
+};
+
+struct Job_t {
+	std::function<void()> Function;
+	CJobCounter* pCounter = nullptr;
+};
+
+// One worker thread per remaining core, each with its own work-stealing deque. The thread that created the
+// job system (the main thread) owns deque 0 and runs jobs while it waits; other threads submit through a shared queue.
+class CJobSystem {
+public:
+	// The engine-wide job system, sized to the machine.
+	static CJobSystem& GetInstance();
+
+	// A separate job system of nThreads threads including the calling thread, 0 for one per core. The
+	// caller owns its deque 0 until it is destroyed, which must happen on the same thread.
+	explicit CJobSystem(unsigned int nThreads = 0);
+	// Runs every job still queued, then joins the workers, so no counter is left waiting.
+	~CJobSystem();
+
+	CJobSystem(const CJobSystem&) = delete;
+	CJobSystem& operator=(const CJobSystem&) = delete;
+
+	void Run(std::function<void()> Function, CJobCounter* pCounter = nullptr);
+
+	// Queues Function once Dependency reaches zero.
+	void RunAfter(CJobCounter& Dependency, std::function<void()> Function, CJobCounter* pCounter = nullptr);
+
+	// Calls Function(nChunkBegin, nChunkEnd) over [nBegin, nEnd) in chunks of nGrainSize (0 picks one)
+	// and returns once all of them finished. The calling thread takes part.
+	void ParallelFor(size_t nBegin, size_t nEnd, size_t nGrainSize, const std::function<void(size_t, size_t)>& Function);
+
+	// Runs pending jobs until the counter reaches zero instead of blocking.
+	void Wait(CJobCounter& Counter);
+
+	// Threads that execute jobs, including the owner thread.
+	unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_Queues.size()); }
+
+private:
+	static constexpr size_t QUEUE_CAPACITY = 4096;
+
+	void Submit(Job_t* pJob);
+	Job_t* FindJob();
+	void Execute(Job_t* pJob);
+	void WorkerMain(unsigned int nIndex);
+
+	int GetCurrentQueue() const;
+
+	std::vector<std::unique_ptr<CWorkStealingDeque<Job_t, QUEUE_CAPACITY>>> m_Queues;
+	std::vector<std::thread> m_Workers;
+
+	// The creating thread's previous job system, given its deque back on destruction.
+	const CJobSystem* m_pPreviousSystem = nullptr;
+	int m_nPreviousQueue = -1;
+
+	// Jobs from threads that don't own a deque.
+	std::mutex m_SharedMutex;
+	std::deque<Job_t*> m_SharedQueue;
+	std::atomic<size_t> m_nSharedJobs = 0;
+
+	// Idle workers sleep until the number of queued jobs goes up.
+	std::atomic<int> m_nQueuedJobs = 0;
+	std::atomic<int> m_nSleeping = 0;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_SleepCondition;
+	bool m_bStop = false;
+};
\ No newline at end of file
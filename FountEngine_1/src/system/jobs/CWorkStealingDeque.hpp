@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size Chase-Lev deque. The owning worker pushes and pops at the bottom (LIFO, cache-warm),
+// other threads steal from the top (FIFO, the oldest and usually largest pieces of work).
+template <typename T, size_t CAPACITY>
+class CWorkStealingDeque {
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CWorkStealingDeque capacity must be a power of two");
+
+public:
+	// Owner only. False when full.
+	bool Push(T* pItem) {
+		const int64_t nBottom = m_nBottom.load(std::memory_order_relaxed);
+		const int64_t nTop = m_nTop.load(std::memory_order_acquire);
+		if (nBottom - nTop >= static_cast<int64_t>(CAPACITY)) {
+			return false;
+		}
+
+		m_Items[nBottom & (CAPACITY - 1)].store(pItem, std::memory_order_relaxed);
+		m_nBottom.store(nBottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Owner only.
+	T* Pop() {
+		const int64_t nBottom = m_nBottom.load(std::memory_order_relaxed) - 1;
+		m_nBottom.store(nBottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t nTop = m_nTop.load(std::memory_order_relaxed);
+
+		if (nTop > nBottom) {
+			m_nBottom.store(nBottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T* pItem = m_Items[nBottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (nTop == nBottom) {
+			// Last item, race the thieves for it.
+			if (!m_nTop.compare_exchange_strong(nTop, nTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				pItem = nullptr;
+			}
+			m_nBottom.store(nBottom + 1, std::memory_order_relaxed);
+		}
+		return pItem;
+	}
+
+	// Any thread.
+	T* Steal() {
+		int64_t nTop = m_nTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t nBottom = m_nBottom.load(std::memory_order_acquire);
+
+		if (nTop >= nBottom) {
+			return nullptr;
+		}
+
+		T* pItem = m_Items[nTop & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!m_nTop.compare_exchange_strong(nTop, nTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return pItem;
+	}
+
+	bool IsEmpty() const {
+		return m_nTop.load(std::memory_order_relaxed) >= m_nBottom.load(std::memory_order_relaxed);
+	}
+
+private:
+	alignas(64) std::atomic<int64_t> m_nTop = 0;
+	alignas(64) std::atomic<int64_t> m_nBottom = 0;
+	alignas(64) std::atomic<T*> m_Items[CAPACITY] = {};
+};
@@ -0,0 +1,95 @@
+#include "CLogConsole.hpp"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+	WORD ToAttributes(CLogConsole::EColor eColor) {
+		switch (eColor) {
+		case CLogConsole::COLOR_DEBUG: return 8;
+		case CLogConsole::COLOR_INFO: return 10;
+		case CLogConsole::COLOR_WARNING: return 14;
+		case CLogConsole::COLOR_ERROR: return 12;
+		case CLogConsole::COLOR_FATAL: return 13;
+		default: return 7;
+		}
+	}
+#else
+	const char* ToEscapeSequence(CLogConsole::EColor eColor) {
+		switch (eColor) {
+		case CLogConsole::COLOR_DEBUG: return "\x1b[90m";
+		case CLogConsole::COLOR_INFO: return "\x1b[92m";
+		case CLogConsole::COLOR_WARNING: return "\x1b[93m";
+		case CLogConsole::COLOR_ERROR: return "\x1b[91m";
+		case CLogConsole::COLOR_FATAL: return "\x1b[95m";
+		default: return "\x1b[0m";
+		}
+	}
+#endif
+}
+
+CLogConsole::CLogConsole() {
+#ifdef _WIN32
+	m_hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+	m_bTerminal = m_hConsole != nullptr && m_hConsole != INVALID_HANDLE_VALUE;
+#else
+	m_bTerminal = isatty(STDOUT_FILENO) != 0;
+#endif
+}
+
+void CLogConsole::Allocate([[maybe_unused]] const char* szTitle) {
+#ifdef _WIN32
+	if (AllocConsole()) {
+		FILE* fDummy;
+		freopen_s(&fDummy, "CONOUT$", "w", stdout);
+		freopen_s(&fDummy, "CONOUT$", "w", stderr);
+		m_hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+		m_bTerminal = m_hConsole != nullptr && m_hConsole != INVALID_HANDLE_VALUE;
+
+		SetConsoleTitleA(szTitle);
+	}
+#endif
+}
+
+bool CLogConsole::IsAvailable() const {
+#ifdef _WIN32
+	return m_hConsole != nullptr && m_hConsole != INVALID_HANDLE_VALUE;
+#else
+	return true;
+#endif
+}
+
+bool CLogConsole::CanColor() const {
+	return m_bColors && m_bTerminal;
+}
+
+void CLogConsole::Write(std::string_view strText, EColor eColor) {
+	if (!CanColor()) {
+		fwrite(strText.data(), 1, strText.size(), stdout);
+		fflush(stdout);
+		return;
+	}
+
+#ifdef _WIN32
+	CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+	GetConsoleScreenBufferInfo(m_hConsole, &consoleInfo);
+	WORD wOriginalColor = consoleInfo.wAttributes;
+
+	SetConsoleTextAttribute(m_hConsole, ToAttributes(eColor));
+	fwrite(strText.data(), 1, strText.size(), stdout);
+	fflush(stdout);
+
+	SetConsoleTextAttribute(m_hConsole, wOriginalColor);
+#else
+	fputs(ToEscapeSequence(eColor), stdout);
+	fwrite(strText.data(), 1, strText.size(), stdout);
+	fputs(ToEscapeSequence(COLOR_DEFAULT), stdout);
+	fflush(stdout);
+#endif
+}
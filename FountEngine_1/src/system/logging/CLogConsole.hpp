@@ -0,0 +1,36 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+
+// Platform side of CLogSystem's console output: the Win32 console with text attributes on Windows,
+// stdout with ANSI colors (when it is a terminal) everywhere else.
+class CLogConsole {
+public:
+	enum EColor {
+		COLOR_DEFAULT,
+		COLOR_DEBUG,
+		COLOR_INFO,
+		COLOR_WARNING,
+		COLOR_ERROR,
+		COLOR_FATAL
+	};
+
+	CLogConsole();
+
+	// Gives GUI processes a console window of their own. Console processes already have one.
+	void Allocate(const char* szTitle);
+	void SetColorsEnabled(bool bEnabled) { m_bColors = bEnabled; }
+
+	// False when writes would go nowhere, e.g. a Windows GUI process that never allocated a console.
+	bool IsAvailable() const;
+
+	// Writes and flushes strText in one color, restoring the previous one afterwards.
+	void Write(std::string_view strText, EColor eColor);
+
+private:
+	bool CanColor() const;
+
+	void* m_hConsole = nullptr; // HANDLE on Windows
+	bool m_bColors = true;
+	bool m_bTerminal = false;
+};
@@ -0,0 +1,283 @@
+#include "CLogFormat.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+	struct Argument_t {
+		CLogFormat::EArgumentType eType;
+		int64_t nInt = 0;
+		uint64_t nUInt = 0;
+		double flDouble = 0.0;
+		std::string_view strString;
+	};
+
+	class CArgumentReader {
+	public:
+		CArgumentReader(const char* pData, size_t nLength) : m_pData(pData), m_nLength(nLength) {}
+
+		bool Next(Argument_t& Argument) {
+			if (m_nOffset >= m_nLength) {
+				return false;
+			}
+
+			Argument.eType = static_cast<CLogFormat::EArgumentType>(m_pData[m_nOffset++]);
+			switch (Argument.eType) {
+			case CLogFormat::ARG_INT: return Read(Argument.nInt);
+			case CLogFormat::ARG_UINT:
+			case CLogFormat::ARG_POINTER: return Read(Argument.nUInt);
+			case CLogFormat::ARG_DOUBLE: return Read(Argument.flDouble);
+			case CLogFormat::ARG_STRING: {
+				uint16_t nStringLength;
+				if (!Read(nStringLength) || m_nOffset + nStringLength > m_nLength) {
+					return false;
+				}
+				Argument.strString = std::string_view(m_pData + m_nOffset, nStringLength);
+				m_nOffset += nStringLength;
+				return true;
+			}
+			default:
+				m_nOffset = m_nLength;
+				return false;
+			}
+		}
+
+	private:
+		template <typename T>
+		bool Read(T& Value) {
+			if (m_nOffset + sizeof(T) > m_nLength) {
+				m_nOffset = m_nLength;
+				return false;
+			}
+			memcpy(&Value, m_pData + m_nOffset, sizeof(T));
+			m_nOffset += sizeof(T);
+			return true;
+		}
+
+		const char* m_pData;
+		size_t m_nLength;
+		size_t m_nOffset = 0;
+	};
+
+	long long ArgumentAsInt(const Argument_t& Argument) {
+		switch (Argument.eType) {
+		case CLogFormat::ARG_INT: return Argument.nInt;
+		case CLogFormat::ARG_DOUBLE: return static_cast<long long>(Argument.flDouble);
+		default: return static_cast<long long>(Argument.nUInt);
+		}
+	}
+
+	double ArgumentAsDouble(const Argument_t& Argument) {
+		switch (Argument.eType) {
+		case CLogFormat::ARG_INT: return static_cast<double>(Argument.nInt);
+		case CLogFormat::ARG_DOUBLE: return Argument.flDouble;
+		default: return static_cast<double>(Argument.nUInt);
+		}
+	}
+
+	template <typename T>
+	void AppendRaw(std::string& strOut, const T& Value) {
+		strOut.append(reinterpret_cast<const char*>(&Value), sizeof(T));
+	}
+
+	void AppendString16(std::string& strOut, std::string_view strValue) {
+		uint16_t nLength = static_cast<uint16_t>(std::min<size_t>(strValue.size(), UINT16_MAX));
+		AppendRaw(strOut, nLength);
+		strOut.append(strValue.data(), nLength);
+	}
+}
+
+void CLogFormat::EncodeString(char* pBuffer, size_t& nCapacity, size_t& nOffset, const char* pData, size_t nLength) {
+	if (nOffset + 1 + sizeof(uint16_t) > nCapacity) {
+		nCapacity = nOffset;
+		return;
+	}
+
+	uint16_t nStored = static_cast<uint16_t>(std::min({ nLength, nCapacity - nOffset - 1 - sizeof(uint16_t), size_t(UINT16_MAX) }));
+	pBuffer[nOffset] = static_cast<char>(ARG_STRING);
+	memcpy(pBuffer + nOffset + 1, &nStored, sizeof(nStored));
+	memcpy(pBuffer + nOffset + 1 + sizeof(nStored), pData, nStored);
+	nOffset += 1 + sizeof(nStored) + nStored;
+}
+
+void CLogFormat::FormatArguments(std::string& strOut, const char* szFormat, const char* pArguments, size_t nLength) {
+	CArgumentReader Reader(pArguments, nLength);
+	char cBuffer[512];
+
+	const char* p = szFormat;
+	while (*p) {
+		if (*p != '%') {
+			const char* pLiteralEnd = p;
+			while (*pLiteralEnd && *pLiteralEnd != '%') {
+				++pLiteralEnd;
+			}
+			strOut.append(p, pLiteralEnd);
+			p = pLiteralEnd;
+			continue;
+		}
+
+		if (p[1] == '%') {
+			strOut += '%';
+			p += 2;
+			continue;
+		}
+
+		// Rebuild the conversion without its length modifier; '*' widths are taken from the arguments.
+		std::string strSpec = "%";
+		const char* pSpec = p + 1;
+		while (*pSpec && strchr("-+ #0", *pSpec)) {
+			strSpec += *pSpec++;
+		}
+
+		Argument_t Argument;
+		auto AppendNumber = [&]() {
+			if (*pSpec == '*') {
+				strSpec += std::to_string(Reader.Next(Argument) ? ArgumentAsInt(Argument) : 0);
+				++pSpec;
+				return;
+			}
+			while (*pSpec >= '0' && *pSpec <= '9') {
+				strSpec += *pSpec++;
+			}
+		};
+
+		AppendNumber();
+		if (*pSpec == '.') {
+			strSpec += *pSpec++;
+			AppendNumber();
+		}
+
+		while (*pSpec && strchr("hljztL", *pSpec)) {
+			++pSpec;
+		}
+
+		const char cConversion = *pSpec;
+		if (!cConversion) {
+			break;
+		}
+		p = pSpec + 1;
+
+		if (!Reader.Next(Argument)) {
+			strOut += '?';
+			continue;
+		}
+
+		switch (cConversion) {
+		case 'd':
+		case 'i':
+			snprintf(cBuffer, sizeof(cBuffer), (strSpec + "lld").c_str(), ArgumentAsInt(Argument));
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			snprintf(cBuffer, sizeof(cBuffer), (strSpec + "ll" + cConversion).c_str(), static_cast<unsigned long long>(ArgumentAsInt(Argument)));
+			break;
+		case 'c':
+			snprintf(cBuffer, sizeof(cBuffer), (strSpec + 'c').c_str(), static_cast<int>(ArgumentAsInt(Argument)));
+			break;
+		case 'f': case 'F':
+		case 'e': case 'E':
+		case 'g': case 'G':
+		case 'a': case 'A':
+			snprintf(cBuffer, sizeof(cBuffer), (strSpec + cConversion).c_str(), ArgumentAsDouble(Argument));
+			break;
+		case 'p':
+			snprintf(cBuffer, sizeof(cBuffer), "0x%016llx", static_cast<unsigned long long>(Argument.nUInt));
+			break;
+		case 's':
+			if (Argument.eType == ARG_STRING) {
+				// Plain %s doesn't need printf, which also keeps long strings from being cut at the scratch buffer.
+				if (strSpec == "%") {
+					strOut += Argument.strString;
+					continue;
+				}
+				std::string strValue(Argument.strString);
+				snprintf(cBuffer, sizeof(cBuffer), (strSpec + 's').c_str(), strValue.c_str());
+			}
+			else if (Argument.eType == ARG_DOUBLE) {
+				snprintf(cBuffer, sizeof(cBuffer), "%g", Argument.flDouble);
+			}
+			else {
+				snprintf(cBuffer, sizeof(cBuffer), "%lld", ArgumentAsInt(Argument));
+			}
+			break;
+		default:
+			snprintf(cBuffer, sizeof(cBuffer), "%%%c", cConversion);
+			break;
+		}
+
+		strOut += cBuffer;
+	}
+}
+
+std::string CLogFormat::FormatTimeStamp(int64_t nTimeMicroseconds) {
+	time_t tTime = static_cast<time_t>(nTimeMicroseconds / 1000000);
+	tm timeInfo;
+#ifdef _WIN32
+	localtime_s(&timeInfo, &tTime);
+#else
+	localtime_r(&tTime, &timeInfo);
+#endif
+
+	char cBuffer[80];
+	strftime(cBuffer, sizeof(cBuffer), "%H:%M:%S", &timeInfo);
+
+	return std::string(cBuffer);
+}
+
+const char* CLogFormat::LevelToString(uint8_t nLevel) {
+	static const char* s_szLevels[] = { "DEBUG", "INFO", "WARNING", "ERROR", "FATAL" };
+	return nLevel < std::size(s_szLevels) ? s_szLevels[nLevel] : "UNKNOWN";
+}
+
+const char* CLogFormat::ChannelToString(uint8_t nChannel) {
+	static const char* s_szChannels[] = { "general", "render", "resources", "input", "mainloop" };
+	return nChannel < std::size(s_szChannels) ? s_szChannels[nChannel] : "unknown";
+}
+
+void CLogFormat::AppendLine(std::string& strOut, std::string_view strTimestamp, uint8_t nLevel, uint8_t nChannel, std::string_view strMessage) {
+	strOut += '[';
+	strOut += strTimestamp;
+	strOut += "] [";
+	strOut += LevelToString(nLevel);
+	strOut += "] ";
+	if (nChannel != 0) {
+		strOut += '[';
+		strOut += ChannelToString(nChannel);
+		strOut += "] ";
+	}
+	strOut += strMessage;
+	strOut += '\n';
+}
+
+void CLogFormat::WriteFileHeader(std::string& strOut) {
+	AppendRaw(strOut, MAGIC);
+	AppendRaw(strOut, VERSION);
+}
+
+void CLogFormat::WriteSite(std::string& strOut, uint32_t nSiteId, uint8_t nLevel, uint8_t nChannel, uint32_t nLine, std::string_view strFile, std::string_view strFormat) {
+	strOut += static_cast<char>(CHUNK_SITE);
+	AppendRaw(strOut, nSiteId);
+	AppendRaw(strOut, nLevel);
+	AppendRaw(strOut, nChannel);
+	AppendRaw(strOut, nLine);
+	AppendString16(strOut, strFile);
+	AppendString16(strOut, strFormat);
+}
+
+void CLogFormat::WriteEvent(std::string& strOut, uint32_t nSiteId, int64_t nTimeMicroseconds, const char* pArguments, size_t nLength) {
+	strOut += static_cast<char>(CHUNK_EVENT);
+	AppendRaw(strOut, nSiteId);
+	AppendRaw(strOut, nTimeMicroseconds);
+	AppendString16(strOut, std::string_view(pArguments, nLength));
+}
+
+void CLogFormat::WriteText(std::string& strOut, uint8_t nLevel, uint8_t nChannel, int64_t nTimeMicroseconds, std::string_view strMessage) {
+	strOut += static_cast<char>(CHUNK_TEXT);
+	AppendRaw(strOut, nLevel);
+	AppendRaw(strOut, nChannel);
+	AppendRaw(strOut, nTimeMicroseconds);
+	AppendString16(strOut, strMessage);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Deferred formatting for LOG_* calls: the call site only stores its arguments as tagged binary values,
+// the printf-style format is applied later on the log writer thread or offline by FountLogDecoder.
+class CLogFormat {
+public:
+	enum EArgumentType : uint8_t {
+		ARG_INT,
+		ARG_UINT,
+		ARG_DOUBLE,
+		ARG_STRING,
+		ARG_POINTER
+	};
+
+	// Binary log files: "FLOG", version, then chunks that each start with an EChunkType byte.
+	// Sites are written once, before their first event.
+	static constexpr uint32_t MAGIC = 0x474F4C46; // "FLOG"
+	static constexpr uint32_t VERSION = 2;
+	static constexpr const char* EXTENSION = ".flog";
+
+	enum EChunkType : uint8_t {
+		CHUNK_SITE = 1, // id, level, channel, line, file, format
+		CHUNK_EVENT,    // site id, time, encoded arguments
+		CHUNK_TEXT      // level, channel, time, preformatted message
+	};
+
+	// Arguments that don't fit are dropped, strings are truncated. Returns the encoded size.
+	template <typename... Args>
+	static size_t EncodeArguments([[maybe_unused]] char* pBuffer, [[maybe_unused]] size_t nCapacity, const Args&... args) {
+		size_t nOffset = 0;
+		(EncodeArgument(pBuffer, nCapacity, nOffset, args), ...);
+		return nOffset;
+	}
+
+	// Appends szFormat applied to encoded arguments. Conversions are matched to the stored types,
+	// so length modifiers in the format don't matter; missing arguments print as "?".
+	static void FormatArguments(std::string& strOut, const char* szFormat, const char* pArguments, size_t nLength);
+
+	static std::string FormatTimeStamp(int64_t nTimeMicroseconds);
+	static const char* LevelToString(uint8_t nLevel);
+	static const char* ChannelToString(uint8_t nChannel);
+
+	// "[time] [LEVEL] [channel] message\n"; the general channel (0) isn't tagged.
+	static void AppendLine(std::string& strOut, std::string_view strTimestamp, uint8_t nLevel, uint8_t nChannel, std::string_view strMessage);
+
+	static void WriteFileHeader(std::string& strOut);
+	static void WriteSite(std::string& strOut, uint32_t nSiteId, uint8_t nLevel, uint8_t nChannel, uint32_t nLine, std::string_view strFile, std::string_view strFormat);
+	static void WriteEvent(std::string& strOut, uint32_t nSiteId, int64_t nTimeMicroseconds, const char* pArguments, size_t nLength);
+	static void WriteText(std::string& strOut, uint8_t nLevel, uint8_t nChannel, int64_t nTimeMicroseconds, std::string_view strMessage);
+
+private:
+	template <typename T>
+	static void EncodeArgument(char* pBuffer, size_t& nCapacity, size_t& nOffset, const T& Value) {
+		using Decayed_t = std::decay_t<T>;
+
+		if constexpr (std::is_array_v<T>) {
+			EncodeString(pBuffer, nCapacity, nOffset, Value, strlen(Value));
+		}
+		else if constexpr (std::is_same_v<Decayed_t, std::string> || std::is_same_v<Decayed_t, std::string_view>) {
+			EncodeString(pBuffer, nCapacity, nOffset, Value.data(), Value.size());
+		}
+		else if constexpr (std::is_same_v<Decayed_t, const char*> || std::is_same_v<Decayed_t, char*>) {
+			const char* szValue = Value ? Value : "(null)";
+			EncodeString(pBuffer, nCapacity, nOffset, szValue, strlen(szValue));
+		}
+		else if constexpr (std::is_pointer_v<Decayed_t> || std::is_null_pointer_v<Decayed_t>) {
+			EncodeValue(pBuffer, nCapacity, nOffset, ARG_POINTER, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<const void*>(Value))));
+		}
+		else if constexpr (std::is_floating_point_v<Decayed_t>) {
+			EncodeValue(pBuffer, nCapacity, nOffset, ARG_DOUBLE, static_cast<double>(Value));
+		}
+		else if constexpr (std::is_enum_v<Decayed_t>) {
+			EncodeValue(pBuffer, nCapacity, nOffset, ARG_INT, static_cast<int64_t>(Value));
+		}
+		else if constexpr (std::is_signed_v<Decayed_t> || std::is_same_v<Decayed_t, bool>) {
+			EncodeValue(pBuffer, nCapacity, nOffset, ARG_INT, static_cast<int64_t>(Value));
+		}
+		else {
+			static_assert(std::is_unsigned_v<Decayed_t>, "Unsupported log argument type");
+			EncodeValue(pBuffer, nCapacity, nOffset, ARG_UINT, static_cast<uint64_t>(Value));
+		}
+	}
+
+	template <typename T>
+	static void EncodeValue(char* pBuffer, size_t& nCapacity, size_t& nOffset, EArgumentType eType, T Value) {
+		// Once one argument didn't fit, later ones mustn't take its place.
+		if (nOffset + 1 + sizeof(T) > nCapacity) {
+			nCapacity = nOffset;
+			return;
+		}
+		pBuffer[nOffset] = static_cast<char>(eType);
+		memcpy(pBuffer + nOffset + 1, &Value, sizeof(T));
+		nOffset += 1 + sizeof(T);
+	}
+
+	static void EncodeString(char* pBuffer, size_t& nCapacity, size_t& nOffset, const char* pData, size_t nLength);
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded multi-producer / single-consumer ring (Vyukov's sequenced cells). Producers claim a cell,
+// fill it in place and publish it; the consumer reads published cells in order. No locks, no allocations
+// after construction.
+template <typename T, size_t CAPACITY>
+class CLogQueue {
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CLogQueue capacity must be a power of two");
+
+public:
+	CLogQueue() : m_pCells(std::make_unique<Cell_t[]>(CAPACITY)) {
+		for (size_t i = 0; i < CAPACITY; ++i) {
+			m_pCells[i].nSequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// Null when the queue is full. A claimed cell must be published with Publish().
+	T* TryClaim(uint64_t& nTicket) {
+		uint64_t nPosition = m_nEnqueuePosition.load(std::memory_order_relaxed);
+		while (true) {
+			Cell_t& Cell = m_pCells[nPosition & (CAPACITY - 1)];
+			int64_t nDiff = static_cast<int64_t>(Cell.nSequence.load(std::memory_order_acquire)) - static_cast<int64_t>(nPosition);
+
+			if (nDiff == 0) {
+				if (m_nEnqueuePosition.compare_exchange_weak(nPosition, nPosition + 1, std::memory_order_relaxed)) {
+					nTicket = nPosition;
+					return &Cell.Data;
+				}
+			}
+			else if (nDiff < 0) {
+				return nullptr;
+			}
+			else {
+				nPosition = m_nEnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void Publish(uint64_t nTicket) {
+		m_pCells[nTicket & (CAPACITY - 1)].nSequence.store(nTicket + 1, std::memory_order_release);
+	}
+
+	// Consumer side. Null when the next cell isn't published yet.
+	T* Peek() {
+		Cell_t& Cell = m_pCells[m_nDequeuePosition & (CAPACITY - 1)];
+		if (Cell.nSequence.load(std::memory_order_acquire) != m_nDequeuePosition + 1) {
+			return nullptr;
+		}
+		return &Cell.Data;
+	}
+
+	void Pop() {
+		m_pCells[m_nDequeuePosition & (CAPACITY - 1)].nSequence.store(m_nDequeuePosition + CAPACITY, std::memory_order_release);
+		++m_nDequeuePosition;
+	}
+
+	// Tickets below this have been claimed (not necessarily published yet).
+	uint64_t GetEnqueuePosition() const { return m_nEnqueuePosition.load(std::memory_order_acquire); }
+	uint64_t GetDequeuePosition() const { return m_nDequeuePosition; }
+
+private:
+	struct Cell_t {
+		std::atomic<uint64_t> nSequence;
+		T Data;
+	};
+
+	std::unique_ptr<Cell_t[]> m_pCells;
+	alignas(64) std::atomic<uint64_t> m_nEnqueuePosition = 0;
+	alignas(64) uint64_t m_nDequeuePosition = 0;
+};
\ No newline at end of file
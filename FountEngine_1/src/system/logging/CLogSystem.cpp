@@ -1,14 +1,11 @@
 #include "CLogSystem.hpp"
-#include <iostream>
 #include <ctime>
 #include <cstdarg>
-#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
 
-#ifdef _DEBUG
-#	include <windows.h>
-#endif
-
-CLogSystem::CLogSystem() : m_hConsole(GetStdHandle(STD_OUTPUT_HANDLE)) {}
+CLogSystem::CLogSystem() = default;
 CLogSystem::~CLogSystem() {
 	Shutdown();
 }
@@ -18,134 +15,424 @@ CLogSystem& CLogSystem::GetInstance() {
 	return Instance;
 }
 
-bool CLogSystem::Initialize(const std::string& strLogFile) {
+bool CLogSystem::Initialize(const std::string& strLogFile, bool bAsync, ELogFormat eFormat) {
 	std::lock_guard<std::mutex> lock(m_Mutex);
 
 	if (m_bInitialized) {
 		return true;
 	}
 
-	m_LogFile.open(strLogFile, std::ios::out | std::ios::trunc);
+	// Sites are registered lazily from the writer's point of view, so binary output needs the writer thread.
+	m_eFormat = bAsync ? eFormat : FORMAT_TEXT;
+
+	m_LogFile.open(strLogFile, std::ios::out | std::ios::trunc | (m_eFormat == FORMAT_BINARY ? std::ios::binary : std::ios::openmode()));
 	if (!m_LogFile.is_open()) {
 		return false;
 	}
 
+	if (m_eFormat == FORMAT_BINARY) {
+		std::string strHeader;
+		CLogFormat::WriteFileHeader(strHeader);
+		m_LogFile.write(strHeader.data(), static_cast<std::streamsize>(strHeader.size()));
+		m_WrittenSites.clear();
+	}
+
 #ifdef _DEBUG
 	if (m_bConsoleColors) {
-		if (AllocConsole()) {
-			FILE* fDummy;
-			freopen_s(&fDummy, "CONOUT$", "w", stdout);
-			freopen_s(&fDummy, "CONOUT$", "w", stderr);
-			m_hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-
-			SetConsoleTitleA("Debug Console - Fount Engine");
-		}
+		m_Console.Allocate("Debug Console - Fount Engine");
 	}
 #endif
 
+	m_bAsync.store(bAsync, std::memory_order_relaxed);
+	if (bAsync) {
+		m_bStopWriter = false;
+		m_Writer = std::thread(&CLogSystem::WriterMain, this);
+	}
+
 	m_bInitialized = true;
 	return true;
 }
 
 void CLogSystem::Shutdown() {
+	if (!m_bInitialized.exchange(false)) {
+		return;
+	}
+
+	StopWriter();
+
+	// Producers that passed the m_bInitialized check before it changed may have published after the
+	// writer's last drain. With the writer gone this thread is the only consumer.
+	if (m_bAsync.load(std::memory_order_relaxed)) {
+		DrainQueue();
+	}
+
 	std::lock_guard <std::mutex> lock(m_Mutex);
+	if (m_LogFile.is_open()) {
+		m_LogFile.flush();
+		m_LogFile.close();
+	}
+}
 
-	if (m_bInitialized) {
-		if (m_LogFile.is_open()) {
-			m_LogFile.flush();
-			m_LogFile.close();
-		}
+void CLogSystem::Flush() {
+	if (!m_bInitialized) {
+		return;
+	}
 
-		m_bInitialized = false;
+	if (!m_bAsync.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_LogFile.flush();
+		return;
 	}
+
+	const uint64_t nTarget = m_Queue.GetEnqueuePosition();
+
+	std::unique_lock<std::mutex> lock(m_WriterMutex);
+	m_bFlushRequested = true;
+	m_WriterCondition.notify_one();
+	m_FlushCondition.wait(lock, [&] {
+		return m_nWrittenPosition.load(std::memory_order_acquire) >= nTarget || m_bStopWriter;
+	});
 }
 
 void CLogSystem::Log(ELogLevel Level, const std::string& strMessage) {
-	if (Level < m_eMinLogLevel || !m_bInitialized) {
+	if (Level < m_eMinLogLevel.load(std::memory_order_relaxed) || !m_bInitialized) {
 		return;
 	}
 
-	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_bAsync.load(std::memory_order_relaxed)) {
+		uint64_t nTicket;
+		if (LogRecord_t* pRecord = ClaimRecord(Level, nTicket)) {
+			pRecord->eLevel = Level;
+			pRecord->nSiteId = 0;
+			pRecord->nSuppressed = 0;
+			pRecord->nLength = static_cast<uint32_t>(std::min(strMessage.size(), MAX_MESSAGE_LENGTH));
+			memcpy(pRecord->cData, strMessage.data(), pRecord->nLength);
+			PublishRecord(pRecord, nTicket);
+		}
+		return;
+	}
 
-	std::stringstream FormattedMessage;
-	std::string strTimestamp = GetCurrentTimeStamp();
-	std::string strLevel = LevelToString(Level);
+	WriteLine(Level, CHANNEL_GENERAL, strMessage);
+}
 
-	FormattedMessage << "[" << strTimestamp << "] [" << strLevel << "] " << strMessage;
+void CLogSystem::WriteLine(ELogLevel Level, ELogChannel Channel, const std::string& strMessage) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
 
-	std::string strFinalMessage = FormattedMessage.str();
+	std::string strFinalMessage;
+	CLogFormat::AppendLine(strFinalMessage, GetCurrentTimeStamp(), static_cast<uint8_t>(Level), static_cast<uint8_t>(Channel), strMessage);
+	strFinalMessage.pop_back();
 
 	WriteToFile(strFinalMessage);
 	WriteToConsole(strFinalMessage, Level);
 }
 
 void CLogSystem::LogF(ELogLevel Level, const char* szFormat, ...) {
-	if (Level < m_eMinLogLevel || !m_bInitialized) {
+	if (Level < m_eMinLogLevel.load(std::memory_order_relaxed) || !m_bInitialized) {
 		return;
 	}
 
-	char cBuffer[1024];
 	va_list args;
 	va_start(args, szFormat);
-	vsprintf_s(cBuffer, szFormat, args);
+	LogV(Level, nullptr, 0, szFormat, args);
 	va_end(args);
-
-	Log(Level, cBuffer);
 }
 
 void CLogSystem::LogF(ELogLevel Level, const char* szFile, int nLine, const char* szFormat, ...) {
-	if (Level < m_eMinLogLevel || !m_bInitialized) {
+	if (Level < m_eMinLogLevel.load(std::memory_order_relaxed) || !m_bInitialized) {
 		return;
 	}
 
-	char cMessageBuffer[1024];
 	va_list args;
 	va_start(args, szFormat);
-	vsprintf_s(cMessageBuffer, szFormat, args);
+	LogV(Level, szFile, nLine, szFormat, args);
 	va_end(args);
+}
+
+void CLogSystem::LogV(ELogLevel Level, const char* szFile, int nLine, const char* szFormat, va_list args) {
+	if (!m_bAsync.load(std::memory_order_relaxed)) {
+		char cMessageBuffer[1024];
+		vsnprintf(cMessageBuffer, sizeof(cMessageBuffer), szFormat, args);
+
+		if (!szFile) {
+			Log(Level, cMessageBuffer);
+			return;
+		}
+
+		char cFinalBuffer[2048];
+		snprintf(cFinalBuffer, sizeof(cFinalBuffer), "%s (%s:%d)", cMessageBuffer, szFile, nLine);
+		Log(Level, cFinalBuffer);
+		return;
+	}
+
+	// Format straight into the queue slot, no intermediate buffers or strings.
+	uint64_t nTicket;
+	LogRecord_t* pRecord = ClaimRecord(Level, nTicket);
+	if (!pRecord) {
+		return;
+	}
 
-	char cFinalBuffer[2048];
-	sprintf_s(cFinalBuffer, "%s (%s:%d)", cMessageBuffer, szFile, nLine);
+	int nLength = vsnprintf(pRecord->cData, MAX_MESSAGE_LENGTH, szFormat, args);
+	nLength = std::clamp(nLength, 0, static_cast<int>(MAX_MESSAGE_LENGTH) - 1);
 
-	Log(Level, cFinalBuffer);
+	if (szFile) {
+		int nSuffix = snprintf(pRecord->cData + nLength, MAX_MESSAGE_LENGTH - nLength, " (%s:%d)", szFile, nLine);
+		nLength = std::min(nLength + std::max(nSuffix, 0), static_cast<int>(MAX_MESSAGE_LENGTH) - 1);
+	}
+
+	pRecord->eLevel = Level;
+	pRecord->nSiteId = 0;
+	pRecord->nSuppressed = 0;
+	pRecord->nLength = static_cast<uint32_t>(nLength);
+	PublishRecord(pRecord, nTicket);
 }
 
-std::string CLogSystem::GetCurrentTimeStamp() {
-	time_t now = time(nullptr);
-	tm timeInfo;
-	localtime_s(&timeInfo, &now);
+uint32_t CLogSystem::RegisterSite(LogSite_t& Site, const char* szFormat) {
+	std::lock_guard<std::mutex> lock(m_SiteMutex);
 
-	char cBuffer[80];
-	strftime(cBuffer, sizeof(cBuffer), "%H:%M:%S", &timeInfo);
+	uint32_t nSiteId = Site.nId.load(std::memory_order_relaxed);
+	if (nSiteId == 0) {
+		Site.szFormat = szFormat;
+		m_Sites.push_back(&Site);
+		nSiteId = static_cast<uint32_t>(m_Sites.size());
+		Site.nId.store(nSiteId, std::memory_order_release);
+	}
+	return nSiteId;
+}
 
-	return std::string(cBuffer);
+const CLogSystem::LogSite_t* CLogSystem::GetSite(uint32_t nSiteId) {
+	std::lock_guard<std::mutex> lock(m_SiteMutex);
+	return nSiteId > 0 && nSiteId <= m_Sites.size() ? m_Sites[nSiteId - 1] : nullptr;
 }
 
-std::string CLogSystem::LevelToString(ELogLevel Level) {
-	switch (Level) {
-	case LEVEL_DEBUG: return "DEBUG";
-	case LEVEL_INFO: return "INFO";
-	case LEVEL_WARNING: return "WARNING";
-	case LEVEL_ERROR: return "ERROR";
-	case LEVEL_FATAL: return "FATAL";
-	default: return "UNKNOWN";
+std::string CLogSystem::FormatSuppressedMessage(const LogSite_t& Site, uint32_t nSuppressed) {
+	return "Rate limit dropped " + std::to_string(nSuppressed) + " messages from " + Site.szFile + ":" + std::to_string(Site.nLine);
+}
+
+bool CLogSystem::PassesRateLimit(LogSite_t& Site, uint32_t nRateLimit) {
+	const int64_t nNow = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	// Fixed one second windows. Racing threads may let a few extra messages through at a window change, that's fine.
+	int64_t nWindowStart = Site.nWindowStart.load(std::memory_order_relaxed);
+	if (nNow - nWindowStart >= 1000 && Site.nWindowStart.compare_exchange_strong(nWindowStart, nNow, std::memory_order_relaxed)) {
+		Site.nWindowCount.store(0, std::memory_order_relaxed);
+	}
+
+	if (Site.nWindowCount.fetch_add(1, std::memory_order_relaxed) >= nRateLimit) {
+		Site.nSuppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
 	}
+	return true;
 }
 
-CLogSystem::ELogColor CLogSystem::LevelToColor(ELogLevel Level) {
-	switch (Level) {
-	case LEVEL_DEBUG: return COLOR_DEBUG;
-	case LEVEL_INFO: return COLOR_INFO;
-	case LEVEL_WARNING: return COLOR_WARNING;
-	case LEVEL_ERROR: return COLOR_ERROR;
-	case LEVEL_FATAL: return COLOR_FATAL;
-	default: return COLOR_DEFAULT;
+std::string CLogSystem::FormatSiteMessage(const LogSite_t& Site, const char* pArguments, size_t nLength) {
+	std::string strMessage;
+	CLogFormat::FormatArguments(strMessage, Site.szFormat, pArguments, nLength);
+
+	char cLocation[512];
+	snprintf(cLocation, sizeof(cLocation), " (%s:%d)", Site.szFile, Site.nLine);
+	strMessage += cLocation;
+	return strMessage;
+}
+
+CLogSystem::LogRecord_t* CLogSystem::ClaimRecord(ELogLevel Level, uint64_t& nTicket) {
+	LogRecord_t* pRecord = m_Queue.TryClaim(nTicket);
+	if (pRecord) {
+		return pRecord;
+	}
+
+	// Fatal messages are never dropped.
+	if (m_eOverflowPolicy.load(std::memory_order_relaxed) == OVERFLOW_DROP && Level != LEVEL_FATAL) {
+		m_nDropPosition.store(m_Queue.GetEnqueuePosition(), std::memory_order_relaxed);
+		m_nDropped.fetch_add(1, std::memory_order_release);
+		return nullptr;
 	}
+
+	while (!(pRecord = m_Queue.TryClaim(nTicket))) {
+		m_WriterCondition.notify_one();
+		std::this_thread::yield();
+	}
+	return pRecord;
+}
+
+void CLogSystem::PublishRecord(LogRecord_t* pRecord, uint64_t nTicket) {
+	const ELogLevel Level = pRecord->eLevel;
+	pRecord->nTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	m_Queue.Publish(nTicket);
+
+	// The process is likely about to go down, make sure the message is on disk first.
+	if (Level == LEVEL_FATAL) {
+		Flush();
+	}
+}
+
+void CLogSystem::StopWriter() {
+	if (!m_Writer.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_WriterMutex);
+		m_bStopWriter = true;
+	}
+	m_WriterCondition.notify_one();
+	m_Writer.join();
+	m_FlushCondition.notify_all();
+}
+
+void CLogSystem::WriterMain() {
+	while (true) {
+		bool bStop;
+		{
+			std::unique_lock<std::mutex> lock(m_WriterMutex);
+			m_WriterCondition.wait_for(lock, std::chrono::milliseconds(5), [this] {
+				return m_bStopWriter || m_bFlushRequested;
+			});
+			m_bFlushRequested = false;
+			bStop = m_bStopWriter;
+		}
+
+		DrainQueue();
+
+		{
+			std::lock_guard<std::mutex> lock(m_WriterMutex);
+			m_nWrittenPosition.store(m_Queue.GetDequeuePosition(), std::memory_order_release);
+		}
+		m_FlushCondition.notify_all();
+
+		if (bStop) {
+			return;
+		}
+	}
+}
+
+void CLogSystem::DrainQueue() {
+	std::string strFile;
+	std::string strConsole;
+	ELogLevel ConsoleLevel = LEVEL_DEBUG;
+	int64_t nLastSecond = -1;
+	std::string strTimestamp;
+	bool bTextRecord = true;
+
+	// Text lines are only built for the sinks that show them. A binary log without a console gets
+	// events and text chunks straight from the records.
+	const bool bConsole = IsConsoleOutputEnabled();
+	const bool bTextFile = m_eFormat == FORMAT_TEXT;
+	const bool bFormat = bConsole || bTextFile;
+
+	auto AppendLine = [&](ELogLevel Level, ELogChannel Channel, int64_t nTime, std::string_view strMessage) {
+		if (!bTextFile && bTextRecord) {
+			CLogFormat::WriteText(strFile, static_cast<uint8_t>(Level), static_cast<uint8_t>(Channel), nTime, strMessage);
+		}
+		if (!bFormat) {
+			return;
+		}
+
+		// Consecutive records of one level share a console color, so they go out as one write.
+		if (Level != ConsoleLevel && !strConsole.empty()) {
+			WriteConsoleBatch(strConsole, ConsoleLevel);
+			strConsole.clear();
+		}
+		ConsoleLevel = Level;
+
+		if (nTime / 1000000 != nLastSecond) {
+			nLastSecond = nTime / 1000000;
+			strTimestamp = CLogFormat::FormatTimeStamp(nTime);
+		}
+
+		const size_t nLineStart = strConsole.size();
+		CLogFormat::AppendLine(strConsole, strTimestamp, static_cast<uint8_t>(Level), static_cast<uint8_t>(Channel), strMessage);
+
+		if (bTextFile) {
+			strFile.append(strConsole, nLineStart, std::string::npos);
+		}
+		if (!bConsole) {
+			strConsole.resize(nLineStart);
+		}
+	};
+
+	// Drops are reported where they happened, after the records that were queued ahead of them. Several
+	// between two passes make one report, at the position of the last.
+	if (uint64_t nDropped = m_nDropped.exchange(0, std::memory_order_acquire)) {
+		m_nTotalDropped.fetch_add(nDropped, std::memory_order_relaxed);
+		m_nUnreportedDropped += nDropped;
+		m_nDropReportPosition = m_nDropPosition.load(std::memory_order_relaxed);
+	}
+
+	auto ReportDrops = [&](int64_t nTime) {
+		if (m_nUnreportedDropped == 0 || m_Queue.GetDequeuePosition() < m_nDropReportPosition) {
+			return;
+		}
+
+		bTextRecord = true;
+		AppendLine(LEVEL_WARNING, CHANNEL_GENERAL, nTime, std::to_string(m_nUnreportedDropped) + " log messages dropped, the queue was full");
+		m_nUnreportedDropped = 0;
+	};
+
+	std::string strMessage;
+	while (LogRecord_t* pRecord = m_Queue.Peek()) {
+		ReportDrops(pRecord->nTime);
+
+		const LogSite_t* pSite = pRecord->nSiteId ? GetSite(pRecord->nSiteId) : nullptr;
+
+		if (pSite && pRecord->nSuppressed != 0) {
+			bTextRecord = true;
+			AppendLine(pRecord->eLevel, pSite->eChannel, pRecord->nTime, FormatSuppressedMessage(*pSite, pRecord->nSuppressed));
+		}
+
+		// Binary files store site records as events and only preformatted text as text chunks.
+		bTextRecord = pSite == nullptr;
+		if (!pSite) {
+			AppendLine(pRecord->eLevel, CHANNEL_GENERAL, pRecord->nTime, std::string_view(pRecord->cData, pRecord->nLength));
+		}
+		else if (bFormat) {
+			strMessage = FormatSiteMessage(*pSite, pRecord->cData, pRecord->nLength);
+			AppendLine(pRecord->eLevel, pSite->eChannel, pRecord->nTime, strMessage);
+		}
+
+		if (m_eFormat == FORMAT_BINARY) {
+			if (pSite) {
+				if (m_WrittenSites.size() < pRecord->nSiteId) {
+					m_WrittenSites.resize(pRecord->nSiteId, false);
+				}
+				if (!m_WrittenSites[pRecord->nSiteId - 1]) {
+					m_WrittenSites[pRecord->nSiteId - 1] = true;
+					CLogFormat::WriteSite(strFile, pRecord->nSiteId, static_cast<uint8_t>(pSite->eLevel), static_cast<uint8_t>(pSite->eChannel), static_cast<uint32_t>(pSite->nLine), pSite->szFile, pSite->szFormat);
+				}
+				CLogFormat::WriteEvent(strFile, pRecord->nSiteId, pRecord->nTime, pRecord->cData, pRecord->nLength);
+			}
+		}
+
+		m_Queue.Pop();
+	}
+	ReportDrops(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+	if (!strConsole.empty()) {
+		WriteConsoleBatch(strConsole, ConsoleLevel);
+	}
+
+	// The writer wakes up every few milliseconds; only flush when this pass wrote something.
+	if (m_LogFile.is_open() && !strFile.empty()) {
+		m_LogFile.write(strFile.data(), static_cast<std::streamsize>(strFile.size()));
+		m_LogFile.flush();
+	}
+}
+
+void CLogSystem::WriteConsoleBatch(const std::string& strBatch, ELogLevel Level) {
+	m_Console.Write(strBatch, LevelToColor(Level));
 }
 
-void CLogSystem::SetConsoleColor(ELogColor Color) {
-	if (m_bConsoleColors && m_hConsole) {
-		SetConsoleTextAttribute(m_hConsole, Color);
+std::string CLogSystem::GetCurrentTimeStamp() {
+	return CLogFormat::FormatTimeStamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+CLogConsole::EColor CLogSystem::LevelToColor(ELogLevel Level) {
+	switch (Level) {
+	case LEVEL_DEBUG: return CLogConsole::COLOR_DEBUG;
+	case LEVEL_INFO: return CLogConsole::COLOR_INFO;
+	case LEVEL_WARNING: return CLogConsole::COLOR_WARNING;
+	case LEVEL_ERROR: return CLogConsole::COLOR_ERROR;
+	case LEVEL_FATAL: return CLogConsole::COLOR_FATAL;
+	default: return CLogConsole::COLOR_DEFAULT;
 	}
 }
 
@@ -156,17 +443,8 @@ void CLogSystem::WriteToFile(const std::string& strMessage) {
 }
 
 void CLogSystem::WriteToConsole(const std::string& strMessage, ELogLevel Level) {
-	if (!m_bConsoleColors || !m_hConsole) {
-		std::cout << strMessage << std::endl;
+	if (!IsConsoleOutputEnabled()) {
 		return;
 	}
-
-	CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
-	GetConsoleScreenBufferInfo(m_hConsole, &consoleInfo);
-	WORD wOriginalColor = consoleInfo.wAttributes;
-
-	SetConsoleColor(LevelToColor(Level));
-	std::cout << strMessage << std::endl;
-
-	SetConsoleTextAttribute(m_hConsole, wOriginalColor);
-}
\ No newline at end of file
+	m_Console.Write(strMessage + '\n', LevelToColor(Level));
+}
@@ -5,7 +5,40 @@
 #include <mutex>
 #include <memory>
 #include <vector>
-#include <windows.h>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstdarg>
+#include <ctime>
+
+#include "CLogConsole.hpp"
+#include "CLogQueue.hpp"
+#include "CLogFormat.hpp"
+
+// Compile-time log levels (0 = debug ... 4 = fatal). Statements below their channel's level compile to nothing.
+// Override per channel, e.g. /DLOG_COMPILE_MIN_LEVEL_RENDER=0 to keep render debug output in release builds.
+#ifndef LOG_COMPILE_MIN_LEVEL
+#	ifdef _DEBUG
+#		define LOG_COMPILE_MIN_LEVEL 0
+#	else
+#		define LOG_COMPILE_MIN_LEVEL 1
+#	endif
+#endif
+#ifndef LOG_COMPILE_MIN_LEVEL_GENERAL
+#	define LOG_COMPILE_MIN_LEVEL_GENERAL LOG_COMPILE_MIN_LEVEL
+#endif
+#ifndef LOG_COMPILE_MIN_LEVEL_RENDER
+#	define LOG_COMPILE_MIN_LEVEL_RENDER LOG_COMPILE_MIN_LEVEL
+#endif
+#ifndef LOG_COMPILE_MIN_LEVEL_RESOURCES
+#	define LOG_COMPILE_MIN_LEVEL_RESOURCES LOG_COMPILE_MIN_LEVEL
+#endif
+#ifndef LOG_COMPILE_MIN_LEVEL_INPUT
+#	define LOG_COMPILE_MIN_LEVEL_INPUT LOG_COMPILE_MIN_LEVEL
+#endif
+#ifndef LOG_COMPILE_MIN_LEVEL_MAINLOOP
+#	define LOG_COMPILE_MIN_LEVEL_MAINLOOP LOG_COMPILE_MIN_LEVEL
+#endif
 
 class CLogSystem {
 public:
@@ -17,53 +50,242 @@ public:
 		LEVEL_FATAL
 	};
 
-	enum ELogColor {
-		COLOR_DEFAULT = 7,
-		COLOR_DEBUG = 8,
-		COLOR_INFO = 10,
-		COLOR_WARNING = 14,
-		COLOR_ERROR = 12,
-		COLOR_FATAL = 13,
-		COLOR_TIMESTAMP = 11
+	// Names are in CLogFormat::ChannelToString.
+	enum ELogChannel {
+		CHANNEL_GENERAL,
+		CHANNEL_RENDER,
+		CHANNEL_RESOURCES,
+		CHANNEL_INPUT,
+		CHANNEL_MAINLOOP,
+		CHANNEL_COUNT
+	};
+
+	// What an asynchronous producer does when the queue is full.
+	enum EOverflowPolicy {
+		OVERFLOW_DROP, // Drop the message and count it, the writer reports the count where the drop happened
+		OVERFLOW_BLOCK // Wait for the writer to make room (default: nothing logged goes missing)
+	};
+
+	// Log file contents. Binary files hold unformatted records (see CLogFormat) and are turned
+	// into text offline by FountLogDecoder; they need the asynchronous mode.
+	enum ELogFormat {
+		FORMAT_TEXT,
+		FORMAT_BINARY
+	};
+
+	// One LOG_* call site. Registered on its first call; after that records only carry its id.
+	struct LogSite_t {
+		ELogLevel eLevel;
+		const char* szFile;
+		int nLine;
+		ELogChannel eChannel;
+		uint32_t nRateLimit = 0; // Messages per second from this site, 0 for the channel's limit
+		const char* szFormat = nullptr;
+		std::atomic<uint32_t> nId = 0;
+
+		// Rate limiting: messages in the current one second window, and how many were dropped since the last one got through.
+		std::atomic<int64_t> nWindowStart = 0;
+		std::atomic<uint32_t> nWindowCount = 0;
+		std::atomic<uint32_t> nSuppressed = 0;
 	};
 
+	static constexpr bool IsCompiledIn(ELogChannel Channel, ELogLevel Level) {
+		constexpr int nCompileMinLevels[CHANNEL_COUNT] = {
+			LOG_COMPILE_MIN_LEVEL_GENERAL,
+			LOG_COMPILE_MIN_LEVEL_RENDER,
+			LOG_COMPILE_MIN_LEVEL_RESOURCES,
+			LOG_COMPILE_MIN_LEVEL_INPUT,
+			LOG_COMPILE_MIN_LEVEL_MAINLOOP
+		};
+		return Level >= nCompileMinLevels[Channel];
+	}
+
 	static CLogSystem& GetInstance();
 
-	bool Initialize(const std::string& strLogFile = "engine.log");
+	// In asynchronous mode LOG_* calls only copy their arguments into a lock-free queue; a writer thread
+	// formats the records and batches them to the file and the console. Fatal messages are always flushed before returning.
+	bool Initialize(const std::string& strLogFile = "engine.log", bool bAsync = true, ELogFormat eFormat = FORMAT_TEXT);
 	void Shutdown();
 
+	// Returns once everything logged before the call is written.
+	void Flush();
+
 	void Log(ELogLevel Level, const std::string& strMessage);
 	void LogF(ELogLevel Level, const char* szFormat, ...);
 	void LogF(ELogLevel Level, const char* szFile, int nLine, const char* szFormat, ...);
 
-	void SetConsoleColorsEnabled(bool bEnabled) { m_bConsoleColors = bEnabled; }
-	void SetMinLogLevel(ELogLevel Level) { m_eMinLogLevel = Level; }
+	// Backend of the LOG_* macros: stores the call site id and the raw arguments, formatting happens later.
+	template <size_t N, typename... Args>
+	void LogDeferred(LogSite_t& Site, const char (&szFormat)[N], const Args&... args) {
+		if (Site.eLevel < m_eMinLogLevel.load(std::memory_order_relaxed) ||
+			Site.eLevel < m_eChannelLevels[Site.eChannel].load(std::memory_order_relaxed) || !m_bInitialized) {
+			return;
+		}
+
+		const uint32_t nRateLimit = Site.nRateLimit != 0 ? Site.nRateLimit : m_nChannelRateLimits[Site.eChannel].load(std::memory_order_relaxed);
+		if (nRateLimit != 0 && Site.eLevel != LEVEL_FATAL && !PassesRateLimit(Site, nRateLimit)) {
+			return;
+		}
+
+		uint32_t nSuppressed = Site.nSuppressed.load(std::memory_order_relaxed);
+		if (nSuppressed != 0) {
+			nSuppressed = Site.nSuppressed.exchange(0, std::memory_order_relaxed);
+		}
+
+		uint32_t nSiteId = Site.nId.load(std::memory_order_acquire);
+		if (nSiteId == 0) {
+			nSiteId = RegisterSite(Site, szFormat);
+		}
+
+		if (!m_bAsync.load(std::memory_order_relaxed)) {
+			char cArguments[MAX_MESSAGE_LENGTH];
+			size_t nLength = CLogFormat::EncodeArguments(cArguments, sizeof(cArguments), args...);
+			if (nSuppressed != 0) {
+				WriteLine(Site.eLevel, Site.eChannel, FormatSuppressedMessage(Site, nSuppressed));
+			}
+			WriteLine(Site.eLevel, Site.eChannel, FormatSiteMessage(Site, cArguments, nLength));
+			return;
+		}
+
+		uint64_t nTicket;
+		LogRecord_t* pRecord = ClaimRecord(Site.eLevel, nTicket);
+		if (!pRecord) {
+			return;
+		}
+
+		pRecord->eLevel = Site.eLevel;
+		pRecord->nSiteId = nSiteId;
+		pRecord->nSuppressed = nSuppressed;
+		pRecord->nLength = static_cast<uint32_t>(CLogFormat::EncodeArguments(pRecord->cData, MAX_MESSAGE_LENGTH, args...));
+		PublishRecord(pRecord, nTicket);
+	}
+
+	void SetConsoleColorsEnabled(bool bEnabled) { m_bConsoleColors = bEnabled; m_Console.SetColorsEnabled(bEnabled); }
+	// With the console off and FORMAT_BINARY, site records are never formatted in-process at all.
+	void SetConsoleOutputEnabled(bool bEnabled) { m_bConsoleOutput.store(bEnabled, std::memory_order_relaxed); }
+	void SetMinLogLevel(ELogLevel Level) { m_eMinLogLevel.store(Level, std::memory_order_relaxed); }
+	void SetChannelLevel(ELogChannel Channel, ELogLevel Level) { m_eChannelLevels[Channel].store(Level, std::memory_order_relaxed); }
+	ELogLevel GetChannelLevel(ELogChannel Channel) const { return m_eChannelLevels[Channel].load(std::memory_order_relaxed); }
+
+	// Most messages per call site and second, 0 for no limit (the default). Sites that log through LOG_LIMITED_CH
+	// bring their own limit. Fatal messages are never limited.
+	void SetChannelRateLimit(ELogChannel Channel, uint32_t nMessagesPerSecond) { m_nChannelRateLimits[Channel].store(nMessagesPerSecond, std::memory_order_relaxed); }
+	void SetRateLimit(uint32_t nMessagesPerSecond) {
+		for (std::atomic<uint32_t>& nRateLimit : m_nChannelRateLimits) {
+			nRateLimit.store(nMessagesPerSecond, std::memory_order_relaxed);
+		}
+	}
+	void SetOverflowPolicy(EOverflowPolicy Policy) { m_eOverflowPolicy.store(Policy, std::memory_order_relaxed); }
+	uint64_t GetDroppedMessageCount() const { return m_nTotalDropped.load(std::memory_order_relaxed) + m_nDropped.load(std::memory_order_relaxed); }
 
 private:
+	static constexpr size_t QUEUE_CAPACITY = 4096;
+	static constexpr size_t MAX_MESSAGE_LENGTH = 1000;
+
+	// cData is the message text, or the encoded arguments of call site nSiteId when that isn't 0.
+	struct LogRecord_t {
+		ELogLevel eLevel;
+		uint32_t nSiteId;
+		uint32_t nSuppressed; // Messages from the site dropped by the rate limit before this one
+		int64_t nTime; // Microseconds since the epoch
+		uint32_t nLength;
+		char cData[MAX_MESSAGE_LENGTH];
+	};
+
 	CLogSystem();
 	~CLogSystem();
 
+	void LogV(ELogLevel Level, const char* szFile, int nLine, const char* szFormat, va_list args);
+	void WriteLine(ELogLevel Level, ELogChannel Channel, const std::string& strMessage);
+
+	uint32_t RegisterSite(LogSite_t& Site, const char* szFormat);
+	const LogSite_t* GetSite(uint32_t nSiteId);
+	std::string FormatSiteMessage(const LogSite_t& Site, const char* pArguments, size_t nLength);
+	std::string FormatSuppressedMessage(const LogSite_t& Site, uint32_t nSuppressed);
+	bool PassesRateLimit(LogSite_t& Site, uint32_t nRateLimit);
+
+	LogRecord_t* ClaimRecord(ELogLevel Level, uint64_t& nTicket);
+	void PublishRecord(LogRecord_t* pRecord, uint64_t nTicket);
+
+	void StopWriter();
+	void WriterMain();
+	void DrainQueue();
+	void WriteConsoleBatch(const std::string& strBatch, ELogLevel Level);
+
 	std::string GetCurrentTimeStamp();
-	std::string LevelToString(ELogLevel Level);
-	ELogColor LevelToColor(ELogLevel Level);
-	void SetConsoleColor(ELogColor Color);
+	CLogConsole::EColor LevelToColor(ELogLevel Level);
 	void WriteToFile(const std::string& strMessage);
 	void WriteToConsole(const std::string& strMessage, ELogLevel Level);
+	bool IsConsoleOutputEnabled() const { return m_bConsoleOutput.load(std::memory_order_relaxed) && m_Console.IsAvailable(); }
 
-	bool m_bInitialized = false;
+	std::atomic<bool> m_bInitialized = false;
+	ELogFormat m_eFormat = FORMAT_TEXT;
 	bool m_bConsoleColors = true;
-	ELogLevel m_eMinLogLevel = LEVEL_DEBUG;
+
+	// Read by every logging thread, set from anywhere; nothing is ordered by them, so relaxed accesses do.
+	std::atomic<bool> m_bAsync = false;
+	std::atomic<bool> m_bConsoleOutput = true;
+	std::atomic<ELogLevel> m_eMinLogLevel = LEVEL_DEBUG;
+	std::atomic<ELogLevel> m_eChannelLevels[CHANNEL_COUNT] = {};
+	std::atomic<uint32_t> m_nChannelRateLimits[CHANNEL_COUNT] = {};
+	std::atomic<EOverflowPolicy> m_eOverflowPolicy = OVERFLOW_BLOCK;
 
 	std::ofstream m_LogFile;
 	std::mutex m_Mutex;
-	HANDLE m_hConsole;
+	CLogConsole m_Console;
+
+	// Asynchronous mode.
+	CLogQueue<LogRecord_t, QUEUE_CAPACITY> m_Queue;
+	std::thread m_Writer;
+	std::mutex m_WriterMutex;
+	std::condition_variable m_WriterCondition;
+	std::condition_variable m_FlushCondition;
+	bool m_bStopWriter = false;
+	bool m_bFlushRequested = false;
+	std::atomic<uint64_t> m_nWrittenPosition = 0;
+	std::atomic<uint64_t> m_nDropped = 0;
+	std::atomic<uint64_t> m_nTotalDropped = 0;
+	// Enqueue position at the latest drop: the report goes after the records claimed before it.
+	std::atomic<uint64_t> m_nDropPosition = 0;
+	// Writer side: drops taken from m_nDropped but not written yet, and where they go.
+	uint64_t m_nUnreportedDropped = 0;
+	uint64_t m_nDropReportPosition = 0;
+
+	// Call sites by id - 1. m_WrittenSites is the writer's record of which ones the binary file already describes.
+	std::mutex m_SiteMutex;
+	std::vector<const LogSite_t*> m_Sites;
+	std::vector<bool> m_WrittenSites;
 };
 
-#define LOG_DEBUG(...)    CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_INFO(...)     CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_WARNING(...)  CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_WARNING, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_ERROR(...)    CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_ERROR, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_FATAL(...)    CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_FATAL, __FILE__, __LINE__, __VA_ARGS__)
+#define LOG_CHANNEL(Channel, Level, ...) \
+	do { \
+		if constexpr (CLogSystem::IsCompiledIn(Channel, Level)) { \
+			static CLogSystem::LogSite_t s_LogSite{ Level, __FILE__, __LINE__, Channel }; \
+			CLogSystem::GetInstance().LogDeferred(s_LogSite, __VA_ARGS__); \
+		} \
+	} while (0)
+
+// LOG_LIMITED_CH(RENDER, WARNING, 10, "...") logs at most 10 messages a second from that line, whatever the channel's limit.
+#define LOG_LIMITED_CH(Channel, Level, nMessagesPerSecond, ...) \
+	do { \
+		if constexpr (CLogSystem::IsCompiledIn(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_##Level)) { \
+			static CLogSystem::LogSite_t s_LogSite{ CLogSystem::LEVEL_##Level, __FILE__, __LINE__, CLogSystem::CHANNEL_##Channel, nMessagesPerSecond }; \
+			CLogSystem::GetInstance().LogDeferred(s_LogSite, __VA_ARGS__); \
+		} \
+	} while (0)
+
+// LOG_WARNING_CH(RENDER, "...") logs to CLogSystem::CHANNEL_RENDER.
+#define LOG_DEBUG_CH(Channel, ...)    LOG_CHANNEL(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO_CH(Channel, ...)     LOG_CHANNEL(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARNING_CH(Channel, ...)  LOG_CHANNEL(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_WARNING, __VA_ARGS__)
+#define LOG_ERROR_CH(Channel, ...)    LOG_CHANNEL(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_ERROR, __VA_ARGS__)
+#define LOG_FATAL_CH(Channel, ...)    LOG_CHANNEL(CLogSystem::CHANNEL_##Channel, CLogSystem::LEVEL_FATAL, __VA_ARGS__)
+
+#define LOG_DEBUG(...)    LOG_DEBUG_CH(GENERAL, __VA_ARGS__)
+#define LOG_INFO(...)     LOG_INFO_CH(GENERAL, __VA_ARGS__)
+#define LOG_WARNING(...)  LOG_WARNING_CH(GENERAL, __VA_ARGS__)
+#define LOG_ERROR(...)    LOG_ERROR_CH(GENERAL, __VA_ARGS__)
+#define LOG_FATAL(...)    LOG_FATAL_CH(GENERAL, __VA_ARGS__)
 
 #define LOG_DEBUG_S(...)    CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_DEBUG, __VA_ARGS__)
 #define LOG_INFO_S(...)     CLogSystem::GetInstance().LogF(CLogSystem::LEVEL_INFO, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "CProfiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "../logging/CLogSystem.hpp"
+
+static_assert((CProfiler::THREAD_BUFFER_CAPACITY & (CProfiler::THREAD_BUFFER_CAPACITY - 1)) == 0, "Profiler thread buffer capacity must be a power of two");
+
+// Single producer (the owning thread), single consumer (whoever calls Collect, under m_ThreadsMutex).
+struct CProfiler::ThreadBuffer_t {
+	Event_t Events[THREAD_BUFFER_CAPACITY];
+	alignas(64) std::atomic<size_t> nWrite = 0;
+	alignas(64) std::atomic<size_t> nRead = 0;
+	std::atomic<uint64_t> nDropped = 0;
+	std::atomic<bool> bExited = false;
+	uint32_t nThread = 0;
+};
+
+namespace {
+	struct FrameNode_t {
+		CProfiler::ScopeStats_t Stats;
+		std::vector<size_t> Children;
+	};
+
+	void AppendDepthFirst(std::vector<CProfiler::ScopeStats_t>& Out, const std::vector<FrameNode_t>& Nodes, size_t nNode) {
+		Out.push_back(Nodes[nNode].Stats);
+		for (size_t nChild : Nodes[nNode].Children) {
+			AppendDepthFirst(Out, Nodes, nChild);
+		}
+	}
+
+	void AppendJsonString(std::string& strOut, const char* szValue) {
+		strOut += '"';
+		for (const char* p = szValue; *p; ++p) {
+			if (*p == '"' || *p == '\\') {
+				strOut += '\\';
+			}
+			strOut += *p;
+		}
+		strOut += '"';
+	}
+}
+
+CProfiler& CProfiler::GetInstance() {
+	static CProfiler Instance;
+	return Instance;
+}
+
+CProfiler::CProfiler() : m_nFrameStart(GetTimestamp()) {}
+CProfiler::~CProfiler() = default;
+
+int64_t CProfiler::GetTimestamp() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CProfiler::ThreadBuffer_t& CProfiler::GetThreadBuffer() {
+	// The profiler keeps the buffer alive after its thread exits until the remaining events are collected.
+	struct Holder_t {
+		std::shared_ptr<ThreadBuffer_t> pBuffer;
+		~Holder_t() {
+			if (pBuffer) {
+				pBuffer->bExited.store(true, std::memory_order_release);
+			}
+		}
+	};
+	thread_local ThreadBuffer_t* t_pBuffer = nullptr;
+	thread_local Holder_t t_Holder;
+
+	if (!t_pBuffer) {
+		auto pBuffer = std::make_shared<ThreadBuffer_t>();
+
+		CProfiler& Profiler = GetInstance();
+		{
+			std::lock_guard<std::mutex> lock(Profiler.m_ThreadsMutex);
+			pBuffer->nThread = Profiler.m_nNextThreadId++;
+			Profiler.m_ThreadNames.push_back("Thread " + std::to_string(pBuffer->nThread));
+			Profiler.m_Threads.push_back(pBuffer);
+		}
+
+		t_pBuffer = pBuffer.get();
+		t_Holder.pBuffer = std::move(pBuffer);
+	}
+	return *t_pBuffer;
+}
+
+void CProfiler::RecordScope(const char* szName, int64_t nStart, int64_t nEnd) {
+	ThreadBuffer_t& Buffer = GetThreadBuffer();
+
+	const size_t nWrite = Buffer.nWrite.load(std::memory_order_relaxed);
+	if (nWrite - Buffer.nRead.load(std::memory_order_acquire) >= THREAD_BUFFER_CAPACITY) {
+		Buffer.nDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Buffer.Events[nWrite & (THREAD_BUFFER_CAPACITY - 1)] = { szName, nStart, nEnd, Buffer.nThread };
+	Buffer.nWrite.store(nWrite + 1, std::memory_order_release);
+}
+
+void CProfiler::SetThreadName(const std::string& strName) {
+	const uint32_t nThread = GetThreadBuffer().nThread;
+
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+	m_ThreadNames[nThread - 1] = strName;
+}
+
+uint64_t CProfiler::GetDroppedEventCount() const {
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+
+	uint64_t nDropped = m_nDroppedFromExitedThreads;
+	for (const auto& pBuffer : m_Threads) {
+		nDropped += pBuffer->nDropped.load(std::memory_order_relaxed);
+	}
+	return nDropped;
+}
+
+void CProfiler::Collect(std::vector<Event_t>& Events) {
+	std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+
+	for (auto it = m_Threads.begin(); it != m_Threads.end();) {
+		ThreadBuffer_t& Buffer = **it;
+
+		// Checked first: anything the thread wrote before exiting is visible below.
+		const bool bExited = Buffer.bExited.load(std::memory_order_acquire);
+
+		size_t nRead = Buffer.nRead.load(std::memory_order_relaxed);
+		const size_t nWrite = Buffer.nWrite.load(std::memory_order_acquire);
+		for (; nRead != nWrite; ++nRead) {
+			Events.push_back(Buffer.Events[nRead & (THREAD_BUFFER_CAPACITY - 1)]);
+		}
+		Buffer.nRead.store(nRead, std::memory_order_release);
+
+		if (bExited) {
+			m_nDroppedFromExitedThreads += Buffer.nDropped.load(std::memory_order_relaxed);
+			it = m_Threads.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void CProfiler::EndFrame() {
+	const int64_t nNow = GetTimestamp();
+
+	// The frame itself is the root scope of the calling thread.
+	RecordScope("Frame", m_nFrameStart, nNow);
+
+	m_FrameEvents.clear();
+	Collect(m_FrameEvents);
+	BuildFrameTree(m_FrameEvents);
+
+	m_flLastFrameMs = static_cast<double>(nNow - m_nFrameStart) / 1e6;
+	m_nFrameStart = nNow;
+	++m_nFrameIndex;
+
+	if (m_bCapturing) {
+		AppendCaptureEvents(m_FrameEvents);
+	}
+}
+
+void CProfiler::BuildFrameTree(std::vector<Event_t>& Events) {
+	// Scopes on one thread nest, so with parents ordered before their children a stack of
+	// still-open scopes gives every event its parent.
+	std::sort(Events.begin(), Events.end(), [](const Event_t& a, const Event_t& b) {
+		if (a.nThread != b.nThread) {
+			return a.nThread < b.nThread;
+		}
+		if (a.nStart != b.nStart) {
+			return a.nStart < b.nStart;
+		}
+		return a.nEnd > b.nEnd;
+	});
+
+	struct OpenScope_t {
+		size_t nNode;
+		int64_t nEnd;
+	};
+
+	std::vector<FrameNode_t> Nodes;
+	std::vector<size_t> Roots;
+	std::vector<OpenScope_t> Stack;
+	uint32_t nThread = 0;
+
+	for (const Event_t& Event : Events) {
+		if (Event.nThread != nThread) {
+			Stack.clear();
+			nThread = Event.nThread;
+		}
+		while (!Stack.empty() && Stack.back().nEnd <= Event.nStart) {
+			Stack.pop_back();
+		}
+
+		const bool bRoot = Stack.empty();
+		const size_t nParent = bRoot ? 0 : Stack.back().nNode;
+		const std::vector<size_t>& Siblings = bRoot ? Roots : Nodes[nParent].Children;
+
+		auto it = std::find_if(Siblings.begin(), Siblings.end(), [&](size_t nNode) {
+			const ScopeStats_t& Stats = Nodes[nNode].Stats;
+			return Stats.nThread == Event.nThread && strcmp(Stats.szName, Event.szName) == 0;
+		});
+
+		size_t nNode;
+		if (it != Siblings.end()) {
+			nNode = *it;
+		}
+		else {
+			nNode = Nodes.size();
+			Nodes.push_back({ { Event.szName, Event.nThread, static_cast<uint32_t>(Stack.size()), 0, 0.0, 0.0 }, {} });
+			(bRoot ? Roots : Nodes[nParent].Children).push_back(nNode);
+		}
+
+		const double flMs = static_cast<double>(Event.nEnd - Event.nStart) / 1e6;
+		ScopeStats_t& Stats = Nodes[nNode].Stats;
+		++Stats.nCalls;
+		Stats.flTotalMs += flMs;
+		Stats.flSelfMs += flMs;
+		if (!bRoot) {
+			Nodes[nParent].Stats.flSelfMs -= flMs;
+		}
+
+		Stack.push_back({ nNode, Event.nEnd });
+	}
+
+	m_LastFrame.clear();
+	for (size_t nRoot : Roots) {
+		AppendDepthFirst(m_LastFrame, Nodes, nRoot);
+	}
+}
+
+void CProfiler::BeginCapture() {
+	m_CaptureEvents.clear();
+	m_nCaptureStart = GetTimestamp();
+	m_bCapturing = true;
+}
+
+void CProfiler::AppendCaptureEvents(const std::vector<Event_t>& Events) {
+	for (const Event_t& Event : Events) {
+		if (m_CaptureEvents.size() >= MAX_CAPTURE_EVENTS) {
+			break;
+		}
+		if (Event.nEnd >= m_nCaptureStart) {
+			m_CaptureEvents.push_back(Event);
+		}
+	}
+}
+
+bool CProfiler::EndCapture(const std::string& strFilePath) {
+	if (!m_bCapturing) {
+		return false;
+	}
+
+	// Scopes that finished since the last EndFrame().
+	std::vector<Event_t> Pending;
+	Collect(Pending);
+	AppendCaptureEvents(Pending);
+	m_bCapturing = false;
+
+	std::string strOut = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	{
+		std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+		for (size_t i = 0; i < m_ThreadNames.size(); ++i) {
+			strOut += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(i + 1) + ",\"args\":{\"name\":";
+			AppendJsonString(strOut, m_ThreadNames[i].c_str());
+			strOut += "}},\n";
+		}
+	}
+
+	char cBuffer[128];
+	for (const Event_t& Event : m_CaptureEvents) {
+		// Scopes that were already open when the capture started are cut at its start.
+		const int64_t nStart = std::max(Event.nStart, m_nCaptureStart);
+
+		strOut += "{\"name\":";
+		AppendJsonString(strOut, Event.szName);
+		snprintf(cBuffer, sizeof(cBuffer), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+			Event.nThread, static_cast<double>(nStart - m_nCaptureStart) / 1e3, static_cast<double>(Event.nEnd - nStart) / 1e3);
+		strOut += cBuffer;
+	}
+
+	// JSON doesn't allow a trailing comma.
+	if (strOut.size() >= 2 && strOut[strOut.size() - 2] == ',') {
+		strOut.erase(strOut.size() - 2, 1);
+	}
+	strOut += "]}\n";
+
+	std::ofstream File(strFilePath, std::ios::binary);
+	if (!File || !File.write(strOut.data(), static_cast<std::streamsize>(strOut.size()))) {
+		LOG_WARNING("Failed to write profiler capture to %s", strFilePath.c_str());
+		return false;
+	}
+
+	LOG_INFO("Wrote %zu profiler events to %s", m_CaptureEvents.size(), strFilePath.c_str());
+	if (m_CaptureEvents.size() >= MAX_CAPTURE_EVENTS) {
+		LOG_WARNING("Profiler capture was cut off at %zu events", MAX_CAPTURE_EVENTS);
+	}
+
+	m_CaptureEvents.clear();
+	m_CaptureEvents.shrink_to_fit();
+	return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Building with FOUNT_PROFILER_ENABLED=0 turns every PROFILE_* macro into nothing.
+#ifndef FOUNT_PROFILER_ENABLED
+#	define FOUNT_PROFILER_ENABLED 1
+#endif
+
+// Scoped CPU timing. Every thread writes finished scopes into its own lock-free buffer; EndFrame()
+// collects them on the main thread, builds the per-frame scope tree and, while a capture runs,
+// keeps them for export as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+class CProfiler {
+public:
+	struct Event_t {
+		const char* szName; // must be a literal or otherwise outlive the profiler
+		int64_t nStart;     // ns, GetTimestamp()
+		int64_t nEnd;
+		uint32_t nThread;
+	};
+
+	// One node of the frame's scope tree, in depth-first order. Calls with the same name under
+	// the same parent are merged.
+	struct ScopeStats_t {
+		const char* szName;
+		uint32_t nThread;
+		uint32_t nDepth;
+		uint32_t nCalls;
+		double flTotalMs;
+		double flSelfMs;
+	};
+
+	static constexpr size_t THREAD_BUFFER_CAPACITY = 16384;
+	static constexpr size_t MAX_CAPTURE_EVENTS = 1 << 21;
+
+	static CProfiler& GetInstance();
+
+	static int64_t GetTimestamp();
+
+	// Called by CProfileScope.
+	static void RecordScope(const char* szName, int64_t nStart, int64_t nEnd);
+
+	// Shown as the thread's name in traces.
+	void SetThreadName(const std::string& strName);
+
+	// Main thread, once per frame.
+	void EndFrame();
+
+	const std::vector<ScopeStats_t>& GetLastFrame() const { return m_LastFrame; }
+	double GetLastFrameTime() const { return m_flLastFrameMs; }
+	uint64_t GetFrameIndex() const { return m_nFrameIndex; }
+	uint64_t GetDroppedEventCount() const;
+
+	void BeginCapture();
+	// Writes everything recorded since BeginCapture() as Chrome trace JSON.
+	bool EndCapture(const std::string& strFilePath);
+	bool IsCapturing() const { return m_bCapturing; }
+
+private:
+	struct ThreadBuffer_t;
+
+	CProfiler();
+	~CProfiler();
+
+	CProfiler(const CProfiler&) = delete;
+	CProfiler& operator=(const CProfiler&) = delete;
+
+	static ThreadBuffer_t& GetThreadBuffer();
+
+	// Moves all finished events out of the thread buffers.
+	void Collect(std::vector<Event_t>& Events);
+	void BuildFrameTree(std::vector<Event_t>& Events);
+	void AppendCaptureEvents(const std::vector<Event_t>& Events);
+
+	mutable std::mutex m_ThreadsMutex;
+	std::vector<std::shared_ptr<ThreadBuffer_t>> m_Threads;
+	std::vector<std::string> m_ThreadNames; // by thread id - 1
+	uint32_t m_nNextThreadId = 1;
+	uint64_t m_nDroppedFromExitedThreads = 0;
+
+	std::vector<Event_t> m_FrameEvents;
+	std::vector<ScopeStats_t> m_LastFrame;
+	int64_t m_nFrameStart;
+	double m_flLastFrameMs = 0.0;
+	uint64_t m_nFrameIndex = 0;
+
+	bool m_bCapturing = false;
+	int64_t m_nCaptureStart = 0;
+	std::vector<Event_t> m_CaptureEvents;
+};
+
+class CProfileScope {
+public:
+	explicit CProfileScope(const char* szName) : m_szName(szName), m_nStart(CProfiler::GetTimestamp()) {}
+	~CProfileScope() { CProfiler::RecordScope(m_szName, m_nStart, CProfiler::GetTimestamp()); }
+
+	CProfileScope(const CProfileScope&) = delete;
+	CProfileScope& operator=(const CProfileScope&) = delete;
+
+private:
+	const char* m_szName;
+	int64_t m_nStart;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if FOUNT_PROFILER_ENABLED
+#	define PROFILE_SCOPE(szName)       CProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(szName)
+#	define PROFILE_FUNCTION()          PROFILE_SCOPE(__FUNCTION__)
+#	define PROFILE_FRAME()             CProfiler::GetInstance().EndFrame()
+#	define PROFILE_THREAD_NAME(strName) CProfiler::GetInstance().SetThreadName(strName)
+#else
+#	define PROFILE_SCOPE(szName)       ((void)0)
+#	define PROFILE_FUNCTION()          ((void)0)
+#	define PROFILE_FRAME()             ((void)0)
+#	define PROFILE_THREAD_NAME(strName) ((void)0)
+#endif
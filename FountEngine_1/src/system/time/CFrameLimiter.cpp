@@ -0,0 +1,111 @@
+#include "CFrameLimiter.hpp"
+
+#include <thread>
+
+#ifdef _WIN32
+#	include <windows.h>
+#	include <mmsystem.h>
+#	pragma comment(lib, "winmm.lib")
+#	ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#		define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#	endif
+#endif
+
+namespace {
+	// How early to wake up and spin. The high resolution timer (and sleep_for on other systems) is accurate
+	// to well under a millisecond, Sleep() with a 1 ms period can overshoot by one more.
+	constexpr std::chrono::microseconds TIMER_SPIN_MARGIN(500);
+	constexpr std::chrono::microseconds SLEEP_SPIN_MARGIN(2000);
+}
+
+CFrameLimiter::CFrameLimiter() {
+#ifdef _WIN32
+	m_hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+CFrameLimiter::~CFrameLimiter() {
+#ifdef _WIN32
+	if (m_hTimer) {
+		CloseHandle(m_hTimer);
+	}
+	if (m_bTimerPeriodSet) {
+		timeEndPeriod(1);
+	}
+#endif
+}
+
+void CFrameLimiter::SetTargetFrameRate(int nFramesPerSecond) {
+	m_nTargetFrameRate = nFramesPerSecond > 0 ? nFramesPerSecond : 0;
+	m_tFrameDuration = m_nTargetFrameRate > 0
+		? std::chrono::duration_cast<Clock_t::duration>(std::chrono::duration<double>(1.0 / m_nTargetFrameRate))
+		: Clock_t::duration::zero();
+	m_tNextFrame = Clock_t::time_point();
+
+#ifdef _WIN32
+	if (m_nTargetFrameRate > 0 && !m_hTimer && !m_bTimerPeriodSet) {
+		m_bTimerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+	}
+#endif
+}
+
+void CFrameLimiter::WaitForNextFrame() {
+	if (m_nTargetFrameRate == 0) {
+		return;
+	}
+
+	auto tNow = Clock_t::now();
+	if (m_tNextFrame == Clock_t::time_point()) {
+		m_tNextFrame = tNow + m_tFrameDuration;
+		return;
+	}
+
+	if (tNow < m_tNextFrame) {
+		SleepUntil(m_tNextFrame);
+		m_tNextFrame += m_tFrameDuration;
+	}
+	else {
+		// Missed the slot; start counting from now instead of rushing the following frames.
+		m_tNextFrame = tNow + m_tFrameDuration;
+	}
+}
+
+void CFrameLimiter::SleepUntil(Clock_t::time_point tTarget) {
+#ifdef _WIN32
+	if (m_hTimer) {
+		const auto tRemaining = tTarget - Clock_t::now();
+		if (tRemaining > TIMER_SPIN_MARGIN) {
+			// Relative due time in 100 ns units.
+			LARGE_INTEGER liDueTime;
+			liDueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::microseconds>(tRemaining - TIMER_SPIN_MARGIN).count()) * 10;
+			if (SetWaitableTimer(m_hTimer, &liDueTime, 0, nullptr, nullptr, FALSE)) {
+				WaitForSingleObject(m_hTimer, INFINITE);
+			}
+			else {
+				// The timer can't be armed; sleep like systems without one from now on instead of spinning.
+				CloseHandle(m_hTimer);
+				m_hTimer = nullptr;
+				if (!m_bTimerPeriodSet) {
+					m_bTimerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+				}
+			}
+		}
+	}
+
+	if (!m_hTimer) {
+		const auto tRemaining = tTarget - Clock_t::now();
+		if (tRemaining > SLEEP_SPIN_MARGIN) {
+			Sleep(static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(tRemaining - SLEEP_SPIN_MARGIN).count()));
+		}
+	}
+#else
+	const auto tRemaining = tTarget - Clock_t::now();
+	if (tRemaining > TIMER_SPIN_MARGIN) {
+		std::this_thread::sleep_for(tRemaining - TIMER_SPIN_MARGIN);
+	}
+#endif
+
+	while (Clock_t::now() < tTarget) {
+		std::this_thread::yield();
+	}
+}
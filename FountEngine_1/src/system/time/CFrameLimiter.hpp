@@ -0,0 +1,32 @@
+#pragma once
+#include <chrono>
+
+// Caps the frame rate without burning a core: sleeps on a high resolution waitable timer on Windows
+// (or Sleep() with a 1 ms timer period on older systems, sleep_for elsewhere) and spins only for the last bit.
+class CFrameLimiter {
+public:
+	CFrameLimiter();
+	~CFrameLimiter();
+
+	CFrameLimiter(const CFrameLimiter&) = delete;
+	CFrameLimiter& operator=(const CFrameLimiter&) = delete;
+
+	// 0 disables the limiter.
+	void SetTargetFrameRate(int nFramesPerSecond);
+	int GetTargetFrameRate() const { return m_nTargetFrameRate; }
+
+	// Call once per frame; returns when the next frame is due.
+	void WaitForNextFrame();
+
+private:
+	using Clock_t = std::chrono::steady_clock;
+
+	void SleepUntil(Clock_t::time_point tTarget);
+
+	void* m_hTimer = nullptr; // HANDLE
+	bool m_bTimerPeriodSet = false;
+
+	int m_nTargetFrameRate = 0;
+	Clock_t::duration m_tFrameDuration{};
+	Clock_t::time_point m_tNextFrame{};
+};
@@ -1,4 +1,9 @@
+#include <cstring>
+
 #include "engine/application/CApplication.hpp"
+#include "engine/graphicscontext/CGraphicsContext.hpp"
+#include "engine/window/CWin32Window.hpp"
+#include "render/backend/CD3D11RenderBackend.hpp"
 #include "system/logging/CLogSystem.hpp"
 
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ PSTR lpCmdLine, _In_ int nCmdShow) {
@@ -11,9 +16,21 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 	LOG_DEBUG("Starting Application...");
 	LOG_INFO("CLogSystem initialized successfully!");
 
+	// -precompileshaders fills the shader cache for shipping and exits; it needs no window or device.
+	if (strstr(lpCmdLine, "-precompileshaders")) {
+		CD3D11RenderBackend Backend;
+		bool bSucceeded = true;
+		for (const PipelineDesc_t& Desc : CGraphicsContext::GetPipelineDescs()) {
+			bSucceeded = Backend.PrecompilePipeline(Desc) && bSucceeded;
+		}
+		LOG_INFO("Shader precompilation %s", bSucceeded ? "succeeded" : "failed");
+		LogSystem.Shutdown();
+		return bSucceeded ? 0 : -1;
+	}
+
 	CApplication appMain;
 
-	if (!appMain.Initialize(hInstance, "Source Like Engine", 1280, 720)) {
+	if (!appMain.Initialize(std::make_unique<CWin32Window>(hInstance), std::make_unique<CD3D11RenderBackend>(), "Source Like Engine", 1280, 720)) {
 		LOG_FATAL("Failed to initialize application!");
 		return -1;
 	}
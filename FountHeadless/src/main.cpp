@@ -0,0 +1,587 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../FountEngine_1/src/engine/application/CApplication.hpp"
+#include "../../FountEngine_1/src/engine/scene/CScene.hpp"
+#include "../../FountEngine_1/src/engine/window/CHeadlessWindow.hpp"
+#include "../../FountEngine_1/src/render/backend/CNullRenderBackend.hpp"
+#include "../../FountEngine_1/src/render/mesh/CMesh.hpp"
+#include "../../FountEngine_1/src/render/mesh/COBJParser.hpp"
+#include "../../FountEngine_1/src/resources/resourcemanager/IResourceManager.hpp"
+#include "../../FountEngine_1/src/system/filesystem/CMappedFile.hpp"
+#include "../../FountEngine_1/src/system/jobs/CJobSystem.hpp"
+#include "../../FountEngine_1/src/system/logging/CLogSystem.hpp"
+#include "../../FountEngine_1/src/system/profiler/CProfiler.hpp"
+
+// Runs the real frame loop on CHeadlessWindow and CNullRenderBackend for a fixed number of frames
+// and reports frame timings and backend counters. Needs no GPU or window system, so it runs on the load-test machines.
+static void PrintUsage() {
+	printf("Usage: FountHeadless [--frames N] [--fps N] [--instances N] [--profile trace.json] [--mesh model.obj [--mesh-distance N] [--no-vertex-packing]] [--spatial-bench] [--obj-bench [model.obj]] [--job-bench [N]]\n");
+	printf("  --frames N            frames to run (default 1000)\n");
+	printf("  --fps N               frame rate limit, 0 runs uncapped (default 0)\n");
+	printf("  --instances N         instanced cubes drawn each frame (default 0)\n");
+	printf("  --profile trace.json  write a profiler capture of the whole run\n");
+	printf("  --mesh model.obj      also draw this mesh every frame, with LODs picked by its distance\n");
+	printf("  --mesh-distance N     how far in front of the camera the mesh is (default 10)\n");
+	printf("  --no-vertex-packing   upload the mesh as full float vertices instead of packed ones\n");
+	printf("  --spatial-bench       compare scene BVH queries against linear scans instead of running frames\n");
+	printf("  --obj-bench [file]    measure OBJ parsing and loading throughput on a file, or on a generated one\n");
+	printf("  --job-bench [N]       measure job system scaling from 1 to N threads (default one per core)\n");
+}
+
+namespace {
+	struct Summary_t {
+		double flMin = 0.0;
+		double flAverage = 0.0;
+		double flMedian = 0.0;
+		double flP95 = 0.0;
+		double flP99 = 0.0;
+		double flMax = 0.0;
+	};
+
+	Summary_t Summarize(std::vector<float> Values) {
+		Summary_t Summary;
+		if (Values.empty()) {
+			return Summary;
+		}
+
+		std::sort(Values.begin(), Values.end());
+		auto Percentile = [&](double flFraction) {
+			return Values[std::min(Values.size() - 1, static_cast<size_t>(flFraction * Values.size()))];
+		};
+
+		double flSum = 0.0;
+		for (float flValue : Values) {
+			flSum += flValue;
+		}
+
+		Summary.flMin = Values.front();
+		Summary.flAverage = flSum / Values.size();
+		Summary.flMedian = Percentile(0.5);
+		Summary.flP95 = Percentile(0.95);
+		Summary.flP99 = Percentile(0.99);
+		Summary.flMax = Values.back();
+		return Summary;
+	}
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point tStart) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	}
+
+	// Unit boxes scattered at a constant density, so a query touches about as many boxes at every
+	// scene size and only the cost of finding them grows. Every query is checked against a linear scan.
+	bool RunSpatialBenchmark() {
+		constexpr uint32_t QUERY_COUNT = 200;
+		constexpr float SPACING = 4.0f; // one box per SPACING^3
+		constexpr float QUERY_RADIUS = 6.0f;
+		constexpr float RAY_LENGTH = 100.0f;
+		bool bMatched = true;
+
+		printf("%8s %9s %9s %9s %7s %7s | %-27s | %-27s | %-27s\n", "entities", "build ms", "move 5%", "move all", "height", "SAH",
+			"ray us (bvh/scan, nodes)", "sphere us (bvh/scan, nodes)", "frustum us (bvh/scan, nodes)");
+
+		for (uint32_t nCount : { 1000u, 10000u, 100000u, 1000000u }) {
+			srand(1234);
+			auto Random = [](float flMin, float flMax) { return flMin + (flMax - flMin) * (rand() / static_cast<float>(RAND_MAX)); };
+			const float flSize = SPACING * cbrtf(static_cast<float>(nCount));
+
+			CScene Scene;
+			std::vector<EntityHandle_t> Entities;
+			for (uint32_t i = 0; i < nCount; ++i) {
+				EntityHandle_t hEntity = Scene.CreateEntity();
+				Scene.SetLocalBounds(hEntity, CMath::Vector3_t(-0.5f, -0.5f, -0.5f), CMath::Vector3_t(0.5f, 0.5f, 0.5f));
+				Scene.SetLocalTransform(hEntity, CMath::Matrix4x4_t::CreateTranslation(Random(0.0f, flSize), Random(0.0f, flSize), Random(0.0f, flSize)));
+				Entities.push_back(hEntity);
+			}
+			Scene.UpdateTransforms();
+
+			auto tStart = std::chrono::steady_clock::now();
+			const CAABBTree& Tree = Scene.GetSpatialTree();
+			const double flBuildMs = MillisecondsSince(tStart);
+
+			auto Jiggle = [&](uint32_t nStep) {
+				for (uint32_t i = 0; i < nCount; i += nStep) {
+					const CMath::Matrix4x4_t& mLocal = Scene.GetLocalTransform(Entities[i]);
+					Scene.SetLocalTransform(Entities[i], CMath::Matrix4x4_t::CreateTranslation(
+						mLocal.m[3][0] + Random(-0.5f, 0.5f), mLocal.m[3][1] + Random(-0.5f, 0.5f), mLocal.m[3][2] + Random(-0.5f, 0.5f)));
+				}
+				Scene.UpdateTransforms();
+				Scene.GetSpatialTree();
+				return Scene.GetSpatialSyncStats().flSyncMs;
+			};
+			const double flMoveSomeMs = Jiggle(20);
+			const double flMoveAllMs = Jiggle(1);
+
+			const size_t nEntities = Scene.GetEntityCount();
+			std::span<const float> CenterX = Scene.GetWorldCentersX(), CenterY = Scene.GetWorldCentersY(), CenterZ = Scene.GetWorldCentersZ();
+			std::span<const float> ExtentX = Scene.GetWorldExtentsX(), ExtentY = Scene.GetWorldExtentsY(), ExtentZ = Scene.GetWorldExtentsZ();
+			auto GetBounds = [&](size_t i) {
+				return AABB_t::FromCenterExtent(CMath::Vector3_t(CenterX[i], CenterY[i], CenterZ[i]), CMath::Vector3_t(ExtentX[i], ExtentY[i], ExtentZ[i]));
+			};
+
+			std::vector<CMath::Vector3_t> Origins, Directions;
+			std::vector<CMath::Frustum_t> Frustums;
+			const CMath::Matrix4x4_t mProjection = CMath::Matrix4x4_t::CreatePerspectiveFieldOfView(1.0f, 16.0f / 9.0f, 0.1f, 30.0f);
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				CMath::Vector3_t vecOrigin(Random(0.0f, flSize), Random(0.0f, flSize), Random(0.0f, flSize));
+				CMath::Vector3_t vecDirection(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+				Origins.push_back(vecOrigin);
+				Directions.push_back(vecDirection.Normalize());
+				Frustums.push_back(CMath::Frustum_t::FromViewProjection(
+					CMath::Matrix4x4_t::CreateLookAt(vecOrigin, vecOrigin + Directions.back(), CMath::Vector3_t(0.0f, 1.0f, 0.0f)) * mProjection));
+			}
+
+			// Tree and scan both count their results; the tree's node visits come from CAABBTree directly.
+			double flTreeMs[3] = {}, flScanMs[3] = {};
+			size_t nVisited[3] = {};
+			std::vector<EntityHandle_t> Results;
+
+			tStart = std::chrono::steady_clock::now();
+			std::vector<float> TreeHits;
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				float flDistance = -1.0f;
+				Scene.RayCast(Origins[q], Directions[q], RAY_LENGTH, &flDistance);
+				TreeHits.push_back(flDistance);
+			}
+			flTreeMs[0] = MillisecondsSince(tStart);
+			tStart = std::chrono::steady_clock::now();
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				const CMath::Vector3_t vecInvDirection(1.0f / Directions[q].x, 1.0f / Directions[q].y, 1.0f / Directions[q].z);
+				float flClosest = RAY_LENGTH, flHit = -1.0f;
+				for (size_t i = 0; i < nEntities; ++i) {
+					float flDistance = GetBounds(i).IntersectRay(Origins[q], vecInvDirection, flClosest);
+					if (flDistance >= 0.0f) {
+						flClosest = flHit = flDistance;
+					}
+				}
+				bMatched &= flHit == TreeHits[q];
+			}
+			flScanMs[0] = MillisecondsSince(tStart);
+
+			size_t nTreeResults = 0, nScanResults = 0;
+			tStart = std::chrono::steady_clock::now();
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				Results.clear();
+				Scene.QuerySphere(Origins[q], QUERY_RADIUS, Results);
+				nTreeResults += Results.size();
+			}
+			flTreeMs[1] = MillisecondsSince(tStart);
+			tStart = std::chrono::steady_clock::now();
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				for (size_t i = 0; i < nEntities; ++i) {
+					nScanResults += GetBounds(i).GetDistanceSq(Origins[q]) <= QUERY_RADIUS * QUERY_RADIUS ? 1 : 0;
+				}
+			}
+			flScanMs[1] = MillisecondsSince(tStart);
+			bMatched &= nTreeResults == nScanResults;
+
+			nTreeResults = nScanResults = 0;
+			tStart = std::chrono::steady_clock::now();
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				Results.clear();
+				Scene.QueryFrustum(Frustums[q], Results);
+				nTreeResults += Results.size();
+			}
+			flTreeMs[2] = MillisecondsSince(tStart);
+			tStart = std::chrono::steady_clock::now();
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				for (size_t i = 0; i < nEntities; ++i) {
+					nScanResults += Frustums[q].IntersectsAABB(
+						CMath::Vector3_t(CenterX[i], CenterY[i], CenterZ[i]), CMath::Vector3_t(ExtentX[i], ExtentY[i], ExtentZ[i])) ? 1 : 0;
+				}
+			}
+			flScanMs[2] = MillisecondsSince(tStart);
+			bMatched &= nTreeResults == nScanResults;
+
+			for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+				nVisited[0] += Tree.RayCast(Origins[q], Directions[q], RAY_LENGTH, [](int32_t, float flMax) { return flMax; });
+				nVisited[1] += Tree.QuerySphere(Origins[q], QUERY_RADIUS, [](int32_t) { return true; });
+				nVisited[2] += Tree.QueryFrustum(Frustums[q], [](int32_t) { return true; });
+			}
+
+			printf("%8u %9.2f %9.2f %9.2f %7d %7.1f", nCount, flBuildMs, flMoveSomeMs, flMoveAllMs, Tree.GetHeight(), Tree.GetSAHCost());
+			for (int k = 0; k < 3; ++k) {
+				printf(" | %8.1f /%9.1f, %6zu", flTreeMs[k] * 1000.0 / QUERY_COUNT, flScanMs[k] * 1000.0 / QUERY_COUNT, nVisited[k] / QUERY_COUNT);
+			}
+			printf("\n");
+		}
+
+		printf("results %s the linear scans\n", bMatched ? "match" : "DO NOT match");
+		return bMatched;
+	}
+
+	// Single-threaded OBJ parsing has to reach this median throughput; --obj-bench reports a miss.
+	constexpr double OBJ_TARGET_MB_PER_SECOND = 200.0;
+
+	// A grid with every corner as v/vt/vn: about 300k positions and 600k triangles, 59 MB.
+	bool WriteBenchmarkOBJ(const std::string& strPath) {
+		constexpr int GRID_SIZE = 548;
+		std::ofstream sFile(strPath, std::ios::binary | std::ios::trunc);
+		if (!sFile.is_open()) {
+			return false;
+		}
+
+		char szLine[256];
+		sFile << "# FountHeadless --obj-bench grid\n";
+		for (int y = 0; y < GRID_SIZE; ++y) {
+			for (int x = 0; x < GRID_SIZE; ++x) {
+				const float u = x / static_cast<float>(GRID_SIZE - 1), v = y / static_cast<float>(GRID_SIZE - 1);
+				sFile.write(szLine, snprintf(szLine, sizeof(szLine), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+					u * 100.0f - 50.0f, 0.5f * sinf(u * 20.0f) * cosf(v * 20.0f), v * 100.0f - 50.0f, u, v, 0.0f, 1.0f, 0.0f));
+			}
+		}
+		for (int y = 0; y + 1 < GRID_SIZE; ++y) {
+			for (int x = 0; x + 1 < GRID_SIZE; ++x) {
+				const int a = y * GRID_SIZE + x + 1, b = a + 1, c = a + GRID_SIZE, d = c + 1;
+				sFile.write(szLine, snprintf(szLine, sizeof(szLine), "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d/%d/%d %d/%d/%d %d/%d/%d\n",
+					a, a, a, c, c, c, b, b, b, b, b, b, c, c, c, d, d, d));
+			}
+		}
+		return sFile.good();
+	}
+
+	// Parses the file in place with COBJParser, then loads it through CMesh::LoadFromOBJ, which adds
+	// mapping, welding and bounds. Best and median of several runs; the first one also warms the page cache.
+	bool RunOBJBenchmark(std::string strPath) {
+		constexpr int RUN_COUNT = 5;
+
+		const bool bGenerated = strPath.empty();
+		if (bGenerated) {
+			strPath = (std::filesystem::temp_directory_path() / "fount_obj_bench.obj").string();
+			if (!WriteBenchmarkOBJ(strPath)) {
+				printf("failed to write %s\n", strPath.c_str());
+				return false;
+			}
+		}
+
+		CMappedFile File;
+		if (!File.Open(strPath)) {
+			printf("failed to open %s\n", strPath.c_str());
+			return false;
+		}
+		const double flMegabytes = static_cast<double>(File.GetSize()) / (1024.0 * 1024.0);
+
+		bool bSuccess = true;
+		std::vector<float> ParseRates, LoadRates;
+		size_t nCorners = 0, nVertices = 0;
+		for (int nRun = 0; nRun < RUN_COUNT && bSuccess; ++nRun) {
+			COBJParser Parser;
+			auto tStart = std::chrono::steady_clock::now();
+			bSuccess = Parser.Parse(File.GetData(), File.GetSize(), strPath);
+			ParseRates.push_back(static_cast<float>(flMegabytes / (MillisecondsSince(tStart) / 1000.0)));
+			nCorners = Parser.GetCorners().size();
+
+			CMesh Mesh;
+			tStart = std::chrono::steady_clock::now();
+			bSuccess = bSuccess && Mesh.LoadFromOBJ(strPath);
+			LoadRates.push_back(static_cast<float>(flMegabytes / (MillisecondsSince(tStart) / 1000.0)));
+			nVertices = Mesh.GetVertices().size();
+		}
+		File.Close();
+		if (bGenerated) {
+			std::error_code ErrorCode;
+			std::filesystem::remove(strPath, ErrorCode);
+		}
+
+		if (!bSuccess) {
+			printf("failed to parse %s\n", strPath.c_str());
+			return false;
+		}
+
+		const Summary_t Parse = Summarize(std::move(ParseRates));
+		const Summary_t Load = Summarize(std::move(LoadRates));
+		printf("%s: %.1f MB, %zu triangles, %zu unique vertices\n", bGenerated ? "generated grid" : strPath.c_str(), flMegabytes, nCorners / 3, nVertices);
+		printf("  parse  best %7.1f  median %7.1f MB/s\n", Parse.flMax, Parse.flMedian);
+		printf("  load   best %7.1f  median %7.1f MB/s\n", Load.flMax, Load.flMedian);
+		printf("parsing %s the %.0f MB/s target\n", Parse.flMedian >= OBJ_TARGET_MB_PER_SECOND ? "meets" : "MISSES", OBJ_TARGET_MB_PER_SECOND);
+		return true;
+	}
+
+	// The same work on job systems of 1 to nMaxThreads threads: a ParallelFor over a large array, whose
+	// speedup is against the single thread run, and a batch of empty jobs for the per-job overhead.
+	bool RunJobBenchmark(unsigned int nMaxThreads) {
+		constexpr size_t ELEMENT_COUNT = 1 << 22;
+		constexpr int TINY_JOB_COUNT = 100000;
+		constexpr int RUN_COUNT = 5;
+
+		std::vector<float> Input(ELEMENT_COUNT), Output(ELEMENT_COUNT), Expected(ELEMENT_COUNT);
+		for (size_t i = 0; i < ELEMENT_COUNT; ++i) {
+			Input[i] = static_cast<float>(i % 1000) * 0.01f;
+		}
+		auto Work = [&Input](std::vector<float>& Result, size_t nBegin, size_t nEnd) {
+			for (size_t i = nBegin; i < nEnd; ++i) {
+				Result[i] = sqrtf(Input[i]) * sinf(Input[i]) + cosf(Input[i] * 0.5f);
+			}
+		};
+		Work(Expected, 0, ELEMENT_COUNT);
+
+		bool bMatched = true;
+		double flSingleThreadMs = 0.0;
+		printf("%7s | %-29s | %-22s\n", "threads", "parallel for ms (best/median)", "tiny jobs ns/job");
+
+		for (unsigned int nThreads = 1; nThreads <= nMaxThreads; ++nThreads) {
+			CJobSystem JobSystem(nThreads);
+
+			std::vector<float> ForTimes, JobTimes;
+			for (int nRun = 0; nRun < RUN_COUNT; ++nRun) {
+				std::fill(Output.begin(), Output.end(), 0.0f);
+				auto tStart = std::chrono::steady_clock::now();
+				JobSystem.ParallelFor(0, ELEMENT_COUNT, 0, [&](size_t nBegin, size_t nEnd) { Work(Output, nBegin, nEnd); });
+				ForTimes.push_back(static_cast<float>(MillisecondsSince(tStart)));
+				bMatched = bMatched && Output == Expected;
+
+				std::atomic<int> nRan = 0;
+				CJobCounter Counter;
+				tStart = std::chrono::steady_clock::now();
+				for (int i = 0; i < TINY_JOB_COUNT; ++i) {
+					JobSystem.Run([&nRan] { nRan.fetch_add(1, std::memory_order_relaxed); }, &Counter);
+				}
+				JobSystem.Wait(Counter);
+				JobTimes.push_back(static_cast<float>(MillisecondsSince(tStart) * 1000000.0 / TINY_JOB_COUNT));
+				bMatched = bMatched && nRan.load() == TINY_JOB_COUNT;
+			}
+
+			const Summary_t For = Summarize(std::move(ForTimes));
+			const Summary_t Jobs = Summarize(std::move(JobTimes));
+			if (nThreads == 1) {
+				flSingleThreadMs = For.flMin;
+			}
+			printf("%7u | %8.2f %8.2f  %5.2fx speedup | %8.1f %8.1f\n", nThreads, For.flMin, For.flMedian,
+				For.flMin > 0.0 ? flSingleThreadMs / For.flMin : 0.0, Jobs.flMin, Jobs.flMedian);
+		}
+
+		if (!bMatched) {
+			printf("MISMATCH: a job system run lost jobs or computed different results\n");
+		}
+		return bMatched;
+	}
+
+	void PrintSummary(const char* szName, const Summary_t& Summary) {
+		printf("  %-9s min %7.3f  avg %7.3f  p50 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f ms\n", szName,
+			Summary.flMin, Summary.flAverage, Summary.flMedian, Summary.flP95, Summary.flP99, Summary.flMax);
+	}
+}
+
+int main(int argc, char** argv) {
+	uint64_t nFrames = 1000;
+	int nFrameRate = 0;
+	uint32_t nInstances = 0;
+	std::string strProfilePath;
+	bool bSpatialBenchmark = false;
+	bool bOBJBenchmark = false;
+	std::string strOBJBenchmarkPath;
+	bool bJobBenchmark = false;
+	unsigned int nJobBenchmarkThreads = 0;
+	bool bPackVertices = true;
+	std::string strMeshPath;
+	float flMeshDistance = 10.0f;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			nFrames = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			nFrameRate = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+			nInstances = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+			strProfilePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc) {
+			strMeshPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--mesh-distance") == 0 && i + 1 < argc) {
+			flMeshDistance = static_cast<float>(atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--no-vertex-packing") == 0) {
+			bPackVertices = false;
+		}
+		else if (strcmp(argv[i], "--spatial-bench") == 0) {
+			bSpatialBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--obj-bench") == 0) {
+			bOBJBenchmark = true;
+			if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+				strOBJBenchmarkPath = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "--job-bench") == 0) {
+			bJobBenchmark = true;
+			if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+				nJobBenchmarkThreads = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+			}
+		}
+		else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (nFrames == 0) {
+		PrintUsage();
+		return 1;
+	}
+
+	auto& LogSystem = CLogSystem::GetInstance();
+	LogSystem.SetConsoleColorsEnabled(false);
+	if (!LogSystem.Initialize("headless.log")) {
+		fprintf(stderr, "Failed to initialize log system!\n");
+		return 1;
+	}
+	LogSystem.SetMinLogLevel(CLogSystem::LEVEL_INFO);
+
+	if (bSpatialBenchmark) {
+		const bool bMatched = RunSpatialBenchmark();
+		LogSystem.Shutdown();
+		return bMatched ? 0 : 1;
+	}
+
+	if (bJobBenchmark) {
+		LogSystem.SetMinLogLevel(CLogSystem::LEVEL_WARNING);
+		const bool bMatched = RunJobBenchmark(nJobBenchmarkThreads != 0 ? nJobBenchmarkThreads : std::max(std::thread::hardware_concurrency(), 1u));
+		LogSystem.Shutdown();
+		return bMatched ? 0 : 1;
+	}
+
+	if (bOBJBenchmark) {
+		LogSystem.SetMinLogLevel(CLogSystem::LEVEL_WARNING);
+		const bool bSuccess = RunOBJBenchmark(strOBJBenchmarkPath);
+		LogSystem.Shutdown();
+		return bSuccess ? 0 : 1;
+	}
+
+	int nResult = 0;
+	{
+		CApplication appMain;
+		if (!appMain.Initialize(std::make_unique<CHeadlessWindow>(), std::make_unique<CNullRenderBackend>(), "Fount Headless", 1280, 720)) {
+			LOG_FATAL("Failed to initialize application!");
+			LogSystem.Shutdown();
+			return 1;
+		}
+		appMain.SetFrameRateLimit(nFrameRate);
+		appMain.GetGraphicsContext().SetCubeInstanceCount(nInstances);
+		if (!strMeshPath.empty()) {
+			// The camera starts at (0, 0, -3) looking down +Z.
+			CGraphicsContext& GraphicsContext = appMain.GetGraphicsContext();
+			IResourceManager::GetInstance().SetPackVerticesOnLoad(bPackVertices);
+			GraphicsContext.LoadMesh(strMeshPath);
+			GraphicsContext.SetMeshTransform(CMath::Matrix4x4_t::CreateTranslation(0.0f, 0.0f, flMeshDistance - 3.0f));
+			GraphicsContext.SetMeshEnabled(true);
+		}
+
+#if FOUNT_PROFILER_ENABLED
+		if (!strProfilePath.empty()) {
+			CProfiler::GetInstance().BeginCapture();
+		}
+#endif
+
+		nResult = appMain.Run(nFrames);
+
+#if FOUNT_PROFILER_ENABLED
+		if (!strProfilePath.empty()) {
+			CProfiler::GetInstance().EndCapture(strProfilePath);
+		}
+#endif
+
+		std::vector<float> Simulate, Render, Frame;
+		RenderQueueStats_t QueueStats;
+		SceneUpdateStats_t SceneStats;
+		CullStats_t CullStats;
+		LODStats_t LODStats;
+		ClusterCullStats_t ClusterStats;
+		for (const CApplication::FrameTiming_t& Timing : appMain.GetFrameTimings()) {
+			Simulate.push_back(Timing.flSimulateMs);
+			Render.push_back(Timing.flRenderMs);
+			Frame.push_back(Timing.flFrameMs);
+
+			QueueStats.nDraws += Timing.QueueStats.nDraws;
+			QueueStats.nInstances += Timing.QueueStats.nInstances;
+			QueueStats.nInstanceBytes += Timing.QueueStats.nInstanceBytes;
+			QueueStats.nBindsIssued += Timing.QueueStats.nBindsIssued;
+			QueueStats.nBindsSkipped += Timing.QueueStats.nBindsSkipped;
+			QueueStats.flSortMs += Timing.QueueStats.flSortMs;
+			QueueStats.flSubmitMs += Timing.QueueStats.flSubmitMs;
+
+			SceneStats.nEntities = std::max(SceneStats.nEntities, Timing.SceneStats.nEntities);
+			SceneStats.nUpdated += Timing.SceneStats.nUpdated;
+			SceneStats.nLevels = std::max(SceneStats.nLevels, Timing.SceneStats.nLevels);
+			SceneStats.flUpdateMs += Timing.SceneStats.flUpdateMs;
+
+			CullStats.nTested += Timing.CullStats.nTested;
+			CullStats.nVisible += Timing.CullStats.nVisible;
+			CullStats.nCulled += Timing.CullStats.nCulled;
+			CullStats.flCullMs += Timing.CullStats.flCullMs;
+
+			LODStats.nDraws += Timing.LODStats.nDraws;
+			LODStats.nTriangles += Timing.LODStats.nTriangles;
+			LODStats.nFullTriangles += Timing.LODStats.nFullTriangles;
+
+			ClusterStats.nTested += Timing.ClusterStats.nTested;
+			ClusterStats.nFrustumCulled += Timing.ClusterStats.nFrustumCulled;
+			ClusterStats.nBackfaceCulled += Timing.ClusterStats.nBackfaceCulled;
+			ClusterStats.nTrianglesTested += Timing.ClusterStats.nTrianglesTested;
+			ClusterStats.nTrianglesVisible += Timing.ClusterStats.nTrianglesVisible;
+			ClusterStats.nRanges += Timing.ClusterStats.nRanges;
+			ClusterStats.flCullMs += Timing.ClusterStats.flCullMs;
+		}
+
+		// Startup messages go out before the report.
+		LogSystem.Flush();
+
+		const IRenderBackend& Backend = appMain.GetGraphicsContext().GetBackend();
+		const RenderStats_t& Stats = Backend.GetTotalStats();
+		const double flFrames = static_cast<double>(std::max<size_t>(Frame.size(), 1));
+
+		printf("%zu frames on the %s backend\n", Frame.size(), Backend.GetName());
+		PrintSummary("simulate", Summarize(std::move(Simulate)));
+		PrintSummary("render", Summarize(std::move(Render)));
+		PrintSummary("frame", Summarize(std::move(Frame)));
+		printf("  draws %llu (%.1f/frame), indices %llu, buffers created %llu, buffer updates %llu (%.1f/frame, %llu bytes)\n",
+			static_cast<unsigned long long>(Stats.nDrawCalls), Stats.nDrawCalls / flFrames,
+			static_cast<unsigned long long>(Stats.nIndices),
+			static_cast<unsigned long long>(Stats.nBufferCreations),
+			static_cast<unsigned long long>(Stats.nBufferUpdates), Stats.nBufferUpdates / flFrames,
+			static_cast<unsigned long long>(Stats.nBytesUpdated));
+		printf("  pipeline binds %llu, buffer binds %llu\n",
+			static_cast<unsigned long long>(Stats.nPipelineBinds),
+			static_cast<unsigned long long>(Stats.nBufferBinds));
+		printf("  queue: %.1f draws/frame, %.1f instances/frame (%.0f instance bytes/frame), binds issued %.1f/frame, skipped %.1f/frame, sort %.3f ms/frame, submit %.3f ms/frame\n",
+			QueueStats.nDraws / flFrames, QueueStats.nInstances / flFrames, QueueStats.nInstanceBytes / flFrames, QueueStats.nBindsIssued / flFrames, QueueStats.nBindsSkipped / flFrames,
+			QueueStats.flSortMs / flFrames, QueueStats.flSubmitMs / flFrames);
+		printf("  scene: %llu entities in %u levels, %.1f transforms updated/frame, update %.3f ms/frame\n",
+			static_cast<unsigned long long>(SceneStats.nEntities), SceneStats.nLevels,
+			SceneStats.nUpdated / flFrames, SceneStats.flUpdateMs / flFrames);
+		printf("  culling: %.1f tested/frame, %.1f visible, %.1f culled, %.3f ms/frame\n",
+			CullStats.nTested / flFrames, CullStats.nVisible / flFrames, CullStats.nCulled / flFrames, CullStats.flCullMs / flFrames);
+		printf("  lod: %.1f draws/frame, %.1f triangles/frame of %.1f at full detail (%.1f%% fewer)\n",
+			LODStats.nDraws / flFrames, LODStats.nTriangles / flFrames, LODStats.nFullTriangles / flFrames,
+			LODStats.nFullTriangles ? 100.0 * (1.0 - static_cast<double>(LODStats.nTriangles) / LODStats.nFullTriangles) : 0.0);
+		printf("  clusters: %.1f tested/frame, %.1f outside the frustum, %.1f back facing, %.1f of %.1f triangles kept in %.1f draws, %.3f ms/frame\n",
+			ClusterStats.nTested / flFrames, ClusterStats.nFrustumCulled / flFrames, ClusterStats.nBackfaceCulled / flFrames,
+			ClusterStats.nTrianglesVisible / flFrames, ClusterStats.nTrianglesTested / flFrames, ClusterStats.nRanges / flFrames, ClusterStats.flCullMs / flFrames);
+
+		const IResourceManager& ResourceManager = IResourceManager::GetInstance();
+		const CMeshCache::Stats_t MeshStats = ResourceManager.GetMeshCacheStats();
+		printf("  meshes: %llu loads (%.1f ms each), cache %llu hits, %llu misses, %llu entries (%llu pruned), %llu evictions (%llu bytes), %zu of %zu bytes resident\n",
+			static_cast<unsigned long long>(MeshStats.nLoads), MeshStats.nLoads ? MeshStats.nLoadTimeMicroseconds / 1000.0 / MeshStats.nLoads : 0.0,
+			static_cast<unsigned long long>(MeshStats.nHits), static_cast<unsigned long long>(MeshStats.nMisses),
+			static_cast<unsigned long long>(MeshStats.nEntries), static_cast<unsigned long long>(MeshStats.nPruned),
+			static_cast<unsigned long long>(MeshStats.nEvictions), static_cast<unsigned long long>(MeshStats.nEvictedBytes),
+			ResourceManager.GetResidentMeshMemory(), ResourceManager.GetMeshMemoryBudget());
+	}
+
+	LogSystem.Shutdown();
+	return nResult;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+// Just enough of a test harness for ctest: TEST(Name) registers a case with tests/main.cpp,
+// CHECK records a failure and keeps going so one run reports every broken check.
+struct TestCase_t {
+	const char* szName;
+	void (*pfnRun)();
+};
+
+std::vector<TestCase_t>& GetTestCases();
+void ReportFailure(const char* szFile, int nLine, const char* szExpression);
+
+struct TestRegistrar_t {
+	TestRegistrar_t(const char* szName, void (*pfnRun)()) { GetTestCases().push_back({ szName, pfnRun }); }
+};
+
+#define TEST(Name) \
+	static void Test_##Name(); \
+	static TestRegistrar_t s_TestRegistrar_##Name(#Name, Test_##Name); \
+	static void Test_##Name()
+
+#define CHECK(Expression) \
+	do { \
+		if (!(Expression)) { \
+			ReportFailure(__FILE__, __LINE__, #Expression); \
+		} \
+	} while (0)
+
+// Relative to the larger magnitude, absolute below 1.
+inline bool IsNear(double flActual, double flExpected, double flEpsilon) {
+	return std::fabs(flActual - flExpected) <= flEpsilon * std::fmax(1.0, std::fmax(std::fabs(flActual), std::fabs(flExpected)));
+}
+
+#define CHECK_NEAR(flActual, flExpected, flEpsilon) \
+	do { \
+		if (!IsNear((flActual), (flExpected), (flEpsilon))) { \
+			ReportFailure(__FILE__, __LINE__, #flActual " near " #flExpected); \
+		} \
+	} while (0)
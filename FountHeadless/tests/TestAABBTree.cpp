@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../FountEngine_1/src/engine/scene/CAABBTree.hpp"
+#include "Test.hpp"
+
+// Every query against a brute-force test of the same fat boxes over all live proxies.
+namespace {
+	struct Random_t {
+		uint32_t nState = 0x2468ace1u;
+
+		float Next(float flMin, float flMax) {
+			nState = nState * 1664525u + 1013904223u;
+			return flMin + (flMax - flMin) * static_cast<float>(nState >> 8) / static_cast<float>(1u << 24);
+		}
+
+		CMath::Vector3_t NextVector3(float flRange) { return CMath::Vector3_t(Next(-flRange, flRange), Next(-flRange, flRange), Next(-flRange, flRange)); }
+
+		AABB_t NextBox() {
+			const float flSize = Next(0.0f, 1.0f);
+			return AABB_t::FromCenterExtent(NextVector3(50.0f), CMath::Vector3_t(Next(0.1f, 3.0f), Next(0.1f, 3.0f), Next(0.1f, 3.0f)) * (flSize * flSize));
+		}
+	};
+
+	std::vector<int32_t> Sorted(std::vector<int32_t> Proxies) {
+		std::sort(Proxies.begin(), Proxies.end());
+		return Proxies;
+	}
+
+	// A box-shaped frustum with two of its sides slanted, so both axis and diagonal planes are tested.
+	CMath::Frustum_t MakeFrustum(const CMath::Vector3_t& vecCenter, float flSize) {
+		const float flInvSqrt2 = 1.0f / sqrtf(2.0f);
+		const CMath::Vector3_t aNormals[CMath::Frustum_t::PLANE_COUNT] = {
+			CMath::Vector3_t(flInvSqrt2, flInvSqrt2, 0.0f), CMath::Vector3_t(-1.0f, 0.0f, 0.0f),
+			CMath::Vector3_t(0.0f, 1.0f, 0.0f), CMath::Vector3_t(0.0f, -flInvSqrt2, flInvSqrt2),
+			CMath::Vector3_t(0.0f, 0.0f, 1.0f), CMath::Vector3_t(0.0f, 0.0f, -1.0f)
+		};
+
+		CMath::Frustum_t Frustum;
+		for (int p = 0; p < CMath::Frustum_t::PLANE_COUNT; ++p) {
+			Frustum.Planes[p].vecNormal = aNormals[p];
+			Frustum.Planes[p].flDistance = flSize - aNormals[p].Dot(vecCenter);
+		}
+		return Frustum;
+	}
+
+	// Runs every kind of query on the tree and compares it with testing each live proxy. Returns the number of mismatches.
+	int CheckQueries(const CAABBTree& Tree, const std::vector<int32_t>& Live, Random_t& Random, int nQueries) {
+		int nWrong = 0;
+		for (int q = 0; q < nQueries; ++q) {
+			std::vector<int32_t> Found, Expected;
+			auto Collect = [&](int32_t nProxy) {
+				Found.push_back(nProxy);
+				return true;
+			};
+
+			const AABB_t Bounds = AABB_t::FromCenterExtent(Random.NextVector3(50.0f), CMath::Vector3_t(10.0f, 5.0f, 8.0f));
+			Tree.QueryAABB(Bounds, Collect);
+			for (int32_t nProxy : Live) {
+				if (Tree.GetFatBounds(nProxy).Overlaps(Bounds)) {
+					Expected.push_back(nProxy);
+				}
+			}
+			nWrong += Sorted(Found) != Sorted(Expected);
+
+			Found.clear();
+			Expected.clear();
+			const CMath::Vector3_t vecCenter = Random.NextVector3(50.0f);
+			const float flRadius = Random.Next(1.0f, 15.0f);
+			Tree.QuerySphere(vecCenter, flRadius, Collect);
+			for (int32_t nProxy : Live) {
+				if (Tree.GetFatBounds(nProxy).GetDistanceSq(vecCenter) <= flRadius * flRadius) {
+					Expected.push_back(nProxy);
+				}
+			}
+			nWrong += Sorted(Found) != Sorted(Expected);
+
+			Found.clear();
+			Expected.clear();
+			const CMath::Frustum_t Frustum = MakeFrustum(Random.NextVector3(40.0f), Random.Next(5.0f, 30.0f));
+			Tree.QueryFrustum(Frustum, Collect);
+			for (int32_t nProxy : Live) {
+				const AABB_t& Fat = Tree.GetFatBounds(nProxy);
+				if (Frustum.IntersectsAABB(Fat.GetCenter(), Fat.GetExtent())) {
+					Expected.push_back(nProxy);
+				}
+			}
+			nWrong += Sorted(Found) != Sorted(Expected);
+
+			// A callback that keeps the max distance sees every box the ray enters.
+			Found.clear();
+			Expected.clear();
+			const CMath::Vector3_t vecOrigin = Random.NextVector3(60.0f);
+			const CMath::Vector3_t vecDirection = (Random.NextVector3(50.0f) - vecOrigin).Normalize();
+			const CMath::Vector3_t vecInvDirection(1.0f / vecDirection.x, 1.0f / vecDirection.y, 1.0f / vecDirection.z);
+			Tree.RayCast(vecOrigin, vecDirection, 80.0f, [&](int32_t nProxy, float flMaxDistance) {
+				Found.push_back(nProxy);
+				return flMaxDistance;
+			});
+			for (int32_t nProxy : Live) {
+				if (Tree.GetFatBounds(nProxy).IntersectRay(vecOrigin, vecInvDirection, 80.0f) >= 0.0f) {
+					Expected.push_back(nProxy);
+				}
+			}
+			nWrong += Sorted(Found) != Sorted(Expected);
+		}
+		return nWrong;
+	}
+}
+
+// Proxies are created, moved and destroyed at random; the tree finds exactly what a brute-force test finds.
+TEST(AABBTreeMatchesBruteForce) {
+	CAABBTree Tree;
+	Random_t Random;
+	std::vector<int32_t> Live;
+	std::vector<AABB_t> Boxes;
+
+	for (uint32_t i = 0; i < 1000; ++i) {
+		Boxes.push_back(Random.NextBox());
+		Live.push_back(Tree.CreateProxy(Boxes.back(), i));
+		CHECK(Tree.GetUserData(Live.back()) == i);
+		CHECK(Tree.GetFatBounds(Live.back()).Contains(Boxes.back()));
+	}
+	CHECK(Tree.GetProxyCount() == 1000);
+	CHECK(CheckQueries(Tree, Live, Random, 50) == 0);
+
+	for (int nRound = 0; nRound < 5; ++nRound) {
+		// Small moves mostly stay inside the fat box, large ones reinsert.
+		size_t nReinserted = 0;
+		for (size_t i = 0; i < Live.size(); ++i) {
+			const float flStep = i % 2 ? 0.05f : 5.0f;
+			Boxes[i] = AABB_t::FromCenterExtent(Boxes[i].GetCenter() + Random.NextVector3(flStep), Boxes[i].GetExtent());
+			nReinserted += Tree.MoveProxy(Live[i], Boxes[i]);
+			CHECK(Tree.GetFatBounds(Live[i]).Contains(Boxes[i]));
+		}
+		CHECK(nReinserted >= Live.size() / 2 && nReinserted < Live.size());
+
+		// Destroy a few and create others, which reuse their nodes.
+		for (int i = 0; i < 100; ++i) {
+			const size_t nIndex = static_cast<size_t>(Random.Next(0.0f, static_cast<float>(Live.size() - 1)));
+			Tree.DestroyProxy(Live[nIndex]);
+			Live[nIndex] = Live.back();
+			Boxes[nIndex] = Boxes.back();
+			Live.pop_back();
+			Boxes.pop_back();
+		}
+		for (int i = 0; i < 80; ++i) {
+			Boxes.push_back(Random.NextBox());
+			Live.push_back(Tree.CreateProxy(Boxes.back(), static_cast<uint32_t>(Live.size())));
+		}
+		CHECK(Tree.GetProxyCount() == Live.size());
+		CHECK(CheckQueries(Tree, Live, Random, 20) == 0);
+	}
+
+	// Balanced inserts keep the height near log2 of the count.
+	CHECK(Tree.GetHeight() <= 4 * static_cast<int32_t>(std::log2(static_cast<double>(Live.size()))));
+
+	// Bulk updates, through a refit and through a rebuild.
+	for (size_t i = 0; i < Live.size(); ++i) {
+		Boxes[i] = Random.NextBox();
+		Tree.UpdateProxyBounds(Live[i], Boxes[i]);
+	}
+	Tree.Refit();
+	CHECK(CheckQueries(Tree, Live, Random, 20) == 0);
+	Tree.Rebuild();
+	CHECK(CheckQueries(Tree, Live, Random, 20) == 0);
+
+	for (int32_t nProxy : Live) {
+		Tree.DestroyProxy(nProxy);
+	}
+	CHECK(Tree.GetProxyCount() == 0 && Tree.GetHeight() == 0);
+	size_t nFound = 0;
+	Tree.QueryAABB(AABB_t::FromCenterExtent(CMath::Vector3_t(0.0f, 0.0f, 0.0f), CMath::Vector3_t(1e6f, 1e6f, 1e6f)), [&](int32_t) {
+		++nFound;
+		return true;
+	});
+	CHECK(nFound == 0);
+}
+
+// Points at powers of two, out both ways along each axis, leave a binned SAH split a point or two to peel
+// off per level: unbounded, that builds a tree over 180 levels deep. Rebuild has to keep it shallow anyway.
+TEST(AABBTreeDegenerateRebuild) {
+	CAABBTree Tree(0.0f);
+	std::vector<int32_t> Live;
+	for (int nAxis = 0; nAxis < 3; ++nAxis) {
+		for (float flSign : { 1.0f, -1.0f }) {
+			for (int nExponent = -120; nExponent <= 126; ++nExponent) {
+				float aPosition[3] = {};
+				aPosition[nAxis] = flSign * ldexpf(1.0f, nExponent);
+				const CMath::Vector3_t vecPosition(aPosition[0], aPosition[1], aPosition[2]);
+				Live.push_back(Tree.CreateProxy({ vecPosition, vecPosition }, static_cast<uint32_t>(Live.size()), false));
+			}
+		}
+	}
+	Tree.Rebuild();
+	CHECK(Tree.GetHeight() <= 48 + 1 + static_cast<int32_t>(std::log2(static_cast<double>(Live.size()))));
+
+	size_t nFound = 0;
+	auto Count = [&](int32_t) {
+		++nFound;
+		return true;
+	};
+	Tree.QueryAABB(AABB_t::FromCenterExtent(CMath::Vector3_t(0.0f, 0.0f, 0.0f), CMath::Vector3_t(FLT_MAX, FLT_MAX, FLT_MAX)), Count);
+	CHECK(nFound == Live.size());
+
+	// Frustum and ray tests of nodes this large round differently from those of their leaves, box and sphere tests don't.
+	std::vector<int32_t> Found, Expected;
+	Tree.QuerySphere(CMath::Vector3_t(0.0f, 0.0f, 0.0f), 1.0f, [&](int32_t nProxy) {
+		Found.push_back(nProxy);
+		return true;
+	});
+	const AABB_t Bounds = { CMath::Vector3_t(-1.0f, 0.5f, -1.0f), CMath::Vector3_t(1.0f, 1e20f, 1.0f) };
+	Tree.QueryAABB(Bounds, [&](int32_t nProxy) {
+		Found.push_back(nProxy);
+		return true;
+	});
+	for (int32_t nProxy : Live) {
+		if (Tree.GetFatBounds(nProxy).GetDistanceSq(CMath::Vector3_t(0.0f, 0.0f, 0.0f)) <= 1.0f) {
+			Expected.push_back(nProxy);
+		}
+		if (Tree.GetFatBounds(nProxy).Overlaps(Bounds)) {
+			Expected.push_back(nProxy);
+		}
+	}
+	CHECK(!Expected.empty() && Sorted(Found) == Sorted(Expected));
+
+	// Nested boxes inserted one at a time all overlap, so the queries open every node of the tree.
+	constexpr int PROXY_COUNT = 2000;
+	CAABBTree Chain(0.0f);
+	for (int i = 0; i < PROXY_COUNT; ++i) {
+		const float flExtent = 1.0f + i;
+		Chain.CreateProxy(AABB_t::FromCenterExtent(CMath::Vector3_t(flExtent, 0.0f, 0.0f), CMath::Vector3_t(flExtent, flExtent, flExtent)), i);
+	}
+	nFound = 0;
+	Chain.QueryFrustum(MakeFrustum(CMath::Vector3_t(0.0f, 0.0f, 0.0f), 1e5f), Count);
+	CHECK(nFound == PROXY_COUNT);
+	nFound = 0;
+	Chain.RayCast(CMath::Vector3_t(-1.0f, 0.0f, 0.0f), CMath::Vector3_t(1.0f, 0.0f, 0.0f), 1e5f, [&](int32_t, float flMaxDistance) {
+		++nFound;
+		return flMaxDistance;
+	});
+	CHECK(nFound == PROXY_COUNT);
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../FountEngine_1/src/render/culling/CFrustumCuller.hpp"
+#include "Test.hpp"
+
+// CFrustumCuller::CullAABBs runs 8 (AVX) or 4 (SSE) boxes at a time and the rest one by one; whichever
+// path this build has is held to the plain plane test, box by box.
+namespace {
+	struct Random_t {
+		uint32_t nState = 0x13579bdfu;
+
+		float Next(float flMin, float flMax) {
+			nState = nState * 1664525u + 1013904223u;
+			return flMin + (flMax - flMin) * static_cast<float>(nState >> 8) / static_cast<float>(1u << 24);
+		}
+
+		CMath::Vector3_t NextVector3(float flRange) { return CMath::Vector3_t(Next(-flRange, flRange), Next(-flRange, flRange), Next(-flRange, flRange)); }
+	};
+
+	struct Boxes_t {
+		std::vector<float> CentersX, CentersY, CentersZ;
+		std::vector<float> ExtentsX, ExtentsY, ExtentsZ;
+
+		void Add(const CMath::Vector3_t& vecCenter, const CMath::Vector3_t& vecExtent) {
+			CentersX.push_back(vecCenter.x);
+			CentersY.push_back(vecCenter.y);
+			CentersZ.push_back(vecCenter.z);
+			ExtentsX.push_back(vecExtent.x);
+			ExtentsY.push_back(vecExtent.y);
+			ExtentsZ.push_back(vecExtent.z);
+		}
+
+		CMath::ConstVector3SoA_t GetCenters(size_t nCount) const {
+			return CMath::ConstVector3SoA_t(std::span(CentersX).first(nCount), std::span(CentersY).first(nCount), std::span(CentersZ).first(nCount));
+		}
+
+		CMath::ConstVector3SoA_t GetExtents(size_t nCount) const {
+			return CMath::ConstVector3SoA_t(std::span(ExtentsX).first(nCount), std::span(ExtentsY).first(nCount), std::span(ExtentsZ).first(nCount));
+		}
+	};
+
+	// Distance of the box's nearest corner inside the plane, for each plane; the box is outside when any is negative.
+	// Computed in double, so the smallest one also says how close to a plane the box sits.
+	double GetMinMargin(const CMath::Frustum_t& Frustum, const Boxes_t& Boxes, size_t i) {
+		double flMin = INFINITY;
+		for (const CMath::Plane_t& Plane : Frustum.Planes) {
+			const double flDistance = static_cast<double>(Plane.vecNormal.x) * Boxes.CentersX[i] + static_cast<double>(Plane.vecNormal.y) * Boxes.CentersY[i] +
+				static_cast<double>(Plane.vecNormal.z) * Boxes.CentersZ[i] + Plane.flDistance;
+			const double flRadius = fabs(static_cast<double>(Plane.vecNormal.x)) * Boxes.ExtentsX[i] + fabs(static_cast<double>(Plane.vecNormal.y)) * Boxes.ExtentsY[i] +
+				fabs(static_cast<double>(Plane.vecNormal.z)) * Boxes.ExtentsZ[i];
+			flMin = std::min(flMin, flDistance + flRadius);
+		}
+		return flMin;
+	}
+}
+
+TEST(FrustumCullerBatchMatchesPlaneTest) {
+	Random_t Random;
+	const CMath::Matrix4x4_t mProjection = CMath::Matrix4x4_t::CreatePerspectiveFieldOfView(1.0f, 16.0f / 9.0f, 0.5f, 60.0f);
+
+	for (int nFrustum = 0; nFrustum < 20; ++nFrustum) {
+		const CMath::Vector3_t vecEye = Random.NextVector3(20.0f);
+		const CMath::Frustum_t Frustum = CMath::Frustum_t::FromViewProjection(
+			CMath::Matrix4x4_t::CreateLookAt(vecEye, vecEye + Random.NextVector3(1.0f), CMath::Vector3_t(0.0f, 1.0f, 0.0f)) * mProjection);
+
+		// Random boxes, then boxes centered on a frustum plane, which straddle it.
+		Boxes_t Boxes;
+		for (int i = 0; i < 1000; ++i) {
+			const float flSize = Random.Next(0.0f, 1.0f);
+			Boxes.Add(Random.NextVector3(80.0f), CMath::Vector3_t(Random.Next(0.0f, 8.0f), Random.Next(0.0f, 8.0f), Random.Next(0.0f, 8.0f)) * (flSize * flSize));
+		}
+		for (int i = 0; i < 1000; ++i) {
+			const CMath::Plane_t& Plane = Frustum.Planes[i % CMath::Frustum_t::PLANE_COUNT];
+			CMath::Vector3_t vecPoint = Random.NextVector3(60.0f);
+			vecPoint = vecPoint - Plane.vecNormal * Plane.GetDistance(vecPoint);
+			Boxes.Add(vecPoint, CMath::Vector3_t(Random.Next(0.01f, 2.0f), Random.Next(0.01f, 2.0f), Random.Next(0.01f, 2.0f)));
+		}
+
+		// Counts around every multiple of both SIMD widths, and the whole lot.
+		for (size_t nCount : { size_t(0), size_t(1), size_t(3), size_t(4), size_t(5), size_t(7), size_t(8), size_t(9), size_t(12), size_t(15),
+				 size_t(17), size_t(1001), size_t(1997), Boxes.CentersX.size() }) {
+			CFrustumCuller Culler;
+			Culler.SetFrustum(Frustum);
+
+			// Results are appended.
+			std::vector<uint32_t> Visible = { 12345u };
+			Culler.CullAABBs(Boxes.GetCenters(nCount), Boxes.GetExtents(nCount), Visible);
+			CHECK(!Visible.empty() && Visible[0] == 12345u);
+			Visible.erase(Visible.begin());
+			CHECK(std::is_sorted(Visible.begin(), Visible.end()));
+
+			// Boxes a rounding error away from a plane may land either way.
+			size_t nWrong = 0, nInside = 0;
+			for (size_t i = 0; i < nCount; ++i) {
+				const double flMargin = GetMinMargin(Frustum, Boxes, i);
+				const bool bVisible = std::binary_search(Visible.begin(), Visible.end(), static_cast<uint32_t>(i));
+				nWrong += fabs(flMargin) > 1e-4 && bVisible != (flMargin >= 0.0);
+				nInside += flMargin >= 0.0;
+			}
+			CHECK(nWrong == 0);
+			CHECK(Visible.empty() || Visible.back() < nCount);
+			CHECK(nCount < 1000 || (nInside > 0 && nInside < nCount));
+
+			const CullStats_t& Stats = Culler.GetFrameStats();
+			CHECK(Stats.nTested == nCount && Stats.nVisible == Visible.size() && Stats.nCulled == nCount - Visible.size());
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#include <atomic>
+#include <vector>
+
+#include "../../FountEngine_1/src/system/jobs/CJobSystem.hpp"
+#include "Test.hpp"
+
+TEST(JobSystemParallelForCoversRange) {
+	for (unsigned int nThreads : { 1u, 2u, 4u }) {
+		CJobSystem JobSystem(nThreads);
+		std::vector<int> Hits(10007, 0);
+		JobSystem.ParallelFor(0, Hits.size(), 64, [&Hits](size_t nBegin, size_t nEnd) {
+			for (size_t i = nBegin; i < nEnd; ++i) {
+				++Hits[i];
+			}
+		});
+
+		bool bOnce = true;
+		for (int nHits : Hits) {
+			bOnce = bOnce && nHits == 1;
+		}
+		CHECK(bOnce);
+	}
+}
+
+TEST(JobSystemRunsContinuations) {
+	CJobSystem JobSystem(3);
+	std::atomic<int> nFirst = 0;
+	int nSeenBySecond = -1;
+	CJobCounter First, Second;
+	for (int i = 0; i < 100; ++i) {
+		JobSystem.Run([&nFirst] { nFirst.fetch_add(1); }, &First);
+	}
+	JobSystem.RunAfter(First, [&] { nSeenBySecond = nFirst.load(); }, &Second);
+	JobSystem.Wait(Second);
+	CHECK(nSeenBySecond == 100);
+}
+
+// Jobs still queued when the job system goes away run, along with the jobs they queue, so a counter
+// waited on elsewhere reaches zero instead of hanging.
+TEST(JobSystemDestructorRunsQueuedJobs) {
+	for (unsigned int nThreads : { 1u, 4u }) {
+		std::atomic<int> nRan = 0;
+		CJobCounter Counter;
+		{
+			CJobSystem JobSystem(nThreads);
+			for (int i = 0; i < 1000; ++i) {
+				JobSystem.Run([&JobSystem, &nRan, &Counter] {
+					nRan.fetch_add(1);
+					JobSystem.Run([&nRan] { nRan.fetch_add(1); }, &Counter);
+				}, &Counter);
+			}
+		}
+		CHECK(Counter.IsDone());
+		CHECK(nRan.load() == 2000);
+	}
+}
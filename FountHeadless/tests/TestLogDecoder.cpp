@@ -0,0 +1,113 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+#include "../../FountEngine_1/src/system/logging/CLogFormat.hpp"
+#include "../../FountEngine_1/src/system/logging/CLogSystem.hpp"
+#include "Test.hpp"
+
+// FountLogDecoder on binary logs written through CLogFormat, the way CLogSystem writes them.
+namespace {
+	struct DecodedLog_t {
+		std::filesystem::path Directory;
+		std::string strOutput;
+		std::string strMessages;
+		int nExitCode = -1;
+
+		DecodedLog_t(const char* szName, const std::string& strLog)
+			: Directory(std::filesystem::temp_directory_path() / (std::string("fount_decoder_") + szName)) {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+			std::filesystem::create_directories(Directory);
+
+			const std::filesystem::path Input = Directory / (std::string("input") + CLogFormat::EXTENSION);
+			const std::filesystem::path Output = Directory / "output.log";
+			const std::filesystem::path Messages = Directory / "messages.txt";
+			std::ofstream(Input, std::ios::binary | std::ios::trunc).write(strLog.data(), static_cast<std::streamsize>(strLog.size()));
+
+			const std::string strCommand = "\"" FOUNT_LOG_DECODER_PATH "\" \"" + Input.string() + "\" \"" + Output.string() + "\" > \"" + Messages.string() + "\" 2>&1";
+			nExitCode = std::system(strCommand.c_str());
+			strOutput = ReadFile(Output);
+			strMessages = ReadFile(Messages);
+		}
+
+		~DecodedLog_t() {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+		}
+
+		static std::string ReadFile(const std::filesystem::path& Path) {
+			std::ifstream sFile(Path, std::ios::binary);
+			return std::string(std::istreambuf_iterator<char>(sFile), std::istreambuf_iterator<char>());
+		}
+	};
+
+	constexpr int64_t TIME = 1700000000LL * 1000000;
+
+	// Time stamps are local time, everything after them is spelled out.
+	void AppendExpected(std::string& strExpected, int64_t nTime, const char* szLine) {
+		strExpected += '[';
+		strExpected += CLogFormat::FormatTimeStamp(nTime);
+		strExpected += "] ";
+		strExpected += szLine;
+		strExpected += '\n';
+	}
+
+	// Two events of one site, one of another on a channel, preformatted text, and an event of a site never written.
+	std::string WriteLog(std::string& strExpected) {
+		std::string strLog;
+		CLogFormat::WriteFileHeader(strLog);
+
+		char cArguments[256];
+		const char* szFile = "src/render/mesh/CMesh.cpp";
+		CLogFormat::WriteSite(strLog, 1, CLogSystem::LEVEL_INFO, CLogSystem::CHANNEL_GENERAL, 42, szFile, "Loaded %s: %d vertices in %.2f ms");
+		size_t nLength = CLogFormat::EncodeArguments(cArguments, sizeof(cArguments), "sphere.obj", 482, 1.5);
+		CLogFormat::WriteEvent(strLog, 1, TIME, cArguments, nLength);
+
+		CLogFormat::WriteSite(strLog, 2, CLogSystem::LEVEL_WARNING, CLogSystem::CHANNEL_RESOURCES, 7, szFile, "Evicted %u meshes (%llu bytes)");
+		nLength = CLogFormat::EncodeArguments(cArguments, sizeof(cArguments), 3u, 1048576ull);
+		CLogFormat::WriteEvent(strLog, 2, TIME + 1000000, cArguments, nLength);
+
+		CLogFormat::WriteText(strLog, CLogSystem::LEVEL_ERROR, CLogSystem::CHANNEL_RENDER, TIME + 2000000, "Device lost");
+
+		nLength = CLogFormat::EncodeArguments(cArguments, sizeof(cArguments), "cube.obj", 8);
+		CLogFormat::WriteEvent(strLog, 1, TIME + 3000000, cArguments, nLength);
+		CLogFormat::WriteEvent(strLog, 9, TIME + 4000000, nullptr, 0);
+
+		strExpected.clear();
+		AppendExpected(strExpected, TIME, "[INFO] Loaded sphere.obj: 482 vertices in 1.50 ms (src/render/mesh/CMesh.cpp:42)");
+		AppendExpected(strExpected, TIME + 1000000, "[WARNING] [resources] Evicted 3 meshes (1048576 bytes) (src/render/mesh/CMesh.cpp:7)");
+		AppendExpected(strExpected, TIME + 2000000, "[ERROR] [render] Device lost");
+		AppendExpected(strExpected, TIME + 3000000, "[INFO] Loaded cube.obj: 8 vertices in ? ms (src/render/mesh/CMesh.cpp:42)");
+		AppendExpected(strExpected, TIME + 4000000, "[DEBUG] <unknown log site 9>");
+		return strLog;
+	}
+}
+
+TEST(LogDecoderRoundTrip) {
+	std::string strExpected;
+	DecodedLog_t Decoded("round_trip", WriteLog(strExpected));
+	CHECK(Decoded.nExitCode == 0);
+	CHECK(Decoded.strOutput == strExpected);
+	CHECK(Decoded.strMessages.find("Decoded 4 records") != std::string::npos);
+}
+
+// A log cut off mid-record, as after a crash, decodes up to its last complete record.
+TEST(LogDecoderTruncatedLog) {
+	std::string strExpected;
+	std::string strLog = WriteLog(strExpected);
+	strLog.resize(strLog.size() - 3);
+	strExpected.resize(strExpected.rfind('[', strExpected.rfind('[') - 1));
+
+	DecodedLog_t Decoded("truncated", strLog);
+	CHECK(Decoded.nExitCode == 0);
+	CHECK(Decoded.strOutput == strExpected);
+	CHECK(Decoded.strMessages.find("incomplete record") != std::string::npos);
+
+	DecodedLog_t NotALog("not_a_log", "not a binary log");
+	CHECK(NotALog.nExitCode != 0);
+	CHECK(NotALog.strMessages.find("is not a version") != std::string::npos);
+}
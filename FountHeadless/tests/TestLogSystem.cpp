@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../../FountEngine_1/src/system/logging/CLogSystem.hpp"
+#include "Test.hpp"
+
+// CLogSystem is a singleton: every case initializes it on a file of its own, without console output,
+// and shuts it down again so the other tests log into nothing.
+namespace {
+	struct LogFile_t {
+		std::filesystem::path Path;
+
+		explicit LogFile_t(const char* szName, bool bAsync = true)
+			: Path(std::filesystem::temp_directory_path() / (std::string("fount_log_") + szName + ".log")) {
+			CLogSystem& LogSystem = CLogSystem::GetInstance();
+			LogSystem.SetConsoleOutputEnabled(false);
+			LogSystem.Initialize(Path.string(), bAsync);
+		}
+
+		~LogFile_t() {
+			CLogSystem& LogSystem = CLogSystem::GetInstance();
+			LogSystem.Shutdown();
+			LogSystem.SetRateLimit(0);
+			LogSystem.SetOverflowPolicy(CLogSystem::OVERFLOW_BLOCK);
+			LogSystem.SetConsoleOutputEnabled(true);
+			std::error_code ErrorCode;
+			std::filesystem::remove(Path, ErrorCode);
+		}
+
+		std::vector<std::string> ReadLines() const {
+			std::vector<std::string> Lines;
+			std::ifstream sFile(Path);
+			for (std::string strLine; std::getline(sFile, strLine);) {
+				Lines.push_back(strLine);
+			}
+			return Lines;
+		}
+	};
+
+	// The number after szTag in the line, -1 if the tag isn't there.
+	long GetNumber(const std::string& strLine, const char* szTag) {
+		const size_t nPosition = strLine.find(szTag);
+		return nPosition == std::string::npos ? -1 : strtol(strLine.c_str() + nPosition + strlen(szTag), nullptr, 10);
+	}
+
+	constexpr long BURST_SIZE = 100000;
+}
+
+// Site records and preformatted text come out in the order they were logged, all of them, by Shutdown.
+TEST(LogSystemKeepsOrderAndFlushesOnShutdown) {
+	std::vector<std::string> Lines;
+	{
+		LogFile_t File("order");
+		for (int i = 0; i < 10000; ++i) {
+			if (i % 3 == 0) {
+				LOG_INFO_S("message %d", i);
+			}
+			else {
+				LOG_INFO("message %d", i);
+			}
+		}
+		CLogSystem::GetInstance().Shutdown();
+		Lines = File.ReadLines();
+	}
+
+	long nExpected = 0;
+	for (const std::string& strLine : Lines) {
+		if (GetNumber(strLine, "message ") == nExpected) {
+			++nExpected;
+		}
+	}
+	CHECK(nExpected == 10000);
+}
+
+// Blocking producers lose nothing, however much they log at once, and each thread's messages stay in order.
+TEST(LogSystemOverflowBlock) {
+	constexpr int THREAD_COUNT = 4;
+	const uint64_t nDroppedBefore = CLogSystem::GetInstance().GetDroppedMessageCount();
+	std::vector<std::string> Lines;
+	{
+		LogFile_t File("block");
+		std::vector<std::thread> Threads;
+		for (int t = 0; t < THREAD_COUNT; ++t) {
+			Threads.emplace_back([t] {
+				for (long i = 0; i < BURST_SIZE / THREAD_COUNT; ++i) {
+					LOG_INFO("thread %d message %ld", t, i);
+				}
+			});
+		}
+		for (std::thread& Thread : Threads) {
+			Thread.join();
+		}
+		CLogSystem::GetInstance().Shutdown();
+		Lines = File.ReadLines();
+	}
+
+	long nNext[THREAD_COUNT] = {};
+	bool bOrdered = true;
+	for (const std::string& strLine : Lines) {
+		const long nThread = GetNumber(strLine, "thread ");
+		if (nThread >= 0 && nThread < THREAD_COUNT) {
+			bOrdered = bOrdered && GetNumber(strLine, "message ") == nNext[nThread];
+			++nNext[nThread];
+		}
+	}
+	CHECK(bOrdered);
+	for (long nCount : nNext) {
+		CHECK(nCount == BURST_SIZE / THREAD_COUNT);
+	}
+	CHECK(CLogSystem::GetInstance().GetDroppedMessageCount() == nDroppedBefore);
+}
+
+// Dropped messages are reported, and never ahead of messages logged before them.
+TEST(LogSystemOverflowDrop) {
+	CLogSystem& LogSystem = CLogSystem::GetInstance();
+	const uint64_t nDroppedBefore = LogSystem.GetDroppedMessageCount();
+	std::vector<std::string> Lines;
+	{
+		LogFile_t File("drop");
+		LogSystem.SetOverflowPolicy(CLogSystem::OVERFLOW_DROP);
+		for (long i = 0; i < BURST_SIZE; ++i) {
+			LOG_INFO("message %ld", i);
+		}
+		LogSystem.Shutdown();
+		Lines = File.ReadLines();
+	}
+	const uint64_t nDropped = LogSystem.GetDroppedMessageCount() - nDroppedBefore;
+	CHECK(nDropped > 0);
+
+	// Every report is written after the message logged last before the drops it counts, so by the next
+	// message that is written, at least as many are missing as have been reported.
+	long nPrevious = -1, nMissing = 0, nReported = 0, nWritten = 0;
+	bool bIncreasing = true, bReportsInPlace = true;
+	for (const std::string& strLine : Lines) {
+		if (strLine.find("log messages dropped") != std::string::npos) {
+			nReported += GetNumber(strLine, "[WARNING] ");
+			continue;
+		}
+
+		const long nMessage = GetNumber(strLine, "message ");
+		if (nMessage >= 0) {
+			bIncreasing = bIncreasing && nMessage > nPrevious;
+			nMissing += nMessage - nPrevious - 1;
+			bReportsInPlace = bReportsInPlace && nReported <= nMissing;
+			nPrevious = nMessage;
+			++nWritten;
+		}
+	}
+	nMissing += BURST_SIZE - 1 - nPrevious;
+
+	CHECK(bIncreasing);
+	CHECK(bReportsInPlace);
+	CHECK(nReported == static_cast<long>(nDropped));
+	CHECK(nMissing == static_cast<long>(nDropped));
+	CHECK(nWritten + nMissing == BURST_SIZE);
+}
+
+// A fatal message is on disk, after everything logged before it, by the time LOG_FATAL returns.
+TEST(LogSystemFatalFlushes) {
+	LogFile_t File("fatal");
+	for (int i = 0; i < 1000; ++i) {
+		LOG_INFO("message %d", i);
+	}
+	LOG_FATAL("fatal %d", 1000);
+
+	const std::vector<std::string> Lines = File.ReadLines();
+	CHECK(!Lines.empty() && GetNumber(Lines.back(), "fatal ") == 1000);
+	CHECK(Lines.size() >= 2 && GetNumber(Lines[Lines.size() - 2], "message ") == 999);
+}
+
+// Nothing is rate limited unless a channel or a call site asks for it. Once a limited site gets a message
+// through again, it first reports how many it suppressed.
+TEST(LogSystemRateLimitSummary) {
+	std::vector<std::string> Lines;
+	{
+		LogFile_t File("rate_limit");
+		CLogSystem::GetInstance().SetChannelRateLimit(CLogSystem::CHANNEL_RENDER, 5);
+		for (int nRound = 0; nRound < 2; ++nRound) {
+			// The second round is in the next one second window.
+			if (nRound == 1) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+			}
+			for (int i = 0; i < 1000; ++i) {
+				LOG_INFO("unlimited %d", i);
+				LOG_INFO_CH(RENDER, "channel %d", i);
+				LOG_LIMITED_CH(GENERAL, INFO, 10, "site %d", i);
+			}
+		}
+		CLogSystem::GetInstance().Shutdown();
+		Lines = File.ReadLines();
+	}
+
+	long nUnlimited = 0, nChannel = 0, nSite = 0;
+	std::vector<std::string> Summaries;
+	for (size_t i = 0; i < Lines.size(); ++i) {
+		nUnlimited += GetNumber(Lines[i], "unlimited ") >= 0;
+		nChannel += GetNumber(Lines[i], "channel ") >= 0;
+		nSite += GetNumber(Lines[i], "site ") >= 0;
+
+		// Each summary comes right before the first message of the second window.
+		const long nSuppressed = GetNumber(Lines[i], "Rate limit dropped ");
+		if (nSuppressed >= 0 && i + 1 < Lines.size()) {
+			const long nNext = std::max(GetNumber(Lines[i + 1], "channel "), GetNumber(Lines[i + 1], "site "));
+			Summaries.push_back(std::to_string(nSuppressed) + " then " + std::to_string(nNext));
+		}
+	}
+
+	CHECK(nUnlimited == 2000);
+	CHECK(nChannel == 10 && nSite == 20);
+	CHECK(Summaries.size() == 2);
+	CHECK(std::find(Summaries.begin(), Summaries.end(), "995 then 0") != Summaries.end());
+	CHECK(std::find(Summaries.begin(), Summaries.end(), "990 then 0") != Summaries.end());
+}
@@ -0,0 +1,170 @@
+#include <cstdint>
+
+#include "../../FountEngine_1/src/math/CMath.hpp"
+#include "Test.hpp"
+
+// CMath against the plain scalar formulas it replaced. CMakeLists.txt builds this file once with the
+// SIMD backend and once with CMATH_FORCE_SCALAR, so both paths are held to the same results.
+namespace {
+	constexpr float EPSILON = 1e-5f;
+	constexpr int ITERATIONS = 10000;
+
+	struct Random_t {
+		uint32_t nState = 0x12345678u;
+
+		float Next(float flMin, float flMax) {
+			nState = nState * 1664525u + 1013904223u;
+			return flMin + (flMax - flMin) * static_cast<float>(nState >> 8) / static_cast<float>(1u << 24);
+		}
+
+		CMath::Vector3_t NextVector3() { return CMath::Vector3_t(Next(-10.0f, 10.0f), Next(-10.0f, 10.0f), Next(-10.0f, 10.0f)); }
+		CMath::Vector4_t NextVector4() { return CMath::Vector4_t(NextVector3(), Next(-10.0f, 10.0f)); }
+
+		CMath::Matrix4x4_t NextMatrix() {
+			CMath::Matrix4x4_t mResult;
+			for (int i = 0; i < 4; ++i) {
+				for (int j = 0; j < 4; ++j) {
+					mResult.m[i][j] = Next(-2.0f, 2.0f);
+				}
+			}
+			return mResult;
+		}
+	};
+
+	float ScalarDot(const CMath::Vector3_t& a, const CMath::Vector3_t& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	CMath::Vector3_t ScalarCross(const CMath::Vector3_t& a, const CMath::Vector3_t& b) {
+		return CMath::Vector3_t(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	CMath::Vector3_t ScalarNormalize(const CMath::Vector3_t& v) {
+		const float flLength = sqrtf(ScalarDot(v, v));
+		return flLength > 0 ? v / flLength : v;
+	}
+
+	CMath::Matrix4x4_t ScalarMultiply(const CMath::Matrix4x4_t& a, const CMath::Matrix4x4_t& b) {
+		CMath::Matrix4x4_t mResult;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				mResult.m[i][j] = 0;
+				for (int k = 0; k < 4; ++k) {
+					mResult.m[i][j] += a.m[i][k] * b.m[k][j];
+				}
+			}
+		}
+		return mResult;
+	}
+
+	CMath::Vector4_t ScalarTransform(const CMath::Matrix4x4_t& m, const CMath::Vector4_t& v) {
+		return CMath::Vector4_t(
+			v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+			v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+			v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+			v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3]);
+	}
+
+	CMath::Matrix4x4_t ScalarLookAt(const CMath::Vector3_t& vecEye, const CMath::Vector3_t& vecTarget, const CMath::Vector3_t& vecUp) {
+		const CMath::Vector3_t zAxis = ScalarNormalize(vecTarget - vecEye);
+		const CMath::Vector3_t xAxis = ScalarNormalize(ScalarCross(vecUp, zAxis));
+		const CMath::Vector3_t yAxis = ScalarCross(zAxis, xAxis);
+
+		CMath::Matrix4x4_t mResult;
+		const CMath::Vector3_t aAxes[3] = { xAxis, yAxis, zAxis };
+		for (int j = 0; j < 3; ++j) {
+			mResult.m[0][j] = aAxes[j].x;
+			mResult.m[1][j] = aAxes[j].y;
+			mResult.m[2][j] = aAxes[j].z;
+			mResult.m[3][j] = -ScalarDot(aAxes[j], vecEye);
+		}
+		mResult.m[0][3] = mResult.m[1][3] = mResult.m[2][3] = 0.0f;
+		mResult.m[3][3] = 1.0f;
+		return mResult;
+	}
+
+	void CheckVector3(const CMath::Vector3_t& vecActual, const CMath::Vector3_t& vecExpected) {
+		CHECK_NEAR(vecActual.x, vecExpected.x, EPSILON);
+		CHECK_NEAR(vecActual.y, vecExpected.y, EPSILON);
+		CHECK_NEAR(vecActual.z, vecExpected.z, EPSILON);
+	}
+
+	void CheckVector4(const CMath::Vector4_t& vecActual, const CMath::Vector4_t& vecExpected) {
+		CHECK_NEAR(vecActual.x, vecExpected.x, EPSILON);
+		CHECK_NEAR(vecActual.y, vecExpected.y, EPSILON);
+		CHECK_NEAR(vecActual.z, vecExpected.z, EPSILON);
+		CHECK_NEAR(vecActual.w, vecExpected.w, EPSILON);
+	}
+
+	void CheckMatrix(const CMath::Matrix4x4_t& mActual, const CMath::Matrix4x4_t& mExpected) {
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				CHECK_NEAR(mActual.m[i][j], mExpected.m[i][j], EPSILON);
+			}
+		}
+	}
+}
+
+TEST(Vector3MatchesScalar) {
+	Random_t Random;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		const CMath::Vector3_t a = Random.NextVector3(), b = Random.NextVector3();
+		CHECK_NEAR(a.Dot(b), ScalarDot(a, b), EPSILON);
+		CHECK_NEAR(a.Length(), sqrtf(ScalarDot(a, a)), EPSILON);
+		CheckVector3(a.Cross(b), ScalarCross(a, b));
+		CheckVector3(a.Normalize(), ScalarNormalize(a));
+	}
+
+	const CMath::Vector3_t vecZero;
+	CheckVector3(vecZero.Normalize(), vecZero);
+}
+
+TEST(Vector4MatchesScalar) {
+	Random_t Random;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		const CMath::Vector4_t a = Random.NextVector4(), b = Random.NextVector4();
+		const float flScalar = Random.Next(-4.0f, 4.0f);
+		CheckVector4(a + b, CMath::Vector4_t(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w));
+		CheckVector4(a - b, CMath::Vector4_t(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w));
+		CheckVector4(a * flScalar, CMath::Vector4_t(a.x * flScalar, a.y * flScalar, a.z * flScalar, a.w * flScalar));
+		CHECK_NEAR(a.Dot(b), a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w, EPSILON);
+	}
+}
+
+TEST(MatrixMatchesScalar) {
+	Random_t Random;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		const CMath::Matrix4x4_t a = Random.NextMatrix(), b = Random.NextMatrix();
+		const CMath::Vector4_t v = Random.NextVector4();
+		CheckMatrix(a * b, ScalarMultiply(a, b));
+		CheckVector4(a.Transform(v), ScalarTransform(a, v));
+	}
+}
+
+TEST(LookAtMatchesScalar) {
+	Random_t Random;
+	const CMath::Vector3_t vecUp(0.0f, 1.0f, 0.0f);
+	for (int i = 0; i < ITERATIONS; ++i) {
+		const CMath::Vector3_t vecEye = Random.NextVector3(), vecTarget = Random.NextVector3();
+		CheckMatrix(CMath::Matrix4x4_t::CreateLookAt(vecEye, vecTarget, vecUp), ScalarLookAt(vecEye, vecTarget, vecUp));
+	}
+}
+
+// Components written one float at a time and read straight back through the SIMD loads. A load that
+// doesn't alias float (e.g. through double*) may be moved above the stores and see the old values.
+TEST(Vector3StoresThenLoads) {
+	Random_t Random;
+	CMath::Vector3_t aVectors[64];
+	for (int i = 0; i < ITERATIONS; ++i) {
+		CMath::Vector3_t& vec = aVectors[i % 64];
+		const float x = Random.Next(-1.0f, 1.0f), y = Random.Next(-1.0f, 1.0f), z = Random.Next(0.1f, 1.0f);
+		vec.x = x;
+		vec.y = y;
+		vec.z = z;
+		CHECK_NEAR(vec.Dot(vec), x * x + y * y + z * z, EPSILON);
+
+		vec = vec.Normalize();
+		vec.x = -vec.x;
+		CHECK_NEAR(vec.Dot(CMath::Vector3_t(1.0f, 0.0f, 0.0f)), -x / sqrtf(x * x + y * y + z * z), EPSILON);
+	}
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <vector>
+
+#include "../../FountEngine_1/src/math/CMathBatch.hpp"
+#include "Test.hpp"
+
+// Batch kernels against one Transform / operator* per element. Counts that aren't a multiple of the
+// SIMD width exercise the scalar tails as well.
+namespace {
+	constexpr float EPSILON = 1e-5f;
+	constexpr size_t COUNTS[] = { 0, 1, 3, 4, 7, 8, 9, 17, 1000 };
+
+	struct Random_t {
+		uint32_t nState = 0x9E3779B9u;
+
+		float Next(float flMin, float flMax) {
+			nState = nState * 1664525u + 1013904223u;
+			return flMin + (flMax - flMin) * static_cast<float>(nState >> 8) / static_cast<float>(1u << 24);
+		}
+
+		CMath::Matrix4x4_t NextMatrix() {
+			CMath::Matrix4x4_t mResult;
+			for (int i = 0; i < 4; ++i) {
+				for (int j = 0; j < 4; ++j) {
+					mResult.m[i][j] = Next(-2.0f, 2.0f);
+				}
+			}
+			return mResult;
+		}
+	};
+
+	std::vector<CMath::Vector3_t> RandomVectors(Random_t& Random, size_t nCount) {
+		std::vector<CMath::Vector3_t> Vectors(nCount);
+		for (CMath::Vector3_t& vec : Vectors) {
+			vec = CMath::Vector3_t(Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f));
+		}
+		return Vectors;
+	}
+
+	void CheckTransformed(const CMath::Matrix4x4_t& m, const CMath::Vector3_t& vecIn, float flW, float x, float y, float z) {
+		const CMath::Vector4_t vecExpected = m.Transform(CMath::Vector4_t(vecIn, flW));
+		CHECK_NEAR(x, vecExpected.x, EPSILON);
+		CHECK_NEAR(y, vecExpected.y, EPSILON);
+		CHECK_NEAR(z, vecExpected.z, EPSILON);
+	}
+}
+
+TEST(TransformAoSMatchesTransform) {
+	Random_t Random;
+	for (size_t nCount : COUNTS) {
+		const CMath::Matrix4x4_t m = Random.NextMatrix();
+		const std::vector<CMath::Vector3_t> In = RandomVectors(Random, nCount);
+		std::vector<CMath::Vector3_t> Points(nCount), Directions(nCount);
+		CMath::TransformPoints(m, In, Points);
+		CMath::TransformDirections(m, In, Directions);
+
+		// In place, the way CFrustumCuller uses it.
+		std::vector<CMath::Vector3_t> InPlace = In;
+		CMath::TransformPoints(m, InPlace, InPlace);
+
+		for (size_t i = 0; i < nCount; ++i) {
+			CheckTransformed(m, In[i], 1.0f, Points[i].x, Points[i].y, Points[i].z);
+			CheckTransformed(m, In[i], 0.0f, Directions[i].x, Directions[i].y, Directions[i].z);
+			CheckTransformed(m, In[i], 1.0f, InPlace[i].x, InPlace[i].y, InPlace[i].z);
+		}
+	}
+}
+
+TEST(TransformSoAMatchesTransform) {
+	Random_t Random;
+	for (size_t nCount : COUNTS) {
+		const CMath::Matrix4x4_t m = Random.NextMatrix();
+		const std::vector<CMath::Vector3_t> In = RandomVectors(Random, nCount);
+		std::vector<float> InX(nCount), InY(nCount), InZ(nCount);
+		for (size_t i = 0; i < nCount; ++i) {
+			InX[i] = In[i].x;
+			InY[i] = In[i].y;
+			InZ[i] = In[i].z;
+		}
+
+		std::vector<float> PointX(nCount), PointY(nCount), PointZ(nCount);
+		std::vector<float> DirectionX(nCount), DirectionY(nCount), DirectionZ(nCount);
+		const CMath::ConstVector3SoA_t Source(InX, InY, InZ);
+		CMath::TransformPoints(m, Source, CMath::Vector3SoA_t{ PointX, PointY, PointZ });
+		CMath::TransformDirections(m, Source, CMath::Vector3SoA_t{ DirectionX, DirectionY, DirectionZ });
+
+		for (size_t i = 0; i < nCount; ++i) {
+			CheckTransformed(m, In[i], 1.0f, PointX[i], PointY[i], PointZ[i]);
+			CheckTransformed(m, In[i], 0.0f, DirectionX[i], DirectionY[i], DirectionZ[i]);
+		}
+	}
+}
+
+TEST(TransformVectorsMatchesTransform) {
+	Random_t Random;
+	for (size_t nCount : COUNTS) {
+		const CMath::Matrix4x4_t m = Random.NextMatrix();
+		std::vector<CMath::Vector4_t> In(nCount), Out(nCount);
+		for (CMath::Vector4_t& vec : In) {
+			vec = CMath::Vector4_t(Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f), Random.Next(-10.0f, 10.0f), Random.Next(-1.0f, 1.0f));
+		}
+		CMath::TransformVectors(m, In, Out);
+
+		for (size_t i = 0; i < nCount; ++i) {
+			const CMath::Vector4_t vecExpected = m.Transform(In[i]);
+			CHECK_NEAR(Out[i].x, vecExpected.x, EPSILON);
+			CHECK_NEAR(Out[i].y, vecExpected.y, EPSILON);
+			CHECK_NEAR(Out[i].z, vecExpected.z, EPSILON);
+			CHECK_NEAR(Out[i].w, vecExpected.w, EPSILON);
+		}
+	}
+}
+
+TEST(MultiplyManyMatchesMultiply) {
+	Random_t Random;
+	for (size_t nCount : COUNTS) {
+		const CMath::Matrix4x4_t mRight = Random.NextMatrix();
+		std::vector<CMath::Matrix4x4_t> Left(nCount), Out(nCount);
+		for (CMath::Matrix4x4_t& mLeft : Left) {
+			mLeft = Random.NextMatrix();
+		}
+		CMath::MultiplyMany(Left, mRight, Out);
+
+		for (size_t i = 0; i < nCount; ++i) {
+			const CMath::Matrix4x4_t mExpected = Left[i] * mRight;
+			for (int j = 0; j < 4; ++j) {
+				for (int k = 0; k < 4; ++k) {
+					CHECK_NEAR(Out[i].m[j][k], mExpected.m[j][k], EPSILON);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../FountEngine_1/src/resources/resourcemanager/CMeshCache.hpp"
+#include "Test.hpp"
+
+TEST(MeshCacheWeakEntries) {
+	CMeshCache Cache;
+	const std::string strPath = "meshes/a.obj";
+
+	auto pMesh = std::make_shared<CMesh>();
+	CHECK(Cache.Find(CMeshCache::Key_t(strPath)) == nullptr);
+	Cache.Insert(CMeshCache::Key_t(strPath), pMesh);
+	CHECK(Cache.Find(CMeshCache::Key_t(strPath)) == pMesh);
+	CHECK(Cache.GetStats().nEntries == 1);
+
+	// The cache doesn't keep the mesh alive, and drops the entry once it is gone.
+	pMesh.reset();
+	CHECK(Cache.Find(CMeshCache::Key_t(strPath)) == nullptr);
+	CHECK(Cache.PruneAll() == 1);
+
+	const CMeshCache::Stats_t Stats = Cache.GetStats();
+	CHECK(Stats.nHits == 1 && Stats.nMisses == 2);
+	CHECK(Stats.nEntries == 0 && Stats.nPruned == 1);
+}
+
+// Threads look up shared meshes, insert and drop meshes of their own, and prune shards, all at once.
+// Live meshes are always found, and only under their own path.
+TEST(MeshCacheConcurrentAccess) {
+	constexpr int THREAD_COUNT = 4;
+	constexpr int SHARED_COUNT = 64;
+	constexpr int ITERATIONS = 20000;
+
+	CMeshCache Cache;
+	std::vector<std::string> SharedPaths;
+	std::vector<std::shared_ptr<CMesh>> SharedMeshes;
+	for (int i = 0; i < SHARED_COUNT; ++i) {
+		SharedPaths.push_back("shared/" + std::to_string(i) + ".obj");
+		SharedMeshes.push_back(std::make_shared<CMesh>());
+		Cache.Insert(CMeshCache::Key_t(SharedPaths.back()), SharedMeshes.back());
+	}
+
+	std::atomic<bool> bStop = false;
+	std::atomic<int> nWrong = 0;
+	std::atomic<uint64_t> nFinds = 0;
+	std::thread Pruner([&] {
+		while (!bStop.load(std::memory_order_relaxed)) {
+			Cache.PruneNextShard();
+		}
+	});
+
+	std::vector<std::thread> Threads;
+	for (int t = 0; t < THREAD_COUNT; ++t) {
+		Threads.emplace_back([&, t] {
+			for (int i = 0; i < ITERATIONS; ++i) {
+				const int nShared = (i * 7 + t) % SHARED_COUNT;
+				if (Cache.Find(CMeshCache::Key_t(SharedPaths[nShared])) != SharedMeshes[nShared]) {
+					nWrong.fetch_add(1);
+				}
+
+				// Reinserting a live mesh under its own path changes nothing.
+				if (i % 16 == 0) {
+					Cache.Insert(CMeshCache::Key_t(SharedPaths[nShared]), SharedMeshes[nShared]);
+				}
+
+				const std::string strOwn = "thread" + std::to_string(t) + "/" + std::to_string(i % 256) + ".obj";
+				auto pOwn = std::make_shared<CMesh>();
+				Cache.Insert(CMeshCache::Key_t(strOwn), pOwn);
+				if (Cache.Find(CMeshCache::Key_t(strOwn)) != pOwn) {
+					nWrong.fetch_add(1);
+				}
+				nFinds.fetch_add(2, std::memory_order_relaxed);
+			}
+		});
+	}
+	for (std::thread& Thread : Threads) {
+		Thread.join();
+	}
+	bStop = true;
+	Pruner.join();
+
+	CHECK(nWrong.load() == 0);
+
+	// Only the shared meshes are still alive.
+	Cache.PruneAll();
+	const CMeshCache::Stats_t Stats = Cache.GetStats();
+	CHECK(Stats.nEntries == SHARED_COUNT);
+	CHECK(Stats.nHits + Stats.nMisses == nFinds.load());
+	CHECK(Stats.nMisses == 0);
+	CHECK(Stats.nPruned >= THREAD_COUNT * 256);
+}
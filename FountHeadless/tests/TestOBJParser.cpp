@@ -0,0 +1,55 @@
+#include <cstring>
+
+#include "../../FountEngine_1/src/render/mesh/COBJParser.hpp"
+#include "Test.hpp"
+
+namespace {
+	bool Parse(COBJParser& Parser, const char* szText) {
+		return Parser.Parse(szText, strlen(szText), "test.obj");
+	}
+}
+
+TEST(OBJParserComments) {
+	COBJParser Parser;
+	CHECK(Parse(Parser,
+		"# exported by hand\n"
+		"v 0 0 0 # origin\n"
+		"v 1 0 0\n"
+		"v 0 1 0#no blank before the comment\n"
+		"f 1 2 3 # trailing comment\n"
+		"f 1 2 3#\n"
+		"   # indented comment\n"));
+	CHECK(Parser.GetPositions().size() == 3);
+	CHECK(Parser.GetCorners().size() == 6);
+}
+
+TEST(OBJParserFaces) {
+	COBJParser Parser;
+	CHECK(Parse(Parser,
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/2/1 3//1 4\r\n"
+		"f -4 -3 -2"));
+	CHECK(Parser.GetTexcoords().size() == 2);
+
+	// The quad is fanned into two triangles, then one more from the relative indices.
+	const std::vector<COBJParser::Corner_t>& Corners = Parser.GetCorners();
+	CHECK(Corners.size() == 9);
+	if (Corners.size() == 9) {
+		CHECK(Corners[0].nPosition == 0 && Corners[0].nTexcoord == 0 && Corners[0].nNormal == 0);
+		CHECK(Corners[2].nPosition == 2 && Corners[2].nTexcoord == -1 && Corners[2].nNormal == 0);
+		CHECK(Corners[3].nPosition == 0 && Corners[4].nPosition == 2 && Corners[5].nPosition == 3);
+		CHECK(Corners[5].nTexcoord == -1 && Corners[5].nNormal == -1);
+		CHECK(Corners[6].nPosition == 0 && Corners[7].nPosition == 1 && Corners[8].nPosition == 2);
+	}
+}
+
+TEST(OBJParserRejectsMalformed) {
+	COBJParser Parser;
+	CHECK(!Parse(Parser, "v 0 0 0\nv 1 0 0\nf 1 2 3\n"));
+	CHECK(!Parse(Parser, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2\n"));
+	CHECK(!Parse(Parser, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 0\n"));
+	CHECK(!Parse(Parser, "v 0 0\n"));
+	CHECK(!Parse(Parser, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3x\n"));
+}
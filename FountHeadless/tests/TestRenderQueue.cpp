@@ -0,0 +1,47 @@
+#include "../../FountEngine_1/src/render/backend/CNullRenderBackend.hpp"
+#include "../../FountEngine_1/src/render/queue/CRenderQueue.hpp"
+#include "Test.hpp"
+
+namespace {
+	DrawPacket_t MakePacket(RenderHandle_t hMaterial, RenderHandle_t hMeshConstants) {
+		DrawPacket_t Packet;
+		Packet.hPipeline = 1;
+		Packet.hMaterial = hMaterial;
+		Packet.hMeshConstants = hMeshConstants;
+		Packet.hVertexBuffer = 2;
+		Packet.hIndexBuffer = 3;
+		Packet.nVertexStride = 16;
+		Packet.nIndexCount = 3;
+		return Packet;
+	}
+
+	void RunFrame(CRenderQueue& Queue, CNullRenderBackend& Backend, RenderHandle_t hMaterial, RenderHandle_t hMeshConstants) {
+		Queue.Clear();
+		for (int i = 0; i < 3; ++i) {
+			Queue.Submit(MakePacket(hMaterial, hMeshConstants), CMath::Matrix4x4_t());
+		}
+		Queue.Execute(Backend, 4);
+	}
+}
+
+// Only state that is set counts as issued or skipped, and every frame starts from nothing bound.
+TEST(RenderQueueBindStats) {
+	CNullRenderBackend Backend;
+	CRenderQueue Queue;
+
+	// Object buffer, then pipeline, material, mesh constants, vertex and index buffer once each; the other
+	// two draws skip all five.
+	RunFrame(Queue, Backend, 5, 6);
+	CHECK(Queue.GetFrameStats().nDraws == 3);
+	CHECK(Queue.GetFrameStats().nBindsIssued == 6 && Queue.GetFrameStats().nBindsSkipped == 10);
+
+	// Without mesh constants there is nothing to skip for them. The material slot is still cleared, so
+	// last frame's material doesn't carry over.
+	RunFrame(Queue, Backend, INVALID_RENDER_HANDLE, INVALID_RENDER_HANDLE);
+	CHECK(Queue.GetFrameStats().nBindsIssued == 5 && Queue.GetFrameStats().nBindsSkipped == 8);
+
+	RunFrame(Queue, Backend, 5, INVALID_RENDER_HANDLE);
+	CHECK(Queue.GetFrameStats().nBindsIssued == 5 && Queue.GetFrameStats().nBindsSkipped == 8);
+
+	Queue.ReleaseBuffers(Backend);
+}
@@ -0,0 +1,203 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "../../FountEngine_1/src/render/backend/CNullRenderBackend.hpp"
+#include "../../FountEngine_1/src/resources/resourcemanager/IResourceManager.hpp"
+#include "Test.hpp"
+
+// IResourceManager is a singleton, so every case uses paths of its own and releases what it made resident.
+namespace {
+	struct MeshDirectory_t {
+		std::filesystem::path Directory;
+
+		explicit MeshDirectory_t(const char* szName)
+			: Directory(std::filesystem::temp_directory_path() / (std::string("fount_resources_") + szName)) {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+			std::filesystem::create_directories(Directory);
+		}
+
+		~MeshDirectory_t() {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+		}
+
+		// A flat nSize x nSize grid, enough for every load step (LODs, optimization, meshlets) to have work.
+		std::string WriteGrid(const char* szName, int nSize) const {
+			const std::filesystem::path Path = Directory / szName;
+			std::ofstream sFile(Path, std::ios::binary | std::ios::trunc);
+			for (int y = 0; y <= nSize; ++y) {
+				for (int x = 0; x <= nSize; ++x) {
+					sFile << "v " << x << " " << y << " 0\n";
+				}
+			}
+			for (int y = 0; y < nSize; ++y) {
+				for (int x = 0; x < nSize; ++x) {
+					const int a = y * (nSize + 1) + x + 1, b = a + 1, c = a + nSize + 1, d = c + 1;
+					sFile << "f " << a << " " << b << " " << c << "\nf " << b << " " << d << " " << c << "\n";
+				}
+			}
+			return Path.string();
+		}
+	};
+
+	// Runs sync points until none of the handles is pending any more.
+	bool WaitUntilLoaded(CNullRenderBackend& Backend, std::initializer_list<const CMeshHandle*> Handles) {
+		for (int i = 0; i < 10000; ++i) {
+			IResourceManager::GetInstance().ProcessPendingLoads(Backend);
+
+			bool bPending = false;
+			for (const CMeshHandle* pHandle : Handles) {
+				bPending = bPending || pHandle->GetState() == MESH_LOAD_PENDING;
+			}
+			if (!bPending) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+}
+
+// Over budget, the least recently used meshes lose their GPU buffers, pinned or not, and come back through
+// their handles. A GetMesh copy doesn't keep the request resident.
+TEST(ResourceManagerEvictsLeastRecentlyUsed) {
+	IResourceManager& Manager = IResourceManager::GetInstance();
+	const size_t nDefaultBudget = Manager.GetMeshMemoryBudget();
+	CNullRenderBackend Backend;
+	MeshDirectory_t Directory("budget");
+
+	std::string aPaths[4];
+	CMeshHandle aHandles[4];
+	for (int i = 0; i < 4; ++i) {
+		char szName[32];
+		snprintf(szName, sizeof(szName), "mesh%d.obj", i);
+		aPaths[i] = Directory.WriteGrid(szName, 16);
+		aHandles[i] = Manager.GetMeshAsync(aPaths[i], i == 0);
+	}
+	CHECK(WaitUntilLoaded(Backend, { &aHandles[0], &aHandles[1], &aHandles[2], &aHandles[3] }));
+
+	std::shared_ptr<CMesh> pOwned = Manager.GetMesh(aPaths[1]);
+	CHECK(pOwned && pOwned->HasCPUData() && !pOwned->HasBuffers());
+	CHECK(pOwned != aHandles[1].Get());
+
+	// Used in order, one frame apart.
+	size_t aBytes[4] = {};
+	for (int i = 0; i < 4; ++i) {
+		std::shared_ptr<CMesh> pMesh = aHandles[i].Get();
+		CHECK(pMesh && pMesh->HasBuffers());
+		if (pMesh) {
+			CHECK(pMesh->HasCPUData() == (i == 0));
+			aBytes[i] = pMesh->GetGPUMemoryUsage() + pMesh->GetCPUMemoryUsage();
+		}
+		Manager.ProcessPendingLoads(Backend);
+	}
+
+	const CMeshCache::Stats_t StatsBefore = Manager.GetMeshCacheStats();
+	Manager.SetMeshMemoryBudget(aBytes[2] + aBytes[3]);
+	Manager.ProcessPendingLoads(Backend);
+	const CMeshCache::Stats_t StatsAfter = Manager.GetMeshCacheStats();
+	CHECK(StatsAfter.nEvictions == StatsBefore.nEvictions + 2);
+	CHECK(StatsAfter.nEvictedBytes == StatsBefore.nEvictedBytes + aBytes[0] + aBytes[1]);
+	CHECK(aHandles[0].GetState() == MESH_LOAD_EVICTED);
+	CHECK(aHandles[1].GetState() == MESH_LOAD_EVICTED);
+	CHECK(aHandles[2].IsReady() && aHandles[3].IsReady());
+	CHECK(Manager.GetResidentMeshMemory() <= Manager.GetMeshMemoryBudget());
+	CHECK(pOwned->HasCPUData());
+
+	// The pinned mesh is uploaded again from its CPU copy, so it doesn't need its file any more.
+	std::filesystem::remove(aPaths[0]);
+	Manager.SetMeshMemoryBudget(nDefaultBudget);
+	CHECK(aHandles[0].Get() == nullptr && aHandles[1].Get() == nullptr);
+	CHECK(WaitUntilLoaded(Backend, { &aHandles[0], &aHandles[1] }));
+	CHECK(aHandles[0].IsReady() && aHandles[1].IsReady());
+
+	std::shared_ptr<CMesh> pPinned = aHandles[0].Get(), pReloaded = aHandles[1].Get();
+	CHECK(pPinned && pPinned->HasBuffers() && pPinned->HasCPUData());
+	CHECK(pReloaded && pReloaded->HasBuffers() && !pReloaded->HasCPUData());
+
+	Manager.ReleaseGPUResources();
+	CHECK(Manager.GetResidentMeshMemory() == 0);
+}
+
+// Requests for the same path share one load, and its mesh.
+TEST(ResourceManagerAsyncLoadSharesRequest) {
+	IResourceManager& Manager = IResourceManager::GetInstance();
+	CNullRenderBackend Backend;
+	MeshDirectory_t Directory("async");
+	const std::string strPath = Directory.WriteGrid("mesh.obj", 8);
+	const uint64_t nLoads = Manager.GetMeshCacheStats().nLoads;
+
+	CMeshHandle First = Manager.GetMeshAsync(strPath);
+	CMeshHandle Second = Manager.GetMeshAsync(strPath);
+	CHECK(First.GetState() == MESH_LOAD_PENDING && First.Get() == nullptr);
+	CHECK(WaitUntilLoaded(Backend, { &First, &Second }));
+
+	std::shared_ptr<CMesh> pMesh = First.Get();
+	CHECK(First.IsReady() && Second.IsReady());
+	CHECK(pMesh && pMesh->HasBuffers() && pMesh == Second.Get());
+	CHECK(Backend.GetBufferCount() > 0);
+	CHECK(Manager.GetMeshCacheStats().nLoads == nLoads + 1);
+
+	Manager.ReleaseGPUResources();
+	CHECK(Backend.GetBufferCount() == 0);
+}
+
+// GetMesh on a path that is loading asynchronously copies that load's data instead of parsing the file again,
+// and the async request still becomes resident with a mesh of its own.
+TEST(ResourceManagerGetMeshJoinsLoad) {
+	IResourceManager& Manager = IResourceManager::GetInstance();
+	CNullRenderBackend Backend;
+	MeshDirectory_t Directory("join");
+	const std::string strPath = Directory.WriteGrid("mesh.obj", 8);
+	const uint64_t nLoads = Manager.GetMeshCacheStats().nLoads;
+
+	CMeshHandle Handle = Manager.GetMeshAsync(strPath);
+	std::shared_ptr<CMesh> pOwned = Manager.GetMesh(strPath);
+	CHECK(pOwned && pOwned->HasCPUData() && pOwned->GetLODs()[0].nIndexCount == 8 * 8 * 6);
+	CHECK(Manager.GetMeshCacheStats().nLoads == nLoads + 1);
+
+	CHECK(WaitUntilLoaded(Backend, { &Handle }));
+	CHECK(Handle.IsReady() && Handle.Get() != pOwned);
+	CHECK(Manager.GetMesh(strPath) == pOwned);
+	CHECK(Manager.GetMeshCacheStats().nLoads == nLoads + 1);
+
+	Manager.ReleaseGPUResources();
+}
+
+// A job that needs a mesh whose load is still queued must not wait for a worker: on the engine-wide job
+// system the only one may be the thread running it. Nothing helps here, so a blocking wait would hang.
+TEST(ResourceManagerGetMeshFromJob) {
+	IResourceManager& Manager = IResourceManager::GetInstance();
+	CJobSystem& JobSystem = CJobSystem::GetInstance();
+	CNullRenderBackend Backend;
+	MeshDirectory_t Directory("job");
+	const std::string strPath = Directory.WriteGrid("mesh.obj", 8);
+
+	CMeshHandle Handle;
+	std::shared_ptr<CMesh> pOwned;
+	CJobCounter Counter;
+	JobSystem.Run([&] {
+		Handle = Manager.GetMeshAsync(strPath);
+		pOwned = Manager.GetMesh(strPath);
+	}, &Counter);
+
+	for (int i = 0; i < 10000 && !Counter.IsDone(); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(Counter.IsDone());
+	JobSystem.Wait(Counter);
+	CHECK(pOwned && pOwned->HasCPUData());
+
+	CHECK(WaitUntilLoaded(Backend, { &Handle }));
+	CHECK(Handle.IsReady());
+
+	Manager.ReleaseGPUResources();
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "../../FountEngine_1/src/engine/scene/CScene.hpp"
+#include "Test.hpp"
+
+namespace {
+	CMath::Vector3_t GetWorldPosition(const CScene& Scene, EntityHandle_t hEntity) {
+		const CMath::Matrix4x4_t& mWorld = Scene.GetWorldTransform(hEntity);
+		return CMath::Vector3_t(mWorld.m[3][0], mWorld.m[3][1], mWorld.m[3][2]);
+	}
+
+	bool IsAt(const CScene& Scene, EntityHandle_t hEntity, float x, float y, float z) {
+		const CMath::Vector3_t vecPosition = GetWorldPosition(Scene, hEntity);
+		return IsNear(vecPosition.x, x, 1e-5) && IsNear(vecPosition.y, y, 1e-5) && IsNear(vecPosition.z, z, 1e-5);
+	}
+}
+
+TEST(SceneParenting) {
+	CScene Scene;
+	const EntityHandle_t hRoot = Scene.CreateEntity();
+	const EntityHandle_t hChild = Scene.CreateEntity(hRoot);
+	const EntityHandle_t hGrandchild = Scene.CreateEntity(hChild);
+	CHECK(Scene.GetParent(hRoot) == INVALID_ENTITY);
+	CHECK(Scene.GetParent(hChild) == hRoot && Scene.GetParent(hGrandchild) == hChild);
+
+	// No cycles.
+	CHECK(!Scene.SetParent(hRoot, hRoot));
+	CHECK(!Scene.SetParent(hRoot, hGrandchild));
+	CHECK(Scene.GetParent(hRoot) == INVALID_ENTITY);
+
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nLevels == 3);
+
+	CHECK(Scene.SetParent(hGrandchild, hRoot));
+	CHECK(Scene.GetParent(hGrandchild) == hRoot);
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().bSorted && Scene.GetUpdateStats().nLevels == 2);
+
+	CHECK(Scene.SetParent(hChild, INVALID_ENTITY));
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetParent(hChild) == INVALID_ENTITY && Scene.GetParent(hGrandchild) == hRoot);
+}
+
+// Only changed entities and everything below them get new world transforms.
+TEST(SceneDirtyPropagation) {
+	CScene Scene;
+	const EntityHandle_t hRoot = Scene.CreateEntity();
+	const EntityHandle_t hChild = Scene.CreateEntity(hRoot);
+	const EntityHandle_t hGrandchild = Scene.CreateEntity(hChild);
+	const EntityHandle_t hOther = Scene.CreateEntity();
+	// A run of siblings goes through the batch multiply.
+	std::vector<EntityHandle_t> Siblings;
+	for (int i = 0; i < 5; ++i) {
+		Siblings.push_back(Scene.CreateEntity(hRoot));
+		Scene.SetLocalTransform(Siblings.back(), CMath::Matrix4x4_t::CreateTranslation(0.0f, 0.0f, static_cast<float>(i)));
+	}
+
+	Scene.SetLocalTransform(hRoot, CMath::Matrix4x4_t::CreateTranslation(1.0f, 0.0f, 0.0f));
+	Scene.SetLocalTransform(hChild, CMath::Matrix4x4_t::CreateTranslation(0.0f, 2.0f, 0.0f));
+	Scene.SetLocalTransform(hGrandchild, CMath::Matrix4x4_t::CreateTranslation(0.0f, 0.0f, 3.0f));
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 9);
+	CHECK(IsAt(Scene, hGrandchild, 1.0f, 2.0f, 3.0f));
+	CHECK(IsAt(Scene, Siblings[4], 1.0f, 0.0f, 4.0f));
+
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 0);
+
+	Scene.SetLocalTransform(hRoot, CMath::Matrix4x4_t::CreateTranslation(10.0f, 0.0f, 0.0f));
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 8);
+	CHECK(IsAt(Scene, hChild, 10.0f, 2.0f, 0.0f));
+	CHECK(IsAt(Scene, hGrandchild, 10.0f, 2.0f, 3.0f));
+	CHECK(IsAt(Scene, Siblings[2], 10.0f, 0.0f, 2.0f));
+	CHECK(IsAt(Scene, hOther, 0.0f, 0.0f, 0.0f));
+
+	Scene.SetLocalTransform(hGrandchild, CMath::Matrix4x4_t::CreateTranslation(0.0f, 0.0f, -3.0f));
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 1);
+	CHECK(IsAt(Scene, hGrandchild, 10.0f, 2.0f, -3.0f));
+
+	// Reparenting keeps the local transform, so the world one follows the new parent.
+	Scene.SetLocalTransform(hOther, CMath::Matrix4x4_t::CreateTranslation(0.0f, 5.0f, 0.0f));
+	CHECK(Scene.SetParent(hGrandchild, hOther));
+	Scene.UpdateTransforms();
+	CHECK(IsAt(Scene, hGrandchild, 0.0f, 5.0f, -3.0f));
+}
+
+TEST(SceneDestroyAndReuse) {
+	CScene Scene;
+	const EntityHandle_t hParent = Scene.CreateEntity();
+	const EntityHandle_t hChild = Scene.CreateEntity(hParent);
+	const EntityHandle_t hKept = Scene.CreateEntity();
+	Scene.SetLocalTransform(hKept, CMath::Matrix4x4_t::CreateTranslation(7.0f, 0.0f, 0.0f));
+	for (EntityHandle_t hEntity : { hParent, hChild, hKept }) {
+		Scene.SetLocalBounds(hEntity, CMath::Vector3_t(-0.5f, -0.5f, -0.5f), CMath::Vector3_t(0.5f, 0.5f, 0.5f));
+	}
+	Scene.UpdateTransforms();
+
+	std::vector<EntityHandle_t> Results;
+	Scene.QueryAABB(AABB_t::FromCenterExtent(CMath::Vector3_t(0.0f, 0.0f, 0.0f), CMath::Vector3_t(100.0f, 100.0f, 100.0f)), Results);
+	CHECK(Results.size() == 3);
+
+	// Children go with their parent.
+	Scene.DestroyEntity(hParent);
+	CHECK(!Scene.IsValid(hParent) && !Scene.IsValid(hChild));
+	CHECK(Scene.IsValid(hKept) && Scene.GetEntityCount() == 1);
+	Scene.DestroyEntity(hParent);
+	CHECK(Scene.GetEntityCount() == 1);
+
+	Scene.UpdateTransforms();
+	CHECK(IsAt(Scene, hKept, 7.0f, 0.0f, 0.0f));
+	Results.clear();
+	Scene.QueryAABB(AABB_t::FromCenterExtent(CMath::Vector3_t(0.0f, 0.0f, 0.0f), CMath::Vector3_t(100.0f, 100.0f, 100.0f)), Results);
+	CHECK(Results.size() == 1 && Results[0] == hKept);
+
+	// New entities take the freed slots, under handles the old ones don't match.
+	const EntityHandle_t hFirst = Scene.CreateEntity();
+	const EntityHandle_t hSecond = Scene.CreateEntity();
+	const uint32_t aFreed[] = { CScene::GetHandleIndex(hParent), CScene::GetHandleIndex(hChild) };
+	CHECK(std::find(std::begin(aFreed), std::end(aFreed), CScene::GetHandleIndex(hFirst)) != std::end(aFreed));
+	CHECK(std::find(std::begin(aFreed), std::end(aFreed), CScene::GetHandleIndex(hSecond)) != std::end(aFreed));
+	CHECK(hFirst != hParent && hFirst != hChild && hSecond != hParent && hSecond != hChild);
+	CHECK(Scene.IsValid(hFirst) && Scene.IsValid(hSecond));
+	CHECK(!Scene.IsValid(hParent) && !Scene.IsValid(hChild));
+	CHECK(!Scene.IsValid(INVALID_ENTITY));
+
+	// A stale handle neither destroys the new entity nor parents to it.
+	Scene.DestroyEntity(hParent);
+	CHECK(Scene.GetEntityCount() == 3);
+	const EntityHandle_t hOrphan = Scene.CreateEntity(hChild);
+	CHECK(Scene.GetParent(hOrphan) == INVALID_ENTITY);
+}
+
+// A mesh that is still loading gets its bounds once it is ready, not never.
+TEST(SceneTakesBoundsOfLoadedMesh) {
+	const std::filesystem::path Path = std::filesystem::temp_directory_path() / "fount_scene_mesh.obj";
+	{
+		std::ofstream sFile(Path, std::ios::binary | std::ios::trunc);
+		sFile << "v -1 -2 -3\nv 1 2 3\nv 1 -2 3\nf 1 2 3\n";
+	}
+
+	auto pRequest = std::make_shared<MeshRequest_t>();
+	pRequest->strFilePath = Path.string();
+	pRequest->pMesh = std::make_shared<CMesh>();
+	CHECK(pRequest->pMesh->LoadFromOBJ(pRequest->strFilePath));
+	std::error_code ErrorCode;
+	std::filesystem::remove(Path, ErrorCode);
+
+	CScene Scene;
+	const EntityHandle_t hEntity = Scene.CreateEntity();
+	Scene.SetLocalTransform(hEntity, CMath::Matrix4x4_t::CreateTranslation(10.0f, 0.0f, 0.0f));
+	Scene.SetMesh(hEntity, CMeshHandle(pRequest));
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetWorldExtentsX()[0] == 0.0f && Scene.GetWorldExtentsY()[0] == 0.0f);
+
+	pRequest->eState = MESH_LOAD_READY;
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 1);
+	CHECK_NEAR(Scene.GetWorldCentersX()[0], 10.0f, 1e-5);
+	CHECK_NEAR(Scene.GetWorldExtentsX()[0], 1.0f, 1e-5);
+	CHECK_NEAR(Scene.GetWorldExtentsY()[0], 2.0f, 1e-5);
+	CHECK_NEAR(Scene.GetWorldExtentsZ()[0], 3.0f, 1e-5);
+
+	std::vector<EntityHandle_t> Results;
+	Scene.QueryAABB(AABB_t::FromCenterExtent(CMath::Vector3_t(11.0f, 2.0f, 3.0f), CMath::Vector3_t(0.1f, 0.1f, 0.1f)), Results);
+	CHECK(Results.size() == 1 && Results[0] == hEntity);
+
+	// Only once.
+	Scene.UpdateTransforms();
+	CHECK(Scene.GetUpdateStats().nUpdated == 0);
+}
@@ -0,0 +1,159 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "../../FountEngine_1/src/render/shader/CShaderCache.hpp"
+#include "Test.hpp"
+
+// CShaderCache on a scratch directory: a shader that includes a header that includes another, and
+// a made-up blob standing in for the bytecode.
+namespace {
+	struct ShaderFixture_t {
+		std::filesystem::path Directory;
+		ShaderCacheKey_t Key;
+		std::vector<char> Bytecode;
+
+		explicit ShaderFixture_t(const char* szName)
+			: Directory(std::filesystem::temp_directory_path() / (std::string("fount_shader_cache_") + szName)) {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+			std::filesystem::create_directories(Directory);
+
+			WriteFile("shader.hlsl", "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return Tint(); }\n");
+			WriteFile("common.hlsli", "  #  include <nested.hlsli>\nfloat4 Tint() { return TINT; }\n");
+			WriteFile("nested.hlsli", "#define TINT float4(1, 0, 0, 1)\n");
+
+			Key.strSourcePath = (Directory / "shader.hlsl").string();
+			Key.strEntry = "main";
+			Key.strProfile = "ps_5_0";
+			Key.nFlags = 1;
+			Key.nCompilerVersion = 47;
+
+			for (int i = 0; i < 1000; ++i) {
+				Bytecode.push_back(static_cast<char>(i * 7));
+			}
+		}
+
+		~ShaderFixture_t() {
+			std::error_code ErrorCode;
+			std::filesystem::remove_all(Directory, ErrorCode);
+		}
+
+		std::string GetCacheDirectory() const { return (Directory / "cache").string(); }
+
+		void WriteFile(const char* szName, const std::string& strContents) const {
+			std::ofstream sFile(Directory / szName, std::ios::binary | std::ios::trunc);
+			sFile << strContents;
+		}
+	};
+}
+
+TEST(ShaderCacheMissStoreHit) {
+	ShaderFixture_t Fixture("hit");
+	CShaderCache Cache(Fixture.GetCacheDirectory());
+
+	std::vector<char> Loaded;
+	CHECK(!Cache.Load(Fixture.Key, Loaded));
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+	CHECK(std::filesystem::exists(Cache.GetEntryPath(Fixture.Key)));
+	CHECK(!std::filesystem::exists(Cache.GetEntryPath(Fixture.Key) + ".tmp"));
+
+	CHECK(Cache.Load(Fixture.Key, Loaded));
+	CHECK(Loaded == Fixture.Bytecode);
+
+	// A second cache on the same directory, like the next launch.
+	CShaderCache NextLaunch(Fixture.GetCacheDirectory());
+	Loaded.clear();
+	CHECK(NextLaunch.Load(Fixture.Key, Loaded));
+	CHECK(Loaded == Fixture.Bytecode);
+
+	CHECK(Cache.GetStats().nHits == 1 && Cache.GetStats().nMisses == 1 && Cache.GetStats().nStores == 1);
+}
+
+TEST(ShaderCacheKeyChangesMiss) {
+	ShaderFixture_t Fixture("key");
+	CShaderCache Cache(Fixture.GetCacheDirectory());
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+
+	std::vector<char> Loaded;
+	ShaderCacheKey_t Key = Fixture.Key;
+	Key.nFlags = 2;
+	CHECK(!Cache.Load(Key, Loaded));
+
+	Key = Fixture.Key;
+	Key.Defines.emplace_back("USE_FOG", "1");
+	CHECK(!Cache.Load(Key, Loaded));
+
+	Key = Fixture.Key;
+	Key.strProfile = "ps_5_1";
+	CHECK(!Cache.Load(Key, Loaded));
+
+	Key = Fixture.Key;
+	Key.nCompilerVersion = 48;
+	CHECK(!Cache.Load(Key, Loaded));
+	CHECK(Cache.GetEntryPath(Key) != Cache.GetEntryPath(Fixture.Key));
+
+	CHECK(Cache.Load(Fixture.Key, Loaded));
+}
+
+TEST(ShaderCacheEditedSourceMisses) {
+	ShaderFixture_t Fixture("stale");
+	CShaderCache Cache(Fixture.GetCacheDirectory());
+	const uint64_t nSourceHash = CShaderCache::HashSources(Fixture.Key.strSourcePath);
+	CHECK(nSourceHash != 0);
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+
+	// Only the header two levels down changes.
+	std::vector<char> Loaded;
+	Fixture.WriteFile("nested.hlsli", "#define TINT float4(0, 1, 0, 1)\n");
+	CHECK(CShaderCache::HashSources(Fixture.Key.strSourcePath) != nSourceHash);
+	CHECK(!Cache.Load(Fixture.Key, Loaded));
+
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+	CHECK(Cache.Load(Fixture.Key, Loaded));
+
+	Fixture.WriteFile("shader.hlsl", "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	CHECK(!Cache.Load(Fixture.Key, Loaded));
+}
+
+TEST(ShaderCacheMissingSourceHits) {
+	ShaderFixture_t Fixture("shipping");
+	CShaderCache Cache(Fixture.GetCacheDirectory());
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+
+	std::filesystem::remove(Fixture.Directory / "shader.hlsl");
+	CHECK(CShaderCache::HashSources(Fixture.Key.strSourcePath) == 0);
+
+	std::vector<char> Loaded;
+	CHECK(Cache.Load(Fixture.Key, Loaded));
+	CHECK(Loaded == Fixture.Bytecode);
+}
+
+TEST(ShaderCacheDamagedEntryMisses) {
+	ShaderFixture_t Fixture("damaged");
+	CShaderCache Cache(Fixture.GetCacheDirectory());
+	const std::string strEntryPath = Cache.GetEntryPath(Fixture.Key);
+	const uintmax_t nEntrySize = sizeof(ShaderCacheEntryHeader_t) + Fixture.Bytecode.size();
+
+	std::vector<char> Loaded;
+	for (uintmax_t nSize : { nEntrySize - 1, static_cast<uintmax_t>(sizeof(ShaderCacheEntryHeader_t)), static_cast<uintmax_t>(10) }) {
+		CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+		std::filesystem::resize_file(strEntryPath, nSize);
+		CHECK(!Cache.Load(Fixture.Key, Loaded));
+	}
+
+	// Right size, one flipped byte in the bytecode.
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+	{
+		std::fstream sFile(strEntryPath, std::ios::binary | std::ios::in | std::ios::out);
+		sFile.seekp(static_cast<std::streamoff>(nEntrySize - 100));
+		sFile.put(static_cast<char>(Fixture.Bytecode[Fixture.Bytecode.size() - 100] ^ 0x5A));
+	}
+	CHECK(!Cache.Load(Fixture.Key, Loaded));
+	CHECK(Loaded.empty());
+
+	CHECK(Cache.Store(Fixture.Key, Fixture.Bytecode));
+	CHECK(Cache.Load(Fixture.Key, Loaded));
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../FountEngine_1/src/render/vertex/CVertexPacker.hpp"
+#include "Test.hpp"
+
+// CVertexPacker against DecodeVertex in shaders.hlsl, spelled out here: the input assembler turns unorm16
+// into value / 65535 and snorm16 into max(value / 32767, -1), then the shader scales, biases and unfolds.
+namespace {
+	struct Random_t {
+		uint32_t nState = 0x0badf00du;
+
+		float Next(float flMin, float flMax) {
+			nState = nState * 1664525u + 1013904223u;
+			return flMin + (flMax - flMin) * static_cast<float>(nState >> 8) / static_cast<float>(1u << 24);
+		}
+	};
+
+	float DecodeUnorm16(uint16_t nValue) {
+		return nValue / 65535.0f;
+	}
+
+	float DecodeSnorm16(int16_t nValue) {
+		return std::max(nValue / 32767.0f, -1.0f);
+	}
+
+	// DecodeOctahedral() in shaders.hlsl.
+	CMath::Vector3_t DecodeOctahedral(float x, float y) {
+		CMath::Vector3_t vecNormal(x, y, 1.0f - fabsf(x) - fabsf(y));
+		const float flFold = std::clamp(-vecNormal.z, 0.0f, 1.0f);
+		vecNormal.x += vecNormal.x >= 0.0f ? -flFold : flFold;
+		vecNormal.y += vecNormal.y >= 0.0f ? -flFold : flFold;
+		return vecNormal.Normalize();
+	}
+
+	// Angle between the normal and its packed and decoded self, in radians.
+	double GetNormalError(const CMath::Vector3_t& vecNormal) {
+		const CMath::Vector2_t vecEncoded = CVertexPacker::EncodeOctahedral(vecNormal);
+		const int16_t nX = static_cast<int16_t>(std::lround(std::clamp(vecEncoded.x, -1.0f, 1.0f) * 32767.0f));
+		const int16_t nY = static_cast<int16_t>(std::lround(std::clamp(vecEncoded.y, -1.0f, 1.0f) * 32767.0f));
+		const CMath::Vector3_t vecDecoded = DecodeOctahedral(DecodeSnorm16(nX), DecodeSnorm16(nY));
+
+		// atan2 of the cross and dot products: acos would read float rounding in the decoded length as an angle.
+		const double ax = vecNormal.x, ay = vecNormal.y, az = vecNormal.z;
+		const double bx = vecDecoded.x, by = vecDecoded.y, bz = vecDecoded.z;
+		const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+		return atan2(sqrt(cx * cx + cy * cy + cz * cz), ax * bx + ay * by + az * bz);
+	}
+
+	// Two snorm16s over the octahedron's square: rounding to the nearest 1/32767 turns the normal by up to
+	// about 6e-5 radians where the mapping stretches most.
+	constexpr double MAX_NORMAL_ERROR = 1e-4;
+}
+
+TEST(VertexPackerOctahedralNormals) {
+	double flMaxError = 0.0;
+	auto Check = [&](float x, float y, float z) {
+		flMaxError = std::max(flMaxError, GetNormalError(CMath::Vector3_t(x, y, z)));
+	};
+
+	// The poles, the axes, and the equator, where the lower half folds over onto the upper one.
+	Check(0.0f, 0.0f, 1.0f);
+	Check(0.0f, 0.0f, -1.0f);
+	for (float flSign : { 1.0f, -1.0f }) {
+		Check(flSign, 0.0f, 0.0f);
+		Check(0.0f, flSign, 0.0f);
+		Check(flSign, flSign, 0.0f);
+		Check(flSign, -flSign, 0.0f);
+	}
+
+	// Just either side of the equator and next to the poles, all around, where the fold and the
+	// corners of the square meet.
+	for (int i = 0; i < 3600; ++i) {
+		const float flAngle = i * (2.0f * 3.14159265f / 3600.0f);
+		const float x = cosf(flAngle), y = sinf(flAngle);
+		for (float z : { 1e-4f, -1e-4f, 1e-7f, -1e-7f, 0.0f, -0.0f }) {
+			Check(x, y, z);
+		}
+		for (float z : { 1.0f, -1.0f }) {
+			Check(x * 1e-4f, y * 1e-4f, z);
+		}
+	}
+
+	Random_t Random;
+	for (int i = 0; i < 100000; ++i) {
+		CMath::Vector3_t vecNormal(Random.Next(-1.0f, 1.0f), Random.Next(-1.0f, 1.0f), Random.Next(-1.0f, 1.0f));
+		if (vecNormal.Length() > 1e-3f) {
+			Check(vecNormal.x, vecNormal.y, vecNormal.z);
+		}
+	}
+	CHECK(flMaxError < MAX_NORMAL_ERROR);
+
+	// Unnormalized normals encode like their normalized selves.
+	const CMath::Vector2_t vecUnit = CVertexPacker::EncodeOctahedral(CMath::Vector3_t(0.6f, -0.48f, -0.64f));
+	const CMath::Vector2_t vecScaled = CVertexPacker::EncodeOctahedral(CMath::Vector3_t(6.0f, -4.8f, -6.4f));
+	CHECK_NEAR(vecUnit.x, vecScaled.x, 1e-6);
+	CHECK_NEAR(vecUnit.y, vecScaled.y, 1e-6);
+}
+
+// Positions and texcoords come back within half a quantization step of their range, flat axes exactly.
+TEST(VertexPackerPositionsAndTexcoords) {
+	Random_t Random;
+	std::vector<Vertex_t> Vertices(5000);
+	for (Vertex_t& Vertex : Vertices) {
+		Vertex.vec3Position = CMath::Vector3_t(Random.Next(-120.0f, 80.0f), Random.Next(0.5f, 0.75f), 3.25f);
+		Vertex.vec3Normal = CMath::Vector3_t(0.0f, 1.0f, 0.0f);
+		Vertex.vec2Texcoord = CMath::Vector2_t(Random.Next(-2.0f, 6.0f), Random.Next(0.0f, 1.0f));
+	}
+	// The extremes, which have to land exactly on 0 and 65535.
+	Vertices[0].vec3Position.x = -120.0f;
+	Vertices[1].vec3Position.x = 80.0f;
+
+	std::vector<PackedVertex_t> Packed;
+	const VertexDecode_t Decode = CVertexPacker::Pack(Vertices, Packed);
+	CHECK(Packed.size() == Vertices.size());
+
+	const float aPositionRange[3] = { 200.0f, 0.25f, 0.0f };
+	const float aTexcoordRange[2] = { 8.0f, 1.0f };
+	bool bPositionsInBounds = true, bTexcoordsInBounds = true, bNormalsUp = true;
+	for (size_t i = 0; i < Vertices.size(); ++i) {
+		const PackedVertex_t& Vertex = Packed[i];
+		const float aDecoded[3] = {
+			DecodeUnorm16(Vertex.aPosition[0]) * Decode.vecPositionScale.x + Decode.vecPositionBias.x,
+			DecodeUnorm16(Vertex.aPosition[1]) * Decode.vecPositionScale.y + Decode.vecPositionBias.y,
+			DecodeUnorm16(Vertex.aPosition[2]) * Decode.vecPositionScale.z + Decode.vecPositionBias.z
+		};
+		const float aOriginal[3] = { Vertices[i].vec3Position.x, Vertices[i].vec3Position.y, Vertices[i].vec3Position.z };
+		for (int nAxis = 0; nAxis < 3; ++nAxis) {
+			// Half a step, and the float rounding of the values themselves.
+			const float flBound = aPositionRange[nAxis] / 65535.0f * 0.5f + fabsf(aOriginal[nAxis]) * 4e-7f;
+			bPositionsInBounds = bPositionsInBounds && fabsf(aDecoded[nAxis] - aOriginal[nAxis]) <= flBound;
+		}
+
+		const float u = DecodeUnorm16(Vertex.aTexcoord[0]) * Decode.vecTexcoordScaleBias.x + Decode.vecTexcoordScaleBias.z;
+		const float v = DecodeUnorm16(Vertex.aTexcoord[1]) * Decode.vecTexcoordScaleBias.y + Decode.vecTexcoordScaleBias.w;
+		bTexcoordsInBounds = bTexcoordsInBounds && fabsf(u - Vertices[i].vec2Texcoord.x) <= aTexcoordRange[0] / 65535.0f * 0.5f + 4e-6f &&
+			fabsf(v - Vertices[i].vec2Texcoord.y) <= aTexcoordRange[1] / 65535.0f * 0.5f + 1e-6f;
+
+		const CMath::Vector3_t vecNormal = DecodeOctahedral(DecodeSnorm16(Vertex.aNormal[0]), DecodeSnorm16(Vertex.aNormal[1]));
+		bNormalsUp = bNormalsUp && vecNormal.y > 0.9999f;
+	}
+	CHECK(bPositionsInBounds);
+	CHECK(bTexcoordsInBounds);
+	CHECK(bNormalsUp);
+
+	CHECK(Packed[0].aPosition[0] == 0 && Packed[1].aPosition[0] == 65535);
+	CHECK(Packed[2].aPosition[2] == 0 && Decode.vecPositionScale.z == 0.0f && Decode.vecPositionBias.z == 3.25f);
+
+	std::vector<PackedVertex_t> Empty;
+	CVertexPacker::Pack({}, Empty);
+	CHECK(Empty.empty());
+}
@@ -0,0 +1,42 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Test.hpp"
+
+namespace {
+	int s_nFailures = 0;
+}
+
+std::vector<TestCase_t>& GetTestCases() {
+	static std::vector<TestCase_t> TestCases;
+	return TestCases;
+}
+
+void ReportFailure(const char* szFile, int nLine, const char* szExpression) {
+	printf("  %s:%d: %s failed\n", szFile, nLine, szExpression);
+	++s_nFailures;
+}
+
+// FountTests [name...]: runs every registered case, or only the named ones.
+int main(int argc, char** argv) {
+	int nFailedCases = 0, nRun = 0;
+	for (const TestCase_t& TestCase : GetTestCases()) {
+		bool bSelected = argc < 2;
+		for (int i = 1; i < argc && !bSelected; ++i) {
+			bSelected = strcmp(argv[i], TestCase.szName) == 0;
+		}
+		if (!bSelected) {
+			continue;
+		}
+
+		const int nFailuresBefore = s_nFailures;
+		TestCase.pfnRun();
+		const bool bPassed = s_nFailures == nFailuresBefore;
+		printf("[%s] %s\n", bPassed ? "  OK  " : "FAILED", TestCase.szName);
+		nFailedCases += bPassed ? 0 : 1;
+		++nRun;
+	}
+
+	printf("%d of %d test cases passed\n", nRun - nFailedCases, nRun);
+	return nFailedCases == 0 && nRun > 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../FountEngine_1/src/system/filesystem/CMappedFile.hpp"
+#include "../../FountEngine_1/src/system/logging/CLogFormat.hpp"
+
+// Offline decoder for binary logs (CLogSystem::FORMAT_BINARY): formats every record the way the
+// text log would have and writes the result to stdout or to a file.
+namespace {
+	struct Site_t {
+		uint8_t nLevel = 0;
+		uint8_t nChannel = 0;
+		uint32_t nLine = 0;
+		std::string strFile;
+		std::string strFormat;
+	};
+
+	class CChunkReader {
+	public:
+		CChunkReader(const char* pData, size_t nSize) : m_pData(pData), m_nSize(nSize) {}
+
+		bool IsAtEnd() const { return m_nOffset >= m_nSize; }
+		size_t GetOffset() const { return m_nOffset; }
+
+		template <typename T>
+		bool Read(T& Value) {
+			if (m_nOffset + sizeof(T) > m_nSize) {
+				return false;
+			}
+			memcpy(&Value, m_pData + m_nOffset, sizeof(T));
+			m_nOffset += sizeof(T);
+			return true;
+		}
+
+		bool ReadString16(std::string_view& strValue) {
+			uint16_t nLength;
+			if (!Read(nLength) || m_nOffset + nLength > m_nSize) {
+				return false;
+			}
+			strValue = std::string_view(m_pData + m_nOffset, nLength);
+			m_nOffset += nLength;
+			return true;
+		}
+
+	private:
+		const char* m_pData;
+		size_t m_nSize;
+		size_t m_nOffset = 0;
+	};
+
+	void AppendLine(std::string& strOut, uint8_t nLevel, uint8_t nChannel, int64_t nTime, std::string_view strMessage) {
+		CLogFormat::AppendLine(strOut, CLogFormat::FormatTimeStamp(nTime), nLevel, nChannel, strMessage);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2 || argc > 3) {
+		printf("Usage: FountLogDecoder <log%s> [output.log]\n", CLogFormat::EXTENSION);
+		return 1;
+	}
+
+	CMappedFile File;
+	if (!File.Open(argv[1])) {
+		fprintf(stderr, "Failed to open %s\n", argv[1]);
+		return 1;
+	}
+
+	CChunkReader Reader(File.GetData(), File.GetSize());
+	uint32_t nMagic = 0;
+	uint32_t nVersion = 0;
+	if (!Reader.Read(nMagic) || !Reader.Read(nVersion) || nMagic != CLogFormat::MAGIC || nVersion != CLogFormat::VERSION) {
+		fprintf(stderr, "%s is not a version %u binary log\n", argv[1], CLogFormat::VERSION);
+		return 1;
+	}
+
+	std::vector<Site_t> Sites;
+	std::string strOut;
+	std::string strMessage;
+	size_t nEvents = 0;
+	bool bTruncated = false;
+
+	while (!Reader.IsAtEnd()) {
+		uint8_t nChunk = 0;
+		Reader.Read(nChunk);
+
+		if (nChunk == CLogFormat::CHUNK_SITE) {
+			uint32_t nSiteId;
+			Site_t Site;
+			std::string_view strFile, strFormat;
+			if (!Reader.Read(nSiteId) || nSiteId == 0 || !Reader.Read(Site.nLevel) || !Reader.Read(Site.nChannel) || !Reader.Read(Site.nLine) ||
+				!Reader.ReadString16(strFile) || !Reader.ReadString16(strFormat)) {
+				bTruncated = true;
+				break;
+			}
+
+			Site.strFile = strFile;
+			Site.strFormat = strFormat;
+			if (Sites.size() < nSiteId) {
+				Sites.resize(nSiteId);
+			}
+			Sites[nSiteId - 1] = std::move(Site);
+		}
+		else if (nChunk == CLogFormat::CHUNK_EVENT) {
+			uint32_t nSiteId;
+			int64_t nTime;
+			std::string_view strArguments;
+			if (!Reader.Read(nSiteId) || !Reader.Read(nTime) || !Reader.ReadString16(strArguments)) {
+				bTruncated = true;
+				break;
+			}
+
+			strMessage.clear();
+			if (nSiteId == 0 || nSiteId > Sites.size()) {
+				strMessage = "<unknown log site " + std::to_string(nSiteId) + ">";
+				AppendLine(strOut, 0, 0, nTime, strMessage);
+				continue;
+			}
+
+			const Site_t& Site = Sites[nSiteId - 1];
+			CLogFormat::FormatArguments(strMessage, Site.strFormat.c_str(), strArguments.data(), strArguments.size());
+			strMessage += " (" + Site.strFile + ":" + std::to_string(Site.nLine) + ")";
+			AppendLine(strOut, Site.nLevel, Site.nChannel, nTime, strMessage);
+			++nEvents;
+		}
+		else if (nChunk == CLogFormat::CHUNK_TEXT) {
+			uint8_t nLevel;
+			uint8_t nChannel;
+			int64_t nTime;
+			std::string_view strText;
+			if (!Reader.Read(nLevel) || !Reader.Read(nChannel) || !Reader.Read(nTime) || !Reader.ReadString16(strText)) {
+				bTruncated = true;
+				break;
+			}
+			AppendLine(strOut, nLevel, nChannel, nTime, strText);
+			++nEvents;
+		}
+		else {
+			fprintf(stderr, "Unknown chunk type %u at offset %zu\n", nChunk, Reader.GetOffset() - 1);
+			bTruncated = true;
+			break;
+		}
+	}
+
+	// A log cut short by a crash still decodes up to its last complete record.
+	if (bTruncated) {
+		fprintf(stderr, "Warning: %s ends in an incomplete record\n", argv[1]);
+	}
+
+	if (argc == 2) {
+		fwrite(strOut.data(), 1, strOut.size(), stdout);
+		return 0;
+	}
+
+	std::ofstream Output(argv[2], std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!Output.write(strOut.data(), static_cast<std::streamsize>(strOut.size()))) {
+		fprintf(stderr, "Failed to write %s\n", argv[2]);
+		return 1;
+	}
+
+	printf("Decoded %zu records from %s (%zu bytes) into %s\n", nEvents, argv[1], File.GetSize(), argv[2]);
+	return 0;
+}
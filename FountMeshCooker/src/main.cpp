@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../FountEngine_1/src/render/mesh/CMesh.hpp"
+#include "../../FountEngine_1/src/render/mesh/CMeshFile.hpp"
+#include "../../FountEngine_1/src/system/logging/CLogSystem.hpp"
+
+// Offline OBJ -> .fmesh cooker. Cooked files are written next to their sources, which is where
+// IResourceManager::GetMesh looks for them.
+static void PrintUsage() {
+	printf("Usage: FountMeshCooker [--force] [--no-optimize] [--lods N] [--no-meshlets] <model.obj> [model.obj ...]\n");
+	printf("  --force        recook even if the cooked file is up to date\n");
+	printf("  --no-optimize  skip the vertex cache / overdraw / vertex fetch optimization\n");
+	printf("  --lods N       levels of detail including the full mesh, 1 disables simplification (default 4)\n");
+	printf("  --no-meshlets  skip splitting the full detail mesh into clusters for culling\n");
+}
+
+int main(int argc, char** argv) {
+	bool bForce = false;
+	bool bOptimize = true;
+	uint32_t nLODCount = 4;
+	bool bMeshlets = true;
+	std::vector<std::string> Inputs;
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--force") == 0) {
+			bForce = true;
+		}
+		else if (strcmp(argv[i], "--no-optimize") == 0) {
+			bOptimize = false;
+		}
+		else if (strcmp(argv[i], "--no-meshlets") == 0) {
+			bMeshlets = false;
+		}
+		else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+			nLODCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argv[i][0] == '-') {
+			PrintUsage();
+			return 1;
+		}
+		else {
+			Inputs.emplace_back(argv[i]);
+		}
+	}
+
+	if (Inputs.empty() || nLODCount == 0 || nLODCount > MAX_MESH_LODS) {
+		PrintUsage();
+		return 1;
+	}
+
+	auto& LogSystem = CLogSystem::GetInstance();
+	LogSystem.SetConsoleColorsEnabled(false);
+	if (!LogSystem.Initialize("meshcooker.log")) {
+		fprintf(stderr, "Failed to initialize log system!\n");
+		return 1;
+	}
+
+	int nFailed = 0;
+	for (const std::string& strInput : Inputs) {
+		std::string strOutput = CMeshFile::GetCookedPath(strInput);
+		if (!bForce && CMeshFile::IsUpToDate(strOutput, strInput)) {
+			LOG_INFO_S("%s is up to date", strOutput.c_str());
+			continue;
+		}
+
+		CMesh Mesh;
+		if (!Mesh.LoadFromOBJ(strInput)) {
+			++nFailed;
+			continue;
+		}
+
+		if (nLODCount > 1) {
+			Mesh.GenerateLODs(nLODCount);
+		}
+
+		if (bOptimize) {
+			Mesh.Optimize();
+		}
+
+		if (bMeshlets) {
+			Mesh.BuildMeshlets();
+		}
+
+		if (!Mesh.SaveCooked(strOutput)) {
+			++nFailed;
+			continue;
+		}
+
+		LOG_INFO_S("Cooked %s -> %s", strInput.c_str(), strOutput.c_str());
+	}
+
+	LogSystem.Shutdown();
+	return nFailed == 0 ? 0 : 1;
+}